@@ -10,6 +10,7 @@
 #include <string>
 #include <atomic>
 #include <csignal>
+#include <cstdlib>
 #include <condition_variable>
 #include <mutex>
 
@@ -67,8 +68,20 @@ int main(int argc, char** argv) {
         std::cout << "=====================================" << std::endl;
         std::cout << std::endl;
 
+        // Optional: --time-scale <x> compresses simulated machine motion (recoat, startup)
+        double timeScale = 1.0;
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string(argv[i]) == "--time-scale") {
+                timeScale = std::atof(argv[i + 1]);
+            }
+        }
+
         // Server and thread lifecycle management
         auto server = std::make_unique<OpcUaSimServer>();
+        server->setTimeScale(timeScale);
+        if (server->timeScale() != 1.0) {
+            std::cout << "[MAIN] Time scale: x" << server->timeScale() << std::endl;
+        }
         std::unique_ptr<std::thread> server_thread;
         std::unique_ptr<std::thread> stdin_thread;
 
@@ -1,6 +1,8 @@
 #include "opcua_sim_server.h"
 #include <open62541/plugin/log_stdout.h>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <atomic>
 
@@ -19,7 +21,22 @@ void OpcUaSimServer::configure(const std::string& endpoint, const std::string& n
 bool OpcUaSimServer::start() {
     std::cout << "[START] Creating server..." << std::endl;
     
-    m_server = UA_Server_new();
+    // Listen on the port given in the endpoint (UA_Server_new() defaults to 4840)
+    UA_UInt16 port = 4840;
+    const size_t colon = m_endpoint.rfind(':');
+    if (colon != std::string::npos) {
+        const int parsed = std::atoi(m_endpoint.c_str() + colon + 1);
+        if (parsed > 0 && parsed < 65536) port = static_cast<UA_UInt16>(parsed);
+    }
+
+    if (port == 4840) {
+        m_server = UA_Server_new();
+    } else {
+        UA_ServerConfig config;
+        std::memset(&config, 0, sizeof(config));
+        UA_ServerConfig_setMinimal(&config, port, nullptr);
+        m_server = UA_Server_newWithConfig(&config);
+    }
     if (!m_server) {
         std::cerr << "[ERROR] Failed to create OPC UA server" << std::endl;
         return false;
@@ -47,6 +64,8 @@ bool OpcUaSimServer::start() {
 }
 
 void OpcUaSimServer::stop() {
+    m_running = false;
+    std::lock_guard<std::mutex> loopLock(m_loopMutex);  // wait for the current run() iteration
     if (m_server) {
         std::cout << "[STOP] Shutting down server..." << std::endl;
         UA_Server_run_shutdown(m_server);
@@ -60,7 +79,11 @@ void OpcUaSimServer::iterate() {
     if (!m_server) return;
     UA_Server_run_iterate(m_server, false);
     applyBehavior();
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    simulateWork(std::chrono::milliseconds(50));
+}
+
+void OpcUaSimServer::simulateWork(std::chrono::milliseconds machineTime) const {
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(machineTime.count() / m_timeScale));
 }
 
 void OpcUaSimServer::run() {
@@ -70,13 +93,17 @@ void OpcUaSimServer::run() {
     }
     
     std::cout << "[RUN] Server loop starting..." << std::endl;
-    std::atomic<bool> running(true);
+    m_running = true;
     
     try {
-        while (running) {
-            UA_Server_run_iterate(m_server, false);
-            applyBehavior();
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        while (m_running) {
+            {
+                std::lock_guard<std::mutex> loopLock(m_loopMutex);
+                if (!m_running || !m_server) break;
+                UA_Server_run_iterate(m_server, false);
+                applyBehavior();
+            }
+            simulateWork(std::chrono::milliseconds(50));
         }
     } catch (const std::exception& e) {
         std::cerr << "[EXCEPTION] Server loop: " << e.what() << std::endl;
@@ -209,7 +236,7 @@ void OpcUaSimServer::applyBehavior() {
     // 1) Startup Sequence
     if (m_state.StartUp && !m_state.StartUp_Done) {
         std::cout << "[SIM] Startup sequence initiated by client." << std::endl;
-        std::this_thread::sleep_for(std::chrono::seconds(2)); // Simulate work
+        simulateWork(std::chrono::seconds(2)); // Simulate work
         m_state.StartUp_Done = UA_TRUE;
         writeVar(nid_StartUp_Done, &m_state.StartUp_Done, &UA_TYPES[UA_TYPES_BOOLEAN]);
         std::cout << "[SIM] Startup sequence complete. StartUp_Done -> TRUE" << std::endl;
@@ -223,7 +250,7 @@ void OpcUaSimServer::applyBehavior() {
             for (int i = 0; i < m_state.Z_Stacks; ++i) {
                 m_state.Marcer_Source_Cylinder_ActualPosition += m_state.Delta_Source;
                 m_state.Marcer_Sink_Cylinder_ActualPosition += m_state.Delta_Sink;
-                std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Simulate movement
+                simulateWork(std::chrono::milliseconds(100)); // Simulate movement
             }
             m_state.MakeSurface_Done = UA_TRUE;
             writeVar(nid_MakeSurface_Done, &m_state.MakeSurface_Done, &UA_TYPES[UA_TYPES_BOOLEAN]);
@@ -247,7 +274,7 @@ void OpcUaSimServer::applyBehavior() {
         std::cout << "[SIM] Simulating recoater/platform movement..." << std::endl;
 
         // Simulate the work of preparing the layer (e.g., recoater movement)
-        std::this_thread::sleep_for(std::chrono::seconds(2)); // Simulate work
+        simulateWork(kLayerPrepTime); // Simulate work
 
         // Update cylinder positions based on Step_Source and Step_Sink
         m_state.Marcer_Source_Cylinder_ActualPosition += m_state.Step_Source;
@@ -4,6 +4,7 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <string>
 
 struct PlcState {
@@ -46,10 +47,19 @@ public:
     void run();  // Main server loop - blocks until stop() is called
     void stop();
 
+    // Time compression: simulated machine motion (startup, powder fill, recoat)
+    // and the server loop period are divided by scale. 1.0 = real time.
+    void setTimeScale(double scale) { m_timeScale = (scale > 0.0) ? scale : 1.0; }
+    double timeScale() const { return m_timeScale; }
+
+    // Machine time of one recoat (LaySurface -> LaySurface_Done), unscaled
+    static constexpr std::chrono::milliseconds kLayerPrepTime{2000};
+
 private:
     void setupNamespace();
     void addVariables();
     void applyBehavior();
+    void simulateWork(std::chrono::milliseconds machineTime) const;
 
     // open62541 server
     UA_Server* m_server = nullptr;
@@ -59,6 +69,9 @@ private:
 
     PlcState m_state;
     std::mutex m_mutex;
+    std::mutex m_loopMutex;            // held by run() per iteration, taken by stop()
+    std::atomic<bool> m_running{false};
+    double m_timeScale = 1.0;
 
     // NodeIds
     UA_NodeId nid_Z_Stacks;
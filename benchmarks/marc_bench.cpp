@@ -0,0 +1,640 @@
+// ============================================================================
+// marc_bench - Throughput benchmark for the MARC file pipeline
+// ============================================================================
+//
+// Measures layers/s and MB/s (MARC input bytes) for the portable pipeline
+// stages, without Qt, RTC5 or OPC UA:
+//
+//   readSlices::open                    whole-file load
+//   StreamingMarcReader::readNextLayer  layer-by-layer streaming read
+//   BuildValidator                      parallel pre-flight check (gates GUI Start)
+//   convertLayerToBlock                 marc::LayerConverter (production path)
+//   LayerIndex::build+nearest           packed Hilbert R-tree + 64 nearest queries per layer
+//   ContourOffsetter::apply             0.05 mm beam compensation of all contours
+//   HatchGenerator::apply               runtime scanline hatching of the contours
+//   IslandPartitioner::apply            5 mm chessboard islands of the file hatches
+//   PartExcluder::apply                 two excluded regions cut out of every layer
+//   writeSVG::writeLayer                one SVG file per layer
+//   SvgExportJob                        streamed, parallel SVG export (GUI path)
+//   LayerRaster::render                 tiled raster + mipmap pyramid (preview)
+//
+// Every input file is benchmarked as-is and as synthetic scaled copies whose
+// layer count is multiplied by --scale (layers replicated and renumbered, with
+// a valid index table), so results can be compared across file sizes.
+//
+// Results are written as JSON (default) or CSV to stdout or --out.
+//
+// Usage:
+//   marc_bench [options] [file.marc ...]
+//     --styles <json>     BuildStyle library (default: Femure_Build/Config/marc_build_styles.json)
+//     --scale <n,...>     synthetic layer-count multipliers (default: 4; 0 disables)
+//     --iterations <n>    repetitions per stage, best and median reported (default: 3)
+//     --format json|csv   output format (default: json)
+//     --out <file>        write results to file instead of stdout
+//     --work-dir <dir>    scratch directory for synthetic files and SVGs
+//     --keep              keep scratch files
+//     --no-svg            skip the writeSVG stage
+//
+// Without file arguments the two sample builds shipped with the repository
+// are used (Models/slicefile.marc, Femure_Build/Data/slicefile.marc).
+// ============================================================================
+
+#include "io/readSlices.h"
+#include "io/streamingmarcreader.h"
+#include "io/layerconverter.h"
+#include "io/buildstyle.h"
+#include "io/rtccommandblock.h"
+#include "io/writeSVG.h"
+#include "io/svgexportjob.h"
+#include "io/layerraster.h"
+#include "io/buildvalidator.h"
+#include "io/contouroffsetter.h"
+#include "io/hatchgenerator.h"
+#include "io/layerindex.h"
+#include "io/islandpartitioner.h"
+#include "io/partexcluder.h"
+#include "io/workerpool.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef MARCSLM_SOURCE_DIR
+#define MARCSLM_SOURCE_DIR "."
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::vector<std::string> files;
+    std::string stylesPath;
+    std::vector<unsigned> scales{4};
+    unsigned iterations = 3;
+    std::string format = "json";
+    std::string outPath;
+    std::string workDir;
+    bool keep = false;
+    bool svg = true;
+};
+
+struct StageResult {
+    std::string file;
+    std::string variant;        // "original" or "xN"
+    uint64_t fileBytes = 0;
+    uint32_t layers = 0;
+    std::string stage;
+    unsigned iterations = 0;
+    double bestSec = 0.0;
+    double medianSec = 0.0;
+    uint64_t items = 0;         // commands (convert) / output bytes (svg)
+    std::string itemsUnit;
+
+    double layersPerSec() const { return bestSec > 0.0 ? layers / bestSec : 0.0; }
+    double mbPerSec() const { return bestSec > 0.0 ? (fileBytes / (1024.0 * 1024.0)) / bestSec : 0.0; }
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+void usage() {
+    std::cerr <<
+        "Usage: marc_bench [options] [file.marc ...]\n"
+        "  --styles <json>     BuildStyle library JSON\n"
+        "  --scale <n,...>     synthetic layer-count multipliers (default 4, 0 = none)\n"
+        "  --iterations <n>    repetitions per stage (default 3)\n"
+        "  --format json|csv   output format (default json)\n"
+        "  --out <file>        output file (default stdout)\n"
+        "  --work-dir <dir>    scratch directory\n"
+        "  --keep              keep scratch files\n"
+        "  --no-svg            skip writeSVG stage\n";
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto next = [&](std::string& dst) {
+            if (i + 1 >= argc) return false;
+            dst = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--styles") { if (!next(opt.stylesPath)) return false; }
+        else if (a == "--scale") {
+            if (!next(v)) return false;
+            opt.scales.clear();
+            std::stringstream ss(v);
+            std::string tok;
+            while (std::getline(ss, tok, ',')) {
+                const unsigned n = static_cast<unsigned>(std::stoul(tok));
+                if (n > 1) opt.scales.push_back(n);
+            }
+        }
+        else if (a == "--iterations") {
+            if (!next(v)) return false;
+            opt.iterations = std::max(1u, static_cast<unsigned>(std::stoul(v)));
+        }
+        else if (a == "--format") {
+            if (!next(opt.format)) return false;
+            if (opt.format != "json" && opt.format != "csv") return false;
+        }
+        else if (a == "--out") { if (!next(opt.outPath)) return false; }
+        else if (a == "--work-dir") { if (!next(opt.workDir)) return false; }
+        else if (a == "--keep") { opt.keep = true; }
+        else if (a == "--no-svg") { opt.svg = false; }
+        else if (a == "-h" || a == "--help") { return false; }
+        else if (!a.empty() && a[0] == '-') { return false; }
+        else { opt.files.push_back(a); }
+    }
+    return true;
+}
+
+// Run fn `iterations` times, returning best and median wall time
+void timeStage(unsigned iterations, const std::function<void()>& fn, StageResult& r) {
+    std::vector<double> t;
+    t.reserve(iterations);
+    for (unsigned i = 0; i < iterations; ++i) {
+        const auto t0 = Clock::now();
+        fn();
+        t.push_back(secondsSince(t0));
+    }
+    std::sort(t.begin(), t.end());
+    r.iterations = iterations;
+    r.bestSec = t.front();
+    r.medianSec = t[t.size() / 2];
+}
+
+// ============================================================================
+// Synthetic scaled files
+// ============================================================================
+// Replicates the layer records of `src` `factor` times (renumbered, Z shifted
+// by the source build height) and appends a layer index table, producing a
+// file that both readers accept.
+bool writeScaledCopy(const std::string& src, const std::string& dst, unsigned factor, std::string& err) {
+    try {
+        marc::StreamingMarcReader reader(src);
+        const uint32_t srcLayers = reader.totalLayers();
+        std::vector<std::vector<char>> records(srcLayers);
+        float buildHeight = 0.0f;
+        for (uint32_t i = 0; i < srcLayers; ++i) {
+            reader.readNextLayerBytes(records[i]);
+            if (records[i].size() < sizeof(uint32_t) + sizeof(float)) {
+                err = "layer record too small";
+                return false;
+            }
+            float z = 0.0f;
+            std::memcpy(&z, records[i].data() + sizeof(uint32_t), sizeof(float));
+            buildHeight = std::max(buildHeight, z);
+        }
+
+        std::ofstream os(dst, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            err = "cannot create " + dst;
+            return false;
+        }
+
+        marc::MarcHeader hdr = reader.header();
+        hdr.totalLayers = srcLayers * factor;
+        os.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+
+        std::vector<uint64_t> offsets;
+        offsets.reserve(hdr.totalLayers);
+        uint32_t layerNumber = 0;
+        for (unsigned copy = 0; copy < factor; ++copy) {
+            for (auto& rec : records) {
+                offsets.push_back(static_cast<uint64_t>(os.tellp()));
+                float z = 0.0f;
+                std::memcpy(&z, rec.data() + sizeof(uint32_t), sizeof(float));
+                const float shiftedZ = z + buildHeight * static_cast<float>(copy);
+                ++layerNumber;
+                os.write(reinterpret_cast<const char*>(&layerNumber), sizeof(layerNumber));
+                os.write(reinterpret_cast<const char*>(&shiftedZ), sizeof(shiftedZ));
+                os.write(rec.data() + sizeof(uint32_t) + sizeof(float),
+                         static_cast<std::streamsize>(rec.size() - sizeof(uint32_t) - sizeof(float)));
+            }
+        }
+
+        hdr.indexTableOffset = static_cast<uint64_t>(os.tellp());
+        os.write(reinterpret_cast<const char*>(offsets.data()),
+                 static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+        os.seekp(0, std::ios::beg);
+        os.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        if (!os) {
+            err = "write failed for " + dst;
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        err = e.what();
+        return false;
+    }
+}
+
+// ============================================================================
+// Stages
+// ============================================================================
+
+void benchFile(const std::string& path, const std::string& label, const std::string& variant,
+               const marc::BuildStyleLibrary& styles, const Options& opt, const fs::path& svgDir,
+               std::vector<StageResult>& results) {
+    StageResult base;
+    base.file = label;
+    base.variant = variant;
+    base.fileBytes = static_cast<uint64_t>(fs::file_size(path));
+
+    // readSlices::open
+    {
+        StageResult r = base;
+        r.stage = "readSlices::open";
+        timeStage(opt.iterations, [&] {
+            marc::readSlices reader;
+            if (!reader.open(path)) throw std::runtime_error("readSlices::open failed: " + path);
+            r.layers = static_cast<uint32_t>(reader.layers().size());
+        }, r);
+        results.push_back(r);
+        base.layers = r.layers;
+    }
+
+    // StreamingMarcReader::readNextLayer
+    {
+        StageResult r = base;
+        r.stage = "StreamingMarcReader::readNextLayer";
+        r.itemsUnit = "geometries";
+        timeStage(opt.iterations, [&] {
+            marc::StreamingMarcReader reader(path);
+            uint64_t geometries = 0;
+            while (reader.hasNextLayer()) {
+                const marc::Layer L = reader.readNextLayer();
+                geometries += L.hatches.size() + L.polylines.size() + L.polygons.size();
+            }
+            r.layers = reader.totalLayers();
+            r.items = geometries;
+        }, r);
+        results.push_back(r);
+    }
+
+    // BuildValidator (reader thread + worker pool, straight from the file)
+    {
+        StageResult r = base;
+        r.stage = "BuildValidator";
+        r.itemsUnit = "issues";
+        timeStage(opt.iterations, [&] {
+            marc::BuildValidator check(fs::path(path).wstring(), opt.stylesPath);
+            if (!check.start() || !check.wait()) throw std::runtime_error("BuildValidator failed: " + check.errorMessage());
+            r.items = check.errorCount() + check.warningCount();
+        }, r);
+        results.push_back(r);
+    }
+
+    // The remaining stages work on decoded layers
+    marc::readSlices loaded;
+    if (!loaded.open(path)) throw std::runtime_error("readSlices::open failed: " + path);
+    const auto& layers = loaded.layers();
+
+    // convertLayerToBlock
+    {
+        StageResult r = base;
+        r.stage = "convertLayerToBlock";
+        r.itemsUnit = "commands";
+        const marc::LayerConverter converter(&styles);
+        timeStage(opt.iterations, [&] {
+            uint64_t commands = 0;
+            for (const auto& L : layers) {
+                marc::RTCCommandBlock block;
+                block.layerNumber = L.layerNumber;
+                block.layerHeight = L.layerHeight;
+                std::string err;
+                if (!converter.convert(L, block, &err)) throw std::runtime_error(err);
+                commands += block.commands.size();
+            }
+            r.items = commands;
+        }, r);
+        results.push_back(r);
+    }
+
+    // LayerIndex::build + nearest (queries on an 8 x 8 grid over the layer bounds)
+    {
+        StageResult r = base;
+        r.stage = "LayerIndex::build+nearest";
+        r.itemsUnit = "items";
+        marc::LayerIndex index;
+        timeStage(opt.iterations, [&] {
+            uint64_t items = 0;
+            for (const auto& L : layers) {
+                index.build(L);
+                items += index.size();
+                const marc::LayerIndex::Box b = index.bounds();
+                for (int q = 0; q < 64; ++q) {
+                    index.nearest(b.minX + (b.maxX - b.minX) * ((q % 8) + 0.5) / 8.0,
+                                  b.minY + (b.maxY - b.minY) * ((q / 8) + 0.5) / 8.0);
+                }
+            }
+            r.items = items;
+        }, r);
+        results.push_back(r);
+    }
+
+    // Geometry stages share one pool, as in the producer
+    marc::WorkerPool geometryPool;
+
+    // ContourOffsetter::apply (every style compensated by 0.05 mm)
+    {
+        StageResult r = base;
+        r.stage = "ContourOffsetter::apply";
+        r.itemsUnit = "contours";
+        marc::BuildStyleLibrary compensated = styles;
+        for (uint32_t type = 0; type < 256; ++type) {
+            if (marc::BuildStyle* s = compensated.getStyle(type)) s->beamCompensation = 0.05;
+        }
+        marc::ContourOffsetter offsetter(&compensated);
+        offsetter.setWorkerPool(&geometryPool);
+        timeStage(opt.iterations, [&] {
+            uint64_t contours = 0;
+            for (const auto& L : layers) {
+                marc::Layer copy = L;
+                contours += offsetter.apply(copy).offset;
+            }
+            r.items = contours;
+        }, r);
+        results.push_back(r);
+    }
+
+    // HatchGenerator::apply (file hatches replaced, spacing from the hatch style)
+    {
+        StageResult r = base;
+        r.stage = "HatchGenerator::apply";
+        r.itemsUnit = "vectors";
+        marc::HatchGenerator::Options hatchOpt;
+        hatchOpt.replaceExisting = true;
+        marc::HatchGenerator generator(&styles, hatchOpt);
+        generator.setWorkerPool(&geometryPool);
+        timeStage(opt.iterations, [&] {
+            uint64_t vectors = 0;
+            for (const auto& L : layers) {
+                marc::Layer copy = L;
+                vectors += generator.apply(copy);
+            }
+            r.items = vectors;
+        }, r);
+        results.push_back(r);
+    }
+
+    // IslandPartitioner::apply (default options: 5 mm chessboard)
+    {
+        StageResult r = base;
+        r.stage = "IslandPartitioner::apply";
+        r.itemsUnit = "vectors";
+        marc::IslandPartitioner islands;
+        islands.setWorkerPool(&geometryPool);
+        timeStage(opt.iterations, [&] {
+            uint64_t vectors = 0;
+            for (const auto& L : layers) {
+                marc::Layer copy = L;
+                vectors += islands.apply(copy).linesOut;
+            }
+            r.items = vectors;
+        }, r);
+        results.push_back(r);
+    }
+
+    // PartExcluder::apply (a centre square and a strip over the plate's contours)
+    {
+        StageResult r = base;
+        r.stage = "PartExcluder::apply";
+        r.itemsUnit = "geometries";
+        double minX = 1e30, minY = 1e30, maxX = -1e30, maxY = -1e30;
+        auto include = [&](const marc::Point& p) {
+            minX = std::min(minX, static_cast<double>(p.x)); maxX = std::max(maxX, static_cast<double>(p.x));
+            minY = std::min(minY, static_cast<double>(p.y)); maxY = std::max(maxY, static_cast<double>(p.y));
+        };
+        for (const auto& L : layers) {
+            for (const auto& p : L.polygons) for (const auto& pt : p.points) include(pt);
+            for (const auto& p : L.polylines) for (const auto& pt : p.points) include(pt);
+        }
+        marc::PartExcluder::Rules rules;
+        if (maxX > minX) {
+            const double w = maxX - minX, h = maxY - minY;
+            rules.regions.push_back({ minX + 0.4 * w, minY + 0.4 * h, minX + 0.6 * w, minY + 0.6 * h, "centre" });
+            rules.regions.push_back({ minX + 0.1 * w, minY, minX + 0.15 * w, maxY, "strip" });
+        }
+        timeStage(opt.iterations, [&] {
+            uint64_t geometries = 0;
+            for (const auto& L : layers) {
+                marc::Layer copy = L;
+                const marc::PartExcluder::Stats st = marc::PartExcluder::apply(rules, copy);
+                geometries += st.removed + st.clipped;
+            }
+            r.items = geometries;
+        }, r);
+        results.push_back(r);
+    }
+
+    // LayerRaster::render
+    {
+        StageResult r = base;
+        r.stage = "LayerRaster::render";
+        r.itemsUnit = "pixels";
+        marc::LayerRaster raster;
+        timeStage(opt.iterations, [&] {
+            uint64_t pixels = 0;
+            for (const auto& L : layers) {
+                raster.render(L);
+                pixels += raster.stats().pixels;
+            }
+            r.items = pixels;
+        }, r);
+        results.push_back(r);
+    }
+
+    // writeSVG::writeLayer
+    if (opt.svg) {
+        StageResult r = base;
+        r.stage = "writeSVG::writeLayer";
+        r.itemsUnit = "output_bytes";
+        const fs::path dir = svgDir / (label + "_" + variant);
+        fs::create_directories(dir);
+        const marc::writeSVG writer;
+        std::string buffer;
+        timeStage(opt.iterations, [&] {
+            for (const auto& L : layers) {
+                const std::string out = (dir / ("layer_" + std::to_string(L.layerNumber) + ".svg")).string();
+                if (!writer.writeLayer(L, out, buffer)) throw std::runtime_error("writeLayer failed: " + out);
+            }
+        }, r);
+        uint64_t bytes = 0;
+        for (const auto& e : fs::directory_iterator(dir)) bytes += static_cast<uint64_t>(e.file_size());
+        r.items = bytes;
+        results.push_back(r);
+        if (!opt.keep) fs::remove_all(dir);
+    }
+
+    // SvgExportJob (reader thread + worker pool, straight from the file)
+    if (opt.svg) {
+        StageResult r = base;
+        r.stage = "SvgExportJob";
+        r.itemsUnit = "output_bytes";
+        const fs::path dir = svgDir / (label + "_" + variant + "_job");
+        timeStage(opt.iterations, [&] {
+            marc::SvgExportJob job(fs::path(path).wstring(), dir.string(), marc::writeSVG::Options());
+            if (!job.start() || !job.wait()) throw std::runtime_error("SvgExportJob failed: " + job.errorMessage());
+        }, r);
+        uint64_t bytes = 0;
+        for (const auto& e : fs::directory_iterator(dir)) bytes += static_cast<uint64_t>(e.file_size());
+        r.items = bytes;
+        results.push_back(r);
+        if (!opt.keep) fs::remove_all(dir);
+    }
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+std::string toJson(const std::vector<StageResult>& results, const Options& opt) {
+    nlohmann::json doc;
+    doc["tool"] = "marc_bench";
+    doc["schema"] = 1;
+    doc["iterations"] = opt.iterations;
+#if defined(__clang__)
+    doc["compiler"] = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    doc["compiler"] = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    doc["compiler"] = "msvc " + std::to_string(_MSC_VER);
+#endif
+#ifdef NDEBUG
+    doc["build"] = "release";
+#else
+    doc["build"] = "debug";
+#endif
+
+    nlohmann::json arr = nlohmann::json::array();
+    for (const auto& r : results) {
+        nlohmann::json j;
+        j["file"] = r.file;
+        j["variant"] = r.variant;
+        j["file_bytes"] = r.fileBytes;
+        j["layers"] = r.layers;
+        j["stage"] = r.stage;
+        j["best_s"] = r.bestSec;
+        j["median_s"] = r.medianSec;
+        j["layers_per_s"] = r.layersPerSec();
+        j["mb_per_s"] = r.mbPerSec();
+        if (!r.itemsUnit.empty()) j[r.itemsUnit] = r.items;
+        arr.push_back(std::move(j));
+    }
+    doc["results"] = std::move(arr);
+    return doc.dump(2) + "\n";
+}
+
+std::string toCsv(const std::vector<StageResult>& results) {
+    std::ostringstream os;
+    os << "file,variant,file_bytes,layers,stage,iterations,best_s,median_s,layers_per_s,mb_per_s,items,items_unit\n";
+    char buf[256];
+    for (const auto& r : results) {
+        std::snprintf(buf, sizeof(buf), "%.6f,%.6f,%.1f,%.2f",
+                      r.bestSec, r.medianSec, r.layersPerSec(), r.mbPerSec());
+        os << r.file << ',' << r.variant << ',' << r.fileBytes << ',' << r.layers << ','
+           << r.stage << ',' << r.iterations << ',' << buf << ','
+           << r.items << ',' << r.itemsUnit << '\n';
+    }
+    return os.str();
+}
+
+// Stable label for a sample path: project directory + stem
+// (".../Femure_Build/Data/slicefile.marc" -> "Femure_Build_slicefile")
+std::string labelFor(const fs::path& p) {
+    fs::path dir = p.parent_path();
+    if (dir.filename() == "Data") dir = dir.parent_path();
+    const std::string parent = dir.filename().string();
+    return (parent.empty() ? std::string() : parent + "_") + p.stem().string();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage();
+        return 2;
+    }
+
+    const fs::path root(MARCSLM_SOURCE_DIR);
+    if (opt.files.empty()) {
+        opt.files.push_back((root / "Models" / "slicefile.marc").string());
+        opt.files.push_back((root / "Femure_Build" / "Data" / "slicefile.marc").string());
+    }
+    if (opt.stylesPath.empty()) {
+        opt.stylesPath = (root / "Femure_Build" / "Config" / "marc_build_styles.json").string();
+    }
+
+    marc::BuildStyleLibrary styles;
+    try {
+        styles.loadFromJson(opt.stylesPath);
+    } catch (const std::exception& e) {
+        std::cerr << "marc_bench: warning: could not load build styles from " << opt.stylesPath
+                  << " (conversion runs without parameter segments): " << e.what() << "\n";
+    }
+
+    const fs::path work = opt.workDir.empty()
+        ? fs::temp_directory_path() / "marc_bench"
+        : fs::path(opt.workDir);
+    fs::create_directories(work);
+
+    std::vector<StageResult> results;
+    try {
+        for (const auto& file : opt.files) {
+            if (!marc::readSlices::isMarcFile(file)) {
+                std::cerr << "marc_bench: skipping " << file << " (not a MARC file)\n";
+                continue;
+            }
+            const std::string label = labelFor(fs::path(file));
+            std::cerr << "marc_bench: " << label << " (original)\n";
+            benchFile(file, label, "original", styles, opt, work, results);
+
+            for (unsigned factor : opt.scales) {
+                const std::string variant = "x" + std::to_string(factor);
+                const std::string scaled = (work / (label + "_" + variant + ".marc")).string();
+                std::string err;
+                if (!writeScaledCopy(file, scaled, factor, err)) {
+                    std::cerr << "marc_bench: cannot create scaled copy of " << file << ": " << err << "\n";
+                    continue;
+                }
+                std::cerr << "marc_bench: " << label << " (" << variant << ")\n";
+                benchFile(scaled, label, variant, styles, opt, work, results);
+                if (!opt.keep) fs::remove(scaled);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "marc_bench: error: " << e.what() << "\n";
+        return 1;
+    }
+
+    const std::string text = (opt.format == "csv") ? toCsv(results) : toJson(results, opt);
+    if (opt.outPath.empty()) {
+        std::cout << text;
+    } else {
+        std::ofstream os(opt.outPath, std::ios::trunc);
+        if (!os) {
+            std::cerr << "marc_bench: cannot write " << opt.outPath << "\n";
+            return 1;
+        }
+        os << text;
+        std::cerr << "marc_bench: results written to " << opt.outPath << "\n";
+    }
+    return results.empty() ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+// ============================================================================
+// marc_energy - Per-layer energy density / coverage maps of a whole build
+// ============================================================================
+//
+// Streams a .marc file through EnergyMapEngine (io/energymap.*) on all cores
+// and writes energy_maps.bin, energy_stats.json and optional PNG images to
+// --out. The build summary is printed to stdout as JSON.
+//
+//   energy   [J/mm^2]  sum of (P / v) * length per cell / cell area
+//   coverage [-]       sum of h * length per cell / cell area (1.0 = nominal)
+//
+// Exit code: 0 = no hotspot cells, 3 = hotspots found, 1 = error, 2 = usage.
+//
+// Usage:
+//   marc_energy [options] [file.marc]
+//     --styles <json>         BuildStyle library (default: Femure_Build/Config/marc_build_styles.json)
+//     --cell <mm>             grid cell size (default: 0.5)
+//     --plate <x,y,w,h>       plate rectangle in mm (default: bounding box of the build)
+//     --hotspot <J/mm^2>      hotspot threshold (default: 1.5 x highest nominal P/(v*h))
+//     --workers <n>           worker threads (default: hardware concurrency)
+//     --out <dir>             output folder (default: <tmp>/marc_energy)
+//     --png                   also write png/layer_NNNNNN.png
+//     --no-binary             skip energy_maps.bin
+// ============================================================================
+
+#include "io/energymap.h"
+#include "io/buildstyle.h"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#ifndef MARCSLM_SOURCE_DIR
+#define MARCSLM_SOURCE_DIR "."
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string marcPath;
+    std::string stylesPath;
+    std::string outDir;
+    marc::EnergyMapEngine::Options engine;
+};
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (a == "--styles" && hasValue) opt.stylesPath = argv[++i];
+        else if (a == "--cell" && hasValue) opt.engine.cellSize = std::atof(argv[++i]);
+        else if (a == "--plate" && hasValue) {
+            auto& e = opt.engine;
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf", &e.plateMinX, &e.plateMinY, &e.plateWidth, &e.plateHeight) != 4) {
+                return false;
+            }
+        }
+        else if (a == "--hotspot" && hasValue) opt.engine.hotspotJmm2 = std::atof(argv[++i]);
+        else if (a == "--workers" && hasValue) opt.engine.workers = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (a == "--out" && hasValue) opt.outDir = argv[++i];
+        else if (a == "--png") opt.engine.writeImages = true;
+        else if (a == "--no-binary") opt.engine.writeBinary = false;
+        else if (!a.empty() && a[0] == '-') return false;
+        else opt.marcPath = a;
+    }
+    return opt.engine.cellSize > 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "Usage: marc_energy [--styles <json>] [--cell <mm>] [--plate <x,y,w,h>] [--hotspot <J/mm^2>]\n"
+                     "                   [--workers <n>] [--out <dir>] [--png] [--no-binary] [file.marc]\n";
+        return 2;
+    }
+
+    const fs::path root(MARCSLM_SOURCE_DIR);
+    if (opt.marcPath.empty()) opt.marcPath = (root / "Femure_Build" / "Data" / "slicefile.marc").string();
+    if (opt.stylesPath.empty()) opt.stylesPath = (root / "Femure_Build" / "Config" / "marc_build_styles.json").string();
+    if (opt.outDir.empty()) opt.outDir = (fs::temp_directory_path() / "marc_energy").string();
+
+    marc::BuildStyleLibrary styles;
+    try {
+        styles.loadFromJson(opt.stylesPath);
+    } catch (const std::exception& e) {
+        std::cerr << "marc_energy: cannot load build styles from " << opt.stylesPath << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    marc::EnergyMapEngine engine(&styles, opt.engine);
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!engine.run(fs::path(opt.marcPath).wstring(), opt.outDir)) {
+        std::cerr << "marc_energy: " << engine.errorMessage() << "\n";
+        return 1;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    nlohmann::json report = nlohmann::json::parse(engine.statsJson())["summary"];
+    report["file"] = opt.marcPath;
+    report["out"] = opt.outDir;
+    report["cell_mm"] = engine.grid().cellSize;
+    report["nominal_max_j_per_mm2"] = engine.nominalMaxDensity();
+    report["hotspot_threshold_j_per_mm2"] = engine.hotspotThreshold();
+    report["seconds"] = seconds;
+    report["layers_per_s"] = seconds > 0.0 ? engine.layersDone() / seconds : 0.0;
+    std::cout << report.dump(2) << "\n";
+
+    return report.value("hotspot_cells", 0ull) > 0 ? 3 : 0;
+}
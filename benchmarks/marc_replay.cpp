@@ -0,0 +1,292 @@
+// ============================================================================
+// marc_replay - Whole-build replay through ScanStreamingManager, no machine
+// ============================================================================
+//
+// Runs a production build (startProcess) end to end with:
+//   - the simulated scanner backend (scanner/ScannerSim.cpp)
+//   - the OPC UA PLC simulator (OPCUASimulator/opcua_sim_server.*) in-process,
+//     reached through the real OPCServerManagerUA client
+//   - a LaySurface_Done poller standing in for ProcessController::onTimerTick
+//
+// Machine time (galvo motion, recoat, list settle delay, PLC poll period) is
+// divided by --time-scale; software costs (OPC round trips, client-side
+// sleeps, conversion) run at their real speed. The report projects the build
+// back to machine time:
+//
+//   layers_per_hour         layers / projected build time
+//   idle_galvo_pct          share of projected build time the galvo is not marking/jumping
+//   handshake_overhead_ms   per layer: PLC wait minus simulated recoat, plus handshake stage
+//   peak_rss_mb             peak resident memory of the process
+//
+// Usage:
+//   marc_replay [options] [file.marc]
+//     --styles <json>       BuildStyle library (default: Femure_Build/Config/marc_build_styles.json)
+//     --time-scale <x>      machine-time compression (default: 50)
+//     --port <n>            simulator port (default: 48400)
+//     --report-dir <dir>    layer_timing.jsonl destination (default: <tmp>/marc_replay)
+//     --out <file>          write the JSON report to file instead of stdout
+//     --verbose             echo ScanStreamingManager status messages to stderr
+// ============================================================================
+
+#include "controllers/scanstreamingmanager.h"
+#include "opcserver/opcserverua.h"
+#include "OPCUASimulator/opcua_sim_server.h"
+#include "Scanner.h"
+#include "diagnostics/metrics.h"
+
+#include <nlohmann/json.hpp>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef MARCSLM_SOURCE_DIR
+#define MARCSLM_SOURCE_DIR "."
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string marcPath;
+    std::string stylesPath;
+    double timeScale = 50.0;
+    int port = 48400;
+    std::string reportDir;
+    std::string outPath;
+    bool verbose = false;
+};
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (a == "--styles" && hasValue) opt.stylesPath = argv[++i];
+        else if (a == "--time-scale" && hasValue) opt.timeScale = std::atof(argv[++i]);
+        else if (a == "--port" && hasValue) opt.port = std::atoi(argv[++i]);
+        else if (a == "--report-dir" && hasValue) opt.reportDir = argv[++i];
+        else if (a == "--out" && hasValue) opt.outPath = argv[++i];
+        else if (a == "--verbose") opt.verbose = true;
+        else if (!a.empty() && a[0] == '-') return false;
+        else opt.marcPath = a;
+    }
+    return opt.timeScale > 0.0 && opt.port > 0 && opt.port < 65536;
+}
+
+double peakRssMB() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return static_cast<double>(pmc.PeakWorkingSetSize) / (1024.0 * 1024.0);
+    }
+    return 0.0;
+#else
+    struct rusage ru {};
+    getrusage(RUSAGE_SELF, &ru);
+#if defined(__APPLE__)
+    return static_cast<double>(ru.ru_maxrss) / (1024.0 * 1024.0);   // bytes
+#else
+    return static_cast<double>(ru.ru_maxrss) / 1024.0;              // KiB
+#endif
+#endif
+}
+
+struct LayerStages {
+    double plcWaitS = 0.0;
+    double listExecS = 0.0;
+    double handshakeS = 0.0;
+};
+
+std::vector<LayerStages> readLayerTiming(const fs::path& file) {
+    std::vector<LayerStages> layers;
+    std::ifstream in(file);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        const auto j = nlohmann::json::parse(line, nullptr, false);
+        if (j.is_discarded()) continue;
+        LayerStages s;
+        s.plcWaitS = j.value("plc_wait_us", 0.0) * 1e-6;
+        s.listExecS = j.value("list_exec_us", 0.0) * 1e-6;
+        s.handshakeS = j.value("handshake_us", 0.0) * 1e-6;
+        layers.push_back(s);
+    }
+    return layers;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "Usage: marc_replay [--styles <json>] [--time-scale <x>] [--port <n>]\n"
+                     "                   [--report-dir <dir>] [--out <file>] [--verbose] [file.marc]\n";
+        return 2;
+    }
+
+    const fs::path root(MARCSLM_SOURCE_DIR);
+    if (opt.marcPath.empty()) opt.marcPath = (root / "Femure_Build" / "Data" / "slicefile.marc").string();
+    if (opt.stylesPath.empty()) opt.stylesPath = (root / "Femure_Build" / "Config" / "marc_build_styles.json").string();
+    if (opt.reportDir.empty()) opt.reportDir = (fs::temp_directory_path() / "marc_replay").string();
+
+    // ========== Simulated card ==========
+    ScannerSimulation::Settings simSettings;
+    simSettings.timeScale = opt.timeScale;
+    ScannerSimulation::configure(simSettings);
+    ScannerSimulation::resetStats();
+
+    // ========== Simulated PLC (in-process OPC UA server) ==========
+    const std::string endpoint = "opc.tcp://localhost:" + std::to_string(opt.port);
+    OpcUaSimServer plc;
+    plc.setTimeScale(opt.timeScale);
+    plc.configure(endpoint, "urn:codesys:dlms:simulation", 2);
+    if (!plc.start()) {
+        std::cerr << "marc_replay: cannot start PLC simulator on " << endpoint << "\n";
+        return 1;
+    }
+    std::thread plcThread([&plc] { plc.run(); });
+
+    qputenv("OPC_UA_URL", QByteArray::fromStdString(endpoint));
+    OPCServerManagerUA opc;
+    if (!opc.initialize()) {
+        std::cerr << "marc_replay: OPC UA client cannot connect to " << endpoint << "\n";
+        plc.stop();
+        plcThread.join();
+        return 1;
+    }
+
+    // ========== Streaming pipeline under test ==========
+    const auto listStartDelay = std::chrono::milliseconds(2000);
+    ScanStreamingManager manager;
+    manager.setOPCManager(&opc);
+    manager.setReportDirectory(fs::path(opt.reportDir).wstring());
+    manager.setListStartDelay(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::duration<double, std::milli>(listStartDelay.count() / opt.timeScale)));
+
+    bool failed = false;
+    QObject::connect(&manager, &ScanStreamingManager::statusMessage, &app, [&opt](const QString& msg) {
+        if (opt.verbose) std::cerr << msg.toStdString() << "\n";
+    });
+    QObject::connect(&manager, &ScanStreamingManager::error, &app, [&failed](const QString& msg) {
+        std::cerr << "marc_replay: " << msg.toStdString() << "\n";
+        // Some consumer start-up failures return without emitting finished()
+        if (msg.startsWith("CRITICAL") || msg.startsWith("ERROR")) {
+            failed = true;
+            QCoreApplication::quit();
+        }
+    });
+    QObject::connect(&manager, &ScanStreamingManager::finished, &app, &QCoreApplication::quit);
+
+    // PLC poll, same edge detection as ProcessController (500 ms machine-time period)
+    bool previousDone = false;
+    uint32_t reportedLayers = 0;
+    QTimer poll;
+    poll.setInterval(std::max(1, static_cast<int>(500.0 / opt.timeScale)));
+    QObject::connect(&poll, &QTimer::timeout, &app, [&] {
+        OPCServerManagerUA::OPCData data;
+        if (!opc.readData(data)) return;
+        const bool done = (data.powderSurfaceDone != 0);
+        if (done && !previousDone) manager.notifyPLCPrepared();
+        previousDone = done;
+
+        const PipelineStatus::Snapshot s = manager.status().snapshot();
+        if (s.layersExecuted != reportedLayers && (s.layersExecuted % 25 == 0 || s.layersExecuted == s.layersTotal)) {
+            reportedLayers = s.layersExecuted;
+            std::cerr << "marc_replay: layer " << s.layersExecuted << "/" << s.layersTotal << "\n";
+        }
+    });
+
+    const fs::path metricsFile = fs::path(opt.reportDir) / "metrics.prom";
+    marc::metrics::Registry::instance().startExporter(metricsFile);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    poll.start();
+    if (!manager.startProcess(fs::path(opt.marcPath).wstring(), fs::path(opt.stylesPath).wstring())) {
+        failed = true;
+    } else {
+        app.exec();
+    }
+    poll.stop();
+    const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    manager.stopProcess();
+    marc::metrics::Registry::instance().stopExporter();
+    opc.stop();
+    plc.stop();
+    plcThread.join();
+
+    // ========== Report ==========
+    const std::vector<LayerStages> layers = readLayerTiming(fs::path(opt.reportDir) / "layer_timing.jsonl");
+    const ScannerSimulation::Stats sim = ScannerSimulation::stats();
+    const size_t n = layers.size();
+
+    const double recoatS = std::chrono::duration<double>(OpcUaSimServer::kLayerPrepTime).count();
+    const double settleS = std::chrono::duration<double>(listStartDelay).count();
+    const double compressedS = sim.busySeconds + n * (recoatS + settleS);      // machine time
+    const double projectedS = wallS + compressedS * (1.0 - 1.0 / opt.timeScale);
+
+    std::vector<double> overheadMs;
+    overheadMs.reserve(n);
+    for (const auto& l : layers) {
+        const double plcOverhead = std::max(0.0, l.plcWaitS - recoatS / opt.timeScale);
+        overheadMs.push_back((plcOverhead + l.handshakeS) * 1000.0);
+    }
+    std::sort(overheadMs.begin(), overheadMs.end());
+    double overheadMean = 0.0;
+    for (double v : overheadMs) overheadMean += v;
+    if (n > 0) overheadMean /= static_cast<double>(n);
+
+    nlohmann::json doc;
+    doc["tool"] = "marc_replay";
+    doc["schema"] = 1;
+    doc["marc"] = opt.marcPath;
+    doc["time_scale"] = opt.timeScale;
+    doc["completed"] = !failed;
+    doc["layers"] = n;
+    doc["wall_s"] = wallS;
+    doc["projected_build_s"] = projectedS;
+    doc["layers_per_hour"] = projectedS > 0.0 ? n / projectedS * 3600.0 : 0.0;
+    doc["scan_s"] = sim.busySeconds;
+    doc["idle_galvo_pct"] = projectedS > 0.0 ? 100.0 * (1.0 - sim.busySeconds / projectedS) : 0.0;
+    doc["handshake_overhead_ms"] = {
+        {"mean", overheadMean},
+        {"p50", n ? overheadMs[n / 2] : 0.0},
+        {"p90", n ? overheadMs[std::min(n - 1, n * 9 / 10)] : 0.0},
+        {"max", n ? overheadMs.back() : 0.0}
+    };
+    doc["scanner"] = {
+        {"lists", sim.listsExecuted}, {"jumps", sim.jumps}, {"marks", sim.marks},
+        {"mark_mm", sim.markMM}, {"jump_mm", sim.jumpMM}
+    };
+    doc["peak_rss_mb"] = peakRssMB();
+    doc["layer_timing"] = (fs::path(opt.reportDir) / "layer_timing.jsonl").string();
+    doc["metrics"] = metricsFile.string();
+
+    const std::string text = doc.dump(2) + "\n";
+    if (opt.outPath.empty()) {
+        std::cout << text;
+    } else {
+        std::ofstream(opt.outPath, std::ios::trunc) << text;
+        std::cerr << "marc_replay: report written to " << opt.outPath << "\n";
+    }
+    return (failed || n == 0) ? 1 : 0;
+}
@@ -0,0 +1,371 @@
+// ============================================================================
+// marc_build - Headless production build runner (no Qt widgets)
+// ============================================================================
+//
+// Runs a production build through the same ScanStreamingManager the GUI uses,
+// on a QCoreApplication: RTC5 card, OPC UA connection to the PLC, per-layer
+// handshake, layer timing / build journal / trace in the report folder. Meant
+// for unattended builds and scripted benchmarking.
+//
+// The pre-flight check (BuildValidator) runs first, as in the GUI; the build
+// does not start when it finds errors. Ctrl+C stops the build: the layer being
+// scanned is aborted and --resume repeats it from the journal. A second Ctrl+C
+// is an emergency stop, handled on its own thread so it also works while the
+// main thread waits for the pipeline to shut down.
+//
+// Progress goes to stdout, either as text or as JSON lines (--progress jsonl):
+//   {"event":"status","text":"..."}                      start-up / shutdown messages
+//   {"event":"log","severity":"warning","text":"..."}    pipeline log ring
+//   {"event":"layer","layer":12,"executed":12,"total":289,"phase":"Recoating",...}
+//   {"event":"error","text":"..."}
+//   {"event":"finished","result":"completed","layers":289,"elapsed_s":...}
+//
+// Usage:
+//   marc_build [options] <project.build>
+//   marc_build [options] --marc <file.marc> --config <styles.json>
+//     --report-dir <dir>    layer timing / journal / trace folder (default: <project>/Reports)
+//     --progress text|jsonl progress format on stdout (default: text)
+//     --resume              continue after the last layer completed in the build journal
+//     --skip-preflight      start without checking the MARC against the styles first
+//     --opc-url <url>       PLC endpoint (default: OPC_UA_URL or the built-in endpoint)
+//     --poll-ms <n>         PLC "layer prepared" poll period (default: 500)
+//     --metrics <file>      Prometheus metrics file (default: MARCSLM_METRICS_FILE, else none)
+//     --trace               write a Chrome trace (trace.json) to the report folder
+//     --verbose             also print Qt debug output
+//
+// Exit code: 0 all layers built, 1 failed, 2 usage / input error, 3 pre-flight
+// errors, 130 stopped by Ctrl+C.
+// ============================================================================
+
+#include "controllers/scanstreamingmanager.h"
+#include "opcserver/opcserverua.h"
+#include "io/buildproject.h"
+#include "io/buildvalidator.h"
+#include "diagnostics/logring.h"
+#include "diagnostics/metrics.h"
+
+#include <nlohmann/json.hpp>
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string projectPath;
+    std::string marcPath;
+    std::string configPath;
+    std::string reportDir;
+    std::string opcUrl;
+    std::string metricsPath;
+    bool jsonLines = false;
+    bool resume = false;
+    bool preflight = true;
+    bool trace = false;
+    bool verbose = false;
+    int pollMs = 500;
+};
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (a == "--marc" && hasValue) opt.marcPath = argv[++i];
+        else if (a == "--config" && hasValue) opt.configPath = argv[++i];
+        else if (a == "--report-dir" && hasValue) opt.reportDir = argv[++i];
+        else if (a == "--opc-url" && hasValue) opt.opcUrl = argv[++i];
+        else if (a == "--metrics" && hasValue) opt.metricsPath = argv[++i];
+        else if (a == "--poll-ms" && hasValue) opt.pollMs = std::atoi(argv[++i]);
+        else if (a == "--progress" && hasValue) {
+            const std::string format = argv[++i];
+            if (format != "text" && format != "jsonl") return false;
+            opt.jsonLines = (format == "jsonl");
+        }
+        else if (a == "--resume") opt.resume = true;
+        else if (a == "--skip-preflight") opt.preflight = false;
+        else if (a == "--trace") opt.trace = true;
+        else if (a == "--verbose") opt.verbose = true;
+        else if (!a.empty() && a[0] == '-') return false;
+        else opt.projectPath = a;
+    }
+    const bool fromProject = !opt.projectPath.empty();
+    const bool fromFiles = !opt.marcPath.empty() || !opt.configPath.empty();
+    return fromProject != fromFiles && opt.pollMs > 0;
+}
+
+// ============================================================================
+// Console output (text or JSON lines), main thread only
+// ============================================================================
+// The emergency watcher thread does not use it: it writes its one line to
+// std::cerr, which never interleaves with the stdout lines written here.
+class Console {
+public:
+    explicit Console(bool jsonLines) : mJson(jsonLines) {}
+
+    void status(const std::string& text) {
+        if (mJson) emitJson({ {"event", "status"}, {"text", text} });
+        else std::cout << text << "\n";
+    }
+
+    void log(marc::logging::Severity severity, const std::string& text) {
+        const char* level = severity == marc::logging::Severity::Error ? "error"
+                          : severity == marc::logging::Severity::Warning ? "warning" : "info";
+        if (mJson) emitJson({ {"event", "log"}, {"severity", level}, {"text", text} });
+        else std::cout << text << "\n";
+    }
+
+    void error(const std::string& text) {
+        if (mJson) emitJson({ {"event", "error"}, {"text", text} });
+        else std::cerr << "marc_build: " << text << "\n";
+    }
+
+    void layer(const PipelineStatus::Snapshot& s) {
+        if (mJson) {
+            emitJson({ {"event", "layer"}, {"layer", s.currentLayer}, {"executed", s.layersExecuted},
+                       {"total", s.layersTotal}, {"produced", s.layersProduced},
+                       {"phase", PipelineStatus::phaseName(s.phase)},
+                       {"layers_per_hour", s.layersPerHour}, {"commands_per_s", s.commandsPerSecond},
+                       {"elapsed_s", s.elapsedSeconds} });
+        } else {
+            std::cout << "Layer " << s.currentLayer << " | " << s.layersExecuted << "/" << s.layersTotal
+                      << " done | " << PipelineStatus::phaseName(s.phase);
+            if (s.layersExecuted > 0) std::cout << " | " << static_cast<int>(s.layersPerHour) << " layers/h";
+            std::cout << std::endl;
+        }
+    }
+
+    void finished(const std::string& result, const PipelineStatus::Snapshot& s) {
+        if (mJson) {
+            emitJson({ {"event", "finished"}, {"result", result}, {"layers", s.layersExecuted},
+                       {"total", s.layersTotal}, {"elapsed_s", s.elapsedSeconds},
+                       {"layers_per_hour", s.layersPerHour}, {"last_error", s.lastError} });
+        } else {
+            std::cout << "Build " << result << ": " << s.layersExecuted << "/" << s.layersTotal
+                      << " layers in " << static_cast<int>(s.elapsedSeconds) << " s" << std::endl;
+        }
+    }
+
+private:
+    static void emitJson(const nlohmann::json& j) { std::cout << j.dump() << std::endl; }
+
+    bool mJson;
+};
+
+// Set from the signal handler; the first is polled by the main-thread timer,
+// the second by the emergency watcher thread
+std::atomic<int> gInterrupts{0};
+
+extern "C" void onInterrupt(int) {
+    gInterrupts.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool gVerbose = false;
+
+void messageHandler(QtMsgType type, const QMessageLogContext&, const QString& msg) {
+    if (gVerbose || type == QtCriticalMsg || type == QtFatalMsg) {
+        std::cerr << msg.toStdString() << "\n";
+    }
+}
+
+// Pre-flight check of the MARC / styles pair, as Run -> Pre-flight Check does
+bool runPreflight(const fs::path& marc, const fs::path& config, Console& console) {
+    marc::BuildValidator validator(marc.wstring(), config.string());
+    if (!validator.start()) {
+        console.error("Pre-flight check cannot start: " + validator.errorMessage());
+        return false;
+    }
+    validator.wait();
+    if (!validator.errorMessage().empty()) {
+        console.error("Pre-flight check failed: " + validator.errorMessage());
+        return false;
+    }
+    for (const marc::BuildIssue& issue : validator.issues()) {
+        if (issue.severity == marc::BuildIssue::Severity::Error) console.error(issue.toString());
+    }
+    console.status("Pre-flight check: " + std::to_string(validator.layersChecked()) + " layers, " +
+                   std::to_string(validator.errorCount()) + " errors, " +
+                   std::to_string(validator.warningCount()) + " warnings");
+    return validator.passed();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("marc_build");
+
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "Usage: marc_build [options] <project.build>\n"
+                     "       marc_build [options] --marc <file.marc> --config <styles.json>\n"
+                     "  --report-dir <dir>  --progress text|jsonl  --resume  --skip-preflight\n"
+                     "  --opc-url <url>  --poll-ms <n>  --metrics <file>  --trace  --verbose\n";
+        return 2;
+    }
+    gVerbose = opt.verbose;
+    qInstallMessageHandler(messageHandler);
+    Console console(opt.jsonLines);
+
+    // ========== Resolve MARC + styles ==========
+    fs::path marcPath = opt.marcPath;
+    fs::path configPath = opt.configPath;
+    if (!opt.projectPath.empty()) {
+        marc::BuildProject project;
+        std::string error;
+        if (!marc::BuildProject::load(opt.projectPath, project, &error)) {
+            console.error(error);
+            return 2;
+        }
+        marcPath = project.marcPath;
+        configPath = project.jsonPath;
+        console.status("Project: " + project.name);
+    }
+    if (marcPath.empty() || !fs::is_regular_file(marcPath)) {
+        console.error("MARC file not found: " + marcPath.string());
+        return 2;
+    }
+    if (configPath.empty() || !fs::is_regular_file(configPath)) {
+        console.error("JSON configuration not found: " + configPath.string());
+        return 2;
+    }
+    console.status("MARC file: " + marcPath.string());
+    console.status("JSON config: " + configPath.string());
+
+    // Also on --resume: the MARC or JSON file may have changed since the interrupted run
+    if (opt.preflight && !runPreflight(marcPath, configPath, console)) {
+        return 3;
+    }
+
+    // ========== PLC connection ==========
+    if (!opt.opcUrl.empty()) qputenv("OPC_UA_URL", QByteArray::fromStdString(opt.opcUrl));
+    OPCServerManagerUA opc;
+    QObject::connect(&opc, &OPCServerManagerUA::logMessage, &app, [&console, &opt](const QString& msg) {
+        if (opt.verbose) console.status(msg.toStdString());
+    });
+    if (!opc.initialize()) {
+        console.error("OPC UA connection to the PLC failed");
+        return 1;
+    }
+
+    const char* metricsEnv = std::getenv("MARCSLM_METRICS_FILE");
+    if (opt.metricsPath.empty() && metricsEnv && *metricsEnv) opt.metricsPath = metricsEnv;
+    if (!opt.metricsPath.empty()) marc::metrics::Registry::instance().startExporter(fs::path(opt.metricsPath));
+
+    // ========== Streaming pipeline ==========
+    ScanStreamingManager manager;
+    manager.setOPCManager(&opc);
+    if (!opt.reportDir.empty()) manager.setReportDirectory(fs::path(opt.reportDir).wstring());
+    manager.setTracingEnabled(opt.trace);
+
+    bool failed = false;
+    QObject::connect(&manager, &ScanStreamingManager::statusMessage, &app, [&console](const QString& msg) {
+        console.status(msg.toStdString());
+    });
+    QObject::connect(&manager, &ScanStreamingManager::error, &app, [&console, &failed](const QString& msg) {
+        console.error(msg.toStdString());
+        // Some consumer start-up failures return without emitting finished()
+        if (msg.startsWith("CRITICAL") || msg.startsWith("ERROR")) {
+            failed = true;
+            QCoreApplication::quit();
+        }
+    });
+    QObject::connect(&manager, &ScanStreamingManager::finished, &app, &QCoreApplication::quit);
+
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+
+    // PLC poll with the same edge detection as ProcessController, progress on change
+    bool previousDone = false;
+    bool stopRequested = false;
+    uint64_t lastVersion = 0;
+    uint32_t lastExecuted = 0;
+    PipelineStatus::Phase lastPhase = PipelineStatus::Phase::Idle;
+    QTimer poll;
+    poll.setInterval(opt.pollMs);
+    QObject::connect(&poll, &QTimer::timeout, &app, [&] {
+        if (!stopRequested && gInterrupts.load(std::memory_order_relaxed) > 0) {
+            stopRequested = true;
+            console.status("Interrupted: aborting the current layer and stopping "
+                           "(--resume repeats it; Ctrl+C again for emergency stop)");
+            // Flag only, the loop keeps running; finished() quits it once the consumer exits
+            manager.requestStop();
+        }
+
+        OPCServerManagerUA::OPCData data;
+        if (opc.readData(data)) {
+            const bool done = (data.powderSurfaceDone != 0);
+            if (done && !previousDone) manager.notifyPLCPrepared();
+            previousDone = done;
+        }
+
+        marc::logging::LogRing::instance().drain([&console](const marc::logging::LogMessage& m) {
+            console.log(m.severity, m.text);
+        }, 2000);
+
+        const PipelineStatus& status = manager.status();
+        if (status.version() == lastVersion) return;
+        const PipelineStatus::Snapshot s = status.snapshot();
+        lastVersion = s.version;
+        // One line per executed layer; JSON also reports phase changes
+        if (s.layersExecuted != lastExecuted || (opt.jsonLines && s.phase != lastPhase)) {
+            console.layer(s);
+        }
+        lastExecuted = s.layersExecuted;
+        lastPhase = s.phase;
+    });
+
+    // Emergency stop off the event loop: the main thread may be blocked in stopProcess()
+    std::atomic<bool> watching{true};
+    std::thread emergencyWatch([&] {
+        while (watching.load(std::memory_order_relaxed)) {
+            if (gInterrupts.load(std::memory_order_relaxed) >= 2) {
+                std::cerr << "EMERGENCY STOP" << std::endl;   // not Console: main thread only
+                opc.writeEmergencyStop();
+                manager.requestStop(true);
+                QMetaObject::invokeMethod(&app, "quit", Qt::QueuedConnection);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    });
+
+    poll.start();
+    const std::wstring marcW = marcPath.wstring();
+    const std::wstring configW = configPath.wstring();
+    const bool started = opt.resume ? manager.resumeFromJournal(marcW, configW)
+                                    : manager.startProcess(marcW, configW);
+    if (!started) {
+        failed = true;
+    } else {
+        app.exec();
+    }
+    poll.stop();
+
+    manager.stopProcess();
+    watching.store(false, std::memory_order_relaxed);
+    emergencyWatch.join();
+    marc::logging::LogRing::instance().drain([&console](const marc::logging::LogMessage& m) {
+        console.log(m.severity, m.text);
+    });
+    if (!opt.metricsPath.empty()) marc::metrics::Registry::instance().stopExporter();
+    opc.stop();
+
+    const PipelineStatus::Snapshot s = manager.status().snapshot();
+    const bool interrupted = gInterrupts.load() > 0;
+    const bool completed = !failed && !interrupted && s.phase == PipelineStatus::Phase::Finished &&
+                           s.layersExecuted > 0;
+    console.finished(completed ? "completed" : (interrupted ? "stopped" : "failed"), s);
+    if (completed) return 0;
+    return interrupted ? 130 : 1;
+}
@@ -0,0 +1,279 @@
+#include "buildjournal.h"
+#include "io/streamingmarcreader.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kHeaderMagic[8] = { 'M', 'A', 'R', 'C', 'J', 'N', 'L', '1' };
+constexpr uint32_t kRecordMagic = 0x4C59524Au;  // "JRYL"
+constexpr uint32_t kJournalVersion = 1;
+constexpr uint32_t kFlagPlcValid = 1u;
+
+// On-disk layout (little-endian, as written by the machine PC)
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t totalLayers;
+    uint64_t marcTimestamp;
+    uint64_t marcFileSize;
+    int64_t createdUnixUs;
+    uint32_t reserved[3];
+    uint32_t crc;                   // over all bytes before it
+};
+static_assert(sizeof(FileHeader) == 56, "journal header layout");
+
+struct FileRecord {
+    uint32_t magic;
+    uint32_t event;
+    uint32_t layerIndex;
+    uint32_t layerNumber;
+    uint64_t blockHash;
+    int64_t unixTimeUs;
+    int32_t sourceCylPosition;
+    int32_t sinkCylPosition;
+    uint32_t flags;
+    uint32_t crc;                   // over all bytes before it
+};
+static_assert(sizeof(FileRecord) == 48, "journal record layout");
+
+const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t crc32(const void* data, size_t len) {
+    const auto& t = crcTable();
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < len; ++i) crc = t[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+    return ~crc;
+}
+
+int64_t unixNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+BuildJournal::~BuildJournal() {
+    close();
+}
+
+bool BuildJournal::create(const std::filesystem::path& file, const Identity& id, std::string* error) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    if (!openFile(file, true, error)) return false;
+
+    FileHeader h{};
+    std::memcpy(h.magic, kHeaderMagic, sizeof(h.magic));
+    h.version = kJournalVersion;
+    h.totalLayers = id.totalLayers;
+    h.marcTimestamp = id.marcTimestamp;
+    h.marcFileSize = id.marcFileSize;
+    h.createdUnixUs = unixNowUs();
+    h.crc = crc32(&h, offsetof(FileHeader, crc));
+    if (!writeAll(&h, sizeof(h))) {
+        if (error) *error = "Failed to write journal header: " + file.string();
+        return false;
+    }
+    return true;
+}
+
+bool BuildJournal::reopen(const std::filesystem::path& file, const Identity& id, std::string* error) {
+    Identity existing;
+    std::vector<Entry> entries;
+    if (!load(file, existing, entries, error)) return false;
+    if (existing != id) {
+        if (error) *error = "Journal belongs to a different .marc file: " + file.string();
+        return false;
+    }
+
+    // Drop a torn tail so new records follow the last valid one
+    const uint64_t validSize = sizeof(FileHeader) + entries.size() * sizeof(FileRecord);
+    std::error_code ec;
+    if (std::filesystem::file_size(file, ec) != validSize && !ec) {
+        std::filesystem::resize_file(file, validSize, ec);
+        if (ec) {
+            if (error) *error = "Failed to truncate journal: " + ec.message();
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(mMutex);
+    return openFile(file, false, error);
+}
+
+bool BuildJournal::openFile(const std::filesystem::path& file, bool truncate, std::string* error) {
+    if (mFd >= 0) {
+#if defined(_WIN32)
+        ::_close(mFd);
+#else
+        ::close(mFd);
+#endif
+        mFd = -1;
+    }
+
+    std::error_code ec;
+    if (file.has_parent_path()) std::filesystem::create_directories(file.parent_path(), ec);
+
+#if defined(_WIN32)
+    const int flags = _O_WRONLY | _O_CREAT | _O_BINARY | (truncate ? _O_TRUNC : _O_APPEND);
+    mFd = ::_wopen(file.wstring().c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND);
+    mFd = ::open(file.string().c_str(), flags, 0644);
+#endif
+    if (mFd < 0) {
+        if (error) *error = "Failed to open journal: " + file.string();
+        return false;
+    }
+    return true;
+}
+
+bool BuildJournal::writeAll(const void* data, size_t size) {
+    if (mFd < 0) return false;
+    const auto* p = static_cast<const char*>(data);
+    while (size > 0) {
+#if defined(_WIN32)
+        const int n = ::_write(mFd, p, static_cast<unsigned>(size));
+#else
+        const ssize_t n = ::write(mFd, p, size);
+#endif
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+#if defined(_WIN32)
+    return ::_commit(mFd) == 0;
+#else
+    return ::fsync(mFd) == 0;
+#endif
+}
+
+void BuildJournal::close() {
+    std::lock_guard<std::mutex> lk(mMutex);
+    if (mFd < 0) return;
+#if defined(_WIN32)
+    ::_close(mFd);
+#else
+    ::close(mFd);
+#endif
+    mFd = -1;
+}
+
+bool BuildJournal::isOpen() const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mFd >= 0;
+}
+
+bool BuildJournal::append(const Entry& entry) {
+    FileRecord r{};
+    r.magic = kRecordMagic;
+    r.event = static_cast<uint32_t>(entry.event);
+    r.layerIndex = entry.layerIndex;
+    r.layerNumber = entry.layerNumber;
+    r.blockHash = entry.blockHash;
+    r.unixTimeUs = entry.unixTimeUs != 0 ? entry.unixTimeUs : unixNowUs();
+    r.sourceCylPosition = entry.sourceCylPosition;
+    r.sinkCylPosition = entry.sinkCylPosition;
+    r.flags = entry.plcValid ? kFlagPlcValid : 0u;
+    r.crc = crc32(&r, offsetof(FileRecord, crc));
+
+    std::lock_guard<std::mutex> lk(mMutex);
+    return writeAll(&r, sizeof(r));
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+bool BuildJournal::load(const std::filesystem::path& file, Identity& id, std::vector<Entry>& entries,
+                        std::string* error) {
+    entries.clear();
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        if (error) *error = "No build journal at " + file.string();
+        return false;
+    }
+
+    FileHeader h{};
+    in.read(reinterpret_cast<char*>(&h), sizeof(h));
+    if (!in || std::memcmp(h.magic, kHeaderMagic, sizeof(h.magic)) != 0 ||
+        h.crc != crc32(&h, offsetof(FileHeader, crc))) {
+        if (error) *error = "Invalid build journal header: " + file.string();
+        return false;
+    }
+    if (h.version != kJournalVersion) {
+        if (error) *error = "Unsupported build journal version " + std::to_string(h.version);
+        return false;
+    }
+    id.totalLayers = h.totalLayers;
+    id.marcTimestamp = h.marcTimestamp;
+    id.marcFileSize = h.marcFileSize;
+
+    // Stop at the first short or corrupt record (crash mid-append)
+    FileRecord r{};
+    while (in.read(reinterpret_cast<char*>(&r), sizeof(r))) {
+        if (r.magic != kRecordMagic || r.crc != crc32(&r, offsetof(FileRecord, crc))) break;
+        if (r.event != Entry::Started && r.event != Entry::Completed) break;
+        Entry e;
+        e.event = static_cast<Entry::Event>(r.event);
+        e.layerIndex = r.layerIndex;
+        e.layerNumber = r.layerNumber;
+        e.blockHash = r.blockHash;
+        e.unixTimeUs = r.unixTimeUs;
+        e.plcValid = (r.flags & kFlagPlcValid) != 0;
+        e.sourceCylPosition = r.sourceCylPosition;
+        e.sinkCylPosition = r.sinkCylPosition;
+        entries.push_back(e);
+    }
+    return true;
+}
+
+BuildJournal::ResumePoint BuildJournal::resumePoint(const std::vector<Entry>& entries) {
+    ResumePoint rp;
+    for (const Entry& e : entries) {
+        if (e.event != Entry::Completed) continue;
+        rp.valid = true;
+        rp.lastCompleted = e;
+        rp.nextLayerIndex = e.layerIndex + 1;
+    }
+    for (const Entry& e : entries) {
+        if (e.event == Entry::Started && e.layerIndex == rp.nextLayerIndex) rp.interrupted = true;
+    }
+    return rp;
+}
+
+BuildJournal::Identity BuildJournal::identify(const std::wstring& marcPath) {
+    marc::StreamingMarcReader reader(marcPath);
+    Identity id;
+    id.totalLayers = reader.totalLayers();
+    id.marcTimestamp = reader.header().timestamp;
+    id.marcFileSize = static_cast<uint64_t>(std::filesystem::file_size(std::filesystem::path(marcPath)));
+    return id;
+}
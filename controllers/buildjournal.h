@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// BuildJournal - Crash-consistent per-layer progress of a production build
+// ============================================================================
+/**
+ * @brief Append-only journal of scanned layers, used to resume a build after
+ * an e-stop, a crash or a power loss at the first layer not completed.
+ *
+ * DESIGN:
+ * - File: a fixed header identifying the .marc (layer count, header
+ *   timestamp, file size), then fixed-size records. Every header and record
+ *   carries a CRC32 and is flushed to the device (fsync / FlushFileBuffers)
+ *   before append() returns, so a record that was reported written survives
+ *   a crash.
+ * - Two records per layer: Started once the PLC prepared the layer and the
+ *   list is about to be loaded, Completed after the layer-complete handshake.
+ *   Completed stores the cylinder positions read back from the PLC.
+ * - load() reads up to the first short or corrupt record; a torn tail from a
+ *   crash mid-write is ignored, earlier records are trusted.
+ * - resumePoint(): the layer after the last Completed one. If that layer has a
+ *   Started record, it was interrupted during scanning.
+ * - The block hash (RTCCommandBlock::contentHash) lets a resume check that the
+ *   configuration still converts the last completed layer identically.
+ *
+ * USAGE:
+ *   BuildJournal journal;
+ *   journal.create(reportDir / BuildJournal::kFileName, BuildJournal::identify(marcPath));
+ *   journal.append(entry);          // consumer, per layer event
+ *   ...
+ *   BuildJournal::load(path, id, entries);
+ *   const auto rp = BuildJournal::resumePoint(entries);
+ */
+class BuildJournal {
+public:
+    static constexpr const char* kFileName = "build_journal.bin";
+
+    // The .marc file a journal belongs to
+    struct Identity {
+        uint32_t totalLayers = 0;
+        uint64_t marcTimestamp = 0;     // MarcHeader::timestamp
+        uint64_t marcFileSize = 0;
+
+        bool operator==(const Identity& o) const {
+            return totalLayers == o.totalLayers && marcTimestamp == o.marcTimestamp && marcFileSize == o.marcFileSize;
+        }
+        bool operator!=(const Identity& o) const { return !(*this == o); }
+    };
+
+    struct Entry {
+        enum Event : uint32_t { Started = 1, Completed = 2 };
+
+        Event event = Completed;
+        uint32_t layerIndex = 0;        // position in the .marc file
+        uint32_t layerNumber = 0;
+        uint64_t blockHash = 0;
+        int64_t unixTimeUs = 0;         // wall clock, filled by append() when 0
+        bool plcValid = false;          // cylinder positions below were read from the PLC
+        int32_t sourceCylPosition = 0;
+        int32_t sinkCylPosition = 0;
+    };
+
+    struct ResumePoint {
+        bool valid = false;             // at least one layer completed
+        uint32_t nextLayerIndex = 0;    // first layer to scan
+        bool interrupted = false;       // nextLayerIndex was started but not completed
+        Entry lastCompleted;
+    };
+
+    BuildJournal() = default;
+    ~BuildJournal();
+
+    BuildJournal(const BuildJournal&) = delete;
+    BuildJournal& operator=(const BuildJournal&) = delete;
+
+    // New journal (an existing file is replaced)
+    bool create(const std::filesystem::path& file, const Identity& id, std::string* error = nullptr);
+    // Existing journal of the same .marc, appended to (resume)
+    bool reopen(const std::filesystem::path& file, const Identity& id, std::string* error = nullptr);
+    void close();
+    bool isOpen() const;
+
+    // Write one record and flush it to the device
+    bool append(const Entry& entry);
+
+    // Read a journal; false when missing or the header is unreadable
+    static bool load(const std::filesystem::path& file, Identity& id, std::vector<Entry>& entries,
+                     std::string* error = nullptr);
+    static ResumePoint resumePoint(const std::vector<Entry>& entries);
+
+    // Identity of a .marc file (throws when it cannot be read)
+    static Identity identify(const std::wstring& marcPath);
+
+private:
+    bool openFile(const std::filesystem::path& file, bool truncate, std::string* error);
+    bool writeAll(const void* data, size_t size);
+
+    mutable std::mutex mMutex;
+    int mFd = -1;
+};
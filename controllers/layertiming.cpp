@@ -0,0 +1,158 @@
+#include "layertiming.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// ============================================================================
+// LayerTimingRecord
+// ============================================================================
+
+void LayerTimingRecord::addSpan(Stage stage, int64_t begin, int64_t end) {
+    if (!seen[stage]) {
+        beginUs[stage] = begin;
+        seen[stage] = true;
+    }
+    durationUs[stage] += (end > begin) ? (end - begin) : 0;
+}
+
+const char* LayerTimingRecord::stageName(Stage stage) {
+    switch (stage) {
+        case Read:      return "read";
+        case Decode:    return "decode";
+        case Convert:   return "convert";
+        case QueueWait: return "queue_wait";
+        case PLCWait:   return "plc_wait";
+        case ListLoad:  return "list_load";
+        case ListExec:  return "list_exec";
+        case Handshake: return "handshake";
+        default:        return "unknown";
+    }
+}
+
+// ============================================================================
+// LayerTimingRecorder
+// ============================================================================
+
+bool LayerTimingRecorder::start(const std::filesystem::path& outputDir) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    mEpoch = Clock::now();
+    mPending.clear();
+    mCompleted.clear();
+    if (mOut.is_open()) mOut.close();
+
+    mOutputDir = outputDir;
+    if (mOutputDir.empty()) return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(mOutputDir, ec);
+    mOut.open(mOutputDir / "layer_timing.jsonl", std::ios::out | std::ios::trunc);
+    return mOut.is_open();
+}
+
+int64_t LayerTimingRecorder::nowUs() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - mEpoch).count();
+}
+
+void LayerTimingRecorder::submitProducerStages(const LayerTimingRecord& record) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    mPending[record.layerNumber] = record;
+}
+
+LayerTimingRecord LayerTimingRecorder::takeProducerStages(uint32_t layerNumber) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto it = mPending.find(layerNumber);
+    if (it == mPending.end()) {
+        LayerTimingRecord r;
+        r.layerNumber = layerNumber;
+        return r;
+    }
+    LayerTimingRecord r = it->second;
+    mPending.erase(it);
+    return r;
+}
+
+void LayerTimingRecorder::commit(const LayerTimingRecord& record) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    mCompleted.push_back(record);
+    if (!mOut.is_open()) return;
+
+    // One self-contained JSON object per line
+    std::ostringstream line;
+    line << "{\"layer\":" << record.layerNumber
+         << ",\"bytes\":" << record.layerBytes
+         << ",\"commands\":" << record.commandCount
+         << ",\"est_exec_us\":" << record.estimatedExecUs;
+    for (int s = 0; s < LayerTimingRecord::StageCount; ++s) {
+        const char* name = LayerTimingRecord::stageName(static_cast<LayerTimingRecord::Stage>(s));
+        line << ",\"" << name << "_begin_us\":" << record.beginUs[s]
+             << ",\"" << name << "_us\":" << record.durationUs[s];
+    }
+    line << "}\n";
+    mOut << line.str();
+    mOut.flush();
+}
+
+size_t LayerTimingRecorder::recordCount() const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mCompleted.size();
+}
+
+std::string LayerTimingRecorder::finish() {
+    std::string summary;
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        if (mOut.is_open()) mOut.close();
+        summary = buildSummary();
+        if (!mOutputDir.empty() && !mCompleted.empty()) {
+            std::ofstream sf(mOutputDir / "layer_timing_summary.txt", std::ios::out | std::ios::trunc);
+            sf << summary;
+        }
+    }
+    return summary;
+}
+
+std::string LayerTimingRecorder::buildSummary() const {
+    std::ostringstream ss;
+    ss << "Layer timing summary (" << mCompleted.size() << " layers, milliseconds)\n";
+    if (mCompleted.empty()) return ss.str();
+
+    // Nearest-rank percentile over a sorted sample
+    auto percentile = [](const std::vector<int64_t>& sorted, double p) -> int64_t {
+        size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.999999);
+        if (rank == 0) rank = 1;
+        return sorted[std::min(rank, sorted.size()) - 1];
+    };
+
+    int64_t grandTotal = 0;
+    int64_t totals[LayerTimingRecord::StageCount] = {};
+    for (const auto& r : mCompleted) {
+        for (int s = 0; s < LayerTimingRecord::StageCount; ++s) {
+            totals[s] += r.durationUs[s];
+            grandTotal += r.durationUs[s];
+        }
+    }
+
+    ss << std::left << std::setw(12) << "stage"
+       << std::right << std::setw(10) << "p50" << std::setw(10) << "p90"
+       << std::setw(10) << "p99" << std::setw(10) << "max" << std::setw(8) << "share" << "\n";
+    ss << std::fixed << std::setprecision(2);
+
+    std::vector<int64_t> samples;
+    samples.reserve(mCompleted.size());
+    for (int s = 0; s < LayerTimingRecord::StageCount; ++s) {
+        samples.clear();
+        for (const auto& r : mCompleted) samples.push_back(r.durationUs[s]);
+        std::sort(samples.begin(), samples.end());
+
+        double share = grandTotal > 0 ? 100.0 * static_cast<double>(totals[s]) / static_cast<double>(grandTotal) : 0.0;
+        ss << std::left << std::setw(12) << LayerTimingRecord::stageName(static_cast<LayerTimingRecord::Stage>(s))
+           << std::right
+           << std::setw(10) << percentile(samples, 50.0) / 1000.0
+           << std::setw(10) << percentile(samples, 90.0) / 1000.0
+           << std::setw(10) << percentile(samples, 99.0) / 1000.0
+           << std::setw(10) << samples.back() / 1000.0
+           << std::setw(7) << share << "%\n";
+    }
+    return ss.str();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// LayerTimingRecord - Monotonic stage timestamps for one layer
+// ============================================================================
+/**
+ * @brief Where one layer's wall time went, stage by stage.
+ *
+ * All timestamps are microseconds on std::chrono::steady_clock relative to the
+ * start of the build. Stages that run more than once per layer (list load and
+ * list execution when a layer is split into several list batches) keep the
+ * first begin timestamp and accumulate their duration.
+ */
+struct LayerTimingRecord {
+    enum Stage {
+        Read = 0,      // raw layer bytes from disk
+        Decode,        // bytes -> marc::Layer
+        Convert,       // marc::Layer -> RTCCommandBlock
+        QueueWait,     // enqueued by producer -> popped by consumer
+        PLCWait,       // writeLayerParameters + wait for "layer prepared"
+        ListLoad,      // jump/mark/parameter commands written into RTC list
+        ListExec,      // execute_list + wait for completion (all batches)
+        Handshake,     // laser off + layer-complete notification to PLC
+        StageCount
+    };
+
+    uint32_t layerNumber = 0;
+    uint64_t layerBytes = 0;
+    uint64_t commandCount = 0;
+    int64_t estimatedExecUs = 0;        // RTCCommandBlock::estimateSeconds at segment speeds
+    int64_t beginUs[StageCount] = {};
+    int64_t durationUs[StageCount] = {};
+    bool seen[StageCount] = {};
+
+    // Record one span of a stage (accumulates for repeated stages)
+    void addSpan(Stage stage, int64_t begin, int64_t end);
+
+    static const char* stageName(Stage stage);
+};
+
+// ============================================================================
+// LayerTimingRecorder - Per-layer JSON-lines export + end-of-build summary
+// ============================================================================
+/**
+ * @brief Collects LayerTimingRecord from producer and consumer threads.
+ *
+ * DESIGN:
+ * - Producer fills Read/Decode/Convert and the QueueWait begin, then hands the
+ *   partial record over with submitProducerStages() BEFORE pushing the block.
+ * - Consumer picks it up with takeProducerStages(), adds its own stages and
+ *   calls commit(), which appends one JSON line to layer_timing.jsonl.
+ * - finish() writes layer_timing_summary.txt with p50/p90/p99/max per stage
+ *   and returns the same text for the status log.
+ *
+ * The recorder is touched a handful of times per layer; a mutex is sufficient.
+ */
+class LayerTimingRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Reset state and open <outputDir>/layer_timing.jsonl (empty dir = memory only)
+    bool start(const std::filesystem::path& outputDir);
+
+    // Microseconds since start()
+    int64_t nowUs() const;
+
+    void submitProducerStages(const LayerTimingRecord& record);
+    LayerTimingRecord takeProducerStages(uint32_t layerNumber);
+
+    // Append the completed record to the export file and the summary set
+    void commit(const LayerTimingRecord& record);
+
+    // Write summary file, close export; returns the summary text
+    std::string finish();
+
+    std::filesystem::path outputFile() const { return mOutputDir / "layer_timing.jsonl"; }
+    size_t recordCount() const;
+
+private:
+    std::string buildSummary() const;
+
+    mutable std::mutex mMutex;
+    Clock::time_point mEpoch{Clock::now()};
+    std::filesystem::path mOutputDir;
+    std::ofstream mOut;
+    std::unordered_map<uint32_t, LayerTimingRecord> mPending;
+    std::vector<LayerTimingRecord> mCompleted;
+};
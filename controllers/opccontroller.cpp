@@ -1,5 +1,5 @@
 #include "opccontroller.h"
-#include <QTextEdit>
+#include "launcher/logview.h"
 #include <QMessageBox>
 #include <thread>
 #include <chrono>
@@ -9,7 +9,7 @@
 // Constructor - Exception-safe initialization
 // ============================================================================
 
-OPCController::OPCController(QTextEdit* logWidget, QObject* parent)
+OPCController::OPCController(LogView* logWidget, QObject* parent)
     : QObject(parent)
     , mOPCServer(nullptr)
     , mLogWidget(logWidget)
@@ -4,7 +4,7 @@
 #include <QObject>
 #include "opcserver/opcserverua.h"
 
-class QTextEdit;
+class LogView;
 
 /**
  * @brief OPCController - Handles all OPC UA communication and operations
@@ -19,7 +19,7 @@ class OPCController : public QObject {
     Q_OBJECT
 
 public:
-    explicit OPCController(QTextEdit* logWidget, QObject* parent = nullptr);
+    explicit OPCController(LogView* logWidget, QObject* parent = nullptr);
     ~OPCController();
 
     // Initialization
@@ -53,7 +53,7 @@ private slots:
 private:
     OPCServerManagerUA* mOPCServer;
     OPCServerManagerUA::OPCData mCurrentData;
-    QTextEdit* mLogWidget;
+    LogView* mLogWidget;
     
     void log(const QString& message);
 };
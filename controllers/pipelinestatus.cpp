@@ -0,0 +1,123 @@
+#include "pipelinestatus.h"
+
+#include <thread>
+
+// ============================================================================
+// Writers (producer / consumer threads)
+// ============================================================================
+
+int64_t PipelineStatus::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PipelineStatus::start(uint32_t layersTotal) {
+    mCurrentLayer.store(0, std::memory_order_relaxed);
+    mLayersTotal.store(layersTotal, std::memory_order_relaxed);
+    mLayersProduced.store(0, std::memory_order_relaxed);
+    mLayersExecuted.store(0, std::memory_order_relaxed);
+    mCommandsExecuted.store(0, std::memory_order_relaxed);
+    mCommandsPerSecond.store(0.0, std::memory_order_relaxed);
+    mStartNs.store(nowNs(), std::memory_order_relaxed);
+    mEndNs.store(0, std::memory_order_relaxed);
+    mPhase.store(static_cast<uint8_t>(Phase::Starting), std::memory_order_relaxed);
+    setError(std::string());
+}
+
+void PipelineStatus::setPhase(Phase phase) {
+    if (phase == Phase::Finished || phase == Phase::Stopped || phase == Phase::Failed) {
+        int64_t expected = 0;
+        mEndNs.compare_exchange_strong(expected, nowNs(), std::memory_order_relaxed);
+    }
+    mPhase.store(static_cast<uint8_t>(phase), std::memory_order_relaxed);
+    bump();
+}
+
+void PipelineStatus::setLayersTotal(uint32_t total) {
+    mLayersTotal.store(total, std::memory_order_relaxed);
+    bump();
+}
+
+void PipelineStatus::setCurrentLayer(uint32_t layer) {
+    mCurrentLayer.store(layer, std::memory_order_relaxed);
+    bump();
+}
+
+void PipelineStatus::layerProduced() {
+    mLayersProduced.fetch_add(1, std::memory_order_relaxed);
+    bump();
+}
+
+void PipelineStatus::layerExecuted(uint64_t commands, double commandsPerSecond) {
+    mLayersExecuted.fetch_add(1, std::memory_order_relaxed);
+    mCommandsExecuted.fetch_add(commands, std::memory_order_relaxed);
+    mCommandsPerSecond.store(commandsPerSecond, std::memory_order_relaxed);
+    bump();
+}
+
+void PipelineStatus::setError(const std::string& message) {
+    // Serialize writers (errors are rare); readers never wait on this
+    while (mErrorWriter.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    const size_t len = message.size() < kErrorCapacity - 1 ? message.size() : kErrorCapacity - 1;
+    mErrorSeq.fetch_add(1, std::memory_order_acq_rel);          // odd: write in progress
+    for (size_t i = 0; i < len; ++i) mError[i].store(message[i], std::memory_order_relaxed);
+    mErrorLength.store(static_cast<uint32_t>(len), std::memory_order_relaxed);
+    mErrorSeq.fetch_add(1, std::memory_order_release);          // even: stable
+
+    mErrorWriter.store(false, std::memory_order_release);
+    bump();
+}
+
+// ============================================================================
+// Reader (GUI thread)
+// ============================================================================
+
+PipelineStatus::Snapshot PipelineStatus::snapshot() const {
+    Snapshot s;
+    s.version = mVersion.load(std::memory_order_acquire);
+    s.phase = static_cast<Phase>(mPhase.load(std::memory_order_relaxed));
+    s.currentLayer = mCurrentLayer.load(std::memory_order_relaxed);
+    s.layersTotal = mLayersTotal.load(std::memory_order_relaxed);
+    s.layersProduced = mLayersProduced.load(std::memory_order_relaxed);
+    s.layersExecuted = mLayersExecuted.load(std::memory_order_relaxed);
+    s.commandsExecuted = mCommandsExecuted.load(std::memory_order_relaxed);
+    s.commandsPerSecond = mCommandsPerSecond.load(std::memory_order_relaxed);
+
+    const int64_t startNs = mStartNs.load(std::memory_order_relaxed);
+    if (startNs != 0) {
+        const int64_t endNs = mEndNs.load(std::memory_order_relaxed);
+        s.elapsedSeconds = ((endNs != 0 ? endNs : nowNs()) - startNs) * 1e-9;
+        if (s.elapsedSeconds > 0.0) s.layersPerHour = s.layersExecuted / s.elapsedSeconds * 3600.0;
+    }
+
+    // Seqlock read of the error text; retry if a writer raced with the copy
+    for (;;) {
+        const uint32_t seq = mErrorSeq.load(std::memory_order_acquire);
+        if (seq & 1u) { std::this_thread::yield(); continue; }
+        const uint32_t len = mErrorLength.load(std::memory_order_relaxed);
+        s.lastError.resize(len);
+        for (uint32_t i = 0; i < len; ++i) s.lastError[i] = mError[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mErrorSeq.load(std::memory_order_relaxed) == seq) break;
+    }
+    return s;
+}
+
+const char* PipelineStatus::phaseName(Phase phase) {
+    switch (phase) {
+    case Phase::Idle:            return "Idle";
+    case Phase::Starting:        return "Starting";
+    case Phase::WaitingForLayer: return "Waiting for layer";
+    case Phase::PLCWait:         return "Recoating";
+    case Phase::ListLoad:        return "Loading list";
+    case Phase::ListExec:        return "Scanning";
+    case Phase::Handshake:       return "Layer handshake";
+    case Phase::Finished:        return "Finished";
+    case Phase::Stopped:         return "Stopped";
+    case Phase::Failed:          return "Failed";
+    }
+    return "Unknown";
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// ============================================================================
+// PipelineStatus - Lock-free progress/status snapshot of the streaming build
+// ============================================================================
+/**
+ * @brief Shared state written by the producer/consumer threads and polled by
+ * the GUI at display rate, instead of one queued Qt signal per event.
+ *
+ * DESIGN:
+ * - Every field is an atomic; writers never block and never allocate.
+ * - version() increases on every update, so a poller can skip redraws when
+ *   nothing changed since its last frame.
+ * - The last error text lives in a fixed buffer guarded by a sequence counter
+ *   (seqlock): readers retry if a write raced with the copy.
+ * - Rates are derived at snapshot time (layers/hour since start) or stored
+ *   per layer (commands/s of the last executed layer).
+ *
+ * USAGE (GUI, ~60 Hz):
+ *   if (status.version() != mLastVersion) {
+ *       const auto s = status.snapshot();
+ *       mLastVersion = s.version;
+ *       label->setText(QString("Layer %1/%2 - %3").arg(s.layersExecuted).arg(s.layersTotal)
+ *                                                 .arg(PipelineStatus::phaseName(s.phase)));
+ *   }
+ */
+class PipelineStatus {
+public:
+    enum class Phase : uint8_t {
+        Idle = 0,
+        Starting,
+        WaitingForLayer,   // consumer waiting on the producer queue
+        PLCWait,           // recoat / layer preparation by the PLC
+        ListLoad,          // loading commands into the RTC5 list
+        ListExec,          // RTC5 list executing
+        Handshake,         // laser off + layer-complete handshake
+        Finished,
+        Stopped,
+        Failed
+    };
+
+    struct Snapshot {
+        uint64_t version = 0;
+        Phase phase = Phase::Idle;
+        uint32_t currentLayer = 0;
+        uint32_t layersTotal = 0;
+        uint32_t layersProduced = 0;
+        uint32_t layersExecuted = 0;
+        uint64_t commandsExecuted = 0;
+        double commandsPerSecond = 0.0;   // last executed layer
+        double layersPerHour = 0.0;       // since start()
+        double elapsedSeconds = 0.0;
+        std::string lastError;
+    };
+
+    static constexpr size_t kErrorCapacity = 256;
+
+    // Reset all counters and start the elapsed-time clock
+    void start(uint32_t layersTotal = 0);
+
+    void setPhase(Phase phase);
+    void setLayersTotal(uint32_t total);
+    void setCurrentLayer(uint32_t layer);
+    void layerProduced();
+    void layerExecuted(uint64_t commands, double commandsPerSecond);
+    void setError(const std::string& message);   // truncated to kErrorCapacity - 1
+
+    uint64_t version() const { return mVersion.load(std::memory_order_acquire); }
+    Phase phase() const { return static_cast<Phase>(mPhase.load(std::memory_order_relaxed)); }
+    Snapshot snapshot() const;
+
+    static const char* phaseName(Phase phase);
+
+private:
+    void bump() { mVersion.fetch_add(1, std::memory_order_release); }
+    static int64_t nowNs();
+
+    std::atomic<uint64_t> mVersion{0};
+    std::atomic<uint8_t> mPhase{static_cast<uint8_t>(Phase::Idle)};
+    std::atomic<uint32_t> mCurrentLayer{0};
+    std::atomic<uint32_t> mLayersTotal{0};
+    std::atomic<uint32_t> mLayersProduced{0};
+    std::atomic<uint32_t> mLayersExecuted{0};
+    std::atomic<uint64_t> mCommandsExecuted{0};
+    std::atomic<double> mCommandsPerSecond{0.0};
+    std::atomic<int64_t> mStartNs{0};
+    std::atomic<int64_t> mEndNs{0};               // set when the build leaves the running phases
+
+    // Last error (seqlock: odd sequence = write in progress)
+    std::atomic<bool> mErrorWriter{false};
+    std::atomic<uint32_t> mErrorSeq{0};
+    std::atomic<uint32_t> mErrorLength{0};
+    std::array<std::atomic<char>, kErrorCapacity> mError{};
+};
@@ -4,12 +4,13 @@
 #include "scanstreamingmanager.h"
 #include "controllers/slm_worker_manager.h"
 #include "opcserver/opcserverua.h"
-#include <QTextEdit>
+#include "diagnostics/trace.h"
+#include "launcher/logview.h"
 #include <QDebug>
 
 ProcessController::ProcessController(OPCController* opcCtrl,
                                      ScannerController* scanCtrl,
-                                     QTextEdit* logWidget,
+                                     LogView* logWidget,
                                      ScanStreamingManager* scanMgr,
                                      QObject* parent)
     : QObject(parent)
@@ -163,7 +164,8 @@ void ProcessController::emergencyStop() {
 // INDUSTRIAL SLM PRODUCTION PROCESS (SLICE-FILE DRIVEN WITH OPC)
 // ============================================================================
 
-void ProcessController::startProductionSLMProcess(const QString& marcFilePath, const QString& configJsonPath) {
+void ProcessController::startProductionSLMProcess(const QString& marcFilePath, const QString& configJsonPath,
+                                                   bool resumeFromJournal) {
     // ========== DEFENSIVE CHECKS ==========
     //
     // Validate all required pointers before proceeding.
@@ -201,7 +203,8 @@ void ProcessController::startProductionSLMProcess(const QString& marcFilePath, c
     }
 
     log("========================================================================");
-    log("INDUSTRIAL SLM PRODUCTION PROCESS STARTING");
+    log(resumeFromJournal ? "INDUSTRIAL SLM PRODUCTION PROCESS RESUMING FROM BUILD JOURNAL"
+                          : "INDUSTRIAL SLM PRODUCTION PROCESS STARTING");
     log("========================================================================");
     log(QString("MARC file: %1").arg(marcFilePath));
     log(QString("JSON config: %1").arg(configJsonPath));
@@ -216,6 +219,7 @@ void ProcessController::startProductionSLMProcess(const QString& marcFilePath, c
     //
     mMarcFilePath = marcFilePath;
     mConfigJsonPath = configJsonPath;
+    mResumeFromJournal = resumeFromJournal;
 
     // ========== STEP 1: Create SLMWorkerManager if not exists =========
     //
@@ -409,7 +413,10 @@ void ProcessController::onSystemReady() {
         return;
     }
 
-    if (mScanManager->startProcess(marcPath, configPath)) {
+    const bool started = mResumeFromJournal
+        ? mScanManager->resumeFromJournal(marcPath, configPath)
+        : mScanManager->startProcess(marcPath, configPath);
+    if (started) {
         setState(Running);
         
         // ========== CRITICAL FIX: START POLLING TIMER ==========
@@ -607,6 +614,7 @@ void ProcessController::onTimerTick() {
     if (mState != Running) {
         return;
     }
+    MARC_TRACE_SCOPE("gui", "ProcessController::onTimerTick");
     
     // ========== CRITICAL FIX: USE WORKER THREAD OPC MANAGER ==========
     // In production mode, the active OPC connection lives in SLMWorkerManager's thread.
@@ -10,7 +10,7 @@ class OPCController;
 class ScannerController;
 class ScanStreamingManager;
 class SLMWorkerManager;  // Forward declaration
-class QTextEdit;
+class LogView;
 
 /**
  * @brief ProcessController - Coordinates manufacturing process workflow
@@ -70,7 +70,7 @@ public:
 
     explicit ProcessController(OPCController* opcCtrl, 
                               ScannerController* scanCtrl,
-                              QTextEdit* logWidget,
+                              LogView* logWidget,
                               ScanStreamingManager* scanMgr = nullptr,
                               QObject* parent = nullptr);
     ~ProcessController();
@@ -87,7 +87,9 @@ public:
     // - Starts OPC worker thread first
     // - Waits for OPC initialization
     // - Then starts producer/consumer scanner threads
-    void startProductionSLMProcess(const QString& marcFilePath, const QString& configJsonPath);
+    // resumeFromJournal: continue after the last layer completed in the build journal
+    void startProductionSLMProcess(const QString& marcFilePath, const QString& configJsonPath,
+                                   bool resumeFromJournal = false);
     
     // Test: Synthetic layers without OPC (hardware testing only)
     // - No worker threads needed
@@ -137,7 +139,7 @@ private:
     ScannerController* mScannerController;
     ScanStreamingManager* mScanManager;
     std::unique_ptr<SLMWorkerManager> mSLMWorkerManager;  // NEW: manages OPC/Scanner worker threads
-    QTextEdit* mLogWidget;
+    LogView* mLogWidget;
     QTimer mTimer;
     
     ProcessState mState;
@@ -148,6 +150,7 @@ private:
     int mCurrentLayerNumber;
     QString mMarcFilePath;  // NEW: stores MARC path during startProductionSLMProcess
     QString mConfigJsonPath;  // NEW: stores JSON config path during startProductionSLMProcess
+    bool mResumeFromJournal = false;  // onSystemReady resumes instead of starting
     
     void setState(ProcessState newState);
     void log(const QString& message);
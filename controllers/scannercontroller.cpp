@@ -1,10 +1,10 @@
 #include "scannercontroller.h"
-#include <QTextEdit>
+#include "launcher/logview.h"
 #include <QLCDNumber>
 #include <QLabel>
 #include <QMessageBox>
 
-ScannerController::ScannerController(QTextEdit* logWidget, QObject* parent)
+ScannerController::ScannerController(LogView* logWidget, QObject* parent)
     : QObject(parent)
     , mScanner(new Scanner())
     , mLogWidget(logWidget)
@@ -4,7 +4,7 @@
 #include <QObject>
 #include "Scanner.h"
 
-class QTextEdit;
+class LogView;
 class QLCDNumber;
 class QLabel;
 
@@ -22,7 +22,7 @@ class ScannerController : public QObject {
     Q_OBJECT
 
 public:
-    explicit ScannerController(QTextEdit* logWidget, QObject* parent = nullptr);
+    explicit ScannerController(LogView* logWidget, QObject* parent = nullptr);
     ~ScannerController();
 
     // Initialization
@@ -60,7 +60,7 @@ signals:
 
 private:
     Scanner* mScanner;
-    QTextEdit* mLogWidget;
+    LogView* mLogWidget;
     int mLayersProcessed;
     
     static constexpr int MAX_PILOT_LAYERS = 20;
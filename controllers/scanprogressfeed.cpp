@@ -0,0 +1,33 @@
+#include "scanprogressfeed.h"
+
+void ScanProgressFeed::publish(std::shared_ptr<const marc::RTCCommandBlock> block) {
+    std::shared_ptr<const marc::RTCCommandBlock> previous;
+    {
+        std::lock_guard<std::mutex> lk(mBlockMutex);
+        previous.swap(mBlock);
+        mBlock = std::move(block);
+        ++mLayerSerial;
+        mSubmitted.store(0, std::memory_order_relaxed);
+        mExecuted.store(0, std::memory_order_relaxed);
+    }
+    mSerial.fetch_add(1, std::memory_order_release);
+    // previous is released here, outside the lock (a reader may still hold it)
+}
+
+ScanProgressFeed::Snapshot ScanProgressFeed::snapshot() const {
+    Snapshot s;
+    s.serial = mSerial.load(std::memory_order_acquire);
+    {
+        std::lock_guard<std::mutex> lk(mBlockMutex);
+        s.block = mBlock;
+        s.layerSerial = mLayerSerial;
+    }
+    s.submitted = mSubmitted.load(std::memory_order_relaxed);
+    s.executed = mExecuted.load(std::memory_order_relaxed);
+    if (s.block) {
+        const size_t n = s.block->commands.size();
+        if (s.submitted > n) s.submitted = n;
+        if (s.executed > s.submitted) s.executed = s.submitted;
+    }
+    return s;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "io/rtccommandblock.h"
+
+// ============================================================================
+// ScanProgressFeed - Executing layer + command progress for live previews
+// ============================================================================
+/**
+ * @brief Lets a viewer follow the consumer through the current layer's
+ * command stream without copying it.
+ *
+ * DESIGN:
+ * - The consumer publishes the shared_ptr it already holds once per layer;
+ *   readers keep the block alive by holding their own reference, so the
+ *   commands are never copied and never freed under a reader.
+ * - Progress is two relaxed atomics: commands submitted to the RTC5 list and
+ *   commands whose list finished executing. The consumer updates "submitted"
+ *   every kSubmitStride commands, so its loop pays one store per stride.
+ * - serial() changes whenever the block or a counter changes, so a renderer
+ *   can skip frames cheaply.
+ *
+ * USAGE (renderer thread):
+ *   const auto s = feed.snapshot();
+ *   if (s.serial != lastSerial && s.block) draw(*s.block, s.submitted, s.executed);
+ */
+class ScanProgressFeed {
+public:
+    static constexpr size_t kSubmitStride = 256;
+
+    struct Snapshot {
+        std::shared_ptr<const marc::RTCCommandBlock> block;
+        uint64_t layerSerial = 0;   // increments per published block
+        uint64_t serial = 0;
+        size_t submitted = 0;       // commands [0, submitted) are in an RTC5 list
+        size_t executed = 0;        // commands [0, executed) have been scanned
+    };
+
+    // Consumer thread
+    void publish(std::shared_ptr<const marc::RTCCommandBlock> block);
+    void setSubmitted(size_t commandIndex) {
+        mSubmitted.store(commandIndex, std::memory_order_relaxed);
+        mSerial.fetch_add(1, std::memory_order_release);
+    }
+    void setExecuted(size_t commandIndex) {
+        mExecuted.store(commandIndex, std::memory_order_relaxed);
+        mSerial.fetch_add(1, std::memory_order_release);
+    }
+    void clear() { publish(nullptr); }
+
+    // Any thread
+    uint64_t serial() const { return mSerial.load(std::memory_order_acquire); }
+    Snapshot snapshot() const;
+
+private:
+    mutable std::mutex mBlockMutex;   // guards mBlock only (taken once per layer by the consumer)
+    std::shared_ptr<const marc::RTCCommandBlock> mBlock;
+    uint64_t mLayerSerial = 0;
+
+    std::atomic<uint64_t> mSerial{0};
+    std::atomic<size_t> mSubmitted{0};
+    std::atomic<size_t> mExecuted{0};
+};
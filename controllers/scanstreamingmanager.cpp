@@ -1,10 +1,15 @@
 ﻿#include "scanstreamingmanager.h"
 #include "io/streamingmarcreader.h"
 #include "opcserver/opcserverua.h"
+#include "diagnostics/trace.h"
+#include "diagnostics/logring.h"
+#include "diagnostics/metrics.h"
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 #include <chrono>
+#include <filesystem>
+#include <cstdlib>
 #include <QDebug>
 #include <QThread>
 
@@ -28,6 +33,16 @@ ScanStreamingManager::ScanStreamingManager(QObject* parent)
     mScannerConfig.laserMode = 1;
     mScannerConfig.analogOutValue = 640;
     mScannerConfig.analogOutStandby = 0;
+
+    // Keep the last error in the status snapshot (runs in the emitting thread)
+    connect(this, &ScanStreamingManager::error, this, [this](const QString& message) {
+        mStatus.setError(message.toStdString());
+    }, Qt::DirectConnection);
+
+    // Config JSON change detection stays off the producer thread
+    mStyleCheckTimer.setInterval(kStyleCheckIntervalMs);
+    connect(&mStyleCheckTimer, &QTimer::timeout, this, &ScanStreamingManager::checkBuildStyleFile);
+    connect(this, &ScanStreamingManager::finished, &mStyleCheckTimer, &QTimer::stop);
 }
 
 ScanStreamingManager::~ScanStreamingManager() {
@@ -43,13 +58,14 @@ bool ScanStreamingManager::loadScanConfig(const std::wstring& configJsonPath) {
         // Convert wstring to string for BuildStyleLibrary
         std::string path(configJsonPath.begin(), configJsonPath.end());
         
-        if (!mBuildStyles.loadFromJson(path)) {
-            emit error(QString::fromStdString("- Failed to parse buildStyles from: " + path));
+        std::string reason;
+        if (!mStyles.reset(path, &reason)) {
+            emit error(QString::fromStdString("- Failed to parse buildStyles from: " + path + " (" + reason + ")"));
             return false;
         }
 
         std::ostringstream ss;
-        ss << "Loaded " << mBuildStyles.count() << " buildStyles from config.json";
+        ss << "Loaded " << mStyles.current()->count() << " buildStyles from config.json";
         emit statusMessage(QString::fromStdString(ss.str()));
         emit configLoaded(QString::fromStdString(path));
         
@@ -67,6 +83,78 @@ bool ScanStreamingManager::loadScanConfig(const std::wstring& configJsonPath) {
 // ============================================================================
 
 bool ScanStreamingManager::startProcess(const std::wstring& marcPath, const std::wstring& configJsonPath) {
+    mResume = BuildJournal::ResumePoint{};
+    return beginProduction(marcPath, configJsonPath);
+}
+
+bool ScanStreamingManager::resumeFromJournal(const std::wstring& marcPath, const std::wstring& configJsonPath) {
+    if (mProducerThread.joinable() || mConsumerThread.joinable()) {
+        emit error("Process already running");
+        return false;
+    }
+    if (marcPath.empty()) {
+        emit error("ERROR: MARC file path is empty");
+        return false;
+    }
+
+    // ========== FIND THE RESUME POINT IN THE BUILD JOURNAL ==========
+    const std::wstring reportDir = mReportDir.empty() ? defaultReportDirectory(marcPath) : mReportDir;
+    const std::filesystem::path journalFile = std::filesystem::path(reportDir) / BuildJournal::kFileName;
+    BuildJournal::Identity journalId;
+    std::vector<BuildJournal::Entry> entries;
+    std::string journalError;
+    if (!BuildJournal::load(journalFile, journalId, entries, &journalError)) {
+        emit error(QString::fromStdString("ERROR: Cannot resume: " + journalError));
+        return false;
+    }
+    try {
+        if (BuildJournal::identify(marcPath) != journalId) {
+            emit error("ERROR: Cannot resume: the build journal was written for a different .marc file");
+            return false;
+        }
+    } catch (const std::exception& e) {
+        emit error(QString("ERROR: Cannot resume: %1").arg(e.what()));
+        return false;
+    }
+
+    const BuildJournal::ResumePoint rp = BuildJournal::resumePoint(entries);
+    if (!rp.valid) {
+        emit error("ERROR: Cannot resume: no layer of this build was completed, start it instead");
+        return false;
+    }
+    if (rp.nextLayerIndex >= journalId.totalLayers) {
+        emit error("ERROR: Cannot resume: all layers of this build are already completed");
+        return false;
+    }
+
+    // ========== RESTORE PART EXCLUSIONS ==========
+    // No file: nothing was excluded when the build stopped, the current rules stay
+    const std::filesystem::path exclusionsFile = std::filesystem::path(reportDir) / marc::PartExcluder::kFileName;
+    if (std::filesystem::exists(exclusionsFile)) {
+        marc::PartExcluder::Rules rules;
+        std::string exclusionsError;
+        if (!marc::PartExcluder::loadRules(exclusionsFile.string(), rules, &exclusionsError)) {
+            emit error(QString::fromStdString("ERROR: Cannot resume: part exclusions of the build cannot be restored (" +
+                                              exclusionsError + ")"));
+            return false;
+        }
+        mExcluder.setRules(rules);
+        if (!rules.empty()) {
+            emit statusMessage(QString("- Restored part exclusions: %1 regions, %2 geometry types (from layer %3)")
+                                   .arg(rules.regions.size()).arg(rules.geometryTypes.size()).arg(rules.fromLayer));
+        }
+    }
+
+    mResume = rp;
+    emit statusMessage(QString("- Resuming build after layer %1 (%2 of %3 layers completed)%4")
+                           .arg(rp.lastCompleted.layerNumber)
+                           .arg(rp.nextLayerIndex)
+                           .arg(journalId.totalLayers)
+                           .arg(rp.interrupted ? ", next layer was interrupted during scanning" : ""));
+    return beginProduction(marcPath, configJsonPath);
+}
+
+bool ScanStreamingManager::beginProduction(const std::wstring& marcPath, const std::wstring& configJsonPath) {
     // Sanity check: ensure no threads already running
     if (mProducerThread.joinable() || mConsumerThread.joinable()) {
         emit error("Process already running");
@@ -100,6 +188,11 @@ bool ScanStreamingManager::startProcess(const std::wstring& marcPath, const std:
     mTotalLayers = 0;
     mCurrentLayerNumber = 0;
     mProcessMode = ProcessMode::Production;  // PRODUCTION MODE
+    mStatus.start();
+    mProgressFeed.clear();
+    if (!mResume.valid) {
+        mExcluder.clear();     // exclusions belong to one build; a resume restored them
+    }
     mProducerFinished = false;
     mLayerRequested = false;
     
@@ -107,6 +200,8 @@ bool ScanStreamingManager::startProcess(const std::wstring& marcPath, const std:
         std::lock_guard<std::mutex> lk(mMutex);
         mQueue.clear();
     }
+    marc::metrics::pipeline().queueDepth.set(0);
+    marc::metrics::pipeline().bytesQueued.set(0);
 
     // ========== STORE CONFIG PATH FOR CONSUMER THREAD ==========
     //
@@ -115,6 +210,51 @@ bool ScanStreamingManager::startProcess(const std::wstring& marcPath, const std:
     //
     mConfigJsonPath = configJsonPath;
 
+    // ========== PER-LAYER TIMING EXPORT ==========
+    const std::wstring reportDir = mReportDir.empty() ? defaultReportDirectory(marcPath) : mReportDir;
+    if (!mTiming.start(std::filesystem::path(reportDir))) {
+        emit statusMessage("- WARNING: Cannot open layer timing file in report folder, timing kept in memory only");
+    }
+
+    // ========== BUILD JOURNAL ==========
+    // New build: replaced. Resume: appended to, after dropping a torn tail.
+    {
+        const std::filesystem::path journalFile = std::filesystem::path(reportDir) / BuildJournal::kFileName;
+        std::string journalError;
+        bool journalOpen = false;
+        try {
+            const BuildJournal::Identity id = BuildJournal::identify(marcPath);
+            journalOpen = mResume.valid ? mJournal.reopen(journalFile, id, &journalError)
+                                        : mJournal.create(journalFile, id, &journalError);
+        } catch (const std::exception& e) {
+            journalError = e.what();
+        }
+        if (!journalOpen) {
+            emit statusMessage(QString::fromStdString(
+                "- WARNING: Build journal disabled, this build cannot be resumed (" + journalError + ")"));
+        }
+    }
+
+    // ========== PART EXCLUSIONS ==========
+    // Saved with every change, so a resume restores what was active when the build stopped
+    {
+        std::lock_guard<std::mutex> lk(mExclusionsFileMutex);
+        mExclusionsFile = std::filesystem::path(reportDir) / marc::PartExcluder::kFileName;
+    }
+    saveExclusions();
+
+    // ========== OPTIONAL CHROME TRACE ==========
+    const char* traceEnv = std::getenv("MARCSLM_TRACE");
+    if (mTracingEnabled || (traceEnv && std::string(traceEnv) == "1")) {
+        const std::filesystem::path traceFile = std::filesystem::path(reportDir) / "trace.json";
+        if (marc::trace::Tracer::instance().start(traceFile)) {
+            marc::trace::setThreadName("GUI");
+            emit statusMessage(QString::fromStdString("- Tracing pipeline threads to " + traceFile.string()));
+        } else {
+            emit statusMessage("- WARNING: Cannot open trace.json, tracing disabled");
+        }
+    }
+
     emit statusMessage("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
     emit statusMessage("INDUSTRIAL SLM STARTUP SEQUENCE");
     emit statusMessage("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
@@ -167,6 +307,7 @@ bool ScanStreamingManager::startProcess(const std::wstring& marcPath, const std:
     // Producer reads layers sequentially with low memory footprint
     // Producer waits on bounded queue if consumer is slow
     mProducerThread = std::thread(&ScanStreamingManager::producerThreadFunc, this, marcPath);
+    mStyleCheckTimer.start();
 
     emit statusMessage("- STEP 3 COMPLETE: Producer thread streaming MARC file");
     emit statusMessage("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
@@ -206,7 +347,12 @@ bool ScanStreamingManager::startTestProcess(float testLayerThickness, size_t tes
         return false;
     }
 
-    // Reset state
+    // Reset state (test runs are not journaled)
+    mResume = BuildJournal::ResumePoint{};
+    {
+        std::lock_guard<std::mutex> lk(mExclusionsFileMutex);
+        mExclusionsFile.clear();
+    }
     mStopRequested = false;
     mEmergencyStopFlag = false;
     mPLCPrepared = false;
@@ -216,6 +362,8 @@ bool ScanStreamingManager::startTestProcess(float testLayerThickness, size_t tes
     mTotalLayers = testLayerCount;
     mCurrentLayerNumber = 0;
     mProcessMode = ProcessMode::Test;  // TEST MODE
+    mStatus.start(static_cast<uint32_t>(testLayerCount));
+    mProgressFeed.clear();
     mProducerFinished = false;
     mLayerRequested = false;
     
@@ -223,6 +371,10 @@ bool ScanStreamingManager::startTestProcess(float testLayerThickness, size_t tes
         std::lock_guard<std::mutex> lk(mMutex);
         mQueue.clear();
     }
+    marc::metrics::pipeline().queueDepth.set(0);
+    marc::metrics::pipeline().bytesQueued.set(0);
+
+    mTiming.start(std::filesystem::path(mReportDir));
 
     emit statusMessage("- TEST MODE STARTUP SEQUENCE");
     emit statusMessage("- STEP 1: Verifying OPC Manager is ready...");
@@ -290,17 +442,23 @@ bool ScanStreamingManager::startTestProcess(float testLayerThickness, size_t tes
     return true;
 }
 
-void ScanStreamingManager::stopProcess() {
-    qDebug() << "ScanStreamingManager::stopProcess() - Initiating graceful shutdown";
-    
+void ScanStreamingManager::requestStop(bool emergency) {
+    if (emergency) mEmergencyStopFlag = true;
     mStopRequested = true;
-    
+
     // Wake all waiting threads to allow them to check mStopRequested
     mCvProducerNotFull.notify_all();
     mCvConsumerNotEmpty.notify_all();
     mCvPLCNotified.notify_all();
     mCvOPCReady.notify_all();
     mCvLayerRequested.notify_all();
+}
+
+void ScanStreamingManager::stopProcess() {
+    qDebug() << "ScanStreamingManager::stopProcess() - Initiating graceful shutdown";
+    
+    requestStop();
+    mStyleCheckTimer.stop();
 
     // ========== FIX: Join test producer thread (was detached, caused crash) ==========
     if (mTestProducerThread.joinable()) {
@@ -322,6 +480,8 @@ void ScanStreamingManager::stopProcess() {
         qDebug() << "Consumer thread finished";
     }
 
+    marc::trace::Tracer::instance().stop();
+
     emit statusMessage("- Streaming process stopped (all threads shut down gracefully)");
 }
 
@@ -329,15 +489,8 @@ void ScanStreamingManager::stopProcess() {
 void ScanStreamingManager::emergencyStop() {
     qDebug() << "ScanStreamingManager::emergencyStop() - EMERGENCY STOP ACTIVATED";
     
-    mEmergencyStopFlag = true;
-    mStopRequested = true;
-    
-    // Wake all waiting threads
-    mCvProducerNotFull.notify_all();
-    mCvConsumerNotEmpty.notify_all();
-    mCvPLCNotified.notify_all();
-    mCvOPCReady.notify_all();
-    mCvLayerRequested.notify_all();
+    requestStop(true);
+    mStyleCheckTimer.stop();
 
     // ========== FIX: Join test producer thread (was detached, caused crash) ==========
     if (mTestProducerThread.joinable()) {
@@ -405,6 +558,16 @@ void ScanStreamingManager::notifyLayerExecutionComplete(uint32_t layerNumber) {
     }
 }
 
+// ========== Report folder for diagnostics ==========
+std::wstring ScanStreamingManager::defaultReportDirectory(const std::wstring& marcPath) {
+    // Project layout: <root>/Data/slicefile.marc -> <root>/Reports
+    std::filesystem::path dir = std::filesystem::path(marcPath).parent_path();
+    if (dir.filename() == "Data") {
+        return (dir.parent_path() / "Reports").wstring();
+    }
+    return dir.wstring();
+}
+
 // ========== Notify PLC Prepared (called from ProcessController / OPC worker) ==========
 void ScanStreamingManager::notifyPLCPrepared() {
     mPLCPrepared = true;
@@ -418,6 +581,8 @@ void ScanStreamingManager::notifyPLCPrepared() {
 void ScanStreamingManager::consumerThreadFunc() {
     try {
         qDebug() << "Consumer thread started";
+        marc::trace::setThreadName("Consumer");
+        marc::metrics::PipelineMetrics& metrics = marc::metrics::pipeline();
         
         std::ostringstream ss;
         
@@ -435,31 +600,94 @@ void ScanStreamingManager::consumerThreadFunc() {
         // PHASE 1: Load BuildStyleLibrary from JSON Configuration File
         // ============================================================================
         // INDUSTRIAL PRACTICE: Load configuration in consumer thread
-        // This ensures thread-safe access to mBuildStyles during layer execution
+        // before the first layer request: the producer reads no styles until then,
+        // so the store can drop the previous build's snapshots here.
         
+        mActiveStyles = nullptr;   // producer picks up the current snapshot at its first layer
         if (!mConfigJsonPath.empty()) {
             // Convert wstring to string for BuildStyleLibrary
             std::string configPath(mConfigJsonPath.begin(), mConfigJsonPath.end());
             
             emit statusMessage(QString("Consumer: Loading BuildStyle parameters from config.json..."));
             
-            if (!mBuildStyles.loadFromJson(configPath)) {
+            std::string reason;
+            if (!mStyles.reset(configPath, &reason)) {
                 ss.str("");
-                ss << "- CRITICAL: Failed to parse buildStyles from: " << configPath;
+                ss << "- CRITICAL: Failed to parse buildStyles from: " << configPath << " (" << reason << ")";
                 emit error(QString::fromStdString(ss.str()));
                 mStopRequested = true;
+                mStatus.setPhase(PipelineStatus::Phase::Failed);
                 return;
             }
 
+            const marc::BuildStyleLibrary* styles = mStyles.current();
+            mActiveStyles = styles;
+            mConverter.setBuildStyles(styles);
             ss.str("");
-            ss << "- Consumer: Loaded " << mBuildStyles.count() << " buildStyles from config.json";
+            ss << "- Consumer: Loaded " << styles->count() << " buildStyles from config.json";
             emit statusMessage(QString::fromStdString(ss.str()));
             emit configLoaded(QString::fromStdString(configPath));
             
             // Validate that we have at least one build style
-            if (mBuildStyles.isEmpty()) {
+            if (styles->isEmpty()) {
                 emit statusMessage("- WARNING: No buildStyles loaded from config.json. Using defaults only.");
             }
+
+            if (!mGeometryPool) {
+                mGeometryPool = std::make_unique<marc::WorkerPool>();
+            }
+
+            // Beam compensation (producer offsets contours before hatching and conversion)
+            mContourOffsetter.reset();
+            if (styles->hasBeamCompensation()) {
+                mContourOffsetter = std::make_unique<marc::ContourOffsetter>(styles);
+                mContourOffsetter->setWorkerPool(mGeometryPool.get());
+                emit statusMessage("- Consumer: Beam compensation enabled (contours offset per BuildStyle)");
+            }
+
+            // Optional runtime hatching (producer fills contours before conversion)
+            mHatchGenerator.reset();
+            try {
+                marc::HatchGenerator::Options hatchOpt;
+                if (marc::HatchGenerator::loadFromJson(configPath, hatchOpt)) {
+                    mHatchGenerator = std::make_unique<marc::HatchGenerator>(styles, hatchOpt);
+                    mHatchGenerator->setWorkerPool(mGeometryPool.get());
+                    ss.str("");
+                    ss << "- Consumer: Runtime hatching enabled (spacing " << mHatchGenerator->spacing()
+                       << " mm, angle " << hatchOpt.angleDeg << " deg + " << hatchOpt.rotationPerLayerDeg
+                       << " deg/layer" << (hatchOpt.replaceExisting ? ", file hatches replaced" : "") << ")";
+                    emit statusMessage(QString::fromStdString(ss.str()));
+                }
+            } catch (const std::exception& e) {
+                ss.str("");
+                ss << "- CRITICAL: Invalid 'hatching' section in " << configPath << ": " << e.what();
+                emit error(QString::fromStdString(ss.str()));
+                mStopRequested = true;
+                mStatus.setPhase(PipelineStatus::Phase::Failed);
+                return;
+            }
+
+            // Optional island scan strategy (producer re-cuts hatches before conversion)
+            mIslandPartitioner.reset();
+            try {
+                marc::IslandPartitioner::Options islandOpt;
+                if (marc::IslandPartitioner::loadFromJson(configPath, islandOpt)) {
+                    mIslandPartitioner = std::make_unique<marc::IslandPartitioner>(islandOpt);
+                    mIslandPartitioner->setWorkerPool(mGeometryPool.get());
+                    ss.str("");
+                    ss << "- Consumer: Island scan strategy enabled (" << islandOpt.islandSize << " mm, "
+                       << marc::IslandPartitioner::orderName(islandOpt.order) << " order, shift "
+                       << islandOpt.shiftPerLayer << " mm/layer)";
+                    emit statusMessage(QString::fromStdString(ss.str()));
+                }
+            } catch (const std::exception& e) {
+                ss.str("");
+                ss << "- CRITICAL: Invalid 'islands' section in " << configPath << ": " << e.what();
+                emit error(QString::fromStdString(ss.str()));
+                mStopRequested = true;
+                mStatus.setPhase(PipelineStatus::Phase::Failed);
+                return;
+            }
         } else {
             emit statusMessage("- WARNING: No config.json path provided. Using default parameters only.");
         }
@@ -474,21 +702,25 @@ void ScanStreamingManager::consumerThreadFunc() {
             if (!RTC5DLLManager::instance().acquireDLL()) {
                 emit error("CRITICAL: Failed to acquire RTC5 DLL in consumer thread");
                 mStopRequested = true;
+                mStatus.setPhase(PipelineStatus::Phase::Failed);
                 return;
             }
             
             if (!scanner.initialize(mScannerConfig)) {
                 emit error("CRITICAL: Scanner initialization failed in consumer thread");
                 mStopRequested = true;
+                mStatus.setPhase(PipelineStatus::Phase::Failed);
                 return;
             }
         } catch (const std::exception& e) {
             qDebug() << "Exception during scanner initialization:" << QString::fromStdString(e.what());
             mStopRequested = true;
+            mStatus.setPhase(PipelineStatus::Phase::Failed);
             return;
         } catch (...) {
             qDebug() << "Unknown exception during scanner initialization";
             mStopRequested = true;
+            mStatus.setPhase(PipelineStatus::Phase::Failed);
             return;
         }
         
@@ -499,6 +731,7 @@ void ScanStreamingManager::consumerThreadFunc() {
                << "  This indicates an internal consistency error in the Scanner class";
             emit error(QString::fromStdString(ss.str()));
             mStopRequested = true;
+            mStatus.setPhase(PipelineStatus::Phase::Failed);
             return;
         }
         
@@ -512,6 +745,7 @@ void ScanStreamingManager::consumerThreadFunc() {
         if (mProcessMode == ProcessMode::Production && !mOPCManager) {
             emit error("ERROR: OPC Manager not initialized. Call setOPCManager() first or ensure SLMWorkerManager is active.");
             mStopRequested = true;
+            mStatus.setPhase(PipelineStatus::Phase::Failed);
             return;
         }
         
@@ -523,6 +757,39 @@ void ScanStreamingManager::consumerThreadFunc() {
         
         size_t layerNumber = 0;
 
+        // ============================================================================
+        // PHASE 4a: Resume - restore the PLC state of the last completed layer
+        // ============================================================================
+        // The next layer is recoated from the cylinder positions the journal recorded
+        // after the last completed layer; an interrupted layer is recoated and scanned again.
+        if (mProcessMode == ProcessMode::Production && mResume.valid) {
+            const BuildJournal::Entry& last = mResume.lastCompleted;
+            if (mResume.interrupted) {
+                ss.str("");
+                ss << "- Layer index " << mResume.nextLayerIndex
+                   << " was interrupted during scanning: it is recoated and scanned again";
+                emit statusMessage(QString::fromStdString(ss.str()));
+            }
+            if (!last.plcValid) {
+                emit statusMessage("- WARNING: Journal has no cylinder positions for the last layer, PLC state not restored");
+            } else if (mOPCManager && mOPCManager->isInitialized()) {
+                OPCServerManagerUA::OPCData plc;
+                if (mOPCManager->readData(plc) &&
+                    plc.sourceCylPosition == last.sourceCylPosition &&
+                    plc.sinkCylPosition == last.sinkCylPosition) {
+                    emit statusMessage("- Cylinder positions match the build journal");
+                } else {
+                    const bool restored = mOPCManager->writeCylinderPosition(true, last.sourceCylPosition) &&
+                                          mOPCManager->writeCylinderPosition(false, last.sinkCylPosition);
+                    ss.str("");
+                    ss << (restored ? "- Cylinder positions restored from build journal: source "
+                                    : "- WARNING: Failed to restore cylinder positions: source ")
+                       << last.sourceCylPosition << ", sink " << last.sinkCylPosition;
+                    emit statusMessage(QString::fromStdString(ss.str()));
+                }
+            }
+        }
+
         // INDUSTRIAL REFINEMENT: Consumer drives the process by requesting the first layer.
         {
             std::lock_guard<std::mutex> lk(mMutex);
@@ -535,6 +802,7 @@ void ScanStreamingManager::consumerThreadFunc() {
             std::shared_ptr<marc::RTCCommandBlock> block;
 
             // ====== WAIT FOR PRODUCER TO ENQUEUE A BLOCK ======
+            mStatus.setPhase(PipelineStatus::Phase::WaitingForLayer);
             {
                 std::unique_lock<std::mutex> lk(mMutex);
                 mCvConsumerNotEmpty.wait(lk, [this] {
@@ -556,6 +824,9 @@ void ScanStreamingManager::consumerThreadFunc() {
                 
                 block = mQueue.front();
                 mQueue.pop_front();
+                MARC_TRACE_COUNTER("pipeline", "queueDepth", mQueue.size());
+                metrics.queueDepth.set(static_cast<double>(mQueue.size()));
+                if (block) metrics.bytesQueued.add(-static_cast<double>(block->byteSize()));
                 lk.unlock();
 
                 // Notify producer that queue has space (important for single-piece flow)
@@ -566,6 +837,18 @@ void ScanStreamingManager::consumerThreadFunc() {
 
             layerNumber = block->layerNumber;
             mCurrentLayerNumber = layerNumber;
+            mStatus.setCurrentLayer(block->layerNumber);
+            mProgressFeed.publish(block);   // shared, not copied: previews draw from this block
+
+            LayerTimingRecord timing = mTiming.takeProducerStages(block->layerNumber);
+            timing.commandCount = block->commands.size();
+            timing.estimatedExecUs = static_cast<int64_t>(
+                block->estimateSeconds(mConverter.calibration().bitsPerMM()) * 1e6);
+            const uint64_t blockHash = mJournal.isOpen() ? block->contentHash() : 0;
+            if (timing.seen[LayerTimingRecord::QueueWait]) {
+                timing.addSpan(LayerTimingRecord::QueueWait,
+                               timing.beginUs[LayerTimingRecord::QueueWait], mTiming.nowUs());
+            }
 
             // ========== INDUSTRIAL PRACTICE: OPC LAYER SYNCHRONIZATION ==========
             // LAYER EXECUTION SEQUENCE:
@@ -579,11 +862,11 @@ void ScanStreamingManager::consumerThreadFunc() {
             
             if (mProcessMode == ProcessMode::Production) {
                 // ========== PRODUCTION MODE: Wait for OPC to prepare layer ==========`"
+                const int64_t plcBegin = mTiming.nowUs();
                 std::unique_lock<std::mutex> lk(mMutex);
                 
-                ss.str("");
-                ss << "Layer " << layerNumber << ": Requesting OPC layer preparation...";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                mStatus.setPhase(PipelineStatus::Phase::PLCWait);
+                MARC_LOG_INFO(0, "Layer %zu: Requesting OPC layer preparation...", layerNumber);
 
                 // Tell OPC to prepare this layer
                 if (mOPCManager && mOPCManager->isInitialized()) {
@@ -597,9 +880,7 @@ void ScanStreamingManager::consumerThreadFunc() {
                             deltaValue,
                             deltaValue))
                         {
-                            ss.str("");
-                            ss << "Layer " << layerNumber << ": OPC layer setup failed, continuing anyway";
-                            emit statusMessage(QString::fromStdString(ss.str()));
+                            MARC_LOG_WARN(0, "Layer %zu: OPC layer setup failed, continuing anyway", layerNumber);
                         }
                     } catch (const std::exception& e) {
                         ss.str("");
@@ -609,9 +890,7 @@ void ScanStreamingManager::consumerThreadFunc() {
                 }
                 
                 // Now wait for OPC to signal "layer prepared"
-                ss.str("");
-                ss << "Layer " << layerNumber << ": Waiting for recoater/platform to prepare...";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                MARC_LOG_INFO(0, "Layer %zu: Waiting for recoater/platform to prepare...", layerNumber);
 
                 // Block consumer until OPC says "layer prepared"
                 mCvPLCNotified.wait(lk, [this] {
@@ -622,15 +901,14 @@ void ScanStreamingManager::consumerThreadFunc() {
 
                 // Reset PLC flag for next layer
                 mPLCPrepared = false;
+                const int64_t plcEnd = mTiming.nowUs();
+                timing.addSpan(LayerTimingRecord::PLCWait, plcBegin, plcEnd);
+                metrics.plcWaitUs.record(static_cast<uint64_t>(plcEnd - plcBegin));
                 
-                ss.str("");
-                ss << "Layer " << layerNumber << ": - Recoater/platform ready, starting laser scan...";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                MARC_LOG_INFO(0, "Layer %zu: - Recoater/platform ready, starting laser scan...", layerNumber);
             } else {
                 // ========== TEST MODE: No OPC synchronization ==========`"
-                ss.str("");
-                ss << "Layer " << layerNumber << " (TEST MODE: no OPC sync, laser OFF)";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                MARC_LOG_INFO(0, "Layer %zu (TEST MODE: no OPC sync, laser OFF)", layerNumber);
             }
 
             // ====== CHECK FOR EMERGENCY STOP BEFORE EXECUTION ======
@@ -651,6 +929,18 @@ void ScanStreamingManager::consumerThreadFunc() {
                 break;
             }
 
+            // Journal: from here on a crash leaves this layer partly exposed
+            if (mJournal.isOpen()) {
+                BuildJournal::Entry entry;
+                entry.event = BuildJournal::Entry::Started;
+                entry.layerIndex = block->layerIndex;
+                entry.layerNumber = block->layerNumber;
+                entry.blockHash = blockHash;
+                if (!mJournal.append(entry)) {
+                    MARC_LOG_WARN(0, "Layer %zu: build journal write failed", layerNumber);
+                }
+            }
+
             // ============================================================================
             // ✅ CRITICAL FIX: PREPARE RTC5 LIST BEFORE QUEUING COMMANDS
             // ============================================================================
@@ -670,6 +960,8 @@ void ScanStreamingManager::consumerThreadFunc() {
             // - RTC5 rejects command → "command failed at index 0"
             //
             // SOLUTION: Explicitly restart list before queuing commands
+            int64_t listLoadBegin = mTiming.nowUs();
+            const int64_t scanBegin = listLoadBegin;
             if (!scanner.prepareListForLayer()) {
                 ss.str("");
                 ss << "CRITICAL: Failed to prepare RTC5 list for layer " << layerNumber;
@@ -678,9 +970,8 @@ void ScanStreamingManager::consumerThreadFunc() {
                 break;
             }
 
-            ss.str("");
-            ss << "Layer " << layerNumber << ": Executing scanner commands...";
-            emit statusMessage(QString::fromStdString(ss.str()));
+            mStatus.setPhase(PipelineStatus::Phase::ListLoad);
+            MARC_LOG_INFO(0, "Layer %zu: Executing scanner commands...", layerNumber);
 
             // ========== PARAMETER SWITCHING: CRITICAL SECTION =========
             const marc::RTCCommandBlock::ParameterSegment* currentSegment = nullptr;
@@ -695,12 +986,13 @@ void ScanStreamingManager::consumerThreadFunc() {
                 // Demo3 monitors ListLevel and executes list when near capacity
                 // This prevents buffer overflow and ensures smooth dual buffering
                 if (scanner.getCurrentListLevel() >= MAX_COMMANDS_PER_BATCH) {
-                    ss.str("");
-                    ss << "  Layer " << layerNumber << ": List buffer near full ("
-                       << scanner.getCurrentListLevel() << " commands), executing batch...";
-                    emit statusMessage(QString::fromStdString(ss.str()));
+                    MARC_LOG_INFO(100, "  Layer %zu: List buffer near full (%u commands), executing batch...",
+                                  layerNumber, scanner.getCurrentListLevel());
                     
                     // Execute current batch
+                    mStatus.setPhase(PipelineStatus::Phase::ListExec);
+                    const int64_t batchBegin = mTiming.nowUs();
+                    timing.addSpan(LayerTimingRecord::ListLoad, listLoadBegin, batchBegin);
                     try {
                         if (!scanner.executeList()) {
                             ss.str("");
@@ -719,6 +1011,14 @@ void ScanStreamingManager::consumerThreadFunc() {
                             break;
                         }
                         
+                        const int64_t batchEnd = mTiming.nowUs();
+                        timing.addSpan(LayerTimingRecord::ListExec, batchBegin, batchEnd);
+                        metrics.listExecUs.record(static_cast<uint64_t>(batchEnd - batchBegin));
+                        metrics.listFill.set(static_cast<double>(commandsInCurrentBatch) / mScannerConfig.listMemory);
+                        mProgressFeed.setSubmitted(i);
+                        mProgressFeed.setExecuted(i);
+                        listLoadBegin = mTiming.nowUs();
+
                         // Prepare next batch buffer (Demo3's auto_change already swapped buffers)
                         if (!scanner.prepareListForLayer()) {
                             ss.str("");
@@ -729,6 +1029,7 @@ void ScanStreamingManager::consumerThreadFunc() {
                         }
                         
                         commandsInCurrentBatch = 0;
+                        mStatus.setPhase(PipelineStatus::Phase::ListLoad);
                         
                     } catch (const std::exception& e) {
                         ss.str("");
@@ -757,12 +1058,10 @@ void ScanStreamingManager::consumerThreadFunc() {
                             break;
                         }
 
-                        ss.str("");
-                        ss << "  - Applied buildStyle " << currentSegment->buildStyleId
-                           << " (power=" << currentSegment->laserPower << "W"
-                           << ", markSpeed=" << currentSegment->laserSpeed << "mm/s"
-                           << ", jumpSpeed=" << currentSegment->jumpSpeed << "mm/s)";
-                        emit statusMessage(QString::fromStdString(ss.str()));
+                        // Hot path: binary log ring (formatted by the GUI drain), rate-limited per site
+                        MARC_LOG_INFO(100, "  - Applied buildStyle %u (power=%gW, markSpeed=%gmm/s, jumpSpeed=%gmm/s)",
+                                      currentSegment->buildStyleId, currentSegment->laserPower,
+                                      currentSegment->laserSpeed, currentSegment->jumpSpeed);
                     } catch (const std::exception& e) {
                         ss.str("");
                         ss << "Exception applying segment parameters: " << e.what();
@@ -779,12 +1078,18 @@ void ScanStreamingManager::consumerThreadFunc() {
                     success = scanner.jumpTo(Scanner::Point(cmd.x, cmd.y));
                 } else if (cmd.type == marc::RTCCommandBlock::Command::Mark) {
                     success = scanner.markTo(Scanner::Point(cmd.x, cmd.y));
+                } else if (cmd.type == marc::RTCCommandBlock::Command::Expose) {
+                    // Point exposure: jump, settle and laser-on all run from the list on the card.
+                    // Without a segment there is no exposure time; never fire a default pulse.
+                    if (currentSegment && currentSegment->pointExposureUs > 0) {
+                        success = scanner.exposePoint(Scanner::Point(cmd.x, cmd.y), currentSegment->pointDelayUs,
+                                                      currentSegment->pointExposureUs);
+                    } else {
+                        success = true;
+                    }
                 } else if (cmd.type == marc::RTCCommandBlock::Command::Delay) {
-                    // Delays are handled by the RTC card, but for simplicity in this refactor,
-                    // we can use a sleep. For high-performance applications, this should be
-                    // replaced with a proper RTC delay command.
-                    std::this_thread::sleep_for(std::chrono::milliseconds(cmd.delayMs));
-                    success = true;
+                    // Card-timed list delay; the host only queues it
+                    success = scanner.addDelay(cmd.delayMs * 1000);
                 } else {
                     // SetPower, SetSpeed, SetFocus handled by applySegmentParameters()
                     success = true;
@@ -797,7 +1102,13 @@ void ScanStreamingManager::consumerThreadFunc() {
                     executionError = true;
                     break;
                 }
+                ++commandsInCurrentBatch;
+                if ((i + 1) % ScanProgressFeed::kSubmitStride == 0) mProgressFeed.setSubmitted(i + 1);
             }
+            mProgressFeed.setSubmitted(block->commands.size());
+
+            const int64_t listExecBegin = mTiming.nowUs();
+            timing.addSpan(LayerTimingRecord::ListLoad, listLoadBegin, listExecBegin);
 
             if (executionError || mStopRequested) {
                 if (executionError) {
@@ -810,14 +1121,13 @@ void ScanStreamingManager::consumerThreadFunc() {
 
             // ====== EXECUTE FINAL BATCH FOR THIS LAYER ======
             // Demo3 Pattern: Close and execute remaining commands in buffer
-            ss.str("");
-            ss << "Layer " << layerNumber << ": Executing final batch ("
-               << scanner.getCurrentListLevel() << " commands)...";
-            emit statusMessage(QString::fromStdString(ss.str()));
+            mStatus.setPhase(PipelineStatus::Phase::ListExec);
+            MARC_LOG_INFO(0, "Layer %zu: Executing final batch (%u commands)...",
+                          layerNumber, scanner.getCurrentListLevel());
 
             // ====== SMALL DELAY BEFORE EXECUTING LIST (RTC5 SYNCHRONIZATION) ======
             // Added delay to ensure RTC5 DSP is ready for command execution
-            std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+            std::this_thread::sleep_for(mListStartDelay);
 
             // ====== EXECUTE THE ACCUMULATED COMMAND LIST ON RTC5 ======
             if (!scanner.executeList()) {
@@ -848,28 +1158,62 @@ void ScanStreamingManager::consumerThreadFunc() {
                 break;
             }
 
+            const int64_t handshakeBegin = mTiming.nowUs();
+            timing.addSpan(LayerTimingRecord::ListExec, listExecBegin, handshakeBegin);
+            metrics.listExecUs.record(static_cast<uint64_t>(handshakeBegin - listExecBegin));
+            metrics.listFill.set(static_cast<double>(commandsInCurrentBatch) / mScannerConfig.listMemory);
+            metrics.commandsExecuted.inc(block->commands.size());
+            mProgressFeed.setExecuted(block->commands.size());
+            const double commandsPerSecond = handshakeBegin > scanBegin
+                ? block->commands.size() * 1e6 / (handshakeBegin - scanBegin) : 0.0;
+            metrics.commandsPerSecond.set(commandsPerSecond);
+            mStatus.setPhase(PipelineStatus::Phase::Handshake);
+
             // ========== LASER OFF AFTER LAYER EXECUTION ==========`
             // Industrial SLM standard: disable laser after each layer to prevent drift
             try {
                 scanner.disableLaser();
-                ss.str("");
-                ss << "Layer " << layerNumber << ": Execution complete, laser OFF";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                MARC_LOG_INFO(0, "Layer %zu: Execution complete, laser OFF", layerNumber);
             } catch (const std::exception& e) {
                 qWarning() << "Failed to disable laser after layer:" << e.what();
             }
 
             // ====== LAYER EXECUTION COMPLETE ======
             ++mLayersConsumed;
-            emit layerExecuted(static_cast<uint32_t>(layerNumber));
-            emit progress(static_cast<int>(mLayersConsumed.load()), 
-                         static_cast<int>(mTotalLayers.load()));
+            metrics.layersExecuted.inc();
+            mStatus.layerExecuted(block->commands.size(), commandsPerSecond);
             
+            // Cylinder positions of the scanned layer for the journal, read before the
+            // layer-complete notification lets the PLC start the next recoat
+            OPCServerManagerUA::OPCData plc;
+            const bool plcValid = mJournal.isOpen() && mOPCManager && mOPCManager->isInitialized() &&
+                                  mOPCManager->readData(plc);
+
             // ========== BIDIRECTIONAL OPC SYNCHRONIZATION: NOTIFY LAYER COMPLETE ========= =
             if (mProcessMode == ProcessMode::Production) {
                 notifyLayerExecutionComplete(static_cast<uint32_t>(layerNumber));
             }
 
+            // Journal: layer done, with the cylinder positions a resume restores
+            if (mJournal.isOpen()) {
+                BuildJournal::Entry entry;
+                entry.event = BuildJournal::Entry::Completed;
+                entry.layerIndex = block->layerIndex;
+                entry.layerNumber = block->layerNumber;
+                entry.blockHash = blockHash;
+                if (plcValid) {
+                    entry.plcValid = true;
+                    entry.sourceCylPosition = plc.sourceCylPosition;
+                    entry.sinkCylPosition = plc.sinkCylPosition;
+                }
+                if (!mJournal.append(entry)) {
+                    MARC_LOG_WARN(0, "Layer %zu: build journal write failed", layerNumber);
+                }
+            }
+            timing.addSpan(LayerTimingRecord::Handshake, handshakeBegin, mTiming.nowUs());
+            mTiming.commit(timing);
+            MARC_TRACE_COUNTER("pipeline", "layersConsumed", mLayersConsumed.load());
+
             // INDUSTRIAL REFINEMENT: Request the next layer only after the current one is fully processed.
             {
                 std::lock_guard<std::mutex> lk(mMutex);
@@ -880,6 +1224,10 @@ void ScanStreamingManager::consumerThreadFunc() {
             mCvLayerRequested.notify_one();
         }
 
+        if (mStatus.phase() != PipelineStatus::Phase::Failed) {
+            mStatus.setPhase(mStopRequested ? PipelineStatus::Phase::Stopped : PipelineStatus::Phase::Finished);
+        }
+
         // ============================================================================
         // PHASE 5: Shutdown scanner gracefully
         // ============================================================================
@@ -900,6 +1248,27 @@ void ScanStreamingManager::consumerThreadFunc() {
             emit statusMessage(QString::fromStdString(ss.str()));
         }
 
+        mJournal.close();
+
+        // ========== PER-LAYER TIMING SUMMARY ==========
+        if (mTiming.recordCount() > 0) {
+            std::istringstream summary(mTiming.finish());
+            std::string line;
+            while (std::getline(summary, line)) {
+                emit statusMessage(QString::fromStdString(line));
+            }
+            emit statusMessage(QString::fromStdString(
+                "- Layer timing written to " + mTiming.outputFile().string()));
+        } else {
+            mTiming.finish();
+        }
+
+        if (marc::trace::Tracer::instance().isEnabled()) {
+            marc::trace::Tracer::instance().stop();
+            emit statusMessage(QString::fromStdString(
+                "- Trace written to " + marc::trace::Tracer::instance().outputFile().string()));
+        }
+
         // ========== SAFE SIGNAL EMISSION: Emit finished only after thread-local cleanup ==========
         // By this point:
         // - Scanner is shut down (local variable destructed)
@@ -915,10 +1284,12 @@ void ScanStreamingManager::consumerThreadFunc() {
         std::ostringstream ss;
         ss << "CRITICAL: Unhandled exception in consumer thread: " << e.what();
         emit error(QString::fromStdString(ss.str()));
+        mStatus.setPhase(PipelineStatus::Phase::Failed);
         emit finished();  // Still signal completion so GUI thread can clean up
     } catch (...) {
         // Catch any exception that std::exception doesn't cover
         emit error("CRITICAL: Unknown exception in consumer thread");
+        mStatus.setPhase(PipelineStatus::Phase::Failed);
         emit finished();  // Still signal completion
     }
 }
@@ -928,9 +1299,12 @@ void ScanStreamingManager::consumerThreadFunc() {
 // ============================================================================
 
 void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
+    marc::trace::setThreadName("Producer");
+    marc::metrics::PipelineMetrics& metrics = marc::metrics::pipeline();
     try {
         marc::StreamingMarcReader reader(marcPath);
         mTotalLayers = reader.totalLayers();
+        mStatus.setLayersTotal(static_cast<uint32_t>(mTotalLayers.load()));
         
         if (mTotalLayers == 0) {
             emit error("MARC file contains no layers");
@@ -944,6 +1318,18 @@ void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
         ss << "Loading " << mTotalLayers << " layers from file (streaming mode)";
         emit statusMessage(QString::fromStdString(ss.str()));
 
+        // Resume: continue at the first layer the journal has not seen completed
+        bool verifyResume = false;
+        if (mResume.valid) {
+            reader.seekToLayer(mResume.nextLayerIndex);
+            verifyResume = true;
+            ss.str("");
+            ss << "Resuming at layer index " << mResume.nextLayerIndex << " of " << mTotalLayers;
+            emit statusMessage(QString::fromStdString(ss.str()));
+        }
+
+        std::vector<char> layerBytes;  // reused across layers
+
         while (reader.hasNextLayer() && !mStopRequested) {
             {
                 std::unique_lock<std::mutex> lk(mMutex);
@@ -956,9 +1342,27 @@ void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
                 mLayerRequested = false; // Consume the request
             }
 
+            // Styles and stages are set up by the consumer before its first request;
+            // a reloaded style library takes effect here, at the layer boundary
+            refreshBuildStyles(reader.currentLayerIndex());
+
+            if (verifyResume) {
+                verifyResume = false;
+                verifyResumeLayer(marcPath);
+            }
+
+            // Read (file I/O) and decode (parse) are timed as separate stages
+            LayerTimingRecord timing;
             marc::Layer layer;
+            const uint32_t layerIndex = reader.currentLayerIndex();
             try {
-                layer = reader.readNextLayer();
+                const int64_t readBegin = mTiming.nowUs();
+                reader.readNextLayerBytes(layerBytes);
+                const int64_t decodeBegin = mTiming.nowUs();
+                layer = marc::StreamingMarcReader::decodeLayer(layerBytes.data(), layerBytes.size(),
+                                                                   reader.header().version);
+                timing.addSpan(LayerTimingRecord::Read, readBegin, decodeBegin);
+                timing.addSpan(LayerTimingRecord::Decode, decodeBegin, mTiming.nowUs());
             } catch (const std::exception& e) {
                 ss.str("");
                 ss << "Error reading layer " << reader.currentLayerIndex() << ": " << e.what();
@@ -967,8 +1371,13 @@ void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
                 break;
             }
 
+            // Convert span includes beam compensation, runtime hatching, islands and exclusion
+            const int64_t convertBegin = mTiming.nowUs();
+            applyLayerStages(layer);
+
             auto block = std::make_shared<marc::RTCCommandBlock>();
             block->layerNumber = layer.layerNumber;
+            block->layerIndex = layerIndex;
             block->layerHeight = layer.layerHeight;
             block->layerThickness = layer.layerThickness;
             block->hatchCount = layer.hatches.size();
@@ -982,6 +1391,14 @@ void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
                 mStopRequested = true;
                 break;
             }
+            const int64_t enqueueAt = mTiming.nowUs();
+            timing.addSpan(LayerTimingRecord::Convert, convertBegin, enqueueAt);
+
+            // Hand producer stages to the recorder before the consumer can pop the block
+            timing.layerNumber = layer.layerNumber;
+            timing.layerBytes = layerBytes.size();
+            timing.addSpan(LayerTimingRecord::QueueWait, enqueueAt, enqueueAt);
+            mTiming.submitProducerStages(timing);
 
             {
                 std::unique_lock<std::mutex> lk(mMutex);
@@ -992,17 +1409,18 @@ void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
 
                 mQueue.push_back(block);
                 ++mLayersProduced;
+                MARC_TRACE_COUNTER("pipeline", "queueDepth", mQueue.size());
+                metrics.queueDepth.set(static_cast<double>(mQueue.size()));
+                metrics.bytesQueued.add(static_cast<double>(block->byteSize()));
+                metrics.layersProduced.inc();
 
-                ss.str("");
-                ss << "Layer " << layer.layerNumber << " enqueued ("
-                   << mLayersProduced << "/" << mTotalLayers << ") with "
-                   << block->parameterSegments.size() << " parameter segments";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                mStatus.layerProduced();
+
+                MARC_LOG_INFO(0, "Layer %u enqueued (%zu/%zu) with %zu parameter segments",
+                              layer.layerNumber, mLayersProduced.load(), mTotalLayers.load(),
+                              block->parameterSegments.size());
             }
             mCvConsumerNotEmpty.notify_one();
-            
-            emit progress(static_cast<int>(mLayersProduced.load()), 
-                         static_cast<int>(mTotalLayers.load()));
         }
 
         {
@@ -1029,11 +1447,129 @@ void ScanStreamingManager::producerThreadFunc(const std::wstring& marcPath) {
     }
 }
 
+void ScanStreamingManager::applyLayerStages(marc::Layer& layer) {
+    if (mContourOffsetter) {
+        mContourOffsetter->apply(layer);
+    }
+    if (mHatchGenerator) {
+        mHatchGenerator->apply(layer);
+    }
+    if (mIslandPartitioner) {
+        mIslandPartitioner->apply(layer);
+    }
+    // Part exclusion last, so nothing generated above is exposed inside a region
+    const auto exclusions = mExcluder.rules();
+    if (exclusions && !exclusions->empty()) {
+        const marc::PartExcluder::Stats ex = marc::PartExcluder::apply(*exclusions, layer);
+        if (ex.removed + ex.clipped > 0) {
+            MARC_LOG_INFO(100, "Layer %u: excluded %zu geometries, clipped %zu",
+                          layer.layerNumber, ex.removed, ex.clipped);
+        }
+    }
+}
+
+void ScanStreamingManager::setExclusions(const marc::PartExcluder::Rules& rules) {
+    mExcluder.setRules(rules);
+    saveExclusions();
+}
+
+void ScanStreamingManager::saveExclusions() {
+    std::string saveError;
+    {
+        std::lock_guard<std::mutex> lk(mExclusionsFileMutex);
+        if (mExclusionsFile.empty()) return;
+        const auto rules = mExcluder.rules();
+        if (marc::PartExcluder::saveRules(rules ? *rules : marc::PartExcluder::Rules{}, mExclusionsFile.string(),
+                                          &saveError)) {
+            return;
+        }
+    }
+    emit statusMessage(QString::fromStdString("- WARNING: Part exclusions not saved, a resume will not restore them (" +
+                                              saveError + ")"));
+}
+
+void ScanStreamingManager::checkBuildStyleFile() {
+    if (!mStyleAutoReload.load(std::memory_order_relaxed)) return;
+    std::string reason;
+    if (mStyles.reloadIfChanged(&reason) == marc::BuildStyleStore::Reload::Rejected) {
+        emit statusMessage(QString::fromStdString("- WARNING: Changed config.json rejected, BuildStyles unchanged: " + reason));
+    }
+}
+
+void ScanStreamingManager::refreshBuildStyles(uint32_t nextLayerIndex) {
+    // Lock-free: one atomic load per layer, the stages are re-pointed only on a swap
+    const marc::BuildStyleLibrary* styles = mStyles.current();
+    if (styles == mActiveStyles) return;
+    const bool swapped = (mActiveStyles != nullptr);
+    mActiveStyles = styles;
+
+    mConverter.setBuildStyles(styles);
+    if (mHatchGenerator) {
+        mHatchGenerator->setBuildStyles(styles);
+    }
+    if (!styles->hasBeamCompensation()) {
+        mContourOffsetter.reset();
+    } else if (mContourOffsetter) {
+        mContourOffsetter->setBuildStyles(styles);
+    } else {
+        mContourOffsetter = std::make_unique<marc::ContourOffsetter>(styles);
+        mContourOffsetter->setWorkerPool(mGeometryPool.get());
+    }
+
+    if (swapped) {
+        emit statusMessage(QString("- BuildStyles revision %1 active from layer index %2 (%3 styles)")
+                               .arg(mStyles.revision()).arg(nextLayerIndex).arg(styles->count()));
+    }
+}
+
+bool ScanStreamingManager::reloadBuildStyles() {
+    std::string reason;
+    if (mStyles.reload(&reason) == marc::BuildStyleStore::Reload::Rejected) {
+        emit statusMessage(QString::fromStdString("- WARNING: BuildStyle reload rejected, active styles kept: " + reason));
+        return false;
+    }
+    emit statusMessage(QString("- BuildStyles reloaded (revision %1), used from the next layer")
+                           .arg(mStyles.revision()));
+    emit configLoaded(QString::fromStdString(mStyles.path()));
+    return true;
+}
+
+void ScanStreamingManager::verifyResumeLayer(const std::wstring& marcPath) {
+    // A different styles file or stage settings would scan the remaining layers
+    // differently from the completed ones; warn, but let the operator decide.
+    const BuildJournal::Entry& last = mResume.lastCompleted;
+    try {
+        marc::StreamingMarcReader reader(marcPath);
+        reader.seekToLayer(last.layerIndex);
+        marc::Layer layer = reader.readNextLayer();
+        applyLayerStages(layer);
+
+        marc::RTCCommandBlock block;
+        block.layerNumber = layer.layerNumber;
+        block.layerIndex = last.layerIndex;
+        block.layerHeight = layer.layerHeight;
+        block.layerThickness = layer.layerThickness;
+        if (!convertLayerToBlock(layer, block)) return;
+
+        if (block.contentHash() == last.blockHash) {
+            emit statusMessage(QString("- Resume check: layer %1 converts as journaled").arg(last.layerNumber));
+        } else {
+            emit statusMessage(QString("- WARNING: Layer %1 converts differently than when it was scanned "
+                                       "(styles, scan strategy or part exclusions changed)")
+                                   .arg(last.layerNumber));
+        }
+    } catch (const std::exception& e) {
+        emit statusMessage(QString("- WARNING: Resume check of layer %1 failed: %2").arg(last.layerNumber).arg(e.what()));
+    }
+}
+
 // ============================================================================
 // PRODUCER THREAD (TEST MODE) - Generate synthetic layers for testing
 // ============================================================================
 
 void ScanStreamingManager::producerTestThreadFunc(float layerThickness, size_t layerCount) {
+    marc::trace::setThreadName("Test Producer");
+    marc::metrics::PipelineMetrics& metrics = marc::metrics::pipeline();
     try {
         std::ostringstream ss;
         ss << "Test producer: Generating " << layerCount << " synthetic layers @ " 
@@ -1129,7 +1665,7 @@ void ScanStreamingManager::producerTestThreadFunc(float layerThickness, size_t l
             pilotStyle.jumpSpeed = 1200.0;
             pilotStyle.laserMode = 0;
             pilotStyle.laserFocus = 0.0;
-            applyBuildStyle(&pilotStyle, *block, 0);
+            marc::LayerConverter::applyBuildStyle(&pilotStyle, *block, 0);
             
             {
                 std::unique_lock<std::mutex> lk(mMutex);
@@ -1140,16 +1676,16 @@ void ScanStreamingManager::producerTestThreadFunc(float layerThickness, size_t l
 
                 mQueue.push_back(block);
                 ++mLayersProduced;
+                metrics.queueDepth.set(static_cast<double>(mQueue.size()));
+                metrics.bytesQueued.add(static_cast<double>(block->byteSize()));
+                metrics.layersProduced.inc();
 
-                ss.str("");
-                ss << "Test Layer " << block->layerNumber << " generated ("
-                   << mLayersProduced << "/" << layerCount << ")";
-                emit statusMessage(QString::fromStdString(ss.str()));
+                mStatus.layerProduced();
+
+                MARC_LOG_INFO(0, "Test Layer %u generated (%zu/%zu)",
+                              block->layerNumber, mLayersProduced.load(), layerCount);
             }
             mCvConsumerNotEmpty.notify_one();
-            
-            emit progress(static_cast<int>(mLayersProduced.load()), 
-                         static_cast<int>(layerCount));
         }
 
         {
@@ -1181,136 +1717,11 @@ void ScanStreamingManager::producerTestThreadFunc(float layerThickness, size_t l
 // ============================================================================
 
 bool ScanStreamingManager::convertLayerToBlock(const marc::Layer& L, marc::RTCCommandBlock& out) {
-    try {
-        size_t cmdStartIdx = 0;
-
-        for (const auto& h : L.hatches) {
-            if (!convertHatch(h, out, cmdStartIdx)) return false;
-        }
-        for (const auto& p : L.polylines) {
-            if (!convertPolyline(p, out, cmdStartIdx)) return false;
-        }
-        for (const auto& pg : L.polygons) {
-            if (!convertPolygon(pg, out, cmdStartIdx)) return false;
-        }
-        return true;
-    } catch (const std::exception& e) {
-        emit error(QString::fromStdString(std::string("convertLayerToBlock exception: ") + e.what()));
-        return false;
-    }
-}
-
-bool ScanStreamingManager::convertHatch(const marc::Hatch& h, marc::RTCCommandBlock& out, size_t& cmdStartIdx) {
-    try {
-        cmdStartIdx = out.commands.size();
-
-        const marc::BuildStyle* style = mBuildStyles.getStyle(h.tag.type);
-        if (!style) style = mBuildStyles.getStyle(8);
-
-        for (const auto& line : h.lines) {
-            marc::RTCCommandBlock::Command jump{marc::RTCCommandBlock::Command::Jump,
-                static_cast<long>(mmToBits(static_cast<double>(line.a.x))),
-                static_cast<long>(mmToBits(static_cast<double>(line.a.y)))};
-            marc::RTCCommandBlock::Command mark{marc::RTCCommandBlock::Command::Mark,
-                static_cast<long>(mmToBits(static_cast<double>(line.b.x))),
-                static_cast<long>(mmToBits(static_cast<double>(line.b.y)))};
-            out.commands.push_back(jump);
-            out.commands.push_back(mark);
-        }
-
-        if (style) applyBuildStyle(style, out, cmdStartIdx);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
-bool ScanStreamingManager::convertPolyline(const marc::Polyline& p, marc::RTCCommandBlock& out, size_t& cmdStartIdx) {
-    try {
-        if (p.points.empty()) return true;
-        cmdStartIdx = out.commands.size();
-
-        const marc::BuildStyle* style = mBuildStyles.getStyle(p.tag.type);
-        if (!style) style = mBuildStyles.getStyle(8);
-
-        // Jump to first point
-        out.commands.push_back(marc::RTCCommandBlock::Command{marc::RTCCommandBlock::Command::Jump,
-            static_cast<long>(mmToBits(static_cast<double>(p.points[0].x))),
-            static_cast<long>(mmToBits(static_cast<double>(p.points[0].y)))});
-
-        for (size_t i = 1; i < p.points.size(); ++i) {
-            out.commands.push_back(marc::RTCCommandBlock::Command{marc::RTCCommandBlock::Command::Mark,
-                static_cast<long>(mmToBits(static_cast<double>(p.points[i].x))),
-                static_cast<long>(mmToBits(static_cast<double>(p.points[i].y)))});
-        }
-
-        if (style) applyBuildStyle(style, out, cmdStartIdx);
-        return true;
-    } catch (...) {
-        return false;
-    }
-}
-
-bool ScanStreamingManager::convertPolygon(const marc::Polygon& p, marc::RTCCommandBlock& out, size_t& cmdStartIdx) {
-    try {
-        if (p.points.empty()) return true;
-        cmdStartIdx = out.commands.size();
-
-        const marc::BuildStyle* style = mBuildStyles.getStyle(p.tag.type);
-        if (!style) style = mBuildStyles.getStyle(8);
-
-        out.commands.push_back(marc::RTCCommandBlock::Command{marc::RTCCommandBlock::Command::Jump,
-            static_cast<long>(mmToBits(static_cast<double>(p.points[0].x))),
-            static_cast<long>(mmToBits(static_cast<double>(p.points[0].y)))});
-
-        for (size_t i = 1; i < p.points.size(); ++i) {
-            out.commands.push_back(marc::RTCCommandBlock::Command{marc::RTCCommandBlock::Command::Mark,
-                static_cast<long>(mmToBits(static_cast<double>(p.points[i].x))),
-                static_cast<long>(mmToBits(static_cast<double>(p.points[i].y)))});
-        }
-
-        // Close loop
-        out.commands.push_back(marc::RTCCommandBlock::Command{marc::RTCCommandBlock::Command::Mark,
-            static_cast<long>(mmToBits(static_cast<double>(p.points[0].x))),
-            static_cast<long>(mmToBits(static_cast<double>(p.points[0].y)))});
-
-        if (style) applyBuildStyle(style, out, cmdStartIdx);
-        return true;
-    } catch (...) {
+    MARC_TRACE_SCOPE("convert", "convertLayerToBlock");
+    std::string err;
+    if (!mConverter.convert(L, out, &err)) {
+        emit error(QString::fromStdString(err));
         return false;
     }
-}
-
-void ScanStreamingManager::applyBuildStyle(const marc::BuildStyle* style,
-                                           marc::RTCCommandBlock& out,
-                                           size_t cmdStartIdx) {
-    if (!style) return;
-
-    size_t cmdEndIdx = out.commands.size();
-    if (cmdEndIdx == 0) return;
-    cmdEndIdx = cmdEndIdx - 1;
-
-    out.addParameterSegment(
-        style->id,
-        style->laserPower,
-        style->laserSpeed,
-        style->jumpSpeed,
-        style->laserMode,
-        style->laserFocus
-    );
-
-    // Ensure segment covers intended commands
-    if (!out.parameterSegments.empty()) {
-        auto &seg = out.parameterSegments.back();
-        seg.startCmd = cmdStartIdx;
-        seg.endCmd = cmdEndIdx;
-    }
-}
-
-long ScanStreamingManager::mmToBits(double mm) const {
-    double bits = mm * mCalib.bitsPerMM();
-    long mx = mCalib.maxBits;
-    if (bits > mx) bits = mx;
-    if (bits < -mx) bits = -mx;
-    return static_cast<long>(std::lround(bits));
+    return true;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -8,11 +9,24 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <chrono>
+#include <filesystem>
 
 #include "io/readSlices.h"
 #include "io/buildstyle.h"
+#include "io/buildstylestore.h"
 #include "io/rtccommandblock.h"
+#include "io/layerconverter.h"
+#include "io/contouroffsetter.h"
+#include "io/hatchgenerator.h"
+#include "io/islandpartitioner.h"
+#include "io/partexcluder.h"
+#include "io/workerpool.h"
 #include "Scanner.h"
+#include "layertiming.h"
+#include "buildjournal.h"
+#include "pipelinestatus.h"
+#include "scanprogressfeed.h"
 
 // ============================================================================
 // Forward Declarations
@@ -79,6 +93,11 @@ public:
     // Thread startup order: OPC ? Consumer ? Producer
     // Consumer thread loads BuildStyleLibrary from configJsonPath before initialization
     bool startProcess(const std::wstring& marcPath, const std::wstring& configJsonPath);
+
+    // Continue an interrupted production build of the same .marc from the build journal
+    // in the report folder: first layer not completed, cylinder positions of the last
+    // completed layer restored on the PLC. Fails when there is nothing to resume.
+    bool resumeFromJournal(const std::wstring& marcPath, const std::wstring& configJsonPath);
     
     // ========== TEST MODE ========= =
     // Synthetic layer generation without MARC file
@@ -90,6 +109,11 @@ public:
     
     // Emergency stop: disable laser immediately, abort all operations
     void emergencyStop();
+
+    // Raise the stop (or emergency stop) flag and wake the pipeline threads without
+    // joining them; safe from any thread. The layer being scanned is aborted and
+    // finished() follows once the consumer has exited. stopProcess() joins.
+    void requestStop(bool emergency = false);
     
     // Called by GUI when OPC signals "layer prepared"
     void notifyPLCPrepared();
@@ -97,9 +121,38 @@ public:
     // Configure queue size (bounded, default 4 layers)
     void setMaxQueuedLayers(size_t sz) { mMaxQueue = (sz < 2 ? 2 : (sz > 10 ? 10 : sz)); }
 
+    // Settle delay before executing each layer's final list (default 2 s).
+    // The replay harness scales it together with the simulated card.
+    void setListStartDelay(std::chrono::milliseconds delay) { mListStartDelay = delay; }
+    std::chrono::milliseconds listStartDelay() const { return mListStartDelay; }
+
+    // Lock-free progress snapshot (layer counters, phase, last error, rates).
+    // Per-layer progress is published here only; poll it from the GUI.
+    const PipelineStatus& status() const { return mStatus; }
+
+    // Executing layer's command block + submitted/executed command counts
+    // (shared with the consumer, never copied). Drives the live scan overlay.
+    const ScanProgressFeed& progressFeed() const { return mProgressFeed; }
+
+    // Mid-build part exclusion (regions / geometry types), any thread. Applied by the
+    // producer to every layer it converts from then on; cleared when a build starts,
+    // saved to the report folder and restored by resumeFromJournal().
+    void setExclusions(const marc::PartExcluder::Rules& rules);
+    void clearExclusions() { setExclusions(marc::PartExcluder::Rules{}); }
+    std::shared_ptr<const marc::PartExcluder::Rules> exclusions() const { return mExcluder.rules(); }
+
     // Query scan config status
-    bool hasScanConfig() const { return !mBuildStyles.isEmpty(); }
-    const marc::BuildStyleLibrary& scanConfig() const { return mBuildStyles; }
+    bool hasScanConfig() const { return !mStyles.snapshot()->isEmpty(); }
+    std::shared_ptr<const marc::BuildStyleLibrary> scanConfig() const { return mStyles.snapshot(); }
+
+    // Mid-build BuildStyle change, any thread: re-reads the config JSON, validates it and
+    // swaps the style library; the producer uses it from the next layer it converts.
+    // False when the file is rejected (reason as statusMessage); the active styles stay.
+    bool reloadBuildStyles();
+    // Reload automatically when the config JSON is saved during a build (default on).
+    // The file is checked on this object's thread every kStyleCheckIntervalMs, not by the producer.
+    void setBuildStyleAutoReload(bool enabled) { mStyleAutoReload = enabled; }
+    uint64_t buildStyleRevision() const { return mStyles.revision(); }
 
     // ========== OPC INTEGRATION ========= =
     // Set OPC UA manager reference (called from SLMWorkerManager)
@@ -108,13 +161,21 @@ public:
     // Signal OPC UA that layer execution is complete (for future bidirectional sync)
     void notifyLayerExecutionComplete(uint32_t layerNumber);
 
+    // ========== DIAGNOSTICS ========= =
+    // Folder receiving layer_timing.jsonl / layer_timing_summary.txt / build_journal.bin.
+    // Empty = derive from MARC path (<project>/Reports when MARC sits in <project>/Data).
+    void setReportDirectory(const std::wstring& dir) { mReportDir = dir; }
+    static std::wstring defaultReportDirectory(const std::wstring& marcPath);
+
+    // Chrome trace export (<report dir>/trace.json). Also enabled by env MARCSLM_TRACE=1.
+    void setTracingEnabled(bool enabled) { mTracingEnabled = enabled; }
+
 signals:
-    // Emitted on worker thread, caught by GUI via Qt
+    // Emitted on worker thread, caught by GUI via Qt.
+    // Start-up/shutdown messages only; per-layer lines go through the log ring.
     void statusMessage(const QString& msg);
-    void progress(int layersProcessed, int totalLayers);  // FIX: Was size_t, now int (Qt-safe)
     void finished();
     void error(const QString& message);
-    void layerExecuted(uint32_t layerNumber);
     void configLoaded(const QString& configPath);
 
 public slots:
@@ -125,6 +186,22 @@ private:
     // ========== PRODUCER THREAD ==========
     // Streams layers from MARC file and converts to command blocks with parameters
     void producerThreadFunc(const std::wstring& marcPath);
+
+    // Shared production start (startProcess / resumeFromJournal, mResume set by the caller)
+    bool beginProduction(const std::wstring& marcPath, const std::wstring& configJsonPath);
+
+    // Geometry stages before conversion: beam compensation, hatching, islands, exclusion
+    void applyLayerStages(marc::Layer& layer);
+
+    // Resume: convert the last journaled layer again and compare its block hash
+    void verifyResumeLayer(const std::wstring& marcPath);
+    // Write the active exclusion rules to mExclusionsFile (no-op outside a production build)
+    void saveExclusions();
+
+    // Producer, per layer: point the stages at the newest style snapshot
+    void refreshBuildStyles(uint32_t nextLayerIndex);
+    // Style check timer (owner thread): reload the config JSON if it was saved
+    void checkBuildStyleFile();
     
     // ========== PRODUCER THREAD (TEST MODE) ========= =
     // Generates synthetic layers for testing (runs in consumer thread in test mode)
@@ -136,19 +213,9 @@ private:
 
     // ========== CONVERSION LOGIC ==========
     // Convert marc::Layer to RTCCommandBlock with parameter segments
+    // (delegates to marc::LayerConverter, emits error() on failure)
     bool convertLayerToBlock(const marc::Layer& L, marc::RTCCommandBlock& out);
     
-    // Convert geometry segment to RTC commands, selecting BuildStyle based on GeometryTag
-    bool convertHatch(const marc::Hatch& h, marc::RTCCommandBlock& out, size_t& cmdStartIdx);
-    bool convertPolyline(const marc::Polyline& p, marc::RTCCommandBlock& out, size_t& cmdStartIdx);
-    bool convertPolygon(const marc::Polygon& p, marc::RTCCommandBlock& out, size_t& cmdStartIdx);
-
-    // Apply laser parameters for geometry segment
-    void applyBuildStyle(const marc::BuildStyle* style, marc::RTCCommandBlock& out, size_t cmdStartIdx);
-    
-    // Convert float mm coordinates to long bits (RTC5 coordinate system)
-    long mmToBits(double mm) const;
-    
     // ========== THREAD-SAFE QUEUE ==========
     std::mutex mMutex;
     std::condition_variable mCvProducerNotFull;   // wake producer when consumer pops
@@ -159,6 +226,7 @@ private:
     
     std::deque<std::shared_ptr<marc::RTCCommandBlock>> mQueue;
     size_t mMaxQueue{1}; // INDUSTRIAL REFINEMENT: Queue size is 1 for single-piece flow
+    std::chrono::milliseconds mListStartDelay{2000};
     
     // ========== CONTROL FLAGS ==========
     std::atomic<bool> mStopRequested{false};
@@ -181,26 +249,56 @@ private:
     std::atomic<size_t> mLayersProduced{0};
     std::atomic<size_t> mLayersConsumed{0};
     std::atomic<uint32_t> mCurrentLayerNumber{0};
+    PipelineStatus mStatus;
+    ScanProgressFeed mProgressFeed;
     
     // ========== SCAN CONFIGURATION (PARAMETER LIBRARY) =========
-    marc::BuildStyleLibrary mBuildStyles;
+    // Immutable snapshots, reset by the consumer at build start, swapped on reload.
+    // mActiveStyles is the producer's current one (producer thread only).
+    marc::BuildStyleStore mStyles;
+    const marc::BuildStyleLibrary* mActiveStyles{nullptr};
+    std::atomic<bool> mStyleAutoReload{true};
+    static constexpr int kStyleCheckIntervalMs = 1000;
+    QTimer mStyleCheckTimer;                    // runs during production builds
     std::wstring mConfigJsonPath;  // NEW: Path to JSON configuration file (loaded in consumer thread)
     
     // ========== SCANNER CONFIGURATION =========
     Scanner::Config mScannerConfig;
     
-    // ========== COORDINATE CALIBRATION =========
-    struct CoordCalib {
-        double fieldSizeMM = 163.4;     // f-theta field size
-        long maxBits = 524287;          // +/- max (20-bit signed)
-        double scaleCorrection = 1.0;   // user calibration
-        
-        double bitsPerMM() const {
-            return (2.0 * static_cast<double>(maxBits)) / fieldSizeMM * scaleCorrection;
-        }
-    } mCalib;
+    // ========== GEOMETRY CONVERSION =========
+    // Resolves styles from mActiveStyles, mm -> bits via default calibration
+    marc::LayerConverter mConverter{mStyles.current()};
+
+    // Beam compensation of contours (BuildStyle beamCompensation), set when any style has one.
+    std::unique_ptr<marc::ContourOffsetter> mContourOffsetter;
+
+    // Runtime hatching of contours ("hatching" object of the config JSON).
+    // Set by the consumer with the styles, before the first layer request.
+    std::unique_ptr<marc::HatchGenerator> mHatchGenerator;
+
+    // Island (chessboard) partitioning of the hatches ("islands" object), same lifetime
+    std::unique_ptr<marc::IslandPartitioner> mIslandPartitioner;
+
+    // Threads shared by the three stages above; created once, idle between layers
+    std::unique_ptr<marc::WorkerPool> mGeometryPool;
+
+    // Region / geometry type exclusion, changed from the GUI while the producer runs
+    marc::PartExcluder mExcluder;
+    std::mutex mExclusionsFileMutex;        // guards the path and the file writes
+    std::filesystem::path mExclusionsFile;  // report folder of the production build, empty otherwise
     
     // ========== OPC INTEGRATION =========
     // Reference to OPC UA manager (owned by SLMWorkerManager OPC worker thread)
     OPCServerManagerUA* mOPCManager{nullptr};
+
+    // ========== PER-LAYER TIMING =========
+    LayerTimingRecorder mTiming;
+    std::wstring mReportDir;
+
+    // ========== BUILD JOURNAL (RESUME) =========
+    // Consumer appends Started / Completed per layer; mResume is set before the threads
+    // start and read-only while they run (valid = this build is a resume).
+    BuildJournal mJournal;
+    BuildJournal::ResumePoint mResume;
+    bool mTracingEnabled{false};
 };
@@ -18,6 +18,7 @@
 #include "controllers/opccontroller.h"
 #include "opcserver/opcserverua.h"
 #include "scanner/Scanner.h"
+#include "diagnostics/trace.h"
 
 #include <QDebug>
 #include <QThread>
@@ -340,6 +341,7 @@ void SLMWorkerManager::opcThreadFunc()
         OPCWorker localWorker;
 
         // ========== RECORD THREAD ID =========
+        marc::trace::setThreadName("OPC Worker");
         std::thread::id threadId = std::this_thread::get_id();
         mOPCThreadId.store(threadId);
         mOPCRunning.store(true);
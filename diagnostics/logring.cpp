@@ -0,0 +1,163 @@
+#include "logring.h"
+
+#include <cstdio>
+
+namespace marc {
+namespace logging {
+
+const char* severityName(Severity s) {
+    switch (s) {
+        case Severity::Debug:   return "DEBUG";
+        case Severity::Info:    return "INFO";
+        case Severity::Warning: return "WARNING";
+        case Severity::Error:   return "ERROR";
+        default:                return "?";
+    }
+}
+
+// ============================================================================
+// LogRecord
+// ============================================================================
+
+void LogRecord::addText(const char* s, size_t len) {
+    if (argCount >= kMaxArgs) return;
+    types[argCount] = Text;
+    // Storage full: the last byte is always a NUL, so the argument reads as empty
+    if (textUsed >= kTextBytes - 1) {
+        values[argCount++].textOffset = kTextBytes - 1;
+        return;
+    }
+    const size_t room = static_cast<size_t>(kTextBytes - 1 - textUsed);   // keeps the NUL inside text
+    if (len > room) len = room;
+    values[argCount++].textOffset = textUsed;
+    if (len > 0) std::memcpy(text + textUsed, s, len);
+    text[textUsed + len] = '\0';
+    textUsed = static_cast<uint8_t>(textUsed + len + 1);
+}
+
+// ============================================================================
+// LogRing
+// ============================================================================
+
+LogRing& LogRing::instance() {
+    static LogRing sInstance;
+    return sInstance;
+}
+
+LogRing::LogRing()
+    : mCells(new Cell[kCapacity]),
+      mEpoch(std::chrono::steady_clock::now()) {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+int64_t LogRing::nowNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - mEpoch).count();
+}
+
+void LogRing::push(const LogRecord& rec) {
+    size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;) {
+        cell = &mCells[pos & kMask];
+        const size_t seq = cell->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            mDropped.fetch_add(1, std::memory_order_relaxed);   // ring full
+            return;
+        } else {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->record = rec;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+}
+
+size_t LogRing::drain(const std::function<void(const LogMessage&)>& sink, size_t maxMessages) {
+    size_t count = 0;
+
+    const uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+    if (dropped != mDroppedReported) {
+        LogMessage m{Severity::Warning, nowNs(),
+                     "- WARNING: log ring full, " + std::to_string(dropped - mDroppedReported) + " messages dropped"};
+        mDroppedReported = dropped;
+        sink(m);
+    }
+
+    while (count < maxMessages) {
+        Cell& cell = mCells[mDequeuePos & kMask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (seq != mDequeuePos + 1) break;   // empty
+
+        LogMessage m{cell.record.site->severity, cell.record.timestampNs, format(cell.record)};
+        cell.sequence.store(mDequeuePos + kCapacity, std::memory_order_release);
+        ++mDequeuePos;
+        ++count;
+        sink(m);
+    }
+    return count;
+}
+
+std::string LogRing::format(const LogRecord& rec) {
+    // printf-style formatting with argument types taken from the record, so
+    // length modifiers in the format string (%lu, %zu, %lld ...) are normalized.
+    std::string out;
+    const char* f = rec.site ? rec.site->format : "";
+    int arg = 0;
+    char spec[32];
+    char buf[128];
+
+    while (*f) {
+        if (*f != '%') { out += *f++; continue; }
+        if (f[1] == '%') { out += '%'; f += 2; continue; }
+
+        // Copy flags/width/precision, skip length modifiers
+        size_t n = 0;
+        spec[n++] = *f++;
+        while (*f && std::strchr("-+ #0123456789.*", *f) && n < sizeof(spec) - 4) spec[n++] = *f++;
+        while (*f && std::strchr("hlLzjt", *f)) ++f;
+        const char conv = *f ? *f++ : 's';
+
+        if (arg >= rec.argCount) { out += "<?>"; continue; }
+        const LogRecord::ArgType type = rec.types[arg];
+        const LogRecord::Value& v = rec.values[arg++];
+
+        if (conv == 's' || type == LogRecord::Text) {
+            if (type == LogRecord::Text) {
+                spec[n++] = 's'; spec[n] = '\0';
+                std::snprintf(buf, sizeof(buf), spec, rec.text + v.textOffset);
+            } else if (type == LogRecord::Double) {
+                std::snprintf(buf, sizeof(buf), "%g", v.d);
+            } else {
+                std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v.i));
+            }
+        } else if (std::strchr("feEgGaA", conv)) {
+            spec[n++] = conv; spec[n] = '\0';
+            const double d = (type == LogRecord::Double) ? v.d
+                           : (type == LogRecord::Int) ? static_cast<double>(v.i) : static_cast<double>(v.u);
+            std::snprintf(buf, sizeof(buf), spec, d);
+        } else {
+            spec[n++] = 'l'; spec[n++] = 'l'; spec[n++] = conv; spec[n] = '\0';
+            if (type == LogRecord::Double) {
+                std::snprintf(buf, sizeof(buf), spec, static_cast<long long>(v.d));
+            } else if (conv == 'd' || conv == 'i') {
+                std::snprintf(buf, sizeof(buf), spec, static_cast<long long>(v.i));
+            } else {
+                std::snprintf(buf, sizeof(buf), spec, static_cast<unsigned long long>(v.u));
+            }
+        }
+        out += buf;
+    }
+
+    if (rec.suppressedBefore > 0) {
+        out += " (+" + std::to_string(rec.suppressedBefore) + " similar suppressed)";
+    }
+    return out;
+}
+
+} // namespace logging
+} // namespace marc
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace marc {
+namespace logging {
+
+enum class Severity : uint8_t {
+    Debug = 0,
+    Info,
+    Warning,
+    Error
+};
+
+const char* severityName(Severity s);
+
+// ============================================================================
+// LogSite - Static per-call-site descriptor (created by MARC_LOG)
+// ============================================================================
+/**
+ * @brief One instance per MARC_LOG statement. Holds the format string and the
+ * per-site rate limit state, so suppression costs one atomic compare.
+ */
+struct LogSite {
+    Severity severity;
+    const char* format;                       // printf-style, string literal
+    int64_t minIntervalNs;                    // 0 = no rate limit
+    std::atomic<int64_t> lastEmitNs{INT64_MIN / 2};
+    std::atomic<uint32_t> suppressed{0};
+
+    LogSite(Severity sev, const char* fmt, int rateLimitMs)
+        : severity(sev), format(fmt),
+          minIntervalNs(static_cast<int64_t>(rateLimitMs) * 1000000) {}
+};
+
+// ============================================================================
+// LogRecord - Binary payload: site pointer + raw arguments, no formatting
+// ============================================================================
+struct LogRecord {
+    static constexpr int kMaxArgs = 8;
+    static constexpr int kTextBytes = 96;     // storage for copied string arguments
+
+    enum ArgType : uint8_t { Int, UInt, Double, Text };
+
+    const LogSite* site = nullptr;
+    int64_t timestampNs = 0;
+    uint32_t suppressedBefore = 0;            // messages dropped by the rate limit since last emit
+    uint8_t argCount = 0;
+    uint8_t textUsed = 0;
+    ArgType types[kMaxArgs] = {};
+    union Value { int64_t i; uint64_t u; double d; uint8_t textOffset; } values[kMaxArgs] = {};
+    char text[kTextBytes] = {};
+
+    void add(int64_t v)  { if (argCount < kMaxArgs) { types[argCount] = Int;    values[argCount++].i = v; } }
+    void add(uint64_t v) { if (argCount < kMaxArgs) { types[argCount] = UInt;   values[argCount++].u = v; } }
+    void add(double v)   { if (argCount < kMaxArgs) { types[argCount] = Double; values[argCount++].d = v; } }
+    void addText(const char* s, size_t len);
+};
+
+struct LogMessage {
+    Severity severity;
+    int64_t timestampNs;
+    std::string text;
+};
+
+// ============================================================================
+// LogRing - Process-wide lock-free MPSC log channel
+// ============================================================================
+/**
+ * @brief Hot-path logging without allocation, locks or Qt events.
+ *
+ * DESIGN:
+ * - Producers (any thread) copy the site pointer and raw arguments into a slot
+ *   of a bounded MPSC ring (per-slot sequence numbers, one CAS per message).
+ * - Formatting happens only in drain(), on the consumer side (GUI timer,
+ *   console loop), where the cost does not slow the scanner thread.
+ * - Each LogSite carries its own rate limit; suppressed messages are counted
+ *   and reported with the next message that gets through.
+ * - When the ring is full the message is dropped and counted; producers
+ *   never block.
+ *
+ * USAGE:
+ *   MARC_LOG_INFO(50, "Applied buildStyle %u (power=%.1fW)", id, power);
+ *   // consumer side, e.g. every 100 ms:
+ *   LogRing::instance().drain([](const LogMessage& m) { ... }, 2000);
+ */
+class LogRing {
+public:
+    static LogRing& instance();
+
+    void setMinSeverity(Severity s) { mMinSeverity.store(static_cast<uint8_t>(s), std::memory_order_relaxed); }
+    Severity minSeverity() const { return static_cast<Severity>(mMinSeverity.load(std::memory_order_relaxed)); }
+
+    template <typename... Args>
+    void log(LogSite& site, const Args&... args) {
+        if (static_cast<uint8_t>(site.severity) < mMinSeverity.load(std::memory_order_relaxed)) return;
+
+        const int64_t now = nowNs();
+        uint32_t suppressedBefore = 0;
+        if (site.minIntervalNs > 0) {
+            int64_t last = site.lastEmitNs.load(std::memory_order_relaxed);
+            if (now - last < site.minIntervalNs ||
+                !site.lastEmitNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+                site.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            suppressedBefore = site.suppressed.exchange(0, std::memory_order_relaxed);
+        }
+
+        LogRecord rec;
+        rec.site = &site;
+        rec.timestampNs = now;
+        rec.suppressedBefore = suppressedBefore;
+        (pack(rec, args), ...);
+        push(rec);
+    }
+
+    // Format and hand out up to maxMessages queued messages (single consumer)
+    size_t drain(const std::function<void(const LogMessage&)>& sink, size_t maxMessages = SIZE_MAX);
+
+    uint64_t droppedMessages() const { return mDropped.load(std::memory_order_relaxed); }
+    int64_t nowNs() const;
+
+    static std::string format(const LogRecord& rec);
+
+private:
+    LogRing();
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    void push(const LogRecord& rec);
+
+    // Argument packing (integers widened, strings copied)
+    template <typename T>
+    static void pack(LogRecord& rec, const T& v) {
+        if constexpr (std::is_enum_v<T>) {
+            rec.add(static_cast<int64_t>(v));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            rec.add(static_cast<double>(v));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            rec.add(static_cast<int64_t>(v));
+        } else if constexpr (std::is_integral_v<T>) {
+            rec.add(static_cast<uint64_t>(v));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            rec.addText(v.data(), v.size());
+        } else {
+            const char* s = v;
+            rec.addText(s, s ? std::strlen(s) : 0);
+        }
+    }
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    static constexpr size_t kCapacity = 1u << 13;  // 8192 messages
+    static constexpr size_t kMask = kCapacity - 1;
+
+    std::unique_ptr<Cell[]> mCells;
+    alignas(64) std::atomic<size_t> mEnqueuePos{0};
+    alignas(64) size_t mDequeuePos{0};             // consumer only
+    std::atomic<uint64_t> mDropped{0};
+    uint64_t mDroppedReported{0};                  // consumer only
+    std::atomic<uint8_t> mMinSeverity{static_cast<uint8_t>(Severity::Info)};
+    const std::chrono::steady_clock::time_point mEpoch;
+};
+
+} // namespace logging
+} // namespace marc
+
+// Log through the lock-free ring. rateLimitMs = minimum spacing of messages from this site.
+#define MARC_LOG(severity, rateLimitMs, fmt, ...)                                          \
+    do {                                                                                   \
+        static ::marc::logging::LogSite marcLogSite_{severity, fmt, rateLimitMs};          \
+        ::marc::logging::LogRing::instance().log(marcLogSite_, ##__VA_ARGS__);             \
+    } while (0)
+
+#define MARC_LOG_DEBUG(rateLimitMs, fmt, ...) MARC_LOG(::marc::logging::Severity::Debug, rateLimitMs, fmt, ##__VA_ARGS__)
+#define MARC_LOG_INFO(rateLimitMs, fmt, ...)  MARC_LOG(::marc::logging::Severity::Info, rateLimitMs, fmt, ##__VA_ARGS__)
+#define MARC_LOG_WARN(rateLimitMs, fmt, ...)  MARC_LOG(::marc::logging::Severity::Warning, rateLimitMs, fmt, ##__VA_ARGS__)
+#define MARC_LOG_ERROR(rateLimitMs, fmt, ...) MARC_LOG(::marc::logging::Severity::Error, rateLimitMs, fmt, ##__VA_ARGS__)
@@ -0,0 +1,267 @@
+#include "metrics.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace marc {
+namespace metrics {
+
+namespace {
+
+int highestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+void appendValue(std::string& out, double v) {
+    char buf[64];
+    if (std::isnan(v)) std::snprintf(buf, sizeof(buf), "NaN");
+    else std::snprintf(buf, sizeof(buf), "%.17g", v);
+    out += buf;
+}
+
+void appendHeader(std::string& out, const std::string& name, const std::string& help, const char* type) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+} // namespace
+
+// ============================================================================
+// Histogram
+// ============================================================================
+
+size_t Histogram::bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) return static_cast<size_t>(value);
+    const int shift = highestBit(value) - kSubBucketBits;
+    return (static_cast<size_t>(shift) + 1) * kSubBuckets +
+           static_cast<size_t>((value >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) return index;
+    const int shift = static_cast<int>(index / kSubBuckets) - 1;
+    const uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    mBuckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+    mSum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t cur = mMax.load(std::memory_order_relaxed);
+    while (value > cur && !mMax.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {}
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot s;
+    s.buckets.resize(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        s.buckets[i] = mBuckets[i].load(std::memory_order_relaxed);
+        s.count += s.buckets[i];     // consistent with the buckets even while recording
+    }
+    s.sum = mSum.load(std::memory_order_relaxed);
+    s.max = mMax.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Histogram::reset() {
+    for (auto& b : mBuckets) b.store(0, std::memory_order_relaxed);
+    mCount.store(0, std::memory_order_relaxed);
+    mSum.store(0, std::memory_order_relaxed);
+    mMax.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::Snapshot::percentile(double q) const {
+    if (count == 0) return 0;
+    q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+    uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            const uint64_t upper = bucketUpperBound(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+Registry& Registry::instance() {
+    static Registry sInstance;
+    return sInstance;
+}
+
+Registry::~Registry() {
+    stopExporter();
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto& e = mCounters[name];
+    if (!e.metric) { e.help = help; e.metric = std::make_unique<Counter>(); }
+    return *e.metric;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto& e = mGauges[name];
+    if (!e.metric) { e.help = help; e.metric = std::make_unique<Gauge>(); }
+    return *e.metric;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto& e = mHistograms[name];
+    if (!e.metric) { e.help = help; e.metric = std::make_unique<Histogram>(); }
+    return *e.metric;
+}
+
+const Counter* Registry::findCounter(const std::string& name) const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto it = mCounters.find(name);
+    return it == mCounters.end() ? nullptr : it->second.metric.get();
+}
+
+const Gauge* Registry::findGauge(const std::string& name) const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto it = mGauges.find(name);
+    return it == mGauges.end() ? nullptr : it->second.metric.get();
+}
+
+const Histogram* Registry::findHistogram(const std::string& name) const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    auto it = mHistograms.find(name);
+    return it == mHistograms.end() ? nullptr : it->second.metric.get();
+}
+
+std::string Registry::renderText() const {
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    std::string out;
+    out.reserve(4096);
+    std::lock_guard<std::mutex> lk(mMutex);
+
+    for (const auto& [name, e] : mCounters) {
+        appendHeader(out, name, e.help, "counter");
+        out += name + " " + std::to_string(e.metric->value()) + "\n";
+    }
+
+    for (const auto& [name, e] : mGauges) {
+        appendHeader(out, name, e.help, "gauge");
+        out += name + " ";
+        appendValue(out, e.metric->value());
+        out += "\n";
+    }
+
+    for (const auto& [name, e] : mHistograms) {
+        const Histogram::Snapshot s = e.metric->snapshot();
+        appendHeader(out, name, e.help, "summary");
+        for (double q : kQuantiles) {
+            char label[48];
+            std::snprintf(label, sizeof(label), "{quantile=\"%g\"} ", q);
+            out += name + label + std::to_string(s.percentile(q)) + "\n";
+        }
+        out += name + "_sum " + std::to_string(s.sum) + "\n";
+        out += name + "_count " + std::to_string(s.count) + "\n";
+        appendHeader(out, name + "_max", "Largest value recorded in " + name, "gauge");
+        out += name + "_max " + std::to_string(s.max) + "\n";
+    }
+    return out;
+}
+
+bool Registry::writeTextFile(const std::filesystem::path& file) const {
+    const std::string text = renderText();
+
+    std::filesystem::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, file, ec);
+    return !ec;
+}
+
+void Registry::startExporter(const std::filesystem::path& file, std::chrono::milliseconds period) {
+    stopExporter();
+
+    std::error_code ec;
+    if (file.has_parent_path()) std::filesystem::create_directories(file.parent_path(), ec);
+
+    {
+        std::lock_guard<std::mutex> lk(mExporterMutex);
+        mExporterStop = false;
+    }
+    mExporter = std::thread(&Registry::exporterThreadFunc, this, file, period);
+}
+
+void Registry::stopExporter() {
+    {
+        std::lock_guard<std::mutex> lk(mExporterMutex);
+        mExporterStop = true;
+    }
+    mExporterCv.notify_all();
+    if (mExporter.joinable()) mExporter.join();
+}
+
+void Registry::exporterThreadFunc(std::filesystem::path file, std::chrono::milliseconds period) {
+    std::unique_lock<std::mutex> lk(mExporterMutex);
+    while (!mExporterStop) {
+        lk.unlock();
+        writeTextFile(file);
+        lk.lock();
+        mExporterCv.wait_for(lk, period, [this] { return mExporterStop; });
+    }
+    lk.unlock();
+    writeTextFile(file);     // final values on shutdown
+}
+
+// ============================================================================
+// Pipeline metrics
+// ============================================================================
+
+PipelineMetrics& pipeline() {
+    static PipelineMetrics sMetrics = [] {
+        Registry& r = Registry::instance();
+        return PipelineMetrics{
+            r.gauge("marc_queue_depth", "Layers waiting between producer and consumer"),
+            r.gauge("marc_queue_bytes", "Command block bytes waiting between producer and consumer"),
+            r.counter("marc_layers_produced_total", "Layers read, converted and enqueued"),
+            r.counter("marc_layers_executed_total", "Layers executed on the scanner"),
+            r.counter("marc_commands_executed_total", "Jump/mark commands loaded into RTC lists"),
+            r.gauge("marc_commands_per_second", "Commands per second of the last layer (list load + execution)"),
+            r.gauge("marc_list_fill_ratio", "Fill level of the last executed RTC list (commands / list memory)"),
+            r.histogram("marc_plc_wait_us", "Layer preparation wait: writeLayerParameters to layer prepared"),
+            r.histogram("marc_list_exec_us", "RTC list execution time: executeList to completion"),
+            r.histogram("marc_opc_read_us", "OPC UA read round trip"),
+            r.histogram("marc_opc_write_us", "OPC UA write round trip"),
+        };
+    }();
+    return sMetrics;
+}
+
+} // namespace metrics
+} // namespace marc
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace marc {
+namespace metrics {
+
+// ============================================================================
+// Counter - Monotonic event count
+// ============================================================================
+class Counter {
+public:
+    void inc(uint64_t n = 1) { mValue.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return mValue.load(std::memory_order_relaxed); }
+    void reset() { mValue.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> mValue{0};
+};
+
+// ============================================================================
+// Gauge - Last value / running level (queue depth, bytes in flight, ...)
+// ============================================================================
+class Gauge {
+public:
+    void set(double v) { mValue.store(v, std::memory_order_relaxed); }
+    void add(double delta) {
+        double cur = mValue.load(std::memory_order_relaxed);
+        while (!mValue.compare_exchange_weak(cur, cur + delta, std::memory_order_relaxed)) {}
+    }
+    double value() const { return mValue.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> mValue{0.0};
+};
+
+// ============================================================================
+// Histogram - HDR-style log-linear latency histogram
+// ============================================================================
+/**
+ * @brief Lock-free latency distribution with bounded relative error.
+ *
+ * Values (microseconds by convention, metric names end in "_us") fall into
+ * 16 linear sub-buckets per power of two, so any recorded value is reported
+ * within ~6% of its true value from 1 us up to the full uint64_t range.
+ * record() is three relaxed atomic adds and one CAS-max; no allocation.
+ */
+class Histogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::vector<uint64_t> buckets;
+
+        // Upper bound of the bucket holding quantile q (0..1), clamped to max
+        uint64_t percentile(double q) const;
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+    };
+
+    void record(uint64_t value);
+    void recordDuration(std::chrono::steady_clock::duration d) {
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        record(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+
+    Snapshot snapshot() const;
+    void reset();
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> mBuckets{};
+    std::atomic<uint64_t> mCount{0};
+    std::atomic<uint64_t> mSum{0};
+    std::atomic<uint64_t> mMax{0};
+};
+
+// Records the lifetime of the scope into a histogram (microseconds)
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& h) : mHistogram(h), mBegin(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { mHistogram.recordDuration(std::chrono::steady_clock::now() - mBegin); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& mHistogram;
+    std::chrono::steady_clock::time_point mBegin;
+};
+
+// ============================================================================
+// Registry - Process-wide named metrics + text exposition
+// ============================================================================
+/**
+ * @brief Owns every metric by name; references returned by counter()/gauge()/
+ * histogram() stay valid for the life of the process.
+ *
+ * DESIGN:
+ * - Registration takes a mutex (do it once, e.g. into a static reference);
+ *   updates never touch the registry.
+ * - renderText() produces the Prometheus text exposition format: counters and
+ *   gauges as-is, histograms as summaries (p50/p90/p99/p999 + _sum/_count)
+ *   plus a <name>_max gauge.
+ * - The exporter thread rewrites a file with renderText() every period
+ *   (write to .tmp, then rename), so readers never see a partial file.
+ *   Compatible with node_exporter's textfile collector.
+ *
+ * USAGE:
+ *   static auto& depth = Registry::instance().gauge("marc_queue_depth", "Layers queued");
+ *   depth.set(queue.size());
+ *   Registry::instance().startExporter("metrics.prom", std::chrono::seconds(1));
+ */
+class Registry {
+public:
+    static Registry& instance();
+
+    Counter& counter(const std::string& name, const std::string& help);
+    Gauge& gauge(const std::string& name, const std::string& help);
+    Histogram& histogram(const std::string& name, const std::string& help);
+
+    // Runtime lookup (nullptr if not registered)
+    const Counter* findCounter(const std::string& name) const;
+    const Gauge* findGauge(const std::string& name) const;
+    const Histogram* findHistogram(const std::string& name) const;
+
+    std::string renderText() const;
+    bool writeTextFile(const std::filesystem::path& file) const;
+
+    // Periodic exposition file (restarts if already running)
+    void startExporter(const std::filesystem::path& file,
+                       std::chrono::milliseconds period = std::chrono::milliseconds(1000));
+    void stopExporter();
+
+private:
+    Registry() = default;
+    ~Registry();
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    void exporterThreadFunc(std::filesystem::path file, std::chrono::milliseconds period);
+
+    template <typename T>
+    struct Entry {
+        std::string help;
+        std::unique_ptr<T> metric;
+    };
+
+    mutable std::mutex mMutex;                       // guards the maps (registration / render)
+    std::map<std::string, Entry<Counter>> mCounters;
+    std::map<std::string, Entry<Gauge>> mGauges;
+    std::map<std::string, Entry<Histogram>> mHistograms;
+
+    std::thread mExporter;
+    std::mutex mExporterMutex;
+    std::condition_variable mExporterCv;
+    bool mExporterStop{false};
+};
+
+// ============================================================================
+// Pipeline metrics (registered on first use)
+// ============================================================================
+struct PipelineMetrics {
+    Gauge& queueDepth;          // layers waiting between producer and consumer
+    Gauge& bytesQueued;         // command block bytes waiting in the queue
+    Counter& layersProduced;
+    Counter& layersExecuted;
+    Counter& commandsExecuted;
+    Gauge& commandsPerSecond;   // last layer: commands / (list load + execution time)
+    Gauge& listFill;            // last executed list: commands / list memory (0..1)
+    Histogram& plcWaitUs;       // writeLayerParameters -> layer prepared
+    Histogram& listExecUs;      // executeList -> list completion, per list
+    Histogram& opcReadUs;       // single OPC UA read round trip
+    Histogram& opcWriteUs;      // single OPC UA write round trip
+};
+
+PipelineMetrics& pipeline();
+
+} // namespace metrics
+} // namespace marc
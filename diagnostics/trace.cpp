@@ -0,0 +1,270 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace marc {
+namespace trace {
+
+// ============================================================================
+// Per-thread ring (single producer: owning thread, single consumer: flusher)
+// ============================================================================
+
+struct Tracer::ThreadRing {
+    static constexpr size_t kCapacity = 1u << 14;   // 16k events per thread
+    static constexpr size_t kMask = kCapacity - 1;
+
+    Event events[kCapacity];
+    std::atomic<size_t> head{0};     // next write (owner thread)
+    std::atomic<size_t> tail{0};     // next read (flusher)
+    std::atomic<bool> retired{false};
+
+    uint32_t tid = 0;
+    std::mutex nameMutex;
+    std::string name;
+    bool nameWritten = false;
+};
+
+namespace {
+// Marks the ring retired when its thread exits; the flusher frees it once drained
+struct RingHandle {
+    std::shared_ptr<Tracer::ThreadRing> ring;
+    ~RingHandle() {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+thread_local RingHandle tRingHandle;
+// Kept apart from the ring, so naming a thread costs no ring while tracing is off
+thread_local std::string tThreadName;
+
+void appendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if (static_cast<unsigned char>(c) < 0x20) { out += ' '; }
+        else { out += c; }
+    }
+    out += '"';
+}
+} // namespace
+
+// ============================================================================
+// Tracer
+// ============================================================================
+
+Tracer& Tracer::instance() {
+    static Tracer sInstance;
+    return sInstance;
+}
+
+Tracer::Tracer() : mEpoch(std::chrono::steady_clock::now()) {}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+int64_t Tracer::nowNs() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - mEpoch).count();
+}
+
+std::filesystem::path Tracer::outputFile() const {
+    return mPath;
+}
+
+Tracer::ThreadRing& Tracer::localRing() {
+    if (!tRingHandle.ring) {
+        auto ring = std::make_shared<ThreadRing>();
+        ring->tid = mNextTid.fetch_add(1, std::memory_order_relaxed);
+        ring->name = tThreadName;
+        std::lock_guard<std::mutex> lk(mRingsMutex);
+        mRings.push_back(ring);
+        tRingHandle.ring = std::move(ring);
+    }
+    return *tRingHandle.ring;
+}
+
+void Tracer::releaseRetiredRings() {
+    std::lock_guard<std::mutex> lk(mRingsMutex);
+    mRings.erase(std::remove_if(mRings.begin(), mRings.end(),
+                                [](const std::shared_ptr<ThreadRing>& ring) {
+                                    return ring->retired.load(std::memory_order_acquire);
+                                }),
+                 mRings.end());
+}
+
+void Tracer::record(const Event& e) {
+    // Rings exist only for threads that record while tracing is on
+    if (!isEnabled()) return;
+    ThreadRing& ring = localRing();
+    const size_t head = ring.head.load(std::memory_order_relaxed);
+    const size_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= ThreadRing::kCapacity) {
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head & ThreadRing::kMask] = e;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    tThreadName = name;
+    if (!tRingHandle.ring) return;      // the ring takes the name when it is created
+    ThreadRing& ring = *tRingHandle.ring;
+    std::lock_guard<std::mutex> lk(ring.nameMutex);
+    ring.name = name;
+    ring.nameWritten = false;
+}
+
+bool Tracer::start(const std::filesystem::path& outputFile) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lk(mFileMutex);
+        std::error_code ec;
+        if (outputFile.has_parent_path()) {
+            std::filesystem::create_directories(outputFile.parent_path(), ec);
+        }
+        mOut.open(outputFile, std::ios::out | std::ios::trunc);
+        if (!mOut.is_open()) return false;
+        mPath = outputFile;
+        mFirstEvent = true;
+        mOut << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    }
+
+    // Rings of threads that exited while tracing was off have nothing to write
+    releaseRetiredRings();
+
+    // Discard anything recorded while tracing was off and re-announce thread names
+    {
+        std::lock_guard<std::mutex> lk(mRingsMutex);
+        for (auto& ring : mRings) {
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+            std::lock_guard<std::mutex> nameLk(ring->nameMutex);
+            ring->nameWritten = false;
+        }
+    }
+
+    mDropped = 0;
+    {
+        std::lock_guard<std::mutex> lk(mFlushMutex);
+        mFlusherStop = false;
+    }
+    mEnabled.store(true, std::memory_order_release);
+    mFlusher = std::thread(&Tracer::flusherThreadFunc, this);
+    return true;
+}
+
+void Tracer::stop() {
+    if (!mFlusher.joinable()) return;
+
+    mEnabled.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lk(mFlushMutex);
+        mFlusherStop = true;
+    }
+    mFlushCv.notify_one();
+    mFlusher.join();
+
+    drainAll();
+
+    {
+        std::lock_guard<std::mutex> lk(mFileMutex);
+        if (mOut.is_open()) {
+            mOut << "\n]}\n";
+            mOut.close();
+        }
+    }
+    releaseRetiredRings();
+}
+
+void Tracer::flusherThreadFunc() {
+    std::unique_lock<std::mutex> lk(mFlushMutex);
+    while (!mFlusherStop) {
+        mFlushCv.wait_for(lk, std::chrono::milliseconds(50), [this] { return mFlusherStop; });
+        lk.unlock();
+        drainAll();
+        lk.lock();
+    }
+}
+
+void Tracer::drainAll() {
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard<std::mutex> lk(mRingsMutex);
+        rings = mRings;
+    }
+
+    std::unique_lock<std::mutex> fileLk(mFileMutex);
+    if (!mOut.is_open()) {
+        fileLk.unlock();
+        releaseRetiredRings();
+        return;
+    }
+
+    for (auto& ring : rings) {
+        const bool retired = ring->retired.load(std::memory_order_acquire);
+        writeThreadName(*ring);
+
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            writeEvent(*ring, ring->events[tail & ThreadRing::kMask]);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        if (retired) {
+            std::lock_guard<std::mutex> lk(mRingsMutex);
+            for (auto it = mRings.begin(); it != mRings.end(); ++it) {
+                if (*it == ring) { mRings.erase(it); break; }
+            }
+        }
+    }
+    mOut.flush();
+}
+
+void Tracer::writeThreadName(const ThreadRing& constRing) {
+    auto& ring = const_cast<ThreadRing&>(constRing);
+    std::lock_guard<std::mutex> lk(ring.nameMutex);
+    if (ring.nameWritten || ring.name.empty()) return;
+
+    mLine.clear();
+    if (!mFirstEvent) mLine += ",\n";
+    mFirstEvent = false;
+    mLine += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+    mLine += std::to_string(ring.tid);
+    mLine += ",\"args\":{\"name\":";
+    appendJsonString(mLine, ring.name);
+    mLine += "}}";
+    mOut << mLine;
+    ring.nameWritten = true;
+}
+
+void Tracer::writeEvent(const ThreadRing& ring, const Event& e) {
+    char buf[160];
+    mLine.clear();
+    if (!mFirstEvent) mLine += ",\n";
+    mFirstEvent = false;
+
+    mLine += "{\"name\":";
+    appendJsonString(mLine, e.name ? e.name : "?");
+    mLine += ",\"cat\":";
+    appendJsonString(mLine, e.category ? e.category : "");
+
+    // Chrome trace timestamps are microseconds (fractional allowed)
+    if (e.phase == 'X') {
+        std::snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                      e.tsNs / 1000.0, e.durNs / 1000.0, ring.tid);
+    } else if (e.phase == 'C') {
+        std::snprintf(buf, sizeof(buf), ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%lld}}",
+                      e.tsNs / 1000.0, ring.tid, static_cast<long long>(e.value));
+    } else {
+        std::snprintf(buf, sizeof(buf), ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                      e.tsNs / 1000.0, ring.tid);
+    }
+    mLine += buf;
+    mOut << mLine;
+}
+
+} // namespace trace
+} // namespace marc
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace marc {
+namespace trace {
+
+// ============================================================================
+// Trace Event
+// ============================================================================
+/**
+ * @brief One trace record. name/category must be string literals (never copied).
+ *
+ * Spans are stored as Chrome "complete" events (ph = 'X'): a single record per
+ * span written when the scope closes, so a dropped record never leaves an
+ * unmatched begin/end pair behind.
+ */
+struct Event {
+    const char* name = nullptr;
+    const char* category = nullptr;
+    int64_t tsNs = 0;       // begin timestamp (ns since tracer epoch)
+    int64_t durNs = 0;      // span duration ('X' only)
+    int64_t value = 0;      // counter value ('C' only)
+    char phase = 'X';       // 'X' span, 'C' counter, 'i' instant
+};
+
+// ============================================================================
+// Tracer - Process-wide Chrome trace-event recorder
+// ============================================================================
+/**
+ * @brief Low-overhead tracing for all pipeline threads.
+ *
+ * DESIGN:
+ * - Each thread records into its own fixed-size single-producer ring
+ *   (created on its first event while tracing is on, no locks on the record
+ *   path). setThreadName() only stores the name until then, so threads that
+ *   never trace cost no ring; rings of exited threads are freed by the
+ *   flusher, or by start()/stop() when tracing is off.
+ * - A background flusher drains all rings every few milliseconds and streams
+ *   JSON to disk, so memory stays bounded for builds of any length.
+ * - When a ring is full the event is dropped and counted; recording never blocks.
+ * - When tracing is stopped, record() is a single relaxed atomic load.
+ *
+ * OUTPUT: Chrome trace-event JSON ("traceEvents" array), loadable in
+ * https://ui.perfetto.dev or chrome://tracing.
+ *
+ * USAGE:
+ *   marc::trace::Tracer::instance().start("Reports/trace.json");
+ *   marc::trace::setThreadName("Producer");
+ *   { MARC_TRACE_SCOPE("marc", "readLayer"); ... }
+ *   MARC_TRACE_COUNTER("queue", "depth", queue.size());
+ *   marc::trace::Tracer::instance().stop();
+ */
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // Open output file and start the flusher (restarts if already running)
+    bool start(const std::filesystem::path& outputFile);
+
+    // Drain remaining events, close the JSON document
+    void stop();
+
+    bool isEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+    int64_t nowNs() const;
+
+    // Record into the calling thread's ring
+    void record(const Event& e);
+    void setThreadName(const std::string& name);
+
+    uint64_t droppedEvents() const { return mDropped.load(std::memory_order_relaxed); }
+    std::filesystem::path outputFile() const;
+
+    struct ThreadRing;
+
+private:
+    Tracer();
+    ~Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    ThreadRing& localRing();
+    void releaseRetiredRings();                       // drop rings of exited threads (unwritten events too)
+    void flusherThreadFunc();
+    void drainAll();
+    void writeEvent(const ThreadRing& ring, const Event& e);
+    void writeThreadName(const ThreadRing& ring);
+
+    std::atomic<bool> mEnabled{false};
+    std::atomic<uint64_t> mDropped{0};
+    const std::chrono::steady_clock::time_point mEpoch;
+
+    mutable std::mutex mRingsMutex;                   // guards mRings (registration only)
+    std::vector<std::shared_ptr<ThreadRing>> mRings;
+    std::atomic<uint32_t> mNextTid{1};
+
+    std::mutex mFileMutex;                            // guards file + first-event flag
+    std::ofstream mOut;
+    std::filesystem::path mPath;
+    bool mFirstEvent{true};
+    std::string mLine;                                // reusable formatting buffer
+
+    std::thread mFlusher;
+    std::mutex mFlushMutex;
+    std::condition_variable mFlushCv;
+    bool mFlusherStop{false};
+};
+
+// Name the calling thread in the trace (e.g. "Producer", "Consumer", "OPC Worker", "GUI")
+inline void setThreadName(const std::string& name) { Tracer::instance().setThreadName(name); }
+
+// ============================================================================
+// Scope - RAII span
+// ============================================================================
+class Scope {
+public:
+    Scope(const char* category, const char* name)
+        : mCategory(category), mName(name),
+          mBeginNs(Tracer::instance().isEnabled() ? Tracer::instance().nowNs() : -1) {}
+
+    ~Scope() {
+        if (mBeginNs < 0) return;
+        Tracer& t = Tracer::instance();
+        if (!t.isEnabled()) return;
+        Event e;
+        e.name = mName;
+        e.category = mCategory;
+        e.tsNs = mBeginNs;
+        e.durNs = t.nowNs() - mBeginNs;
+        e.phase = 'X';
+        t.record(e);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* mCategory;
+    const char* mName;
+    int64_t mBeginNs;
+};
+
+inline void counter(const char* category, const char* name, int64_t value) {
+    Tracer& t = Tracer::instance();
+    if (!t.isEnabled()) return;
+    Event e;
+    e.name = name;
+    e.category = category;
+    e.tsNs = t.nowNs();
+    e.value = value;
+    e.phase = 'C';
+    t.record(e);
+}
+
+inline void instant(const char* category, const char* name) {
+    Tracer& t = Tracer::instance();
+    if (!t.isEnabled()) return;
+    Event e;
+    e.name = name;
+    e.category = category;
+    e.tsNs = t.nowNs();
+    e.phase = 'i';
+    t.record(e);
+}
+
+} // namespace trace
+} // namespace marc
+
+#define MARC_TRACE_CONCAT_INNER(a, b) a##b
+#define MARC_TRACE_CONCAT(a, b) MARC_TRACE_CONCAT_INNER(a, b)
+
+// Span covering the rest of the enclosing block
+#define MARC_TRACE_SCOPE(category, name) \
+    ::marc::trace::Scope MARC_TRACE_CONCAT(marcTraceScope_, __LINE__)(category, name)
+#define MARC_TRACE_COUNTER(category, name, value) \
+    ::marc::trace::counter(category, name, static_cast<int64_t>(value))
+#define MARC_TRACE_INSTANT(category, name) \
+    ::marc::trace::instant(category, name)
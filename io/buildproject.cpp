@@ -0,0 +1,45 @@
+#include "buildproject.h"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace marc {
+
+namespace {
+
+std::filesystem::path resolve(const std::filesystem::path& root, const std::string& file) {
+    if (file.empty()) return {};
+    const std::filesystem::path p = std::filesystem::u8path(file);
+    return (p.is_absolute() ? p : root / p).lexically_normal();
+}
+
+} // namespace
+
+bool BuildProject::load(const std::filesystem::path& buildFile, BuildProject& out, std::string* error) {
+    std::ifstream in(buildFile);
+    if (!in) {
+        if (error) *error = "Cannot open project file: " + buildFile.string();
+        return false;
+    }
+    const nlohmann::json doc = nlohmann::json::parse(in, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object()) {
+        if (error) *error = "Invalid .build file JSON: " + buildFile.string();
+        return false;
+    }
+
+    // Same layout ProjectManager writes: { "project": { "name" }, "files": { "marcFile", "jsonFile" } }
+    const std::filesystem::path root = std::filesystem::absolute(buildFile).parent_path();
+    const nlohmann::json project = doc.value("project", nlohmann::json::object());
+    const nlohmann::json files = doc.value("files", nlohmann::json::object());
+
+    out = BuildProject{};
+    out.buildFile = buildFile;
+    out.name = project.is_object() ? project.value("name", std::string()) : std::string();
+    if (files.is_object()) {
+        out.marcPath = resolve(root, files.value("marcFile", std::string()));
+        out.jsonPath = resolve(root, files.value("jsonFile", std::string()));
+    }
+    return true;
+}
+
+} // namespace marc
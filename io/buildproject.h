@@ -0,0 +1,33 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace marc {
+
+// ============================================================================
+// BuildProject - Qt-free reader of a .build project file
+// ============================================================================
+/**
+ * @brief The parts of a .build project a build needs: its name and the MARC
+ * and JSON files, resolved against the folder of the .build file.
+ *
+ * The GUI keeps using ProjectManager (which also writes projects); this is
+ * for tools without Qt widgets, such as the marc_build command line runner.
+ *
+ * USAGE:
+ *   BuildProject project;
+ *   std::string error;
+ *   if (!BuildProject::load("Femure_Build/Femure_Build.build", project, &error)) ...
+ *   run(project.marcPath, project.jsonPath);
+ */
+struct BuildProject {
+    std::string name;
+    std::filesystem::path buildFile;
+    std::filesystem::path marcPath;     // absolute, empty when no MARC is attached
+    std::filesystem::path jsonPath;     // absolute, empty when no JSON is attached
+
+    static bool load(const std::filesystem::path& buildFile, BuildProject& out, std::string* error = nullptr);
+};
+
+} // namespace marc
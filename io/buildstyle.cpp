@@ -1,4 +1,5 @@
 #include "buildstyle.h"
+#include <algorithm>
 #include <sstream>
 #include <fstream>
 #include <stdexcept>
@@ -112,6 +113,9 @@ bool BuildStyleLibrary::parseJsonArray(const std::string& jsonContent) {
             if (styleObj.contains("layerThickness")) {
                 style.layerThickness = styleObj["layerThickness"].get<double>();
             }
+            if (styleObj.contains("beamCompensation")) {
+                style.beamCompensation = styleObj["beamCompensation"].get<double>();
+            }
             if (styleObj.contains("pointDistance")) {
                 style.pointDistance = styleObj["pointDistance"].get<double>();
             }
@@ -176,6 +180,25 @@ const BuildStyle* BuildStyleLibrary::getStyleById(uint32_t buildStyleId) const {
     return nullptr;
 }
 
+bool BuildStyleLibrary::hasBeamCompensation() const {
+    for (const auto& pair : mStyles) {
+        if (pair.second.beamCompensation != 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<uint32_t> BuildStyleLibrary::styleIds() const {
+    std::vector<uint32_t> ids;
+    ids.reserve(mStyles.size());
+    for (const auto& pair : mStyles) {
+        ids.push_back(pair.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
 std::string BuildStyleLibrary::debugString() const {
     std::ostringstream ss;
     ss << "BuildStyleLibrary{count=" << mStyles.size() << ", styles=[";
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace marc {
 
@@ -36,11 +37,12 @@ struct BuildStyle {
     // Geometry parameters
     double hatchSpacing = 0.1;             // Hatch line spacing (mm)
     double layerThickness = 0.03;          // Layer thickness (mm)
+    double beamCompensation = 0.0;         // Contour offset toward the material (mm), 0 = off
 
     // Point sequence parameters
     double pointDistance = 0.05;           // Distance between point exposures (mm)
-    uint32_t pointDelay = 1;               // Delay before point (ms)
-    uint32_t pointExposureTime = 100;      // Point dwell time (ms)
+    uint32_t pointDelay = 1;               // Settling delay before each point exposure (us)
+    uint32_t pointExposureTime = 100;      // Laser-on dwell per point exposure (us)
 
     // Timing
     double jumpDelay = 1.0;                // Delay after jump before mark (ms)
@@ -84,6 +86,8 @@ public:
     // Utility
     size_t count() const { return mStyles.size(); }
     bool isEmpty() const { return mStyles.empty(); }
+    bool hasBeamCompensation() const;      // any style with beamCompensation != 0
+    std::vector<uint32_t> styleIds() const; // geometry types with a style, ascending
 
     // Debug
     std::string debugString() const;
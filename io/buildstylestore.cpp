@@ -0,0 +1,117 @@
+#include "buildstylestore.h"
+
+#include <system_error>
+
+namespace marc {
+
+BuildStyleStore::BuildStyleStore() {
+    publishLocked(std::make_shared<const BuildStyleLibrary>());
+}
+
+std::string BuildStyleStore::path() const {
+    std::lock_guard<std::mutex> lk(mWriteMutex);
+    return mPath;
+}
+
+std::shared_ptr<const BuildStyleLibrary> BuildStyleStore::snapshot() const {
+    std::lock_guard<std::mutex> lk(mWriteMutex);
+    return mSnapshots.back();
+}
+
+BuildStyleStore::FileStamp BuildStyleStore::stampOf(const std::string& path) {
+    FileStamp stamp;
+    std::error_code ec;
+    stamp.time = std::filesystem::last_write_time(path, ec);
+    if (ec) return stamp;
+    stamp.size = std::filesystem::file_size(path, ec);
+    stamp.valid = !ec;
+    return stamp;
+}
+
+// ============================================================================
+// Publishing
+// ============================================================================
+
+void BuildStyleStore::publishLocked(std::shared_ptr<const BuildStyleLibrary> next) {
+    // Retained (not released) until reset(): a reader may still use the old pointer
+    const BuildStyleLibrary* raw = next.get();
+    mSnapshots.push_back(std::move(next));
+    mCurrent.store(raw, std::memory_order_release);
+    mRevision.fetch_add(1, std::memory_order_acq_rel);
+}
+
+bool BuildStyleStore::reset(const std::string& jsonPath, std::string* error) {
+    std::lock_guard<std::mutex> lk(mWriteMutex);
+    const FileStamp stamp = stampOf(jsonPath);
+
+    auto next = std::make_shared<BuildStyleLibrary>();
+    try {
+        next->loadFromJson(jsonPath);
+    } catch (const std::exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+
+    mPath = jsonPath;
+    mSeen = stamp;
+    publishLocked(std::move(next));
+    mSnapshots.erase(mSnapshots.begin(), mSnapshots.end() - 1);
+    return true;
+}
+
+// ============================================================================
+// Reload
+// ============================================================================
+
+bool BuildStyleStore::validate(const BuildStyleLibrary& next, const BuildStyleLibrary& active, std::string* error) {
+    if (next.isEmpty()) {
+        if (error) *error = "no buildStyles defined";
+        return false;
+    }
+    for (uint32_t id : active.styleIds()) {
+        if (!next.getStyle(id)) {
+            if (error) *error = "buildStyle " + std::to_string(id) + " is in use and was removed";
+            return false;
+        }
+    }
+    return true;
+}
+
+BuildStyleStore::Reload BuildStyleStore::reload(std::string* error) {
+    std::lock_guard<std::mutex> lk(mWriteMutex);
+    return reloadLocked(stampOf(mPath), error);
+}
+
+BuildStyleStore::Reload BuildStyleStore::reloadIfChanged(std::string* error) {
+    std::lock_guard<std::mutex> lk(mWriteMutex);
+    if (mPath.empty()) return Reload::Unchanged;
+    const FileStamp stamp = stampOf(mPath);
+    if (stamp == mSeen) return Reload::Unchanged;
+    return reloadLocked(stamp, error);
+}
+
+BuildStyleStore::Reload BuildStyleStore::reloadLocked(const FileStamp& stamp, std::string* error) {
+    mSeen = stamp;
+    if (mPath.empty()) {
+        if (error) *error = "no configuration file loaded";
+        return Reload::Rejected;
+    }
+
+    auto next = std::make_shared<BuildStyleLibrary>();
+    std::string reason;
+    try {
+        next->loadFromJson(mPath);
+    } catch (const std::exception& e) {
+        reason = e.what();
+    }
+    if (reason.empty()) validate(*next, *mSnapshots.back(), &reason);
+    if (!reason.empty()) {
+        if (error) *error = reason;
+        return Reload::Rejected;
+    }
+
+    publishLocked(std::move(next));
+    return Reload::Reloaded;
+}
+
+} // namespace marc
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "buildstyle.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// BuildStyleStore - Hot-reloadable BuildStyleLibrary (read-copy-update)
+// ============================================================================
+/**
+ * @brief Holds the style library of a running build as immutable snapshots
+ * that are replaced as a whole, so laser parameters can change mid-build.
+ *
+ * DESIGN:
+ * - Readers (producer thread) call current(): one atomic pointer load, no
+ *   lock, no reference count. The pointer stays valid for the whole build.
+ * - Writers (reload from the GUI / API thread, or the owner's periodic file
+ *   check) parse the JSON into a new library, validate it, then publish it
+ *   with one atomic store. A rejected file never replaces the active snapshot.
+ * - Reclamation: replaced snapshots are retained until reset(), which the
+ *   manager calls when a build starts and no reader is running. Reloads are
+ *   rare and a library is a few kB, so the grace period is simply the build.
+ * - Validation beyond BuildStyleLibrary::loadFromJson (which already checks
+ *   every style): the file must define at least one style, and every style id
+ *   of the active snapshot must still exist, so no geometry type silently
+ *   falls back to another style halfway through a part.
+ * - reloadIfChanged() compares the file's modification time and size with
+ *   the last version seen (loaded or rejected), so a bad file is reported once
+ *   and retried only after it is saved again.
+ *
+ * USAGE:
+ *   BuildStyleStore store;
+ *   store.reset(configPath, &err);                 // build start, before the threads read
+ *   const BuildStyleLibrary* styles = store.current();   // producer, per layer
+ *   store.reload(&err);                             // API request, any thread
+ *   store.reloadIfChanged(&err);                    // timer: config.json saved?
+ */
+class BuildStyleStore {
+public:
+    enum class Reload { Unchanged, Reloaded, Rejected };
+
+    BuildStyleStore();
+    ~BuildStyleStore() = default;
+
+    BuildStyleStore(const BuildStyleStore&) = delete;
+    BuildStyleStore& operator=(const BuildStyleStore&) = delete;
+
+    // Load the file as the only snapshot, releasing all earlier ones.
+    // Only while no reader holds a pointer from current().
+    bool reset(const std::string& jsonPath, std::string* error = nullptr);
+
+    // Active library, never nullptr (empty before the first load). Lock-free.
+    const BuildStyleLibrary* current() const { return mCurrent.load(std::memory_order_acquire); }
+
+    // Increments with every published snapshot. Lock-free.
+    uint64_t revision() const { return mRevision.load(std::memory_order_acquire); }
+
+    // Shared reference to the active library for callers outside the pipeline
+    std::shared_ptr<const BuildStyleLibrary> snapshot() const;
+
+    // Re-read the file set by reset(); validated before it is published
+    Reload reload(std::string* error = nullptr);
+
+    // reload() when the file changed since the last version seen
+    Reload reloadIfChanged(std::string* error = nullptr);
+
+    // Rules a new library must satisfy to replace the active one
+    static bool validate(const BuildStyleLibrary& next, const BuildStyleLibrary& active, std::string* error);
+
+    std::string path() const;
+
+private:
+    struct FileStamp {
+        std::filesystem::file_time_type time{};
+        uintmax_t size = 0;
+        bool valid = false;
+
+        bool operator==(const FileStamp& o) const { return valid == o.valid && time == o.time && size == o.size; }
+    };
+
+    static FileStamp stampOf(const std::string& path);
+    Reload reloadLocked(const FileStamp& stamp, std::string* error);
+    void publishLocked(std::shared_ptr<const BuildStyleLibrary> next);
+
+    mutable std::mutex mWriteMutex;     // writers only; readers never take it
+    std::string mPath;
+    FileStamp mSeen;                    // last version loaded or rejected
+    std::vector<std::shared_ptr<const BuildStyleLibrary>> mSnapshots;   // active = back()
+
+    std::atomic<const BuildStyleLibrary*> mCurrent{nullptr};
+    std::atomic<uint64_t> mRevision{0};
+};
+
+} // namespace marc
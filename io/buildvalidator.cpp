@@ -0,0 +1,280 @@
+#include "buildvalidator.h"
+#include "streamingmarcreader.h"
+#include "diagnostics/trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace marc {
+
+namespace {
+
+constexpr uint32_t kUnreadLayer = std::numeric_limits<uint32_t>::max();
+
+BuildIssue makeIssue(BuildIssue::Severity severity, BuildIssue::Kind kind, const Layer& layer, uint32_t layerIndex,
+                     BuildIssue::Geometry geometry, int32_t geometryIndex, uint32_t count, std::string message) {
+    BuildIssue issue;
+    issue.severity = severity;
+    issue.kind = kind;
+    issue.layerIndex = layerIndex;
+    issue.layerNumber = layer.layerNumber;
+    issue.geometry = geometry;
+    issue.geometryIndex = geometryIndex;
+    issue.count = count;
+    issue.message = std::move(message);
+    return issue;
+}
+
+// Non-finite and out-of-field vertices of one geometry -> at most one issue each
+template <typename Visit>
+void checkVertices(const Layer& layer, uint32_t layerIndex, BuildIssue::Geometry geometry, int32_t index,
+                   double fieldLimitMM, Visit&& forEachPoint, std::vector<BuildIssue>& out) {
+    uint32_t nonFinite = 0;
+    uint32_t outside = 0;
+    double worst = 0.0;
+    forEachPoint([&](const Point& p) {
+        const double x = p.x, y = p.y;
+        if (!std::isfinite(x) || !std::isfinite(y)) { ++nonFinite; return; }
+        const double m = std::max(std::fabs(x), std::fabs(y));
+        if (m > fieldLimitMM) { ++outside; worst = std::max(worst, m); }
+    });
+    if (nonFinite > 0) {
+        out.push_back(makeIssue(BuildIssue::Severity::Error, BuildIssue::Kind::NonFiniteCoordinate, layer, layerIndex,
+                                geometry, index, nonFinite,
+                                std::to_string(nonFinite) + " vertices with NaN/Inf coordinates"));
+    }
+    if (outside > 0) {
+        std::ostringstream msg;
+        msg << outside << " vertices outside the scan field (|coord| up to " << worst << " mm, limit "
+            << fieldLimitMM << " mm)";
+        out.push_back(makeIssue(BuildIssue::Severity::Error, BuildIssue::Kind::OutsideField, layer, layerIndex,
+                                geometry, index, outside, msg.str()));
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// BuildIssue
+// ============================================================================
+
+const char* BuildIssue::kindName(Kind kind) {
+    switch (kind) {
+        case Kind::UnreadableLayer:     return "unreadable_layer";
+        case Kind::NonFiniteCoordinate: return "non_finite_coordinate";
+        case Kind::OutsideField:        return "outside_field";
+        case Kind::NoBuildStyle:        return "no_build_style";
+        case Kind::FallbackBuildStyle:  return "fallback_build_style";
+        case Kind::OddHatchPoints:      return "odd_hatch_points";
+        case Kind::DegenerateGeometry:  return "degenerate_geometry";
+        case Kind::LayerOrder:          return "layer_order";
+    }
+    return "unknown";
+}
+
+const char* BuildIssue::geometryName(Geometry geometry) {
+    switch (geometry) {
+        case Geometry::Layer:    return "layer";
+        case Geometry::Hatch:    return "hatch";
+        case Geometry::Polyline: return "polyline";
+        case Geometry::Polygon:  return "polygon";
+        case Geometry::Circle:   return "circle";
+    }
+    return "unknown";
+}
+
+std::string BuildIssue::toString() const {
+    std::ostringstream s;
+    s << (severity == Severity::Error ? "Error" : "Warning") << ": layer " << layerNumber
+      << " (index " << layerIndex << ")";
+    if (geometryIndex >= 0) s << " " << geometryName(geometry) << " #" << geometryIndex;
+    s << ": " << message;
+    return s.str();
+}
+
+// ============================================================================
+// Per-layer checks
+// ============================================================================
+
+void BuildValidator::checkLayer(const Layer& layer, uint32_t layerIndex, const BuildStyleLibrary& styles,
+                                const CoordinateCalibration& calib, std::vector<BuildIssue>& out) {
+    // mmToBits clamps at +/- maxBits
+    const double fieldLimitMM = static_cast<double>(calib.maxBits) / calib.bitsPerMM();
+
+    // Style resolution, once per geometry type: (first geometry, kind, count)
+    struct StyleUse { BuildIssue::Geometry geometry; int32_t first; uint32_t count; };
+    std::map<uint32_t, StyleUse> missingStyles;
+    auto noteStyle = [&](uint32_t type, BuildIssue::Geometry geometry, int32_t index) {
+        if (styles.getStyle(type)) return;
+        auto it = missingStyles.find(type);
+        if (it == missingStyles.end()) missingStyles.emplace(type, StyleUse{ geometry, index, 1 });
+        else ++it->second.count;
+    };
+
+    for (size_t i = 0; i < layer.hatches.size(); ++i) {
+        const Hatch& h = layer.hatches[i];
+        const auto index = static_cast<int32_t>(i);
+        noteStyle(h.tag.type, BuildIssue::Geometry::Hatch, index);
+        if (h.tag.pointCount % 2 == 1) {
+            out.push_back(makeIssue(BuildIssue::Severity::Warning, BuildIssue::Kind::OddHatchPoints, layer, layerIndex,
+                                    BuildIssue::Geometry::Hatch, index, 1,
+                                    std::to_string(h.tag.pointCount) + " vertices, last vertex has no partner and is dropped"));
+        }
+        checkVertices(layer, layerIndex, BuildIssue::Geometry::Hatch, index, fieldLimitMM, [&](auto&& visit) {
+            for (const Line& ln : h.lines) { visit(ln.a); visit(ln.b); }
+        }, out);
+    }
+    for (size_t i = 0; i < layer.polylines.size(); ++i) {
+        const Polyline& p = layer.polylines[i];
+        const auto index = static_cast<int32_t>(i);
+        noteStyle(p.tag.type, BuildIssue::Geometry::Polyline, index);
+        if (p.points.size() < 2) {
+            out.push_back(makeIssue(BuildIssue::Severity::Warning, BuildIssue::Kind::DegenerateGeometry, layer, layerIndex,
+                                    BuildIssue::Geometry::Polyline, index, static_cast<uint32_t>(p.points.size()),
+                                    std::to_string(p.points.size()) + " vertices, nothing is marked"));
+        }
+        checkVertices(layer, layerIndex, BuildIssue::Geometry::Polyline, index, fieldLimitMM, [&](auto&& visit) {
+            for (const Point& pt : p.points) visit(pt);
+        }, out);
+    }
+    for (size_t i = 0; i < layer.polygons.size(); ++i) {
+        const Polygon& p = layer.polygons[i];
+        const auto index = static_cast<int32_t>(i);
+        noteStyle(p.tag.type, BuildIssue::Geometry::Polygon, index);
+        if (p.points.size() < 3) {
+            out.push_back(makeIssue(BuildIssue::Severity::Warning, BuildIssue::Kind::DegenerateGeometry, layer, layerIndex,
+                                    BuildIssue::Geometry::Polygon, index, static_cast<uint32_t>(p.points.size()),
+                                    std::to_string(p.points.size()) + " vertices, not a closed contour"));
+        }
+        checkVertices(layer, layerIndex, BuildIssue::Geometry::Polygon, index, fieldLimitMM, [&](auto&& visit) {
+            for (const Point& pt : p.points) visit(pt);
+        }, out);
+    }
+
+    for (size_t i = 0; i < layer.support_circles.size(); ++i) {
+        const Circle& c = layer.support_circles[i];
+        const auto index = static_cast<int32_t>(i);
+        noteStyle(c.tag.type, BuildIssue::Geometry::Circle, index);
+        // Extreme points of the circumference (the centre alone for point exposures)
+        checkVertices(layer, layerIndex, BuildIssue::Geometry::Circle, index, fieldLimitMM, [&](auto&& visit) {
+            const float r = c.radius;
+            visit(Point{ c.center.x - r, c.center.y - r });
+            visit(Point{ c.center.x + r, c.center.y + r });
+        }, out);
+    }
+
+    const bool haveFallback = styles.getStyle(8) != nullptr;
+    for (const auto& [type, use] : missingStyles) {
+        const std::string what = "geometry type " + std::to_string(type) + " (" + std::to_string(use.count) +
+                                 " geometries) has no BuildStyle";
+        if (haveFallback) {
+            out.push_back(makeIssue(BuildIssue::Severity::Warning, BuildIssue::Kind::FallbackBuildStyle, layer,
+                                    layerIndex, use.geometry, use.first, use.count, what + ", style 8 is used"));
+        } else {
+            out.push_back(makeIssue(BuildIssue::Severity::Error, BuildIssue::Kind::NoBuildStyle, layer,
+                                    layerIndex, use.geometry, use.first, use.count, what + " and no fallback style 8"));
+        }
+    }
+}
+
+// ============================================================================
+// Construction / Start / Wait
+// ============================================================================
+
+BuildValidator::BuildValidator(const std::wstring& marcPath, const std::string& stylesJsonPath)
+    : BuildValidator(marcPath, stylesJsonPath, Settings()) {}
+
+BuildValidator::BuildValidator(const std::wstring& marcPath, const std::string& stylesJsonPath,
+                               const Settings& settings)
+    : mMarcPath(marcPath), mStylesPath(stylesJsonPath), mSettings(settings),
+      mPipeline("Preflight", LayerPipeline::Settings{ settings.workers, settings.maxInFlight }) {}
+
+BuildValidator::~BuildValidator() {
+    cancel();
+    wait();
+}
+
+bool BuildValidator::start() {
+    if (mPipeline.isStarted()) return false;   // already started
+
+    try {
+        mStyles.loadFromJson(mStylesPath);
+    } catch (const std::exception& e) {
+        mPipeline.abort("Cannot load build styles from " + mStylesPath + ": " + e.what());
+        return false;
+    }
+    if (!mPipeline.open(mMarcPath)) return false;
+    mLayerNumbers.assign(mPipeline.totalLayers(), kUnreadLayer);
+
+    mPipeline.run([this] { return makeWorker(); }, [this] { finish(); });
+    return true;
+}
+
+bool BuildValidator::wait() {
+    return mPipeline.wait();
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+
+LayerPipeline::Worker BuildValidator::makeWorker() {
+    return [this, found = std::vector<BuildIssue>()](LayerPipeline::RawLayer& raw) mutable {
+        MARC_TRACE_SCOPE("preflight", "BuildValidator::checkLayer");
+        found.clear();
+        uint32_t layerNumber = kUnreadLayer;
+        try {
+            const Layer layer = StreamingMarcReader::decodeLayer(raw.bytes.data(), raw.bytes.size(), mPipeline.fileVersion());
+            layerNumber = layer.layerNumber;
+            checkLayer(layer, raw.index, mStyles, mSettings.calibration, found);
+        } catch (const std::exception& e) {
+            BuildIssue issue;
+            issue.kind = BuildIssue::Kind::UnreadableLayer;
+            issue.layerIndex = raw.index;
+            issue.message = std::string("cannot decode layer: ") + e.what();
+            found.push_back(std::move(issue));
+        }
+
+        std::lock_guard<std::mutex> lk(mIssueMutex);
+        mLayerNumbers[raw.index] = layerNumber;
+        for (auto& issue : found) {
+            (issue.severity == BuildIssue::Severity::Error ? mErrorCount : mWarningCount)++;
+            if (mIssues.size() < mSettings.maxIssues) mIssues.push_back(std::move(issue));
+        }
+        return true;
+    };
+}
+
+// Last worker out: cross-layer checks and ordering of the report
+void BuildValidator::finish() {
+    std::lock_guard<std::mutex> lk(mIssueMutex);
+    uint32_t previous = kUnreadLayer;
+    for (uint32_t i = 0; i < mLayerNumbers.size(); ++i) {
+        const uint32_t n = mLayerNumbers[i];
+        if (n == kUnreadLayer) continue;
+        if (previous != kUnreadLayer && n <= previous) {
+            ++mWarningCount;
+            if (mIssues.size() < mSettings.maxIssues) {
+                BuildIssue issue;
+                issue.severity = BuildIssue::Severity::Warning;
+                issue.kind = BuildIssue::Kind::LayerOrder;
+                issue.layerIndex = i;
+                issue.layerNumber = n;
+                issue.message = "layer number " + std::to_string(n) + " follows " + std::to_string(previous);
+                mIssues.push_back(std::move(issue));
+            }
+        }
+        previous = n;
+    }
+
+    std::stable_sort(mIssues.begin(), mIssues.end(), [](const BuildIssue& a, const BuildIssue& b) {
+        if (a.layerIndex != b.layerIndex) return a.layerIndex < b.layerIndex;
+        if (a.geometry != b.geometry) return a.geometry < b.geometry;
+        return a.geometryIndex < b.geometryIndex;
+    });
+}
+
+} // namespace marc
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "buildstyle.h"
+#include "layerconverter.h"
+#include "layerpipeline.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// BuildIssue - One problem found by the pre-flight check
+// ============================================================================
+struct BuildIssue {
+    enum class Severity { Warning, Error };
+    enum class Kind {
+        UnreadableLayer,        // layer bytes could not be decoded
+        NonFiniteCoordinate,    // NaN / Inf in a vertex
+        OutsideField,           // vertex beyond the scan field (mmToBits would clamp it)
+        NoBuildStyle,           // geometry type has no style and no fallback style 8
+        FallbackBuildStyle,     // geometry type has no style, style 8 is used instead
+        OddHatchPoints,         // hatch with an odd vertex count (last vertex is dropped)
+        DegenerateGeometry,     // polyline < 2 or polygon < 3 vertices
+        LayerOrder              // layer number not increasing
+    };
+    enum class Geometry { Layer, Hatch, Polyline, Polygon, Circle };
+
+    Severity severity = Severity::Error;
+    Kind kind = Kind::UnreadableLayer;
+    uint32_t layerIndex = 0;        // position in the file
+    uint32_t layerNumber = 0;       // as stored in the layer
+    Geometry geometry = Geometry::Layer;
+    int32_t geometryIndex = -1;     // index within its collection, -1 = whole layer
+    uint32_t count = 0;             // offending vertices in the geometry (0 = n/a)
+    std::string message;
+
+    static const char* kindName(Kind kind);
+    static const char* geometryName(Geometry geometry);
+    std::string toString() const;   // "Layer 12 hatch #3: ..."
+};
+
+// ============================================================================
+// BuildValidator - Parallel pre-flight check of a whole build
+// ============================================================================
+/**
+ * @brief Decodes every layer of a .marc file once and reports everything that
+ * would otherwise go wrong silently (or only surface) during the build.
+ *
+ * DESIGN:
+ * - Runs on a LayerPipeline: one reader thread streams raw layer bytes,
+ *   N workers decode and check them, bounded queue between them.
+ * - Checks mirror LayerConverter: style resolution by GeometryTag::type with
+ *   fallback 8, field limit from CoordinateCalibration. A layer that fails to
+ *   decode is reported and skipped; only an unreadable file aborts the run.
+ * - One issue per geometry and kind (with the number of offending vertices),
+ *   so a corrupt hatch yields one entry, not thousands; style issues once per
+ *   layer and geometry type (first geometry, count = geometries). Issues are
+ *   sorted by layer / geometry once the run completes.
+ * - Errors block a build; warnings are informational.
+ *
+ * USAGE:
+ *   BuildValidator check(marcPath, stylesJsonPath);
+ *   check.start();
+ *   // poll check.isFinished() / check.layersChecked()
+ *   check.wait();
+ *   if (check.errorCount() > 0) { ... check.issues() ... }
+ */
+class BuildValidator {
+public:
+    struct Settings {
+        CoordinateCalibration calibration;
+        unsigned workers = 0;          // 0 = hardware concurrency
+        size_t maxInFlight = 0;        // queued raw layers, 0 = 2 x workers
+        size_t maxIssues = 10000;      // stored issues (all are counted)
+    };
+
+    BuildValidator(const std::wstring& marcPath, const std::string& stylesJsonPath);
+    BuildValidator(const std::wstring& marcPath, const std::string& stylesJsonPath, const Settings& settings);
+    ~BuildValidator();
+
+    BuildValidator(const BuildValidator&) = delete;
+    BuildValidator& operator=(const BuildValidator&) = delete;
+
+    // Open the files and spawn the threads (false if either cannot be opened)
+    bool start();
+
+    void cancel() { mPipeline.cancel(); }
+
+    // Join all threads; true when every layer was checked (issues or not)
+    bool wait();
+
+    bool isFinished() const { return mPipeline.isFinished(); }
+    bool isCancelled() const { return mPipeline.isCancelled(); }
+    uint32_t totalLayers() const { return mPipeline.totalLayers(); }
+    uint32_t layersChecked() const { return mPipeline.layersDone(); }
+    std::string errorMessage() const { return mPipeline.errorMessage(); }
+
+    // Results (valid once isFinished())
+    const std::vector<BuildIssue>& issues() const { return mIssues; }
+    size_t errorCount() const { return mErrorCount; }
+    size_t warningCount() const { return mWarningCount; }
+    bool passed() const { return mErrorCount == 0 && errorMessage().empty() && !isCancelled(); }
+
+    const std::wstring& marcPath() const { return mMarcPath; }
+    const std::string& stylesJsonPath() const { return mStylesPath; }
+
+    // Checks of one decoded layer (used by the workers; pure)
+    static void checkLayer(const Layer& layer, uint32_t layerIndex, const BuildStyleLibrary& styles,
+                           const CoordinateCalibration& calib, std::vector<BuildIssue>& out);
+
+private:
+    LayerPipeline::Worker makeWorker();
+    void finish();
+
+    const std::wstring mMarcPath;
+    const std::string mStylesPath;
+    Settings mSettings;
+    BuildStyleLibrary mStyles;
+
+    // Collected by the workers, merged in finish()
+    std::mutex mIssueMutex;
+    std::vector<BuildIssue> mIssues;
+    std::vector<uint32_t> mLayerNumbers;   // by layer index, for the order check
+    size_t mErrorCount = 0;
+    size_t mWarningCount = 0;
+
+    LayerPipeline mPipeline;                // last: its threads use the members above
+};
+
+} // namespace marc
@@ -0,0 +1,308 @@
+#include "contouroffsetter.h"
+#include "workerpool.h"
+#include "diagnostics/trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace marc {
+
+namespace {
+
+// Below this many contour vertices a layer is offset on the calling thread
+constexpr size_t kParallelMinVertices = 4096;
+
+// Crossings this close to an edge end are treated as touching, not crossing
+constexpr double kEdgeEps = 1e-9;
+
+// Jitter (mm) applied to the raw offset ring. Rectilinear parts produce
+// collinear and vertex-on-edge contacts that a crossing test cannot classify;
+// a tiny deterministic jitter turns them into proper crossings or gaps.
+// Far below float resolution of the output coordinates.
+constexpr double kJitter = 1e-7;
+
+double jitter(size_t i, uint32_t salt) {
+    uint32_t h = static_cast<uint32_t>(i) * 2654435761u ^ salt;
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    return kJitter * (static_cast<double>(h & 0xffffu) / 32767.5 - 1.0);
+}
+
+struct Crossing {
+    double t;       // position along the edge
+    size_t id;      // intersection index
+    double x, y;
+};
+
+double signedArea(const std::vector<double>& x, const std::vector<double>& y, size_t n) {
+    double a = 0.0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) a += x[j] * y[i] - x[i] * y[j];
+    return 0.5 * a;
+}
+
+// Split a closed ring at its self-intersections into simple loops and keep
+// the ones oriented like the source ring
+void uncross(const std::vector<double>& qx, const std::vector<double>& qy, double sourceArea, double minArea,
+             std::vector<std::vector<Point>>& out) {
+    const size_t m = qx.size();
+
+    // Sweep over edge x-extents for crossing pairs
+    std::vector<size_t> byMinX(m);
+    for (size_t i = 0; i < m; ++i) byMinX[i] = i;
+    auto x0 = [&](size_t e) { return std::min(qx[e], qx[(e + 1) % m]); };
+    auto x1 = [&](size_t e) { return std::max(qx[e], qx[(e + 1) % m]); };
+    std::sort(byMinX.begin(), byMinX.end(), [&](size_t a, size_t b) { return x0(a) < x0(b); });
+
+    std::vector<std::vector<Crossing>> onEdge(m);
+    size_t crossings = 0;
+    std::vector<size_t> active;
+    for (size_t e : byMinX) {
+        active.erase(std::remove_if(active.begin(), active.end(), [&](size_t a) { return x1(a) < x0(e); }),
+                     active.end());
+        const size_t en = (e + 1) % m;
+        const double ey0 = std::min(qy[e], qy[en]), ey1 = std::max(qy[e], qy[en]);
+        for (size_t a : active) {
+            const size_t an = (a + 1) % m;
+            if (an == e || en == a) continue;                       // neighbours share a vertex
+            if (std::max(qy[a], qy[an]) < ey0 || std::min(qy[a], qy[an]) > ey1) continue;
+            const double rx = qx[an] - qx[a], ry = qy[an] - qy[a];
+            const double sx = qx[en] - qx[e], sy = qy[en] - qy[e];
+            const double denom = rx * sy - ry * sx;
+            if (denom == 0.0) continue;                             // parallel / collinear
+            const double wx = qx[e] - qx[a], wy = qy[e] - qy[a];
+            const double t = (wx * sy - wy * sx) / denom;
+            const double u = (wx * ry - wy * rx) / denom;
+            if (t <= kEdgeEps || t >= 1.0 - kEdgeEps || u <= kEdgeEps || u >= 1.0 - kEdgeEps) continue;
+            const double px = qx[a] + t * rx, py = qy[a] + t * ry;
+            onEdge[a].push_back(Crossing{ t, crossings, px, py });
+            onEdge[e].push_back(Crossing{ u, crossings, px, py });
+            ++crossings;
+        }
+        active.push_back(e);
+    }
+
+    auto keep = [&](const std::vector<double>& lx, const std::vector<double>& ly) {
+        if (lx.size() < 3) return;
+        const double area = signedArea(lx, ly, lx.size());
+        if ((area > 0.0) != (sourceArea > 0.0) || std::abs(area) < minArea) return;
+        std::vector<Point> loop(lx.size());
+        for (size_t i = 0; i < lx.size(); ++i) {
+            loop[i].x = static_cast<float>(lx[i]);
+            loop[i].y = static_cast<float>(ly[i]);
+        }
+        out.push_back(std::move(loop));
+    };
+
+    if (crossings == 0) {
+        keep(qx, qy);
+        return;
+    }
+
+    // Node sequence: ring vertices with the crossings inserted along each edge
+    std::vector<double> nx, ny;
+    std::vector<size_t> nodeOf(2 * crossings, SIZE_MAX);
+    nx.reserve(m + 2 * crossings);
+    ny.reserve(m + 2 * crossings);
+    for (size_t e = 0; e < m; ++e) {
+        nx.push_back(qx[e]);
+        ny.push_back(qy[e]);
+        auto& cs = onEdge[e];
+        std::sort(cs.begin(), cs.end(), [](const Crossing& a, const Crossing& b) { return a.t < b.t; });
+        for (const Crossing& c : cs) {
+            const size_t slot = 2 * c.id + (nodeOf[2 * c.id] == SIZE_MAX ? 0 : 1);
+            nodeOf[slot] = nx.size();
+            nx.push_back(c.x);
+            ny.push_back(c.y);
+        }
+    }
+
+    // Swapping successors at both nodes of a crossing uncrosses the ring there
+    const size_t count = nx.size();
+    std::vector<size_t> next(count);
+    for (size_t k = 0; k < count; ++k) next[k] = (k + 1) % count;
+    for (size_t c = 0; c < crossings; ++c) std::swap(next[nodeOf[2 * c]], next[nodeOf[2 * c + 1]]);
+
+    std::vector<char> visited(count, 0);
+    std::vector<double> lx, ly;
+    for (size_t start = 0; start < count; ++start) {
+        if (visited[start]) continue;
+        lx.clear();
+        ly.clear();
+        for (size_t k = start; !visited[k]; k = next[k]) {
+            visited[k] = 1;
+            lx.push_back(nx[k]);
+            ly.push_back(ny[k]);
+        }
+        keep(lx, ly);
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Ring offset
+// ============================================================================
+
+void ContourOffsetter::offsetRing(const std::vector<Point>& ring, double offset, const Options& opt,
+                                  std::vector<std::vector<Point>>& out) {
+    // Distinct vertices; x / y padded by one so edge i is always (i, i + 1)
+    std::vector<double> x, y;
+    x.reserve(ring.size() + 1);
+    y.reserve(ring.size() + 1);
+    for (const Point& p : ring) {
+        if (!x.empty() && x.back() == p.x && y.back() == p.y) continue;
+        x.push_back(p.x);
+        y.push_back(p.y);
+    }
+    while (x.size() > 1 && x.back() == x.front() && y.back() == y.front()) {
+        x.pop_back();
+        y.pop_back();
+    }
+    const size_t n = x.size();
+    const double area = n >= 3 ? signedArea(x, y, n) : 0.0;
+    if (n < 3 || area == 0.0 || offset == 0.0) {
+        out.emplace_back(ring.begin(), ring.end() - ((ring.size() > 1 && ring.front().x == ring.back().x &&
+                                                      ring.front().y == ring.back().y) ? 1 : 0));
+        return;
+    }
+    x.push_back(x[0]);
+    y.push_back(y[0]);
+
+    // Left unit normal of every edge
+    std::vector<double> ex(n), ey(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double dx = x[i + 1] - x[i];
+        const double dy = y[i + 1] - y[i];
+        const double inv = 1.0 / std::sqrt(dx * dx + dy * dy);
+        ex[i] = -dy * inv;
+        ey[i] = dx * inv;
+    }
+
+    // Miter at vertex i joins edge i - 1 and edge i: offset * (n0 + n1) / (1 + n0.n1).
+    // opens > 0 where the offset edges move apart (gap at the corner to bridge).
+    std::vector<double> mx(n), my(n), cosine(n), opens(n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t p = i ? i - 1 : n - 1;
+        const double c = ex[p] * ex[i] + ey[p] * ey[i];
+        const double k = offset / std::max(1.0 + c, 1e-12);
+        cosine[i] = c;
+        opens[i] = -(ex[p] * ey[i] - ey[p] * ex[i]) * offset;
+        mx[i] = x[i] + (ex[p] + ex[i]) * k;
+        my[i] = y[i] + (ey[p] + ey[i]) * k;
+    }
+
+    // Miter length is offset * sqrt(2 / (1 + cos)). Open corners are bevelled
+    // beyond the limit; closing corners keep the miter (the exact crossing of
+    // the offset edges) unless the edges are nearly antiparallel.
+    const double bevelBelow = 2.0 / (opt.miterLimit * opt.miterLimit) - 1.0;
+    constexpr double kAntiparallel = -1.0 + 1e-6;
+    std::vector<double> qx, qy;
+    qx.reserve(2 * n);
+    qy.reserve(2 * n);
+    for (size_t i = 0; i < n; ++i) {
+        if (cosine[i] >= (opens[i] > 0.0 ? bevelBelow : kAntiparallel)) {
+            qx.push_back(mx[i]);
+            qy.push_back(my[i]);
+            continue;
+        }
+        const size_t p = i ? i - 1 : n - 1;
+        qx.push_back(x[i] + ex[p] * offset);
+        qy.push_back(y[i] + ey[p] * offset);
+        qx.push_back(x[i] + ex[i] * offset);
+        qy.push_back(y[i] + ey[i] * offset);
+    }
+
+    for (size_t i = 0; i < qx.size(); ++i) {
+        qx[i] += jitter(i, 0x9e3779b9u);
+        qy[i] += jitter(i, 0x7f4a7c15u);
+    }
+    uncross(qx, qy, area, opt.minArea, out);
+}
+
+double ContourOffsetter::offsetFor(uint32_t geometryType) const {
+    if (!mStyles) return 0.0;
+    const BuildStyle* style = mStyles->getStyle(geometryType);
+    if (!style) style = mStyles->getStyle(8);
+    return style ? style->beamCompensation : 0.0;
+}
+
+// ============================================================================
+// Layer
+// ============================================================================
+
+ContourOffsetter::Stats ContourOffsetter::apply(Layer& layer) const {
+    MARC_TRACE_SCOPE("contour", "ContourOffsetter::apply");
+    Stats stats;
+
+    // Contours with a non-zero offset
+    struct Job {
+        const std::vector<Point>* ring;
+        double offset;
+        std::vector<std::vector<Point>> loops;
+    };
+    std::vector<Job> jobs;
+    std::vector<size_t> polygonJob(layer.polygons.size(), SIZE_MAX);
+    std::vector<size_t> polylineJob(layer.polylines.size(), SIZE_MAX);
+    size_t vertices = 0;
+    for (size_t i = 0; i < layer.polygons.size(); ++i) {
+        const Polygon& p = layer.polygons[i];
+        const double d = p.points.size() >= 3 ? offsetFor(p.tag.type) : 0.0;
+        if (d == 0.0) continue;
+        polygonJob[i] = jobs.size();
+        jobs.push_back(Job{ &p.points, d, {} });
+        vertices += p.points.size();
+    }
+    for (size_t i = 0; i < layer.polylines.size(); ++i) {
+        const Polyline& p = layer.polylines[i];
+        if (p.points.size() < 4 || p.points.front().x != p.points.back().x ||
+            p.points.front().y != p.points.back().y) {
+            continue;
+        }
+        const double d = offsetFor(p.tag.type);
+        if (d == 0.0) continue;
+        polylineJob[i] = jobs.size();
+        jobs.push_back(Job{ &p.points, d, {} });
+        vertices += p.points.size();
+    }
+    if (jobs.empty()) return stats;
+
+    parallelFor(mPool, jobs.size(), vertices < kParallelMinVertices ? 1u : mOpt.workers, [&](size_t j) {
+        offsetRing(*jobs[j].ring, jobs[j].offset, mOpt, jobs[j].loops);
+    });
+
+    // Replace offset contours in place; closed stays closed, splits keep their tag
+    auto rebuild = [&](auto& geometries, const std::vector<size_t>& jobOf) {
+        using Geometry = typename std::decay_t<decltype(geometries)>::value_type;
+        std::vector<Geometry> result;
+        result.reserve(geometries.size());
+        for (size_t i = 0; i < geometries.size(); ++i) {
+            if (jobOf[i] == SIZE_MAX) {
+                result.push_back(std::move(geometries[i]));
+                continue;
+            }
+            const auto& src = geometries[i].points;
+            const bool closed = src.front().x == src.back().x && src.front().y == src.back().y;
+            auto& loops = jobs[jobOf[i]].loops;
+            ++stats.offset;
+            if (loops.empty()) ++stats.removed;
+            if (loops.size() > 1) stats.split += loops.size() - 1;
+            for (auto& loop : loops) {
+                Geometry g;
+                g.tag = geometries[i].tag;
+                if (closed) loop.push_back(loop.front());
+                g.tag.pointCount = static_cast<uint32_t>(loop.size());
+                g.points = std::move(loop);
+                result.push_back(std::move(g));
+            }
+        }
+        geometries = std::move(result);
+    };
+    rebuild(layer.polygons, polygonJob);
+    rebuild(layer.polylines, polylineJob);
+    return stats;
+}
+
+} // namespace marc
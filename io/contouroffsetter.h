@@ -0,0 +1,86 @@
+#pragma once
+
+#include "readSlices.h"
+#include "buildstyle.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace marc {
+
+class WorkerPool;
+
+// ============================================================================
+// ContourOffsetter - Beam compensation of contours at runtime
+// ============================================================================
+/**
+ * @brief Offsets closed contours toward the material by the beamCompensation
+ * of their BuildStyle, so compensation can change without re-slicing.
+ *
+ * DESIGN:
+ * - Contours are closed Polygons and closed Polylines (first == last); open
+ *   polylines have no material side and are left alone.
+ * - Slicer convention: outer boundaries run counter-clockwise, holes
+ *   clockwise (both sample builds follow it). The material is then always on
+ *   the left of the travel direction, so every ring moves to its left by the
+ *   offset: outer boundaries shrink, holes grow. Negative values move away.
+ * - Raw offset: each edge shifted along its normal, corners joined by miters,
+ *   or bevels beyond miterLimit x offset. Normals and miter factors are
+ *   computed in flat x / y arrays so the loops auto-vectorise.
+ * - Cleanup: self-intersections of the raw ring are found with a sweep over
+ *   the edges' x-extents, the ring is uncrossed at each intersection (swap of
+ *   successors) into simple loops, and loops whose orientation flipped
+ *   (collapsed necks, swallowtails at corners, features thinner than twice
+ *   the offset) or smaller than minArea are dropped. A ring may therefore
+ *   vanish or split into several geometries with the same tag.
+ * - BuildStyle is resolved like LayerConverter (GeometryTag::type, fallback
+ *   style 8). Contours of large layers are distributed over a shared
+ *   WorkerPool (setWorkerPool, the calling thread takes part).
+ *
+ * USAGE:
+ *   ContourOffsetter offsetter(&styles);
+ *   offsetter.apply(layer);    // in the producer, before hatching and conversion
+ *
+ * Config: "beamCompensation" (mm) per entry of the buildStyles array.
+ */
+class ContourOffsetter {
+public:
+    struct Options {
+        double miterLimit = 2.0;    // corners longer than miterLimit x offset are bevelled
+        double minArea = 1e-4;      // mm^2, smaller loops are dropped
+        unsigned workers = 0;       // 0 = every pool thread, 1 = calling thread only
+    };
+
+    // Result of one apply() call
+    struct Stats {
+        size_t offset = 0;          // contours offset
+        size_t removed = 0;         // contours that collapsed completely
+        size_t split = 0;           // additional geometries from contours that split
+    };
+
+    ContourOffsetter() = default;
+    explicit ContourOffsetter(const BuildStyleLibrary* styles) : mStyles(styles) {}
+    ContourOffsetter(const BuildStyleLibrary* styles, const Options& opt) : mStyles(styles), mOpt(opt) {}
+
+    void setBuildStyles(const BuildStyleLibrary* styles) { mStyles = styles; }
+    void setWorkerPool(WorkerPool* pool) { mPool = pool; }   // nullptr = calling thread only
+    const Options& options() const { return mOpt; }
+
+    // Offset for a geometry type (beamCompensation of its style, 0 if none)
+    double offsetFor(uint32_t geometryType) const;
+
+    // Offset the layer's contours in place
+    Stats apply(Layer& layer) const;
+
+    // Offset one closed ring (closing point optional) to its left; appends the
+    // resulting simple loops to out, without closing point
+    static void offsetRing(const std::vector<Point>& ring, double offset, const Options& opt,
+                           std::vector<std::vector<Point>>& out);
+
+private:
+    const BuildStyleLibrary* mStyles = nullptr;
+    Options mOpt;
+    WorkerPool* mPool = nullptr;
+};
+
+} // namespace marc
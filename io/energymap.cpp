@@ -0,0 +1,423 @@
+#include "energymap.h"
+#include "layerpipeline.h"
+#include "streamingmarcreader.h"
+#include "layerraster.h"
+#include "layerconverter.h"
+#include "diagnostics/trace.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace marc {
+
+namespace {
+
+constexpr uint32_t kBinaryVersion = 1;
+constexpr size_t kHeaderBytes = 4 + 4 + 4 + 4 + 8 * 3 + 4;
+
+template <typename T>
+void putPod(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+} // namespace
+
+// ============================================================================
+// EnergyMapper
+// ============================================================================
+
+const BuildStyle* EnergyMapper::resolveStyle(uint32_t geometryType) const {
+    // Same resolution as LayerConverter: by geometry type, falling back to style 8
+    if (!mStyles) return nullptr;
+    const BuildStyle* style = mStyles->getStyle(geometryType);
+    if (!style) style = mStyles->getStyle(8);
+    return style;
+}
+
+void EnergyMapper::addPoint(LayerEnergyMap& map, double x, double y,
+                            double energy, double footprint, double& totalEnergy) const {
+    totalEnergy += energy;
+    const double col = (x - mGrid.minX) / mGrid.cellSize;
+    const double row = (mGrid.minY + mGrid.rows * mGrid.cellSize - y) / mGrid.cellSize;
+    if (col < 0.0 || row < 0.0 || col >= mGrid.cols || row >= mGrid.rows) return;
+    const size_t c = static_cast<size_t>(row) * mGrid.cols + static_cast<size_t>(col);
+    map.energy[c] += static_cast<float>(energy / mGrid.cellArea());
+    map.coverage[c] += static_cast<float>(footprint / mGrid.cellArea());
+}
+
+void EnergyMapper::addSegment(LayerEnergyMap& map, double x0, double y0, double x1, double y1,
+                              double linearEnergy, double spacing, double& totalEnergy) const {
+    const double length = std::hypot(x1 - x0, y1 - y0);
+    if (length <= 0.0) return;
+    totalEnergy += linearEnergy * length;
+
+    // Grid space: columns left to right, rows top (max Y) to bottom
+    const double inv = 1.0 / mGrid.cellSize;
+    const double topY = mGrid.minY + mGrid.rows * mGrid.cellSize;
+    double gx0 = (x0 - mGrid.minX) * inv, gy0 = (topY - y0) * inv;
+    double gx1 = (x1 - mGrid.minX) * inv, gy1 = (topY - y1) * inv;
+
+    // Clip to the grid (Liang-Barsky), keeping the parametric range
+    const double dx = gx1 - gx0, dy = gy1 - gy0;
+    double t0 = 0.0, t1 = 1.0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { gx0, mGrid.cols - gx0, gy0, mGrid.rows - gy0 };
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) { if (q[i] < 0.0) return; continue; }
+        const double r = q[i] / p[i];
+        if (p[i] < 0.0) { if (r > t1) return; t0 = std::max(t0, r); }
+        else            { if (r < t0) return; t1 = std::min(t1, r); }
+    }
+    if (t1 <= t0) return;
+
+    // Amanatides-Woo traversal: exact length of the segment inside each cell
+    const double sx = gx0 + t0 * dx, sy = gy0 + t0 * dy;
+    int ix = std::min(static_cast<int>(sx), static_cast<int>(mGrid.cols) - 1);
+    int iy = std::min(static_cast<int>(sy), static_cast<int>(mGrid.rows) - 1);
+    const int stepX = dx > 0 ? 1 : -1;
+    const int stepY = dy > 0 ? 1 : -1;
+    const double tDeltaX = dx != 0.0 ? std::fabs(1.0 / dx) : INFINITY;
+    const double tDeltaY = dy != 0.0 ? std::fabs(1.0 / dy) : INFINITY;
+    double tMaxX = dx != 0.0 ? ((dx > 0 ? ix + 1 - gx0 : ix - gx0) / dx) : INFINITY;
+    double tMaxY = dy != 0.0 ? ((dy > 0 ? iy + 1 - gy0 : iy - gy0) / dy) : INFINITY;
+
+    const double energyPerT = linearEnergy * length / mGrid.cellArea();
+    const double coveragePerT = spacing * length / mGrid.cellArea();
+    double t = t0;
+    while (t < t1) {
+        const double tNext = std::min({ tMaxX, tMaxY, t1 });
+        if (ix >= 0 && iy >= 0 && ix < static_cast<int>(mGrid.cols) && iy < static_cast<int>(mGrid.rows)) {
+            const size_t c = static_cast<size_t>(iy) * mGrid.cols + static_cast<size_t>(ix);
+            map.energy[c] += static_cast<float>(energyPerT * (tNext - t));
+            map.coverage[c] += static_cast<float>(coveragePerT * (tNext - t));
+        }
+        t = tNext;
+        if (tMaxX < tMaxY) { ix += stepX; tMaxX += tDeltaX; }
+        else               { iy += stepY; tMaxY += tDeltaY; }
+    }
+}
+
+LayerEnergyStats EnergyMapper::accumulate(const Layer& layer, LayerEnergyMap& map, double hotspotJmm2) const {
+    MARC_TRACE_SCOPE("energy", "EnergyMapper::accumulate");
+    map.layerNumber = layer.layerNumber;
+    map.energy.assign(mGrid.cellCount(), 0.0f);
+    map.coverage.assign(mGrid.cellCount(), 0.0f);
+
+    LayerEnergyStats st;
+    st.layerNumber = layer.layerNumber;
+    double totalEnergy = 0.0;
+
+    // Scanned geometry only (hatches, polylines, polygons, point exposures), as converted for the RTC5
+    auto styleFor = [&](const GeometryTag& tag, double& linearEnergy, double& spacing) {
+        const BuildStyle* s = resolveStyle(tag.type);
+        if (!s || s->laserSpeed <= 0.0) { ++st.unstyledGeometries; return false; }
+        linearEnergy = s->laserPower / s->laserSpeed;   // J/mm (W / (mm/s))
+        spacing = s->hatchSpacing;
+        return true;
+    };
+
+    double e = 0.0, h = 0.0;
+    for (const auto& hatch : layer.hatches) {
+        if (!styleFor(hatch.tag, e, h)) continue;
+        for (const auto& ln : hatch.lines) addSegment(map, ln.a.x, ln.a.y, ln.b.x, ln.b.y, e, h, totalEnergy);
+    }
+    for (const auto& pl : layer.polylines) {
+        if (!styleFor(pl.tag, e, h)) continue;
+        for (size_t i = 1; i < pl.points.size(); ++i) {
+            addSegment(map, pl.points[i - 1].x, pl.points[i - 1].y, pl.points[i].x, pl.points[i].y, e, h, totalEnergy);
+        }
+    }
+    for (const auto& pg : layer.polygons) {
+        if (!styleFor(pg.tag, e, h)) continue;
+        const size_t n = pg.points.size();
+        for (size_t i = 1; i <= n && n > 1; ++i) {
+            const Point& a = pg.points[i - 1];
+            const Point& b = pg.points[i % n];
+            addSegment(map, a.x, a.y, b.x, b.y, e, h, totalEnergy);
+        }
+    }
+    // Point exposures: laserPower x pointExposureTime deposited in the cell of each point
+    std::vector<Point> points;
+    for (const auto& c : layer.support_circles) {
+        const BuildStyle* s = resolveStyle(c.tag.type);
+        if (!s) { ++st.unstyledGeometries; continue; }
+        const double pulseEnergy = s->laserPower * s->pointExposureTime * 1e-6;   // J
+        const double footprint = s->pointDistance * s->pointDistance;
+        points.clear();
+        LayerConverter::circlePoints(c, s->pointDistance, points);
+        for (const Point& p : points) addPoint(map, p.x, p.y, pulseEnergy, footprint, totalEnergy);
+    }
+    st.totalEnergyJ = totalEnergy;
+
+    // Statistics over covered cells
+    std::vector<float> covered;
+    covered.reserve(map.energy.size() / 4);
+    size_t hottest = 0;
+    double sum = 0.0;
+    for (size_t c = 0; c < map.energy.size(); ++c) {
+        const float v = map.energy[c];
+        if (v <= 0.0f) continue;
+        covered.push_back(v);
+        sum += v;
+        if (v > map.energy[hottest]) hottest = c;
+        if (hotspotJmm2 > 0.0 && v > hotspotJmm2) ++st.hotspotCells;
+        st.maxCoverage = std::max(st.maxCoverage, static_cast<double>(map.coverage[c]));
+    }
+    st.coveredCells = static_cast<uint32_t>(covered.size());
+    if (!covered.empty()) {
+        st.maxEnergy = map.energy[hottest];
+        st.meanEnergy = sum / covered.size();
+        const size_t k = std::min(covered.size() - 1, static_cast<size_t>(covered.size() * 0.99));
+        std::nth_element(covered.begin(), covered.begin() + static_cast<std::ptrdiff_t>(k), covered.end());
+        st.p99Energy = covered[k];
+        st.hotspotX = mGrid.minX + (hottest % mGrid.cols + 0.5) * mGrid.cellSize;
+        st.hotspotY = mGrid.minY + (mGrid.rows - hottest / mGrid.cols - 0.5) * mGrid.cellSize;
+    }
+    return st;
+}
+
+// ============================================================================
+// EnergyMapEngine
+// ============================================================================
+
+EnergyMapEngine::EnergyMapEngine(const BuildStyleLibrary* styles, const Options& opt)
+    : mStyles(styles), mOpt(opt)
+{
+    if (!(mOpt.cellSize > 0.0)) mOpt.cellSize = 0.5;
+    if (mOpt.workers == 0) mOpt.workers = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool EnergyMapEngine::computeBounds(const std::wstring& marcPath) {
+    MARC_TRACE_SCOPE("energy", "EnergyMapEngine::computeBounds");
+    StreamingMarcReader reader(marcPath);
+    bool any = false;
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    auto include = [&](double x, double y) {
+        if (!any) { minX = maxX = x; minY = maxY = y; any = true; return; }
+        minX = std::min(minX, x); maxX = std::max(maxX, x);
+        minY = std::min(minY, y); maxY = std::max(maxY, y);
+    };
+    while (reader.hasNextLayer() && !mCancel) {
+        const Layer L = reader.readNextLayer();
+        for (const auto& h : L.hatches)
+            for (const auto& ln : h.lines) { include(ln.a.x, ln.a.y); include(ln.b.x, ln.b.y); }
+        for (const auto& p : L.polylines) for (const auto& pt : p.points) include(pt.x, pt.y);
+        for (const auto& p : L.polygons) for (const auto& pt : p.points) include(pt.x, pt.y);
+    }
+    if (!any) return false;
+    mOpt.plateMinX = minX - mOpt.cellSize;
+    mOpt.plateMinY = minY - mOpt.cellSize;
+    mOpt.plateWidth = maxX - minX + 2.0 * mOpt.cellSize;
+    mOpt.plateHeight = maxY - minY + 2.0 * mOpt.cellSize;
+    return true;
+}
+
+bool EnergyMapEngine::run(const std::wstring& marcPath, const std::string& outDir) {
+    MARC_TRACE_SCOPE("energy", "EnergyMapEngine::run");
+    mError.clear();
+    mStats.clear();
+    mDone = 0;
+
+    try {
+        if (!(mOpt.plateWidth > 0.0 && mOpt.plateHeight > 0.0) && !computeBounds(marcPath)) {
+            mError = "Build contains no scan geometry";
+            return false;
+        }
+    } catch (const std::exception& e) {
+        mError = std::string("Cannot read MARC file: ") + e.what();
+        return false;
+    }
+
+    mGrid.minX = mOpt.plateMinX;
+    mGrid.minY = mOpt.plateMinY;
+    mGrid.cellSize = mOpt.cellSize;
+    mGrid.cols = static_cast<uint32_t>(std::ceil(mOpt.plateWidth / mOpt.cellSize));
+    mGrid.rows = static_cast<uint32_t>(std::ceil(mOpt.plateHeight / mOpt.cellSize));
+
+    // Nominal areal density P / (v * h) of the styles geometry types resolve to (0-15)
+    mNominalMax = 0.0;
+    if (mStyles) {
+        for (uint32_t type = 0; type < 16; ++type) {
+            const BuildStyle* s = mStyles->getStyle(type);
+            if (s && s->laserSpeed > 0.0 && s->hatchSpacing > 0.0) {
+                mNominalMax = std::max(mNominalMax, s->laserPower / (s->laserSpeed * s->hatchSpacing));
+            }
+        }
+    }
+    mHotspot = mOpt.hotspotJmm2 > 0.0 ? mOpt.hotspotJmm2 : 1.5 * mNominalMax;
+    const double imageFullScale = mNominalMax > 0.0 ? 2.0 * mNominalMax : 1.0;
+
+    LayerPipeline pipeline("Energy", LayerPipeline::Settings{ mOpt.workers, 0 });
+    if (!pipeline.open(marcPath)) {
+        mError = pipeline.errorMessage();
+        return false;
+    }
+    const uint32_t total = pipeline.totalLayers();
+    mTotal = total;
+    mStats.assign(total, LayerEnergyStats());
+
+    // Outputs
+    const size_t cells = mGrid.cellCount();
+    const size_t recordBytes = 4 + 4 + cells * 2 + cells;
+    std::ofstream binary;
+    std::mutex binaryMutex;
+    if (!outDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(outDir, ec);
+        if (mOpt.writeImages) std::filesystem::create_directories(outDir + "/png", ec);
+        if (ec) {
+            mError = "Cannot create " + outDir + ": " + ec.message();
+            return false;
+        }
+        if (mOpt.writeBinary) {
+            binary.open(outDir + "/energy_maps.bin", std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!binary) {
+                mError = "Cannot create " + outDir + "/energy_maps.bin";
+                return false;
+            }
+            std::string header;
+            header.append("MEMP", 4);
+            putPod(header, kBinaryVersion);
+            putPod(header, mGrid.cols);
+            putPod(header, mGrid.rows);
+            putPod(header, mGrid.minX);
+            putPod(header, mGrid.minY);
+            putPod(header, mGrid.cellSize);
+            putPod(header, total);
+            binary.write(header.data(), static_cast<std::streamsize>(header.size()));
+        }
+    }
+
+    // Reader -> bounded queue -> workers; the outputs are shared, the buffers per worker
+    const EnergyMapper mapper(mStyles, mGrid);
+    pipeline.run([&] {
+        return [&, map = LayerEnergyMap(), record = std::string(), image = std::vector<uint8_t>()]
+               (LayerPipeline::RawLayer& raw) mutable {
+            if (mCancel) {
+                pipeline.cancel();
+                return false;
+            }
+            try {
+                const Layer layer = StreamingMarcReader::decodeLayer(raw.bytes.data(), raw.bytes.size(), pipeline.fileVersion());
+                const LayerEnergyStats st = mapper.accumulate(layer, map, mHotspot);
+                mStats[raw.index] = st;
+
+                if (binary.is_open()) {
+                    // Quantize: u16 energy with per-layer scale, u8 coverage in 1/100
+                    const float scale = st.maxEnergy > 0.0 ? static_cast<float>(st.maxEnergy / 65535.0) : 1.0f;
+                    record.clear();
+                    record.reserve(recordBytes);
+                    putPod(record, layer.layerNumber);
+                    putPod(record, scale);
+                    for (float v : map.energy) {
+                        putPod(record, static_cast<uint16_t>(std::min(65535.0f, std::round(v / scale))));
+                    }
+                    for (float v : map.coverage) {
+                        record.push_back(static_cast<char>(static_cast<uint8_t>(std::min(255.0f, std::round(v * 100.0f)))));
+                    }
+                    std::lock_guard<std::mutex> lk(binaryMutex);
+                    binary.seekp(static_cast<std::streamoff>(kHeaderBytes + static_cast<size_t>(raw.index) * recordBytes));
+                    binary.write(record.data(), static_cast<std::streamsize>(record.size()));
+                    if (!binary) throw std::runtime_error("write to energy_maps.bin failed");
+                }
+
+                if (mOpt.writeImages && !outDir.empty()) {
+                    image.resize(cells);
+                    for (size_t c = 0; c < cells; ++c) {
+                        image[c] = static_cast<uint8_t>(std::min(255.0, map.energy[c] / imageFullScale * 255.0));
+                    }
+                    std::ostringstream name;
+                    name << outDir << "/png/layer_" << std::setw(6) << std::setfill('0') << layer.layerNumber << ".png";
+                    if (!LayerRaster::writeGrayPng(name.str(), static_cast<int>(mGrid.cols),
+                                                   static_cast<int>(mGrid.rows), image.data(),
+                                                   static_cast<int>(mGrid.cols))) {
+                        throw std::runtime_error("cannot write " + name.str());
+                    }
+                }
+                mDone.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            } catch (const std::exception& e) {
+                pipeline.fail("Layer " + std::to_string(raw.index) + ": " + e.what());
+                return false;
+            }
+        };
+    });
+    pipeline.wait();
+
+    if (binary.is_open()) binary.close();
+    mError = pipeline.errorMessage();
+    if (!mError.empty()) return false;
+    if (mCancel || pipeline.isCancelled()) {
+        mError = "Cancelled";
+        return false;
+    }
+
+    if (!outDir.empty()) {
+        std::ofstream json(outDir + "/energy_stats.json", std::ios::out | std::ios::trunc);
+        json << statsJson();
+        if (!json) {
+            mError = "Cannot write " + outDir + "/energy_stats.json";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string EnergyMapEngine::statsJson() const {
+    nlohmann::json doc;
+    doc["tool"] = "energy_map";
+    doc["schema"] = 1;
+    doc["grid"] = {
+        {"min_x_mm", mGrid.minX}, {"min_y_mm", mGrid.minY}, {"cell_mm", mGrid.cellSize},
+        {"cols", mGrid.cols}, {"rows", mGrid.rows}
+    };
+    doc["nominal_max_j_per_mm2"] = mNominalMax;
+    doc["hotspot_threshold_j_per_mm2"] = mHotspot;
+
+    double buildMax = 0.0, totalEnergy = 0.0;
+    uint32_t buildMaxLayer = 0, layersWithHotspots = 0;
+    uint64_t hotspotCells = 0, unstyled = 0;
+    nlohmann::json layers = nlohmann::json::array();
+    for (const auto& s : mStats) {
+        layers.push_back({
+            {"layer", s.layerNumber},
+            {"covered_cells", s.coveredCells},
+            {"hotspot_cells", s.hotspotCells},
+            {"max_j_per_mm2", s.maxEnergy},
+            {"mean_j_per_mm2", s.meanEnergy},
+            {"p99_j_per_mm2", s.p99Energy},
+            {"max_coverage", s.maxCoverage},
+            {"energy_j", s.totalEnergyJ},
+            {"hotspot_mm", {s.hotspotX, s.hotspotY}},
+            {"unstyled_geometries", s.unstyledGeometries}
+        });
+        if (s.maxEnergy > buildMax) { buildMax = s.maxEnergy; buildMaxLayer = s.layerNumber; }
+        if (s.hotspotCells > 0) ++layersWithHotspots;
+        hotspotCells += s.hotspotCells;
+        unstyled += s.unstyledGeometries;
+        totalEnergy += s.totalEnergyJ;
+    }
+    doc["summary"] = {
+        {"layers", mStats.size()},
+        {"max_j_per_mm2", buildMax},
+        {"max_layer", buildMaxLayer},
+        {"layers_with_hotspots", layersWithHotspots},
+        {"hotspot_cells", hotspotCells},
+        {"unstyled_geometries", unstyled},
+        {"energy_j", totalEnergy}
+    };
+    doc["layers"] = std::move(layers);
+    return doc.dump(2);
+}
+
+} // namespace marc
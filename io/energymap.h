@@ -0,0 +1,155 @@
+#pragma once
+
+#include "readSlices.h"
+#include "buildstyle.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// EnergyGrid - Regular grid over the plate (mm, Y up)
+// ============================================================================
+struct EnergyGrid {
+    double minX = 0.0;
+    double minY = 0.0;
+    double cellSize = 0.5;          // mm
+    uint32_t cols = 0;
+    uint32_t rows = 0;
+
+    size_t cellCount() const { return static_cast<size_t>(cols) * rows; }
+    double cellArea() const { return cellSize * cellSize; }
+};
+
+// ============================================================================
+// LayerEnergyMap - Energy density and coverage of one layer
+// ============================================================================
+/**
+ * @brief Per-cell maps accumulated from layer geometry and resolved BuildStyles.
+ *
+ * energy[c]   [J/mm^2]  sum over vectors in the cell of (P / v) * length, divided
+ *                       by the cell area. A fully hatched cell converges to the
+ *                       nominal P / (v * h) of its style. Point exposures add
+ *                       P * pointExposureTime to the cell of each point.
+ * coverage[c] [-]       sum of h * length / cell area: 1.0 = cell scanned once
+ *                       at nominal hatch spacing, > 1 = overlapping exposure.
+ *
+ * Rows are stored top (max Y) to bottom, like images.
+ */
+struct LayerEnergyMap {
+    uint32_t layerNumber = 0;
+    std::vector<float> energy;
+    std::vector<float> coverage;
+};
+
+struct LayerEnergyStats {
+    uint32_t layerNumber = 0;
+    uint32_t coveredCells = 0;      // cells with any exposure
+    uint32_t hotspotCells = 0;      // cells above EnergyMapEngine::Options::hotspotJmm2
+    uint32_t unstyledGeometries = 0;
+    double maxEnergy = 0.0;         // J/mm^2
+    double meanEnergy = 0.0;        // over covered cells
+    double p99Energy = 0.0;         // over covered cells
+    double maxCoverage = 0.0;
+    double totalEnergyJ = 0.0;      // sum of P / v * length over the layer
+    double hotspotX = 0.0;          // mm, centre of the hottest cell
+    double hotspotY = 0.0;
+};
+
+// ============================================================================
+// EnergyMapper - Single-layer accumulation (pure, thread-safe when const)
+// ============================================================================
+class EnergyMapper {
+public:
+    EnergyMapper(const BuildStyleLibrary* styles, const EnergyGrid& grid)
+        : mStyles(styles), mGrid(grid) {}
+
+    // Fills map (resized to the grid) and returns its statistics
+    LayerEnergyStats accumulate(const Layer& layer, LayerEnergyMap& map, double hotspotJmm2) const;
+
+    const EnergyGrid& grid() const { return mGrid; }
+
+private:
+    const BuildStyle* resolveStyle(uint32_t geometryType) const;
+    void addSegment(LayerEnergyMap& map, double x0, double y0, double x1, double y1,
+                    double linearEnergy, double spacing, double& totalEnergy) const;
+    void addPoint(LayerEnergyMap& map, double x, double y,
+                  double energy, double footprint, double& totalEnergy) const;
+
+    const BuildStyleLibrary* mStyles = nullptr;
+    EnergyGrid mGrid;
+};
+
+// ============================================================================
+// EnergyMapEngine - Whole-build maps across all cores
+// ============================================================================
+/**
+ * @brief Streams a .marc file (LayerPipeline: reader thread + worker pool) and
+ * computes every layer's energy/coverage map and statistics.
+ *
+ * OUTPUTS (outDir):
+ *   energy_maps.bin  header + one fixed-size record per layer (random access):
+ *                      "MEMP", u32 version, u32 cols, u32 rows, f64 minX, minY,
+ *                      cellSize, u32 layerCount; then per layer: u32 layerNumber,
+ *                      f32 energyScale, u16 energy[cols*rows] (value * scale =
+ *                      J/mm^2), u8 coverage[cols*rows] (value / 100).
+ *   png/layer_NNNNNN.png  (optional) 8-bit energy image, 255 = 2 x nominal max.
+ *   energy_stats.json     per-layer statistics + build summary.
+ *
+ * USAGE:
+ *   EnergyMapEngine engine(&styles);
+ *   if (!engine.run(L"build.marc", "energy_out")) std::cerr << engine.errorMessage();
+ */
+class EnergyMapEngine {
+public:
+    struct Options {
+        double cellSize = 0.5;          // mm
+        double plateMinX = 0.0;         // plate rectangle in mm; width/height 0 =
+        double plateMinY = 0.0;         //   bounding box of the build (extra pass)
+        double plateWidth = 0.0;
+        double plateHeight = 0.0;
+        double hotspotJmm2 = 0.0;       // 0 = 1.5 x highest nominal P / (v * h)
+        unsigned workers = 0;           // 0 = hardware concurrency
+        bool writeBinary = true;
+        bool writeImages = false;
+    };
+
+    explicit EnergyMapEngine(const BuildStyleLibrary* styles) : EnergyMapEngine(styles, Options()) {}
+    EnergyMapEngine(const BuildStyleLibrary* styles, const Options& opt);
+
+    // Blocking; outDir may be empty to compute statistics only
+    bool run(const std::wstring& marcPath, const std::string& outDir);
+
+    void cancel() { mCancel = true; }
+    uint32_t layersDone() const { return mDone.load(std::memory_order_relaxed); }
+    uint32_t totalLayers() const { return mTotal.load(std::memory_order_relaxed); }
+
+    const EnergyGrid& grid() const { return mGrid; }
+    const std::vector<LayerEnergyStats>& layerStats() const { return mStats; }
+    double hotspotThreshold() const { return mHotspot; }
+    double nominalMaxDensity() const { return mNominalMax; }
+    const std::string& errorMessage() const { return mError; }
+
+    // Statistics + summary as JSON text
+    std::string statsJson() const;
+
+private:
+    bool computeBounds(const std::wstring& marcPath);
+
+    const BuildStyleLibrary* mStyles;
+    Options mOpt;
+    EnergyGrid mGrid;
+    double mHotspot = 0.0;
+    double mNominalMax = 0.0;
+    std::vector<LayerEnergyStats> mStats;
+    std::string mError;
+
+    std::atomic<bool> mCancel{false};
+    std::atomic<uint32_t> mDone{0};
+    std::atomic<uint32_t> mTotal{0};
+};
+
+} // namespace marc
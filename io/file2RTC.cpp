@@ -2,6 +2,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 using namespace std::chrono_literals;
 
@@ -31,7 +32,7 @@ file2RTC::~file2RTC()
 // ============================================================================
 
 void file2RTC::setLogCallback(std::function<void(const std::string&)> cb) {
-    std::lock_guard<std::mutex> lk(mMutex);
+    std::lock_guard<std::mutex> lk(mLogMutex);
     mLogCb = std::move(cb);
 }
 
@@ -58,6 +59,16 @@ file2RTC::State file2RTC::getState() const {
     return mState.load();
 }
 
+file2RTC::Position file2RTC::getPosition() const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mPosition;
+}
+
+void file2RTC::setSegmentSize(size_t commands) {
+    std::lock_guard<std::mutex> lk(mMutex);
+    mSegmentSize = commands;
+}
+
 // ============================================================================
 // File Loading
 // ============================================================================
@@ -72,26 +83,20 @@ bool file2RTC::loadFile(const std::wstring& path) {
     }
 
     mState = State::Loading;
-    mJobQueue.clear();
+    mReader.reset();
     mTotalLayers = 0;
+    mCommands.clear();
+    mLayerConverted = false;
+    mPosition = Position();
 
     try {
-        marc::readSlices reader;
-        if (!reader.open(path)) {
-            log("Failed to open MARC file: " + std::string(path.begin(), path.end()));
-            mState = State::Error;
-            return false;
-        }
-
-        const auto& layers = reader.layers();
-        mTotalLayers = layers.size();
+        // Header and index table only; layers are read by the worker as it goes
+        mReader = std::make_unique<marc::StreamingMarcReader>(path);
+        mTotalLayers = mReader->totalLayers();
         
         if (mTotalLayers == 0) {
             log("WARNING: File contains no layers");
         }
-        
-        // FIX: Copy layers to job queue (avoid lifetime issues)
-        mJobQueue.insert(mJobQueue.end(), layers.begin(), layers.end());
 
         std::ostringstream ss;
         ss << "Loaded file '" << std::string(path.begin(), path.end())
@@ -216,32 +221,41 @@ bool file2RTC::stop() {
 void file2RTC::workerThreadFunc() {
     log("Worker thread started");
 
-    size_t layerIndex = 0;
     size_t total = mTotalLayers;
 
     while (!mStopRequested) {
-        // Pause handling
+        // Pause handling (between segments, the position is kept)
         // FIX: Proper pause/resume with condition variable
         if (mPauseRequested) {
-            log("Worker paused");
+            const Position at = getPosition();
+            log("Worker paused at layer " + std::to_string(at.layerIndex) + " command " +
+                std::to_string(at.commandIndex) + "/" + std::to_string(at.commandCount));
             std::unique_lock<std::mutex> lk(mMutex);
             mCv.wait(lk, [this]{ return !mPauseRequested || mStopRequested; });
             if (mStopRequested) break;
+            lk.unlock();
             log("Worker resumed");
         }
 
-        // Get next layer from queue
-        marc::Layer layer;
-        {
-            std::lock_guard<std::mutex> lk(mMutex);
-            if (mJobQueue.empty()) break;
-            layer = std::move(mJobQueue.front());
-            mJobQueue.pop_front();
-        }
+        const size_t layerIndex = getPosition().layerIndex;
 
-        // process copy outside lock (NO LOCK DURING SCANNER OPS!)
+        // NO LOCK DURING FILE OR SCANNER OPS!
         try {
-            processLayer(layer, layerIndex);
+            // Read and convert the next layer on demand
+            if (!mLayerConverted) {
+                if (!mReader || !mReader->hasNextLayer()) break;
+                const marc::Layer layer = mReader->readNextLayer();
+                convertLayer(layer, layerIndex);
+                mLayerConverted = true;
+                std::lock_guard<std::mutex> lk(mMutex);
+                mPosition.commandIndex = 0;
+                mPosition.commandCount = mCommands.size();
+            }
+
+            if (getPosition().commandIndex < mCommands.size()) {
+                executeSegment(layerIndex);
+                if (getPosition().commandIndex < mCommands.size()) continue;
+            }
         } catch (const std::exception& e) {
             log(std::string("Error processing layer ") + std::to_string(layerIndex) + 
                 std::string(": ") + e.what());
@@ -249,13 +263,21 @@ void file2RTC::workerThreadFunc() {
             break;
         }
 
-        layerIndex++;
+        std::ostringstream ss;
+        ss << "Layer " << layerIndex << " completed successfully";
+        log(ss.str());
+
+        mLayerConverted = false;
+        mCommands.clear();
         
         // FIX: Call progress callback with proper locking
         {
             std::lock_guard<std::mutex> lk(mMutex);
+            mPosition.layerIndex = layerIndex + 1;
+            mPosition.commandIndex = 0;
+            mPosition.commandCount = 0;
             if (mProgressCb) {
-                mProgressCb(layerIndex, total);
+                mProgressCb(layerIndex + 1, total);
             }
         }
     }
@@ -272,8 +294,9 @@ void file2RTC::workerThreadFunc() {
 // Layer Processing
 // ============================================================================
 
-void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
+void file2RTC::convertLayer(const marc::Layer& L, size_t layerIndex) {
     std::ostringstream ss;
+    mCommands.clear();
     
     // Log layer info
     ss.str("");
@@ -297,12 +320,6 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
         // Use manual stepper control if implemented in Scanner class
     }
 
-    // Prepare command list
-    // FIX: Ensure scanner is ready for new list
-    if (!mScanner.isInitialized()) {
-        throw std::runtime_error("Scanner not initialized");
-    }
-
     // 2) Process Hatches
     // FIX: Each line in hatch is a pair of points (a, b)
     for (size_t hIdx = 0; hIdx < L.hatches.size(); ++hIdx) {
@@ -323,14 +340,9 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
                 continue;  // Skip invalid geometry
             }
 
-            // Move laser OFF (jump)
-            if (!mScanner.jumpTo(a)) {
-                throw std::runtime_error("jumpTo failed in hatch");
-            }
-            // Mark with laser ON
-            if (!mScanner.markTo(b)) {
-                throw std::runtime_error("markTo failed in hatch");
-            }
+            // Move laser OFF (jump), then mark with laser ON
+            mCommands.push_back({ a, false });
+            mCommands.push_back({ b, true });
         }
     }
 
@@ -350,9 +362,7 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
             continue;
         }
         
-        if (!mScanner.jumpTo(p0)) {
-            throw std::runtime_error("jumpTo failed (polyline start)");
-        }
+        mCommands.push_back({ p0, false });
         
         for (size_t i = 1; i < pl.points.size(); ++i) {
             Scanner::Point pi = toScannerPoint(pl.points[i]);
@@ -364,9 +374,7 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
                 continue;
             }
             
-            if (!mScanner.markTo(pi)) {
-                throw std::runtime_error("markTo failed (polyline)");
-            }
+            mCommands.push_back({ pi, true });
         }
     }
 
@@ -386,9 +394,7 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
             continue;
         }
         
-        if (!mScanner.jumpTo(p0)) {
-            throw std::runtime_error("jumpTo failed (polygon start)");
-        }
+        mCommands.push_back({ p0, false });
         
         // Mark all segments
         for (size_t i = 1; i < pg.points.size(); ++i) {
@@ -401,15 +407,11 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
                 continue;
             }
             
-            if (!mScanner.markTo(pi)) {
-                throw std::runtime_error("markTo failed (polygon segment)");
-            }
+            mCommands.push_back({ pi, true });
         }
         
         // FIX: Close the loop by returning to first point
-        if (!mScanner.markTo(p0)) {
-            throw std::runtime_error("markTo failed (polygon close)");
-        }
+        mCommands.push_back({ p0, true });
     }
 
     // 5) Process Support Circles
@@ -444,9 +446,7 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
                 continue;
             }
             
-            if (!mScanner.jumpTo(start)) {
-                throw std::runtime_error("jumpTo failed (circle)");
-            }
+            mCommands.push_back({ start, false });
             
             for (size_t i = 1; i < pts.size(); ++i) {
                 if (!pts[i].isValid()) {
@@ -456,27 +456,108 @@ void file2RTC::processLayer(const marc::Layer& L, size_t layerIndex) {
                     continue;
                 }
                 
-                if (!mScanner.markTo(pts[i])) {
-                    throw std::runtime_error("markTo failed (circle segment)");
-                }
+                mCommands.push_back({ pts[i], true });
             }
         }
     }
 
-    // 6) Execute the accumulated command list
+}
+
+// ============================================================================
+// Segment Execution
+// ============================================================================
+
+void file2RTC::executeSegment(size_t layerIndex) {
+    // FIX: Ensure scanner is ready for new list
+    if (!mScanner.isInitialized()) {
+        throw std::runtime_error("Scanner not initialized");
+    }
+
+    size_t begin = 0;
+    size_t cap = 0;
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        begin = mPosition.commandIndex;
+        cap = mSegmentSize;
+    }
+    // Fill the list, leaving room for the resume jump and the list framing
+    const size_t listMemory = static_cast<size_t>(mScanner.getConfig().listMemory);
+    size_t segment = listMemory > kListReserve ? listMemory - kListReserve : 1;
+    if (cap > 0) segment = std::min(segment, cap);
+    const size_t end = std::min(mCommands.size(), begin + segment);
+
+    if (!mScanner.prepareListForLayer()) {
+        throw std::runtime_error("prepareListForLayer failed");
+    }
+
+    // Resuming inside a mark run: the mark starts where the previous command ended
+    if (begin > 0 && mCommands[begin].mark) {
+        if (!mScanner.jumpTo(mCommands[begin - 1].point)) {
+            throw std::runtime_error("jumpTo failed (segment resume)");
+        }
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        const Command& c = mCommands[i];
+        if (!(c.mark ? mScanner.markTo(c.point) : mScanner.jumpTo(c.point))) {
+            std::ostringstream ss;
+            ss << (c.mark ? "markTo" : "jumpTo") << " failed at layer " << layerIndex << " command " << i;
+            throw std::runtime_error(ss.str());
+        }
+    }
+
+    // Paused while queuing: nothing was sent, the worker's pause handling waits
+    if (mPauseRequested) return;
+
+    // Execute the accumulated command list
     if (!mScanner.executeList()) {
         throw std::runtime_error("executeList failed");
     }
 
-    // 7) Wait for scanner to finish this layer
-    // FIX: Use reasonable timeout (30 seconds per layer)
-    if (!mScanner.waitForListCompletion(30000)) {
-        throw std::runtime_error("Scanner list did not finish in time");
+    // Wait for the card; a pause halts the list (pause_list) at the vector being
+    // scanned and restart_list continues it there
+    const size_t listOffset = (begin > 0 && mCommands[begin].mark) ? 1 : 0;   // resume jump
+    int64_t runningMs = 0;
+    for (;;) {
+        UINT busy = 0;
+        UINT listPos = 0;
+        mScanner.getStatus(busy, listPos);
+        if (!busy) break;
+
+        if (mPauseRequested) {
+            mScanner.pauseScanning();
+            mScanner.getStatus(busy, listPos);
+            // Commands before the card's list position are exposed
+            const size_t done = (listPos > listOffset) ? std::min<size_t>(listPos - listOffset, end - begin) : 0;
+            {
+                std::lock_guard<std::mutex> lk(mMutex);
+                mPosition.commandIndex = begin + done;
+            }
+            log("Card paused at layer " + std::to_string(layerIndex) + " command " + std::to_string(begin + done));
+
+            std::unique_lock<std::mutex> lk(mMutex);
+            mCv.wait(lk, [this]{ return !mPauseRequested || mStopRequested; });
+            lk.unlock();
+            if (mStopRequested) {
+                // The layer continues from the paused vector on the next run
+                mScanner.stopScanning();
+                return;
+            }
+            mScanner.resumeScanning();
+            log("Card resumed");
+            continue;
+        }
+
+        // A full list: same timeout as the production consumer's batches (running time only)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        runningMs += 10;
+        if (runningMs >= 100000) {
+            throw std::runtime_error("Scanner list did not finish in time");
+        }
     }
-    
-    ss.str("");
-    ss << "Layer " << layerIndex << " completed successfully";
-    log(ss.str());
+
+    std::lock_guard<std::mutex> lk(mMutex);
+    mPosition.commandIndex = end;
 }
 
 // ============================================================================
@@ -512,7 +593,8 @@ Scanner::Point file2RTC::toScannerPoint(const marc::Point& p) const {
 // ============================================================================
 
 void file2RTC::log(const std::string& s) {
-    std::lock_guard<std::mutex> lk(mMutex);
+    // Own mutex: log() is called while mMutex is held (loadFile, start, scanner callback)
+    std::lock_guard<std::mutex> lk(mLogMutex);
     if (mLogCb) {
         mLogCb(s);
     }
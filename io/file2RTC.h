@@ -1,16 +1,17 @@
 #pragma once
 
-#include "readSlices.h"
+#include "streamingmarcreader.h"
 #include "Scanner.h"
 
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <deque>
 #include <atomic>
 #include <functional>
 #include <chrono>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 // ============================================================================
 // file2RTC Class - Converts MARC files to RTC5 Scanner operations
@@ -19,15 +20,24 @@
 // DESIGN NOTES:
 // - Designed for single-threaded scanner usage (Scanner is NOT thread-safe)
 // - Worker thread OWNS the Scanner instance exclusively
-// - Main thread manages job queue and state via atomics/mutexes
-// - Layer data is copied to worker to avoid lifetime issues
+// - Main thread manages state via atomics/mutexes
+// - Layers are streamed from the .marc on demand (StreamingMarcReader owned
+//   by the worker once started); only the current layer is in memory
+// - Each layer is converted once into a flat jump/mark command sequence and
+//   sent to the card in segments that fill the list memory (less
+//   kListReserve). pause() halts the card within one status poll (10 ms)
+//   with pause_list; the position is taken from the card's list position and
+//   resume() continues the same list with restart_list, so no exposed vector
+//   is repeated or lost. A segment that starts inside a mark run re-jumps to
+//   the run's last point first. stop() during a pause leaves getPosition() at
+//   the paused command
 //
 // USAGE PATTERN:
 //   1. Create file2RTC instance
-//   2. Call loadFile() to queue layers
+//   2. Call loadFile() to open the .marc (header + index only)
 //   3. Call start() to spawn worker thread
 //   4. Use pause() / resume() / stop() to control execution
-//   5. Query state via getState()
+//   5. Query state via getState(), the exact point via getPosition()
 //
 class file2RTC {
 public:
@@ -43,6 +53,15 @@ public:
         }
     };
 
+    // Where execution stands: the next command to send within the current layer
+    struct Position {
+        size_t layerIndex = 0;
+        size_t commandIndex = 0;        // commands of this layer already executed
+        size_t commandCount = 0;        // 0 until the layer has been converted
+    };
+
+    static constexpr size_t kListReserve = 16;     // list memory left for the resume jump and list framing
+
     file2RTC();
     ~file2RTC();
 
@@ -51,12 +70,16 @@ public:
     file2RTC& operator=(const file2RTC&) = delete;
 
     // High level
-    bool loadFile(const std::wstring& path);   // load .marc into internal job queue
+    bool loadFile(const std::wstring& path);   // open .marc for streaming
     bool start();                              // start worker thread if ready
     bool pause();                              // request pause
     bool resume();                             // resume from pause
     bool stop();                               // stop (graceful)
     State getState() const;
+    Position getPosition() const;
+
+    // Cap on commands per list segment, 0 (default) = list memory less kListReserve
+    void setSegmentSize(size_t commands);
 
     // Calibration
     void setCalibration(const Calib& c);
@@ -67,9 +90,15 @@ public:
     void setProgressCallback(std::function<void(size_t layerIndex, size_t total)> cb);
 
 private:
+    struct Command {
+        Scanner::Point point;
+        bool mark = false;              // false = jump
+    };
+
     // worker
     void workerThreadFunc();
-    void processLayer(const marc::Layer& layer, size_t layerIndex);
+    void convertLayer(const marc::Layer& layer, size_t layerIndex);
+    void executeSegment(size_t layerIndex);
 
     // helpers
     long mmToBits(double mm) const;
@@ -84,15 +113,20 @@ private:
     std::atomic<bool> mStopRequested;
     std::atomic<bool> mPauseRequested;
 
-    // job queue (copies of layers)
-    std::deque<marc::Layer> mJobQueue;
+    // layer source and the current layer's commands (worker only while running)
+    std::unique_ptr<marc::StreamingMarcReader> mReader;
     size_t mTotalLayers{0};
+    std::vector<Command> mCommands;
+    bool mLayerConverted{false};
+    Position mPosition;                 // guarded by mMutex
+    size_t mSegmentSize{0};
 
     // dependencies
     Scanner mScanner;            // owned scanner; only used by worker thread
     Calib mCalib;
 
     // callbacks
+    std::mutex mLogMutex;
     std::function<void(const std::string&)> mLogCb;
     std::function<void(size_t, size_t)> mProgressCb;
 };
@@ -0,0 +1,338 @@
+#include "hatchgenerator.h"
+#include "workerpool.h"
+#include "diagnostics/trace.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace marc {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Below this many contour vertices a layer is hatched on the calling thread
+constexpr size_t kParallelMinVertices = 4096;
+
+struct Box {
+    double minX, minY, maxX, maxY;
+};
+
+Box boundsOf(const std::vector<Point>& ring) {
+    Box b{ ring[0].x, ring[0].y, ring[0].x, ring[0].y };
+    for (const Point& pt : ring) {
+        b.minX = std::min(b.minX, static_cast<double>(pt.x));
+        b.maxX = std::max(b.maxX, static_cast<double>(pt.x));
+        b.minY = std::min(b.minY, static_cast<double>(pt.y));
+        b.maxY = std::max(b.maxY, static_cast<double>(pt.y));
+    }
+    return b;
+}
+
+bool contains(const Box& outer, const Box& inner) {
+    return outer.minX <= inner.minX && outer.minY <= inner.minY &&
+           outer.maxX >= inner.maxX && outer.maxY >= inner.maxY;
+}
+
+bool pointInRing(const std::vector<Point>& ring, double x, double y) {
+    bool inside = false;
+    for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        const double yi = ring[i].y, yj = ring[j].y;
+        if ((yi > y) != (yj > y)) {
+            const double xc = ring[j].x + (y - yj) * (ring[i].x - ring[j].x) / (yi - yj);
+            if (x < xc) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// Collapse offset passes: keep, per boundary, the ring next to the material
+std::vector<const std::vector<Point>*> selectBoundaries(const std::vector<const std::vector<Point>*>& rings,
+                                                        double tolerance) {
+    const size_t n = rings.size();
+    if (tolerance <= 0.0 || n < 2) return rings;
+
+    std::vector<Box> boxes(n);
+    for (size_t i = 0; i < n; ++i) boxes[i] = boundsOf(*rings[i]);
+    auto area = [&](size_t i) { return (boxes[i].maxX - boxes[i].minX) * (boxes[i].maxY - boxes[i].minY); };
+
+    // Immediate parent: smallest containing ring
+    std::vector<size_t> parent(n, SIZE_MAX);
+    for (size_t i = 0; i < n; ++i) {
+        const Point& probe = (*rings[i])[0];
+        for (size_t j = 0; j < n; ++j) {
+            if (i == j || !contains(boxes[j], boxes[i]) || area(j) < area(i)) continue;
+            if (parent[i] != SIZE_MAX && area(j) >= area(parent[i])) continue;
+            if (pointInRing(*rings[j], probe.x, probe.y)) parent[i] = j;
+        }
+    }
+
+    auto isOffsetOf = [&](size_t child, size_t p) {
+        return boxes[child].minX - boxes[p].minX < tolerance && boxes[child].minY - boxes[p].minY < tolerance &&
+               boxes[p].maxX - boxes[child].maxX < tolerance && boxes[p].maxY - boxes[child].maxY < tolerance;
+    };
+
+    // Boundary top (outermost pass) and nesting depth in boundaries
+    std::vector<size_t> top(n), depth(n, 0);
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return area(a) > area(b); });
+    for (size_t i : order) {   // parents first
+        const size_t p = parent[i];
+        if (p == SIZE_MAX) { top[i] = i; depth[i] = 0; }
+        else if (isOffsetOf(i, p)) { top[i] = top[p]; depth[i] = depth[p]; }
+        else { top[i] = i; depth[i] = depth[p] + 1; }
+    }
+
+    // Outer boundaries (even depth) keep their innermost pass, holes their outermost
+    std::vector<size_t> chosen(n, SIZE_MAX);
+    for (size_t i : order) {
+        const size_t t = top[i];
+        if (depth[t] % 2 == 1) chosen[t] = t;
+        else chosen[t] = i;   // later in order = smaller = further in
+    }
+    std::vector<const std::vector<Point>*> selected;
+    for (size_t i = 0; i < n; ++i) {
+        if (top[i] == i) selected.push_back(rings[chosen[i]]);
+    }
+    return selected;
+}
+
+size_t findRoot(std::vector<size_t>& parent, size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+} // namespace
+
+HatchGenerator::HatchGenerator(const BuildStyleLibrary* styles, const Options& opt)
+    : mStyles(styles), mOpt(opt) {}
+
+double HatchGenerator::angleForLayer(uint32_t layerNumber) const {
+    double a = std::fmod(mOpt.angleDeg + static_cast<double>(layerNumber) * mOpt.rotationPerLayerDeg, 180.0);
+    if (a < 0.0) a += 180.0;
+    return a;
+}
+
+double HatchGenerator::spacing() const {
+    if (mOpt.spacing > 0.0) return mOpt.spacing;
+    if (mStyles) {
+        const BuildStyle* style = mStyles->getStyle(mOpt.hatchType);
+        if (style && style->hatchSpacing > 0.0) return style->hatchSpacing;
+    }
+    return 0.1;
+}
+
+bool HatchGenerator::fillsType(uint32_t contourType) const {
+    return mOpt.contourTypes.empty() ||
+           std::find(mOpt.contourTypes.begin(), mOpt.contourTypes.end(), contourType) != mOpt.contourTypes.end();
+}
+
+// ============================================================================
+// Scanline fill
+// ============================================================================
+
+void HatchGenerator::fillRegion(const std::vector<const std::vector<Point>*>& rings, double spacing, double angleRad,
+                                bool serpentine, double minLength, std::vector<Line>& out) {
+    if (!(spacing > 0.0)) return;
+
+    // Rotated frame: u along the hatch direction, v across it
+    const double c = std::cos(angleRad);
+    const double s = std::sin(angleRad);
+
+    struct Edge {
+        double v0, v1;      // v0 < v1
+        double u0;          // u at v0
+        double dudv;
+    };
+    std::vector<Edge> edges;
+    double vMin = INFINITY, vMax = -INFINITY;
+    for (const std::vector<Point>* ring : rings) {
+        const auto& pts = *ring;
+        const size_t n = pts.size();
+        if (n < 3) continue;
+        for (size_t i = 0; i < n; ++i) {
+            const Point& p = pts[i];
+            const Point& q = pts[(i + 1) % n];
+            double pu = p.x * c + p.y * s, pv = -p.x * s + p.y * c;
+            double qu = q.x * c + q.y * s, qv = -q.x * s + q.y * c;
+            if (!std::isfinite(pv) || !std::isfinite(qv) || pv == qv) continue;
+            if (pv > qv) { std::swap(pu, qu); std::swap(pv, qv); }
+            edges.push_back({ pv, qv, pu, (qu - pu) / (qv - pv) });
+            vMin = std::min(vMin, pv);
+            vMax = std::max(vMax, qv);
+        }
+    }
+    if (edges.empty()) return;
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.v0 < b.v0; });
+
+    std::vector<size_t> active;
+    std::vector<double> crossings;
+    size_t nextEdge = 0;
+    const long long kFirst = static_cast<long long>(std::ceil(vMin / spacing));
+    const long long kLast = static_cast<long long>(std::floor(vMax / spacing));
+
+    for (long long k = kFirst; k <= kLast; ++k) {
+        const double v = static_cast<double>(k) * spacing;
+
+        // Edge is crossed when v0 <= v < v1 (vertices on the line count once)
+        while (nextEdge < edges.size() && edges[nextEdge].v0 <= v) active.push_back(nextEdge++);
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [&](size_t e) { return edges[e].v1 <= v; }),
+                     active.end());
+        if (active.size() < 2) continue;
+
+        crossings.clear();
+        for (size_t e : active) crossings.push_back(edges[e].u0 + (v - edges[e].v0) * edges[e].dudv);
+        std::sort(crossings.begin(), crossings.end());
+
+        const size_t lineStart = out.size();
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            const double u0 = crossings[i];
+            const double u1 = crossings[i + 1];
+            if (u1 - u0 <= minLength || u1 <= u0) continue;
+            Line ln;
+            ln.a.x = static_cast<float>(u0 * c - v * s);
+            ln.a.y = static_cast<float>(u0 * s + v * c);
+            ln.b.x = static_cast<float>(u1 * c - v * s);
+            ln.b.y = static_cast<float>(u1 * s + v * c);
+            out.push_back(ln);
+        }
+
+        // Every other scanline runs backwards (short jumps between lines)
+        if (serpentine && (k & 1) != 0) {
+            std::reverse(out.begin() + static_cast<std::ptrdiff_t>(lineStart), out.end());
+            for (size_t i = lineStart; i < out.size(); ++i) std::swap(out[i].a, out[i].b);
+        }
+    }
+}
+
+// ============================================================================
+// Layer
+// ============================================================================
+
+size_t HatchGenerator::apply(Layer& layer) const {
+    MARC_TRACE_SCOPE("hatch", "HatchGenerator::apply");
+    if (mOpt.replaceExisting) layer.hatches.clear();
+
+    // Contours to fill (polygons, closed polylines) and their bounding boxes
+    std::vector<const std::vector<Point>*> contours;
+    std::vector<Box> boxes;
+    size_t vertices = 0;
+    auto addContour = [&](const std::vector<Point>& ring) {
+        contours.push_back(&ring);
+        boxes.push_back(boundsOf(ring));
+        vertices += ring.size();
+    };
+    for (const Polygon& p : layer.polygons) {
+        if (p.points.size() >= 3 && fillsType(p.tag.type)) addContour(p.points);
+    }
+    if (mOpt.closedPolylines) {
+        for (const Polyline& p : layer.polylines) {
+            if (p.points.size() < 4 || !fillsType(p.tag.type)) continue;
+            const Point& a = p.points.front();
+            const Point& b = p.points.back();
+            if (a.x == b.x && a.y == b.y) addContour(p.points);
+        }
+    }
+    if (contours.empty()) return 0;
+
+    // Regions: contours with overlapping bounding boxes (sweep over minX + union-find)
+    const size_t n = contours.size();
+    std::vector<size_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<size_t> byMinX(n);
+    std::iota(byMinX.begin(), byMinX.end(), 0);
+    std::sort(byMinX.begin(), byMinX.end(), [&](size_t a, size_t b) { return boxes[a].minX < boxes[b].minX; });
+    std::vector<size_t> open;
+    for (size_t i : byMinX) {
+        open.erase(std::remove_if(open.begin(), open.end(),
+                                  [&](size_t j) { return boxes[j].maxX < boxes[i].minX; }),
+                   open.end());
+        for (size_t j : open) {
+            if (boxes[j].minY <= boxes[i].maxY && boxes[i].minY <= boxes[j].maxY) {
+                parent[findRoot(parent, i)] = findRoot(parent, j);
+            }
+        }
+        open.push_back(i);
+    }
+
+    // Regions in order of their first contour, so output is deterministic
+    std::vector<std::vector<const std::vector<Point>*>> regions;
+    std::vector<size_t> regionOfRoot(n, SIZE_MAX);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t root = findRoot(parent, i);
+        if (regionOfRoot[root] == SIZE_MAX) {
+            regionOfRoot[root] = regions.size();
+            regions.emplace_back();
+        }
+        regions[regionOfRoot[root]].push_back(contours[i]);
+    }
+
+    // Fill regions across threads
+    const double h = spacing();
+    const double angle = angleForLayer(layer.layerNumber) * kPi / 180.0;
+    std::vector<std::vector<Line>> filled(regions.size());
+    parallelFor(mPool, regions.size(), vertices < kParallelMinVertices ? 1u : mOpt.workers, [&](size_t r) {
+        fillRegion(selectBoundaries(regions[r], mOpt.offsetTolerance), h, angle, mOpt.serpentine,
+                   mOpt.minLength, filled[r]);
+    });
+
+    size_t added = 0;
+    for (auto& lines : filled) {
+        if (lines.empty()) continue;
+        Hatch hatch;
+        hatch.tag.type = mOpt.hatchType;
+        hatch.tag.category = 1;
+        hatch.tag.pointCount = static_cast<uint32_t>(lines.size() * 2);
+        hatch.lines = std::move(lines);
+        added += hatch.lines.size();
+        layer.hatches.push_back(std::move(hatch));
+    }
+    return added;
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+bool HatchGenerator::loadFromJson(const std::string& jsonPath, Options& opt) {
+    std::ifstream file(jsonPath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open " + jsonPath);
+    }
+    const nlohmann::json doc = nlohmann::json::parse(file);
+    if (!doc.contains("hatching")) return false;
+
+    const nlohmann::json& h = doc["hatching"];
+    if (!h.is_object()) throw std::runtime_error("'hatching' is not an object");
+    if (!h.value("enabled", true)) return false;
+
+    Options parsed;
+    parsed.spacing = h.value("spacing", parsed.spacing);
+    parsed.angleDeg = h.value("angle", parsed.angleDeg);
+    parsed.rotationPerLayerDeg = h.value("rotationPerLayer", parsed.rotationPerLayerDeg);
+    parsed.hatchType = h.value("hatchType", parsed.hatchType);
+    parsed.contourTypes = h.value("contourTypes", parsed.contourTypes);
+    parsed.replaceExisting = h.value("replaceExisting", parsed.replaceExisting);
+    parsed.serpentine = h.value("serpentine", parsed.serpentine);
+    parsed.minLength = h.value("minLength", parsed.minLength);
+    parsed.offsetTolerance = h.value("offsetTolerance", parsed.offsetTolerance);
+    parsed.closedPolylines = h.value("closedPolylines", parsed.closedPolylines);
+    parsed.workers = h.value("workers", parsed.workers);
+    if (parsed.spacing < 0.0) throw std::runtime_error("'hatching.spacing' must not be negative");
+
+    opt = parsed;
+    return true;
+}
+
+} // namespace marc
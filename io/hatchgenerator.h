@@ -0,0 +1,98 @@
+#pragma once
+
+#include "readSlices.h"
+#include "buildstyle.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace marc {
+
+class WorkerPool;
+
+// ============================================================================
+// HatchGenerator - Scanline hatching of contour polygons at runtime
+// ============================================================================
+/**
+ * @brief Fills the closed Polygon contours of a layer with parallel hatch
+ * vectors, so hatch spacing and angle can change without re-slicing.
+ *
+ * DESIGN:
+ * - Contours whose bounding boxes overlap are grouped into regions (outer
+ *   contour + holes end up together); each region is filled independently
+ *   with the even-odd rule, so holes stay empty regardless of winding.
+ * - Slicers often emit several offset passes per boundary. Nested contours
+ *   whose bounding boxes differ by less than offsetTolerance on every side
+ *   count as one boundary; the pass next to the material bounds the fill
+ *   (innermost for outer boundaries, outermost for holes).
+ * - Scanline fill in a frame rotated by the layer angle: sorted edge list +
+ *   active edges, one sort of the crossings per scanline. Scanlines sit on
+ *   multiples of the spacing from the plate origin, so neighbouring regions
+ *   and parts share the same lines.
+ * - Layer angle = angleDeg + layerNumber * rotationPerLayerDeg (mod 180).
+ * - Regions are distributed over a shared WorkerPool (the calling thread
+ *   takes part); output order is region order, independent of thread timing.
+ * - Generated vectors are appended as one Hatch per region, tagged with
+ *   hatchType, so LayerConverter resolves their BuildStyle like any hatch.
+ *
+ * USAGE:
+ *   HatchGenerator::Options opt;
+ *   opt.rotationPerLayerDeg = 67.0;
+ *   HatchGenerator gen(&styles, opt);
+ *   gen.apply(layer);          // in the producer, before LayerConverter
+ *
+ * Config (optional top-level object of the build style JSON):
+ *   "hatching": { "enabled": true, "spacing": 0.1, "angle": 0, "rotationPerLayer": 67,
+ *                 "hatchType": 8, "contourTypes": [64], "replaceExisting": true,
+ *                 "serpentine": true, "minLength": 0.05, "workers": 0 }
+ */
+class HatchGenerator {
+public:
+    struct Options {
+        double spacing = 0.0;               // mm; 0 = hatchSpacing of the hatchType style
+        double angleDeg = 0.0;              // angle of layer 0
+        double rotationPerLayerDeg = 67.0;  // increment per layer number
+        uint32_t hatchType = 8;             // GeometryTag::type of generated hatches
+        std::vector<uint32_t> contourTypes; // contour types to fill, empty = all
+        bool closedPolylines = true;        // closed polylines (first == last) are contours too
+        bool replaceExisting = false;       // drop the file's pre-hatched vectors
+        bool serpentine = true;             // alternate direction on every other scanline
+        double minLength = 0.0;             // mm, shorter vectors are dropped
+        double offsetTolerance = 0.5;       // mm, offset passes of one boundary (0 = off)
+        unsigned workers = 0;               // 0 = every pool thread, 1 = calling thread only
+    };
+
+    HatchGenerator() = default;
+    HatchGenerator(const BuildStyleLibrary* styles, const Options& opt);
+
+    void setBuildStyles(const BuildStyleLibrary* styles) { mStyles = styles; }
+    void setWorkerPool(WorkerPool* pool) { mPool = pool; }   // nullptr = calling thread only
+    const Options& options() const { return mOpt; }
+
+    // Hatch angle for a layer, degrees in [0, 180)
+    double angleForLayer(uint32_t layerNumber) const;
+
+    // Effective spacing (explicit, else hatchType style, else 0.1 mm)
+    double spacing() const;
+
+    // Hatch the layer's contours in place; returns the number of vectors added
+    size_t apply(Layer& layer) const;
+
+    // Even-odd scanline fill of a set of closed rings (appends to out)
+    static void fillRegion(const std::vector<const std::vector<Point>*>& rings, double spacing, double angleRad,
+                           bool serpentine, double minLength, std::vector<Line>& out);
+
+    // Reads the optional "hatching" object of a build style JSON.
+    // Returns false when absent or disabled (opt untouched); throws on malformed JSON.
+    static bool loadFromJson(const std::string& jsonPath, Options& opt);
+
+private:
+    bool fillsType(uint32_t contourType) const;
+
+    const BuildStyleLibrary* mStyles = nullptr;
+    Options mOpt;
+    WorkerPool* mPool = nullptr;
+};
+
+} // namespace marc
@@ -0,0 +1,283 @@
+#include "islandpartitioner.h"
+#include "workerpool.h"
+#include "diagnostics/trace.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace marc {
+
+namespace {
+
+// Below this many vectors a layer is clipped on the calling thread
+constexpr size_t kParallelMinLines = 4096;
+
+// Smallest island edge accepted from the config (keeps the grid bounded)
+constexpr double kMinIslandSize = 0.5;
+
+struct LineRef {
+    uint32_t hatch;
+    uint32_t line;
+};
+
+} // namespace
+
+bool IslandPartitioner::partitions(uint32_t hatchType) const {
+    return mOpt.hatchTypes.empty() ||
+           std::find(mOpt.hatchTypes.begin(), mOpt.hatchTypes.end(), hatchType) != mOpt.hatchTypes.end();
+}
+
+// ============================================================================
+// Clipping
+// ============================================================================
+
+bool IslandPartitioner::clipLine(const Line& in, double minX, double minY, double maxX, double maxY, Line& out) {
+    const double x0 = in.a.x, y0 = in.a.y;
+    const double dx = static_cast<double>(in.b.x) - x0;
+    const double dy = static_cast<double>(in.b.y) - y0;
+    double t0 = 0.0, t1 = 1.0;
+
+    // Liang-Barsky: p * t <= q for the four edges. A vector lying on a max
+    // edge belongs to the next island, so shared edges are not scanned twice.
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0 - minX, maxX - x0, y0 - minY, maxY - y0 };
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0 || (q[i] == 0.0 && (i & 1) != 0)) return false;
+            continue;
+        }
+        const double t = q[i] / p[i];
+        if (p[i] < 0.0) {
+            if (t > t1) return false;
+            t0 = std::max(t0, t);
+        } else {
+            if (t < t0) return false;
+            t1 = std::min(t1, t);
+        }
+    }
+    if (t1 <= t0 && (dx != 0.0 || dy != 0.0)) return false;   // touches a corner or edge only
+
+    out.a.x = t0 > 0.0 ? static_cast<float>(x0 + t0 * dx) : in.a.x;
+    out.a.y = t0 > 0.0 ? static_cast<float>(y0 + t0 * dy) : in.a.y;
+    out.b.x = t1 < 1.0 ? static_cast<float>(x0 + t1 * dx) : in.b.x;
+    out.b.y = t1 < 1.0 ? static_cast<float>(y0 + t1 * dy) : in.b.y;
+    return true;
+}
+
+// ============================================================================
+// Layer
+// ============================================================================
+
+IslandPartitioner::Stats IslandPartitioner::apply(Layer& layer) const {
+    MARC_TRACE_SCOPE("hatch", "IslandPartitioner::apply");
+    Stats stats;
+    const double size = mOpt.islandSize;
+    const double ov = std::max(0.0, mOpt.overlap);
+    if (!(size > 0.0)) return stats;
+
+    // Partitioned vectors and their extent
+    std::vector<uint32_t> sources;
+    double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+    for (uint32_t h = 0; h < layer.hatches.size(); ++h) {
+        const Hatch& hatch = layer.hatches[h];
+        if (hatch.lines.empty() || !partitions(hatch.tag.type)) continue;
+        for (const Line& ln : hatch.lines) {
+            if (stats.linesIn == 0) {
+                minX = maxX = ln.a.x;
+                minY = maxY = ln.a.y;
+            }
+            minX = std::min({ minX, static_cast<double>(ln.a.x), static_cast<double>(ln.b.x) });
+            maxX = std::max({ maxX, static_cast<double>(ln.a.x), static_cast<double>(ln.b.x) });
+            minY = std::min({ minY, static_cast<double>(ln.a.y), static_cast<double>(ln.b.y) });
+            maxY = std::max({ maxY, static_cast<double>(ln.a.y), static_cast<double>(ln.b.y) });
+            ++stats.linesIn;
+        }
+        sources.push_back(h);
+    }
+    if (stats.linesIn == 0) return stats;
+
+    // Grid shifted per layer; indices are absolute so colours stay stable
+    const double shift = std::fmod(static_cast<double>(layer.layerNumber) * mOpt.shiftPerLayer, size);
+    auto cellOf = [&](double v) { return static_cast<long>(std::floor((v - shift) / size)); };
+    const long ix0 = cellOf(minX - ov), ix1 = cellOf(maxX + ov);
+    const long iy0 = cellOf(minY - ov), iy1 = cellOf(maxY + ov);
+    const size_t nx = static_cast<size_t>(ix1 - ix0 + 1);
+    const size_t ny = static_cast<size_t>(iy1 - iy0 + 1);
+
+    // Bin: per row band, only the columns the line crosses inside that band
+    std::vector<std::vector<LineRef>> cells(nx * ny);
+    for (uint32_t h : sources) {
+        const auto& lines = layer.hatches[h].lines;
+        for (uint32_t i = 0; i < lines.size(); ++i) {
+            const Line& ln = lines[i];
+            const double ax = ln.a.x, ay = ln.a.y;
+            const double dx = static_cast<double>(ln.b.x) - ax;
+            const double dy = static_cast<double>(ln.b.y) - ay;
+            const long r0 = cellOf(std::min(ay, ay + dy) - ov);
+            const long r1 = cellOf(std::max(ay, ay + dy) + ov);
+            for (long r = r0; r <= r1; ++r) {
+                double lo = 0.0, hi = 1.0;
+                if (dy != 0.0) {
+                    const double bandLo = shift + static_cast<double>(r) * size - ov;
+                    const double bandHi = bandLo + size + 2.0 * ov;
+                    double ta = (bandLo - ay) / dy, tb = (bandHi - ay) / dy;
+                    if (ta > tb) std::swap(ta, tb);
+                    lo = std::max(lo, ta);
+                    hi = std::min(hi, tb);
+                    if (lo > hi) continue;
+                }
+                const double xa = ax + lo * dx, xb = ax + hi * dx;
+                const long c0 = std::max(ix0, cellOf(std::min(xa, xb) - ov));
+                const long c1 = std::min(ix1, cellOf(std::max(xa, xb) + ov));
+                const size_t rowStart = static_cast<size_t>(r - iy0) * nx;
+                for (long c = c0; c <= c1; ++c) {
+                    cells[rowStart + static_cast<size_t>(c - ix0)].push_back(LineRef{ h, i });
+                }
+            }
+        }
+    }
+
+    // Island order
+    std::vector<size_t> order;
+    for (size_t k = 0; k < cells.size(); ++k) {
+        if (!cells[k].empty()) order.push_back(k);
+    }
+    auto absCol = [&](size_t k) { return ix0 + static_cast<long>(k % nx); };
+    auto absRow = [&](size_t k) { return iy0 + static_cast<long>(k / nx); };
+    switch (mOpt.order) {
+    case Order::RowMajor:
+        break;
+    case Order::Serpentine:
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (absRow(a) != absRow(b)) return absRow(a) < absRow(b);
+            return (absRow(a) & 1) ? absCol(a) > absCol(b) : absCol(a) < absCol(b);
+        });
+        break;
+    case Order::Chessboard: {
+        const long first = static_cast<long>(layer.layerNumber & 1u);
+        std::stable_partition(order.begin(), order.end(),
+                              [&](size_t k) { return ((absCol(k) + absRow(k)) & 1) == first; });
+        break;
+    }
+    case Order::Random: {
+        std::mt19937 rng(mOpt.seed + layer.layerNumber);
+        std::shuffle(order.begin(), order.end(), rng);
+        break;
+    }
+    }
+
+    // Clip islands across threads; one Hatch per island and hatch type
+    std::vector<std::vector<Hatch>> islands(order.size());
+    parallelFor(mPool, order.size(), stats.linesIn < kParallelMinLines ? 1u : mOpt.workers, [&](size_t n) {
+        const size_t k = order[n];
+        const double x0 = shift + static_cast<double>(absCol(k)) * size - ov;
+        const double y0 = shift + static_cast<double>(absRow(k)) * size - ov;
+        const double x1 = x0 + size + 2.0 * ov;
+        const double y1 = y0 + size + 2.0 * ov;
+        auto& out = islands[n];
+        for (const LineRef& ref : cells[k]) {
+            const Hatch& src = layer.hatches[ref.hatch];
+            Line clipped;
+            if (!clipLine(src.lines[ref.line], x0, y0, x1, y1, clipped)) continue;
+            if (mOpt.minLength > 0.0 &&
+                std::hypot(clipped.b.x - clipped.a.x, clipped.b.y - clipped.a.y) <= mOpt.minLength) {
+                continue;
+            }
+            auto it = std::find_if(out.begin(), out.end(),
+                                   [&](const Hatch& h) { return h.tag.type == src.tag.type; });
+            if (it == out.end()) {
+                Hatch hatch;
+                hatch.tag = src.tag;
+                out.push_back(std::move(hatch));
+                it = out.end() - 1;
+            }
+            it->lines.push_back(clipped);
+        }
+    });
+
+    // Untouched hatches first, then the islands in scan order
+    std::vector<Hatch> result;
+    size_t src = 0;
+    for (uint32_t h = 0; h < layer.hatches.size(); ++h) {
+        if (src < sources.size() && sources[src] == h) {
+            ++src;
+            continue;
+        }
+        result.push_back(std::move(layer.hatches[h]));
+    }
+    for (auto& island : islands) {
+        if (island.empty()) continue;
+        ++stats.islands;
+        for (Hatch& hatch : island) {
+            hatch.tag.pointCount = static_cast<uint32_t>(hatch.lines.size() * 2);
+            stats.linesOut += hatch.lines.size();
+            result.push_back(std::move(hatch));
+        }
+    }
+    layer.hatches = std::move(result);
+    return stats;
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+const char* IslandPartitioner::orderName(Order order) {
+    switch (order) {
+    case Order::RowMajor:   return "rowMajor";
+    case Order::Serpentine: return "serpentine";
+    case Order::Chessboard: return "chessboard";
+    case Order::Random:     return "random";
+    }
+    return "unknown";
+}
+
+bool IslandPartitioner::parseOrder(const std::string& name, Order& order) {
+    for (Order o : { Order::RowMajor, Order::Serpentine, Order::Chessboard, Order::Random }) {
+        if (name == orderName(o)) {
+            order = o;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IslandPartitioner::loadFromJson(const std::string& jsonPath, Options& opt) {
+    std::ifstream file(jsonPath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open " + jsonPath);
+    }
+    const nlohmann::json doc = nlohmann::json::parse(file);
+    if (!doc.contains("islands")) return false;
+
+    const nlohmann::json& j = doc["islands"];
+    if (!j.is_object()) throw std::runtime_error("'islands' is not an object");
+    if (!j.value("enabled", true)) return false;
+
+    Options parsed;
+    parsed.islandSize = j.value("size", parsed.islandSize);
+    parsed.overlap = j.value("overlap", parsed.overlap);
+    parsed.shiftPerLayer = j.value("shiftPerLayer", parsed.shiftPerLayer);
+    parsed.seed = j.value("seed", parsed.seed);
+    parsed.hatchTypes = j.value("hatchTypes", parsed.hatchTypes);
+    parsed.minLength = j.value("minLength", parsed.minLength);
+    parsed.workers = j.value("workers", parsed.workers);
+    const std::string order = j.value("order", std::string(orderName(parsed.order)));
+    if (!parseOrder(order, parsed.order)) {
+        throw std::runtime_error("Unknown 'islands.order' \"" + order + "\"");
+    }
+    if (parsed.islandSize < kMinIslandSize) {
+        throw std::runtime_error("'islands.size' must be at least 0.5 mm");
+    }
+    if (parsed.overlap < 0.0) throw std::runtime_error("'islands.overlap' must not be negative");
+
+    opt = parsed;
+    return true;
+}
+
+} // namespace marc
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "readSlices.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace marc {
+
+class WorkerPool;
+
+// ============================================================================
+// IslandPartitioner - Island (chessboard) scan strategy
+// ============================================================================
+/**
+ * @brief Cuts the hatch vectors of a layer into square islands and reorders
+ * them island by island, so a large cross-section is scanned as many short
+ * vectors in small, thermally separated patches.
+ *
+ * DESIGN:
+ * - Fixed grid of islandSize squares anchored at the plate origin, shifted by
+ *   shiftPerLayer (mod islandSize) each layer so island seams do not stack.
+ * - Binning walks each line row band by row band and only lists the islands
+ *   it actually crosses (not its whole bounding box); each island then clips
+ *   its candidates with Liang-Barsky against its axis-aligned rectangle.
+ *   Clipping runs per island on a shared WorkerPool (calling thread included).
+ * - Islands are emitted in the configured order as one Hatch per island and
+ *   source hatch type, so LayerConverter gives every island its own
+ *   ParameterSegment (command group); BuildStyles are unchanged.
+ * - Order is deterministic for a given layer number (Random is seeded).
+ *   Chessboard scans one colour first and alternates the colour per layer.
+ * - Contours are left alone; they are scanned after all islands as before.
+ *
+ * USAGE:
+ *   IslandPartitioner::Options opt;
+ *   opt.islandSize = 5.0;
+ *   IslandPartitioner islands(opt);
+ *   islands.apply(layer);      // in the producer, after hatching, before LayerConverter
+ *
+ * Config (optional top-level object of the build style JSON):
+ *   "islands": { "enabled": true, "size": 5.0, "overlap": 0.0, "shiftPerLayer": 1.3,
+ *                "order": "chessboard", "seed": 0, "hatchTypes": [8], "minLength": 0.05 }
+ */
+class IslandPartitioner {
+public:
+    enum class Order {
+        RowMajor,       // left to right, bottom to top
+        Serpentine,     // rows alternate direction
+        Chessboard,     // all islands of one colour, then the other
+        Random          // shuffled, seeded by seed + layer number
+    };
+
+    struct Options {
+        double islandSize = 5.0;            // mm, edge length of an island
+        double overlap = 0.0;               // mm, islands extended into their neighbours
+        double shiftPerLayer = 0.0;         // mm, grid shift per layer number (x and y)
+        Order order = Order::Chessboard;
+        uint32_t seed = 0;                  // Random order
+        std::vector<uint32_t> hatchTypes;   // hatch types to partition, empty = all
+        double minLength = 0.0;             // mm, shorter clipped vectors are dropped
+        unsigned workers = 0;               // 0 = every pool thread, 1 = calling thread only
+    };
+
+    // Result of one apply() call
+    struct Stats {
+        size_t islands = 0;         // non-empty islands emitted
+        size_t linesIn = 0;         // vectors partitioned
+        size_t linesOut = 0;        // vectors after clipping
+    };
+
+    IslandPartitioner() = default;
+    explicit IslandPartitioner(const Options& opt) : mOpt(opt) {}
+
+    void setWorkerPool(WorkerPool* pool) { mPool = pool; }   // nullptr = calling thread only
+    const Options& options() const { return mOpt; }
+
+    // Partition the layer's hatches in place
+    Stats apply(Layer& layer) const;
+
+    // Clip a segment to [minX, maxX] x [minY, maxY]; false when nothing (or a single point) is left.
+    // Vectors lying on the max edges are rejected, so adjacent islands do not share them.
+    static bool clipLine(const Line& in, double minX, double minY, double maxX, double maxY, Line& out);
+
+    static const char* orderName(Order order);
+    static bool parseOrder(const std::string& name, Order& order);
+
+    // Reads the optional "islands" object of a build style JSON.
+    // Returns false when absent or disabled (opt untouched); throws on malformed JSON.
+    static bool loadFromJson(const std::string& jsonPath, Options& opt);
+
+private:
+    bool partitions(uint32_t hatchType) const;
+
+    Options mOpt;
+    WorkerPool* mPool = nullptr;
+};
+
+} // namespace marc
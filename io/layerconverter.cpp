@@ -0,0 +1,149 @@
+#include "layerconverter.h"
+#include "diagnostics/trace.h"
+
+#include <stdexcept>
+
+namespace marc {
+
+// ============================================================================
+// Layer Conversion
+// ============================================================================
+
+bool LayerConverter::convert(const Layer& L, RTCCommandBlock& out, std::string* error) const {
+    MARC_TRACE_SCOPE("convert", "LayerConverter::convert");
+    try {
+        // Pre-size the command vector: one jump/mark pair per hatch line,
+        // one command per contour point (+1 closing mark for polygons),
+        // at least one exposure per circle
+        size_t expected = out.commands.size();
+        for (const auto& h : L.hatches) expected += h.lines.size() * 2;
+        for (const auto& p : L.polylines) expected += p.points.size();
+        for (const auto& pg : L.polygons) expected += pg.points.size() + 1;
+        expected += L.support_circles.size();
+        out.commands.reserve(expected);
+        out.parameterSegments.reserve(out.parameterSegments.size() +
+                                      L.hatches.size() + L.polylines.size() + L.polygons.size());
+
+        for (const auto& h : L.hatches) convertHatch(h, out);
+        for (const auto& p : L.polylines) convertPolyline(p, out);
+        for (const auto& pg : L.polygons) convertPolygon(pg, out);
+        convertCircles(L.support_circles, out);
+        return true;
+    } catch (const std::exception& e) {
+        if (error) *error = std::string("convertLayerToBlock exception: ") + e.what();
+        return false;
+    }
+}
+
+const BuildStyle* LayerConverter::resolveStyle(uint32_t geometryType) const {
+    if (!mStyles) return nullptr;
+    const BuildStyle* style = mStyles->getStyle(geometryType);
+    if (!style) style = mStyles->getStyle(8);
+    return style;
+}
+
+void LayerConverter::convertHatch(const Hatch& h, RTCCommandBlock& out) const {
+    const size_t cmdStartIdx = out.commands.size();
+
+    for (const auto& line : h.lines) {
+        out.commands.push_back(command(RTCCommandBlock::Command::Jump, line.a));
+        out.commands.push_back(command(RTCCommandBlock::Command::Mark, line.b));
+    }
+
+    applyBuildStyle(resolveStyle(h.tag.type), out, cmdStartIdx);
+}
+
+void LayerConverter::convertPolyline(const Polyline& p, RTCCommandBlock& out) const {
+    if (p.points.empty()) return;
+    const size_t cmdStartIdx = out.commands.size();
+
+    // Jump to first point
+    out.commands.push_back(command(RTCCommandBlock::Command::Jump, p.points[0]));
+    for (size_t i = 1; i < p.points.size(); ++i) {
+        out.commands.push_back(command(RTCCommandBlock::Command::Mark, p.points[i]));
+    }
+
+    applyBuildStyle(resolveStyle(p.tag.type), out, cmdStartIdx);
+}
+
+void LayerConverter::convertPolygon(const Polygon& p, RTCCommandBlock& out) const {
+    if (p.points.empty()) return;
+    const size_t cmdStartIdx = out.commands.size();
+
+    out.commands.push_back(command(RTCCommandBlock::Command::Jump, p.points[0]));
+    for (size_t i = 1; i < p.points.size(); ++i) {
+        out.commands.push_back(command(RTCCommandBlock::Command::Mark, p.points[i]));
+    }
+
+    // Close loop
+    out.commands.push_back(command(RTCCommandBlock::Command::Mark, p.points[0]));
+
+    applyBuildStyle(resolveStyle(p.tag.type), out, cmdStartIdx);
+}
+
+void LayerConverter::circlePoints(const Circle& c, double pointDistance, std::vector<Point>& out) {
+    const double pitch = pointDistance > 0.0 ? pointDistance : 0.05;
+    const double r = static_cast<double>(c.radius);
+    if (r <= 0.5 * pitch) {
+        out.push_back(c.center);
+        return;
+    }
+
+    // Points evenly spaced on the circumference, no further apart than pitch
+    constexpr double kTwoPi = 6.283185307179586;
+    const size_t n = static_cast<size_t>(std::ceil(kTwoPi * r / pitch));
+    const double step = kTwoPi / static_cast<double>(n);
+    for (size_t k = 0; k < n; ++k) {
+        const double a = step * static_cast<double>(k);
+        out.push_back(Point{ static_cast<float>(c.center.x + r * std::cos(a)),
+                             static_cast<float>(c.center.y + r * std::sin(a)) });
+    }
+}
+
+void LayerConverter::convertCircles(const std::vector<Circle>& circles, RTCCommandBlock& out) const {
+    std::vector<Point> points;
+    size_t i = 0;
+    while (i < circles.size()) {
+        const uint32_t type = circles[i].tag.type;
+        const BuildStyle* style = resolveStyle(type);
+        if (!style) {
+            // No exposure time without a style: the points are skipped, not pulsed
+            while (i < circles.size() && circles[i].tag.type == type) ++i;
+            continue;
+        }
+        const double pitch = style->pointDistance;
+        const size_t cmdStartIdx = out.commands.size();
+        for (; i < circles.size() && circles[i].tag.type == type; ++i) {
+            points.clear();
+            circlePoints(circles[i], pitch, points);
+            for (const Point& p : points) out.commands.push_back(command(RTCCommandBlock::Command::Expose, p));
+        }
+        applyBuildStyle(style, out, cmdStartIdx);
+    }
+}
+
+void LayerConverter::applyBuildStyle(const BuildStyle* style, RTCCommandBlock& out, size_t cmdStartIdx) {
+    if (!style) return;
+
+    size_t cmdEndIdx = out.commands.size();
+    if (cmdEndIdx == 0) return;
+    cmdEndIdx = cmdEndIdx - 1;
+
+    out.addParameterSegment(
+        style->id,
+        style->laserPower,
+        style->laserSpeed,
+        style->jumpSpeed,
+        style->laserMode,
+        style->laserFocus
+    );
+
+    // Ensure segment covers intended commands
+    auto& seg = out.parameterSegments.back();
+    seg.startCmd = cmdStartIdx;
+    seg.endCmd = cmdEndIdx;
+    seg.pointDelayUs = style->pointDelay;
+    seg.pointExposureUs = style->pointExposureTime;
+}
+
+} // namespace marc
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "readSlices.h"
+#include "buildstyle.h"
+#include "rtccommandblock.h"
+
+#include <cmath>
+#include <string>
+
+namespace marc {
+
+// ============================================================================
+// CoordinateCalibration - mm -> RTC5 bits mapping
+// ============================================================================
+struct CoordinateCalibration {
+    double fieldSizeMM = 163.4;     // f-theta field size
+    long maxBits = 524287;          // +/- max (20-bit signed)
+    double scaleCorrection = 1.0;   // user calibration
+
+    double bitsPerMM() const {
+        return (2.0 * static_cast<double>(maxBits)) / fieldSizeMM * scaleCorrection;
+    }
+};
+
+// ============================================================================
+// LayerConverter - marc::Layer -> RTCCommandBlock (no Qt, no RTC5)
+// ============================================================================
+/**
+ * @brief Converts layer geometry into jump/mark commands with parameter segments.
+ *
+ * DESIGN:
+ * - Pure function of (layer, BuildStyleLibrary, calibration); owns no state
+ *   besides configuration, so it can run on any thread (producer, benchmarks,
+ *   exporters, headless runners).
+ * - BuildStyle is resolved by GeometryTag::type, falling back to style 8.
+ * - One ParameterSegment per geometry, covering that geometry's commands.
+ * - Circles are point exposures (Expose commands): a circle no larger than
+ *   pointDistance is one exposure at its centre, a larger one is exposed as
+ *   points pointDistance apart on its circumference. Consecutive circles of
+ *   the same type share one segment, so point sets stay a single group.
+ *   Circles whose type resolves to no style are not exposed at all.
+ *
+ * USAGE:
+ *   LayerConverter conv(&styles);
+ *   RTCCommandBlock block;
+ *   if (!conv.convert(layer, block, &err)) { ... }
+ */
+class LayerConverter {
+public:
+    LayerConverter() = default;
+    explicit LayerConverter(const BuildStyleLibrary* styles,
+                            const CoordinateCalibration& calib = CoordinateCalibration())
+        : mStyles(styles), mCalib(calib) {}
+
+    void setBuildStyles(const BuildStyleLibrary* styles) { mStyles = styles; }
+    void setCalibration(const CoordinateCalibration& calib) { mCalib = calib; }
+    const CoordinateCalibration& calibration() const { return mCalib; }
+
+    // Append all geometry of L to out. Returns false (and sets error) on failure.
+    bool convert(const Layer& L, RTCCommandBlock& out, std::string* error = nullptr) const;
+
+    // Convert float mm coordinates to long bits (clamped to the field)
+    long mmToBits(double mm) const {
+        double bits = mm * mCalib.bitsPerMM();
+        const double mx = static_cast<double>(mCalib.maxBits);
+        if (bits > mx) bits = mx;
+        if (bits < -mx) bits = -mx;
+        return static_cast<long>(std::lround(bits));
+    }
+
+    // Add a parameter segment for commands [cmdStartIdx, end) using style
+    static void applyBuildStyle(const BuildStyle* style, RTCCommandBlock& out, size_t cmdStartIdx);
+
+    // BuildStyle for a geometry type (fallback: style 8), may be nullptr
+    const BuildStyle* resolveStyle(uint32_t geometryType) const;
+
+    // Exposure positions of a circle (mm) for a point distance; appended to out
+    static void circlePoints(const Circle& c, double pointDistance, std::vector<Point>& out);
+
+private:
+    void convertHatch(const Hatch& h, RTCCommandBlock& out) const;
+    void convertPolyline(const Polyline& p, RTCCommandBlock& out) const;
+    void convertPolygon(const Polygon& p, RTCCommandBlock& out) const;
+    void convertCircles(const std::vector<Circle>& circles, RTCCommandBlock& out) const;
+
+    RTCCommandBlock::Command command(RTCCommandBlock::Command::Type type, const Point& p) const {
+        RTCCommandBlock::Command c{type};
+        c.x = mmToBits(static_cast<double>(p.x));
+        c.y = mmToBits(static_cast<double>(p.y));
+        return c;
+    }
+
+    const BuildStyleLibrary* mStyles = nullptr;
+    CoordinateCalibration mCalib;
+};
+
+} // namespace marc
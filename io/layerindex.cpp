@@ -0,0 +1,282 @@
+#include "layerindex.h"
+#include "diagnostics/trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+
+namespace marc {
+
+namespace {
+
+// Hilbert curve index of (x, y) on a 65536 x 65536 grid
+uint32_t hilbert(uint32_t x, uint32_t y) {
+    uint32_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        const uint32_t rx = (x & s) ? 1u : 0u;
+        const uint32_t ry = (y & s) ? 1u : 0u;
+        d += s * s * ((3u * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+double segmentDistance2(double px, double py, const Point& a, const Point& b) {
+    const double dx = static_cast<double>(b.x) - a.x;
+    const double dy = static_cast<double>(b.y) - a.y;
+    const double len2 = dx * dx + dy * dy;
+    double t = len2 > 0.0 ? ((px - a.x) * dx + (py - a.y) * dy) / len2 : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    const double ex = a.x + t * dx - px;
+    const double ey = a.y + t * dy - py;
+    return ex * ex + ey * ey;
+}
+
+double pathDistance2(double px, double py, const std::vector<Point>& pts, bool closed) {
+    if (pts.empty()) return std::numeric_limits<double>::infinity();
+    if (pts.size() == 1) return segmentDistance2(px, py, pts[0], pts[0]);
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i + 1 < pts.size(); ++i) best = std::min(best, segmentDistance2(px, py, pts[i], pts[i + 1]));
+    if (closed) best = std::min(best, segmentDistance2(px, py, pts.back(), pts.front()));
+    return best;
+}
+
+double boxDistance2(const LayerIndex::Box& b, double x, double y) {
+    const double dx = std::max({ static_cast<double>(b.minX) - x, 0.0, x - static_cast<double>(b.maxX) });
+    const double dy = std::max({ static_cast<double>(b.minY) - y, 0.0, y - static_cast<double>(b.maxY) });
+    return dx * dx + dy * dy;
+}
+
+bool intersects(const LayerIndex::Box& b, double minX, double minY, double maxX, double maxY) {
+    return b.minX <= maxX && b.maxX >= minX && b.minY <= maxY && b.maxY >= minY;
+}
+
+LayerIndex::Box boxOf(const std::vector<Point>& pts) {
+    LayerIndex::Box b{ pts[0].x, pts[0].y, pts[0].x, pts[0].y };
+    for (const Point& p : pts) {
+        b.minX = std::min(b.minX, p.x);
+        b.minY = std::min(b.minY, p.y);
+        b.maxX = std::max(b.maxX, p.x);
+        b.maxY = std::max(b.maxY, p.y);
+    }
+    return b;
+}
+
+} // namespace
+
+LayerIndex::LayerIndex(const Layer& layer, int nodeSize)
+    : mNodeSize(nodeSize < 2 ? 2 : nodeSize)
+{
+    build(layer);
+}
+
+// ============================================================================
+// Build
+// ============================================================================
+
+void LayerIndex::build(const Layer& layer) {
+    MARC_TRACE_SCOPE("index", "LayerIndex::build");
+    mLayer = &layer;
+    mItems.clear();
+    mBoxes.clear();
+    mChildStart.clear();
+    mLevelEnds.clear();
+
+    // One box per item
+    std::vector<Item> items;
+    std::vector<Box> boxes;
+    size_t lines = 0;
+    for (const Hatch& h : layer.hatches) lines += h.lines.size();
+    items.reserve(lines + layer.polylines.size() + layer.polygons.size() + layer.support_circles.size());
+    boxes.reserve(items.capacity());
+    for (uint32_t g = 0; g < layer.hatches.size(); ++g) {
+        const auto& hl = layer.hatches[g].lines;
+        for (uint32_t i = 0; i < hl.size(); ++i) {
+            const Line& ln = hl[i];
+            items.push_back(Item{ Kind::Hatch, g, i });
+            boxes.push_back(Box{ std::min(ln.a.x, ln.b.x), std::min(ln.a.y, ln.b.y),
+                                 std::max(ln.a.x, ln.b.x), std::max(ln.a.y, ln.b.y) });
+        }
+    }
+    for (uint32_t g = 0; g < layer.polylines.size(); ++g) {
+        if (layer.polylines[g].points.empty()) continue;
+        items.push_back(Item{ Kind::Polyline, g, 0 });
+        boxes.push_back(boxOf(layer.polylines[g].points));
+    }
+    for (uint32_t g = 0; g < layer.polygons.size(); ++g) {
+        if (layer.polygons[g].points.empty()) continue;
+        items.push_back(Item{ Kind::Polygon, g, 0 });
+        boxes.push_back(boxOf(layer.polygons[g].points));
+    }
+    for (uint32_t g = 0; g < layer.support_circles.size(); ++g) {
+        const Circle& c = layer.support_circles[g];
+        items.push_back(Item{ Kind::Circle, g, 0 });
+        boxes.push_back(Box{ c.center.x - c.radius, c.center.y - c.radius, c.center.x + c.radius, c.center.y + c.radius });
+    }
+    const size_t n = items.size();
+    if (n == 0) return;
+
+    // Sort by Hilbert value of the box centres
+    Box all = boxes[0];
+    for (const Box& b : boxes) {
+        all.minX = std::min(all.minX, b.minX);
+        all.minY = std::min(all.minY, b.minY);
+        all.maxX = std::max(all.maxX, b.maxX);
+        all.maxY = std::max(all.maxY, b.maxY);
+    }
+    const double w = std::max(static_cast<double>(all.maxX) - all.minX, 1e-9);
+    const double h = std::max(static_cast<double>(all.maxY) - all.minY, 1e-9);
+    std::vector<uint32_t> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double cx = 0.5 * (static_cast<double>(boxes[i].minX) + boxes[i].maxX);
+        const double cy = 0.5 * (static_cast<double>(boxes[i].minY) + boxes[i].maxY);
+        keys[i] = hilbert(static_cast<uint32_t>(65535.0 * (cx - all.minX) / w),
+                          static_cast<uint32_t>(65535.0 * (cy - all.minY) / h));
+    }
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    mItems.resize(n);
+    mBoxes.reserve(n + n / static_cast<size_t>(mNodeSize - 1) + 2);
+    for (size_t i = 0; i < n; ++i) {
+        mItems[i] = items[order[i]];
+        mBoxes.push_back(boxes[order[i]]);
+    }
+    mChildStart.assign(n, 0);
+    mLevelEnds.push_back(n);
+
+    // Parent levels, bottom-up, until a single root
+    size_t levelBegin = 0;
+    while (mLevelEnds.back() - levelBegin > 1) {
+        const size_t levelEnd = mLevelEnds.back();
+        for (size_t c = levelBegin; c < levelEnd; c += static_cast<size_t>(mNodeSize)) {
+            const size_t cEnd = std::min(levelEnd, c + static_cast<size_t>(mNodeSize));
+            Box b = mBoxes[c];
+            for (size_t k = c + 1; k < cEnd; ++k) {
+                b.minX = std::min(b.minX, mBoxes[k].minX);
+                b.minY = std::min(b.minY, mBoxes[k].minY);
+                b.maxX = std::max(b.maxX, mBoxes[k].maxX);
+                b.maxY = std::max(b.maxY, mBoxes[k].maxY);
+            }
+            mChildStart.push_back(static_cast<uint32_t>(c));
+            mBoxes.push_back(b);
+        }
+        levelBegin = levelEnd;
+        mLevelEnds.push_back(mBoxes.size());
+    }
+}
+
+LayerIndex::Box LayerIndex::bounds() const {
+    return mBoxes.empty() ? Box{ 0.0f, 0.0f, 0.0f, 0.0f } : mBoxes.back();
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+void LayerIndex::search(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>& out) const {
+    if (mBoxes.empty()) return;
+
+    // (box, level) pairs still to open
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(mBoxes.size() - 1, mLevelEnds.size() - 1);
+    while (!stack.empty()) {
+        const auto [node, level] = stack.back();
+        stack.pop_back();
+        if (!intersects(mBoxes[node], minX, minY, maxX, maxY)) continue;
+        if (level == 0) {
+            out.push_back(static_cast<uint32_t>(node));
+            continue;
+        }
+        const size_t first = mChildStart[node];
+        const size_t last = std::min(first + static_cast<size_t>(mNodeSize), mLevelEnds[level - 1]);
+        for (size_t c = first; c < last; ++c) stack.emplace_back(c, level - 1);
+    }
+}
+
+std::vector<uint32_t> LayerIndex::nearest(double x, double y, size_t maxResults, double maxDistance) const {
+    std::vector<uint32_t> result;
+    if (mBoxes.empty() || maxResults == 0) return result;
+    const double limit2 = maxDistance < 0.0 ? std::numeric_limits<double>::infinity() : maxDistance * maxDistance;
+
+    // Best-first: nodes keyed by box distance, items by exact distance
+    struct Entry {
+        double dist2;
+        size_t index;
+        size_t level;
+        bool operator>(const Entry& o) const { return dist2 > o.dist2; }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    const size_t rootLevel = mLevelEnds.size() - 1;
+    const size_t root = mBoxes.size() - 1;
+    if (rootLevel == 0) {
+        const double d = distance(static_cast<uint32_t>(root), x, y);
+        queue.push(Entry{ d * d, root, 0 });
+    } else {
+        queue.push(Entry{ boxDistance2(mBoxes[root], x, y), root, rootLevel });
+    }
+
+    while (!queue.empty()) {
+        const Entry e = queue.top();
+        queue.pop();
+        if (e.dist2 > limit2) break;
+        if (e.level == 0) {
+            result.push_back(static_cast<uint32_t>(e.index));
+            if (result.size() >= maxResults) break;
+            continue;
+        }
+        const size_t first = mChildStart[e.index];
+        const size_t last = std::min(first + static_cast<size_t>(mNodeSize), mLevelEnds[e.level - 1]);
+        for (size_t c = first; c < last; ++c) {
+            const double boxD2 = boxDistance2(mBoxes[c], x, y);
+            if (boxD2 > limit2) continue;
+            if (e.level - 1 == 0) {
+                const double d = distance(static_cast<uint32_t>(c), x, y);
+                queue.push(Entry{ d * d, c, 0 });
+            } else {
+                queue.push(Entry{ boxD2, c, e.level - 1 });
+            }
+        }
+    }
+    return result;
+}
+
+double LayerIndex::distance(uint32_t id, double x, double y) const {
+    const Item& it = mItems[id];
+    switch (it.kind) {
+    case Kind::Hatch: {
+        const Line& ln = mLayer->hatches[it.geometry].lines[it.element];
+        return std::sqrt(segmentDistance2(x, y, ln.a, ln.b));
+    }
+    case Kind::Polyline:
+        return std::sqrt(pathDistance2(x, y, mLayer->polylines[it.geometry].points, false));
+    case Kind::Polygon:
+        return std::sqrt(pathDistance2(x, y, mLayer->polygons[it.geometry].points, true));
+    case Kind::Circle: {
+        const Circle& c = mLayer->support_circles[it.geometry];
+        return std::max(0.0, std::hypot(x - c.center.x, y - c.center.y) - c.radius);
+    }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+const char* LayerIndex::kindName(Kind kind) {
+    switch (kind) {
+    case Kind::Hatch:    return "hatch";
+    case Kind::Polyline: return "polyline";
+    case Kind::Polygon:  return "polygon";
+    case Kind::Circle:   return "circle";
+    }
+    return "unknown";
+}
+
+} // namespace marc
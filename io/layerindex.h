@@ -0,0 +1,90 @@
+#pragma once
+
+#include "readSlices.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// LayerIndex - Packed Hilbert R-tree over the geometry of one layer
+// ============================================================================
+/**
+ * @brief Static spatial index of a layer for box and nearest-neighbour
+ * queries (picking, region selection, culling, locality ordering).
+ *
+ * DESIGN:
+ * - Items: every hatch vector, every polyline, polygon and support circle
+ *   (one bounding box each). An item refers back into the layer by kind,
+ *   geometry index and, for hatches, line index.
+ * - Packed R-tree: items sorted once by the Hilbert value of their box
+ *   centre (O(n log n)), then grouped bottom-up into nodes of nodeSize.
+ *   Boxes live in one flat array, levels stored leaf first, so the tree is
+ *   a handful of allocations and needs no pointers.
+ * - Leaf order is a locality order: items() walks the layer along the
+ *   Hilbert curve, which makes it a cheap starting point for path ordering
+ *   and work splitting.
+ * - search() visits every item whose box intersects the query box.
+ *   nearest() is best-first over node boxes with exact point-to-geometry
+ *   distances for the items, so results are exact and sorted.
+ * - The index holds a pointer to the layer for exact distances; the layer
+ *   must outlive it and stay unmodified. Queries are const and thread-safe.
+ *
+ * USAGE:
+ *   LayerIndex index(layer);
+ *   std::vector<uint32_t> hits;
+ *   index.search(x0, y0, x1, y1, hits);            // item ids
+ *   for (uint32_t id : index.nearest(x, y, 1)) { const LayerIndex::Item& it = index.item(id); ... }
+ */
+class LayerIndex {
+public:
+    enum class Kind : uint8_t { Hatch, Polyline, Polygon, Circle };
+
+    struct Item {
+        Kind kind = Kind::Hatch;
+        uint32_t geometry = 0;      // index in layer.hatches / polylines / polygons / support_circles
+        uint32_t element = 0;       // line index for hatches, 0 otherwise
+    };
+
+    struct Box {
+        float minX, minY, maxX, maxY;
+    };
+
+    explicit LayerIndex(int nodeSize = 16) : mNodeSize(nodeSize < 2 ? 2 : nodeSize) {}
+    explicit LayerIndex(const Layer& layer, int nodeSize = 16);
+
+    // (Re)build over a layer; previous contents are discarded
+    void build(const Layer& layer);
+
+    size_t size() const { return mItems.size(); }
+    bool empty() const { return mItems.empty(); }
+    const Layer* layer() const { return mLayer; }
+
+    // Items in Hilbert (locality) order; ids are positions in this list
+    const std::vector<Item>& items() const { return mItems; }
+    const Item& item(uint32_t id) const { return mItems[id]; }
+    const Box& itemBox(uint32_t id) const { return mBoxes[id]; }
+    Box bounds() const;
+
+    // Ids of all items whose bounding box intersects [minX, maxX] x [minY, maxY]
+    void search(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>& out) const;
+
+    // Up to maxResults ids nearest to (x, y), closest first, within maxDistance mm
+    std::vector<uint32_t> nearest(double x, double y, size_t maxResults = 1, double maxDistance = -1.0) const;
+
+    // Exact distance from (x, y) to an item's geometry (mm)
+    double distance(uint32_t id, double x, double y) const;
+
+    static const char* kindName(Kind kind);
+
+private:
+    const Layer* mLayer = nullptr;
+    int mNodeSize = 16;
+    std::vector<Item> mItems;
+    std::vector<Box> mBoxes;                // items, then every level's nodes, root last
+    std::vector<uint32_t> mChildStart;      // per box: first child box (items: unused)
+    std::vector<size_t> mLevelEnds;         // end of each level in mBoxes, leaf first
+};
+
+} // namespace marc
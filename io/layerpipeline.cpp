@@ -0,0 +1,145 @@
+#include "layerpipeline.h"
+#include "streamingmarcreader.h"
+#include "diagnostics/trace.h"
+
+#include <algorithm>
+
+namespace marc {
+
+LayerPipeline::LayerPipeline(std::string name, const Settings& settings)
+    : mName(std::move(name)), mSettings(settings)
+{
+    if (mSettings.workers == 0) {
+        mSettings.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (mSettings.maxInFlight == 0) {
+        mSettings.maxInFlight = 2 * static_cast<size_t>(mSettings.workers);
+    }
+}
+
+LayerPipeline::~LayerPipeline() {
+    cancel();
+    wait();
+}
+
+std::string LayerPipeline::errorMessage() const {
+    std::lock_guard<std::mutex> lk(mErrorMutex);
+    return mError;
+}
+
+void LayerPipeline::fail(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lk(mErrorMutex);
+        if (mError.empty()) mError = message;
+    }
+    mFailed.store(true, std::memory_order_relaxed);
+    cancel();
+}
+
+void LayerPipeline::abort(const std::string& message) {
+    fail(message);
+    mFinished.store(true, std::memory_order_release);
+}
+
+// ============================================================================
+// Open / Run / Wait
+// ============================================================================
+
+bool LayerPipeline::open(const std::wstring& marcPath) {
+    try {
+        mFile = std::make_unique<StreamingMarcReader>(marcPath);
+    } catch (const std::exception& e) {
+        abort(std::string("Cannot open MARC file: ") + e.what());
+        return false;
+    }
+    mVersion = mFile->header().version;
+    mTotal.store(mFile->totalLayers(), std::memory_order_relaxed);
+    return true;
+}
+
+void LayerPipeline::run(WorkerFactory makeWorker, std::function<void()> onFinished) {
+    mActiveWorkers.store(mSettings.workers, std::memory_order_relaxed);
+    mReader = std::thread(&LayerPipeline::readerThreadFunc, this);
+    mWorkers.reserve(mSettings.workers);
+    for (unsigned i = 0; i < mSettings.workers; ++i) {
+        mWorkers.emplace_back(&LayerPipeline::workerThreadFunc, this, makeWorker, onFinished);
+    }
+}
+
+bool LayerPipeline::wait() {
+    if (mReader.joinable()) mReader.join();
+    for (auto& w : mWorkers) {
+        if (w.joinable()) w.join();
+    }
+    mWorkers.clear();
+    mFile.reset();
+
+    return !mFailed.load(std::memory_order_relaxed) &&
+           !mCancel.load(std::memory_order_relaxed) &&
+           mDone.load(std::memory_order_relaxed) == mTotal.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Reader: raw layer bytes only (file I/O), bounded hand-off
+// ============================================================================
+
+void LayerPipeline::readerThreadFunc() {
+    trace::setThreadName(mName + " Reader");
+    try {
+        while (mFile->hasNextLayer() && !mCancel.load(std::memory_order_relaxed)) {
+            RawLayer raw;
+            raw.index = mFile->currentLayerIndex();
+            mFile->readNextLayerBytes(raw.bytes);
+
+            std::unique_lock<std::mutex> lk(mQueueMutex);
+            mQueueCv.wait(lk, [this] {
+                return mCancel.load(std::memory_order_relaxed) || mQueue.size() < mSettings.maxInFlight;
+            });
+            if (mCancel.load(std::memory_order_relaxed)) break;
+            mQueue.push_back(std::move(raw));
+            lk.unlock();
+            mQueueCv.notify_all();
+        }
+    } catch (const std::exception& e) {
+        fail(std::string("Read error: ") + e.what());
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mQueueMutex);
+        mReaderDone = true;
+    }
+    mQueueCv.notify_all();
+}
+
+// ============================================================================
+// Workers: one Worker per thread, fully independent per layer
+// ============================================================================
+
+void LayerPipeline::workerThreadFunc(WorkerFactory makeWorker, std::function<void()> onFinished) {
+    trace::setThreadName(mName + " Worker");
+    Worker process = makeWorker();
+    for (;;) {
+        RawLayer raw;
+        {
+            std::unique_lock<std::mutex> lk(mQueueMutex);
+            mQueueCv.wait(lk, [this] {
+                return mCancel.load(std::memory_order_relaxed) || !mQueue.empty() || mReaderDone;
+            });
+            if (mCancel.load(std::memory_order_relaxed) || mQueue.empty()) break;
+            raw = std::move(mQueue.front());
+            mQueue.pop_front();
+        }
+        mQueueCv.notify_all();   // space for the reader
+
+        if (!process(raw)) break;
+        mDone.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Last worker out
+    if (mActiveWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (onFinished) onFinished();
+        mFinished.store(true, std::memory_order_release);
+    }
+}
+
+} // namespace marc
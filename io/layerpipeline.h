@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace marc {
+
+class StreamingMarcReader;
+
+// ============================================================================
+// LayerPipeline - One reader, N workers, bounded queue of raw MARC layers
+// ============================================================================
+/**
+ * @brief Streams the raw layer bytes of a .marc file to a pool of worker
+ * threads; the shared engine of the background jobs (SvgExportJob,
+ * BuildValidator).
+ *
+ * DESIGN:
+ * - One reader thread streams raw layer bytes with StreamingMarcReader
+ *   (the build is never loaded as a whole); decoding is left to the workers.
+ * - Reader and workers share a bounded queue (maxInFlight raw layers), so
+ *   memory stays at a few layers regardless of build size.
+ * - Each worker thread calls the WorkerFactory once and runs the returned
+ *   Worker for every layer it takes, so per-thread state (buffers, scratch
+ *   vectors) lives in the closure. A Worker returns false after fail() to stop.
+ * - The last worker to exit runs the onFinished callback, then isFinished()
+ *   turns true; the owner polls progress through the atomics.
+ * - fail() keeps the first error and cancels the run.
+ *
+ * USAGE:
+ *   LayerPipeline pipeline("SVG", settings);
+ *   if (!pipeline.open(marcPath)) return false;          // header + index table
+ *   pipeline.run([&] { return [&](LayerPipeline::RawLayer& raw) { ...; return true; }; });
+ *   // poll pipeline.layersDone() / pipeline.totalLayers()
+ *   pipeline.wait();
+ */
+class LayerPipeline {
+public:
+    struct Settings {
+        unsigned workers = 0;          // 0 = hardware concurrency
+        size_t maxInFlight = 0;        // queued raw layers, 0 = 2 x workers
+    };
+
+    struct RawLayer {
+        uint32_t index = 0;            // position in the file
+        std::vector<char> bytes;
+    };
+
+    using Worker = std::function<bool(RawLayer& raw)>;
+    using WorkerFactory = std::function<Worker()>;
+
+    LayerPipeline(std::string name, const Settings& settings);
+    ~LayerPipeline();
+
+    LayerPipeline(const LayerPipeline&) = delete;
+    LayerPipeline& operator=(const LayerPipeline&) = delete;
+
+    // Open the file (false, finished and failed if it cannot be opened)
+    bool open(const std::wstring& marcPath);
+
+    // Spawn the reader and the workers; open() must have succeeded
+    void run(WorkerFactory makeWorker, std::function<void()> onFinished = {});
+
+    // Request cancellation (returns immediately; wait() joins)
+    void cancel() { mCancel.store(true, std::memory_order_relaxed); mQueueCv.notify_all(); }
+
+    // Record the first error and cancel the run
+    void fail(const std::string& message);
+
+    // fail() before run(): the run is over without having started
+    void abort(const std::string& message);
+
+    // Join all threads; true when every layer was processed and nothing failed
+    bool wait();
+
+    bool isStarted() const { return mReader.joinable(); }
+    bool isFinished() const { return mFinished.load(std::memory_order_acquire); }
+    bool isCancelled() const { return mCancel.load(std::memory_order_relaxed); }
+    bool hasFailed() const { return mFailed.load(std::memory_order_relaxed); }
+    uint32_t totalLayers() const { return mTotal.load(std::memory_order_relaxed); }
+    uint32_t layersDone() const { return mDone.load(std::memory_order_relaxed); }
+    uint32_t fileVersion() const { return mVersion; }   // for StreamingMarcReader::decodeLayer, set by open()
+    std::string errorMessage() const;
+
+    const Settings& settings() const { return mSettings; }
+
+private:
+    void readerThreadFunc();
+    void workerThreadFunc(WorkerFactory makeWorker, std::function<void()> onFinished);
+
+    const std::string mName;           // thread names: "<name> Reader" / "<name> Worker"
+    Settings mSettings;
+
+    std::unique_ptr<StreamingMarcReader> mFile;
+    uint32_t mVersion = 0;
+    std::thread mReader;
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mQueueMutex;
+    std::condition_variable mQueueCv;          // items available / space available
+    std::deque<RawLayer> mQueue;
+    bool mReaderDone = false;
+
+    std::atomic<bool> mCancel{false};
+    std::atomic<bool> mFailed{false};
+    std::atomic<bool> mFinished{false};
+    std::atomic<uint32_t> mTotal{0};
+    std::atomic<uint32_t> mDone{0};
+    std::atomic<unsigned> mActiveWorkers{0};
+
+    mutable std::mutex mErrorMutex;
+    std::string mError;
+};
+
+} // namespace marc
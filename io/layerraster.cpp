@@ -0,0 +1,382 @@
+#include "layerraster.h"
+#include "diagnostics/trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+
+namespace marc {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Liang-Barsky clip of a segment against [0, w) x [0, h); false if outside
+bool clipSegment(double& x0, double& y0, double& x1, double& y1, double w, double h) {
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    double t0 = 0.0, t1 = 1.0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0, w - x0, y0, h - y0 };
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;
+            continue;
+        }
+        const double r = q[i] / p[i];
+        if (p[i] < 0.0) { if (r > t1) return false; if (r > t0) t0 = r; }
+        else            { if (r < t0) return false; if (r < t1) t1 = r; }
+    }
+    const double nx0 = x0 + t0 * dx, ny0 = y0 + t0 * dy;
+    x1 = x0 + t1 * dx; y1 = y0 + t1 * dy;
+    x0 = nx0; y0 = ny0;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Minimal PNG encoder (8-bit gray, zlib "stored" blocks: no deflate dependency)
+// ----------------------------------------------------------------------------
+
+const std::array<uint32_t, 256>& crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    const auto& t = crcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) crc = t[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    return ~crc;
+}
+
+void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void putChunk(std::vector<uint8_t>& out, const char type[4], const std::vector<uint8_t>& data) {
+    putBE32(out, static_cast<uint32_t>(data.size()));
+    const size_t typeAt = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBE32(out, crc32(0, out.data() + typeAt, out.size() - typeAt));
+}
+
+} // namespace
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+LayerRaster::LayerRaster(const Options& opt)
+    : mOpt(opt)
+{
+    // Tile size must be a power of two (shift/mask addressing)
+    int ts = 16;
+    while (ts < mOpt.tileSize && ts < 4096) ts <<= 1;
+    mOpt.tileSize = ts;
+    if (!(mOpt.pixelsPerMm > 0.0)) mOpt.pixelsPerMm = 20.0;
+}
+
+void LayerRaster::clear() {
+    mLevels.clear();
+    mStats = Stats();
+    mCachedTile = -1;
+    mCachedPixels = nullptr;
+}
+
+// ============================================================================
+// Rendering
+// ============================================================================
+
+void LayerRaster::render(const Layer& layer) {
+    MARC_TRACE_SCOPE("raster", "LayerRaster::render");
+    clear();
+
+    // Plate rectangle: fixed, or the layer's bounding box (+1 mm margin)
+    if (mOpt.plateWidth > 0.0 && mOpt.plateHeight > 0.0) {
+        mPlateMinX = mOpt.plateMinX;
+        mPlateMinY = mOpt.plateMinY;
+        mPlateWidth = mOpt.plateWidth;
+        mPlateHeight = mOpt.plateHeight;
+    } else {
+        double minX = 0, minY = 0, maxX = 0, maxY = 0;
+        bool any = false;
+        auto include = [&](double x, double y) {
+            if (!any) { minX = maxX = x; minY = maxY = y; any = true; return; }
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+        };
+        for (const auto& h : layer.hatches)
+            for (const auto& ln : h.lines) { include(ln.a.x, ln.a.y); include(ln.b.x, ln.b.y); }
+        for (const auto& p : layer.polylines) for (const auto& pt : p.points) include(pt.x, pt.y);
+        for (const auto& p : layer.polygons) for (const auto& pt : p.points) include(pt.x, pt.y);
+        for (const auto& c : layer.support_circles) {
+            include(c.center.x - c.radius, c.center.y - c.radius);
+            include(c.center.x + c.radius, c.center.y + c.radius);
+        }
+        const double margin = 1.0;
+        mPlateMinX = (any ? minX : 0.0) - margin;
+        mPlateMinY = (any ? minY : 0.0) - margin;
+        mPlateWidth = (any ? maxX - minX : 0.0) + 2.0 * margin;
+        mPlateHeight = (any ? maxY - minY : 0.0) + 2.0 * margin;
+    }
+
+    Level base;
+    base.width = std::max(1, static_cast<int>(std::ceil(mPlateWidth * mOpt.pixelsPerMm)));
+    base.height = std::max(1, static_cast<int>(std::ceil(mPlateHeight * mOpt.pixelsPerMm)));
+    base.tilesX = (base.width + mOpt.tileSize - 1) / mOpt.tileSize;
+    base.tilesY = (base.height + mOpt.tileSize - 1) / mOpt.tileSize;
+    mLevels.push_back(std::move(base));
+
+    // Hatches first: contours drawn later win through max() anyway
+    for (const auto& h : layer.hatches) {
+        for (const auto& ln : h.lines) {
+            drawSegment(toPx(ln.a.x), toPy(ln.a.y), toPx(ln.b.x), toPy(ln.b.y), mOpt.hatchValue);
+        }
+    }
+    for (const auto& p : layer.polylines) drawPoints(p.points, false, mOpt.contourValue);
+    for (const auto& p : layer.polygons) drawPoints(p.points, true, mOpt.contourValue);
+    for (const auto& c : layer.support_circles) drawCircle(c, mOpt.circleValue);
+
+    buildPyramid();
+}
+
+uint8_t* LayerRaster::touchTile(Level& level, int tx, int ty) {
+    const uint32_t key = static_cast<uint32_t>(ty) * static_cast<uint32_t>(level.tilesX) + static_cast<uint32_t>(tx);
+    auto it = level.tiles.find(key);
+    if (it == level.tiles.end()) {
+        const size_t n = static_cast<size_t>(mOpt.tileSize) * static_cast<size_t>(mOpt.tileSize);
+        it = level.tiles.emplace(key, std::vector<uint8_t>(n, 0)).first;
+        ++mStats.tiles;
+    }
+    return it->second.data();
+}
+
+void LayerRaster::drawSegment(double x0, double y0, double x1, double y1, uint8_t value) {
+    Level& base = mLevels[0];
+    const double w = static_cast<double>(base.width) - 1e-6;
+    const double h = static_cast<double>(base.height) - 1e-6;
+    if (!clipSegment(x0, y0, x1, y1, w, h)) return;
+    ++mStats.vectors;
+
+    // 16.16 fixed-point DDA along the major axis
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    const int steps = static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy))));
+    const double inv = steps > 0 ? 1.0 / steps : 0.0;
+    int64_t fx = static_cast<int64_t>(x0 * 65536.0);
+    int64_t fy = static_cast<int64_t>(y0 * 65536.0);
+    const int64_t sx = static_cast<int64_t>(dx * inv * 65536.0);
+    const int64_t sy = static_cast<int64_t>(dy * inv * 65536.0);
+
+    int shift = 0;
+    while ((1 << shift) < mOpt.tileSize) ++shift;
+    const int mask = mOpt.tileSize - 1;
+    const int maxX = base.width - 1;
+    const int maxY = base.height - 1;
+
+    for (int i = 0; i <= steps; ++i, fx += sx, fy += sy) {
+        const int px = std::min(static_cast<int>(fx >> 16), maxX);
+        const int py = std::min(static_cast<int>(fy >> 16), maxY);
+        const int tileIndex = (py >> shift) * base.tilesX + (px >> shift);
+        if (tileIndex != mCachedTile) {
+            mCachedPixels = touchTile(base, px >> shift, py >> shift);
+            mCachedTile = tileIndex;
+        }
+        uint8_t& dst = mCachedPixels[((py & mask) << shift) + (px & mask)];
+        dst = std::max(dst, value);
+    }
+    mStats.pixels += static_cast<uint64_t>(steps) + 1;
+}
+
+void LayerRaster::drawPoints(const std::vector<Point>& points, bool closed, uint8_t value) {
+    if (points.empty()) return;
+    for (size_t i = 1; i < points.size(); ++i) {
+        drawSegment(toPx(points[i - 1].x), toPy(points[i - 1].y), toPx(points[i].x), toPy(points[i].y), value);
+    }
+    if (closed && points.size() > 2) {
+        drawSegment(toPx(points.back().x), toPy(points.back().y), toPx(points.front().x), toPy(points.front().y),
+                    value);
+    }
+    if (points.size() == 1) {
+        drawSegment(toPx(points[0].x), toPy(points[0].y), toPx(points[0].x), toPy(points[0].y), value);
+    }
+}
+
+void LayerRaster::drawCircle(const Circle& c, uint8_t value) {
+    // Chord length of ~2 px keeps the outline closed at any radius
+    const double rPx = static_cast<double>(c.radius) * mOpt.pixelsPerMm;
+    const int segments = std::clamp(static_cast<int>(std::ceil(2.0 * kPi * rPx / 2.0)), 8, 1024);
+    double prevX = toPx(c.center.x + c.radius);
+    double prevY = toPy(c.center.y);
+    for (int i = 1; i <= segments; ++i) {
+        const double a = 2.0 * kPi * i / segments;
+        const double x = toPx(c.center.x + c.radius * std::cos(a));
+        const double y = toPy(c.center.y + c.radius * std::sin(a));
+        drawSegment(prevX, prevY, x, y, value);
+        prevX = x;
+        prevY = y;
+    }
+}
+
+// ============================================================================
+// Pyramid
+// ============================================================================
+
+void LayerRaster::buildPyramid() {
+    MARC_TRACE_SCOPE("raster", "LayerRaster::buildPyramid");
+    const int ts = mOpt.tileSize;
+    const int half = ts / 2;
+
+    while (mLevels.back().tilesX > 1 || mLevels.back().tilesY > 1) {
+        const Level& src = mLevels.back();
+        Level dst;
+        dst.width = std::max(1, (src.width + 1) / 2);
+        dst.height = std::max(1, (src.height + 1) / 2);
+        dst.tilesX = (dst.width + ts - 1) / ts;
+        dst.tilesY = (dst.height + ts - 1) / ts;
+
+        for (const auto& entry : src.tiles) {
+            const int sx = static_cast<int>(entry.first % static_cast<uint32_t>(src.tilesX));
+            const int sy = static_cast<int>(entry.first / static_cast<uint32_t>(src.tilesX));
+            uint8_t* out = touchTile(dst, sx / 2, sy / 2);
+            const int ox = (sx & 1) * half;
+            const int oy = (sy & 1) * half;
+            const uint8_t* in = entry.second.data();
+
+            // 2x2 max-reduction, plain loops over contiguous rows (auto-vectorized)
+            for (int y = 0; y < half; ++y) {
+                const uint8_t* r0 = in + (2 * y) * ts;
+                const uint8_t* r1 = r0 + ts;
+                uint8_t* o = out + (oy + y) * ts + ox;
+                for (int x = 0; x < half; ++x) {
+                    const uint8_t a = std::max(r0[2 * x], r0[2 * x + 1]);
+                    const uint8_t b = std::max(r1[2 * x], r1[2 * x + 1]);
+                    o[x] = std::max(a, b);
+                }
+            }
+        }
+        mLevels.push_back(std::move(dst));
+    }
+}
+
+// ============================================================================
+// Access
+// ============================================================================
+
+const uint8_t* LayerRaster::tile(int level, int tx, int ty) const {
+    if (level < 0 || level >= levelCount()) return nullptr;
+    const Level& l = mLevels[level];
+    if (tx < 0 || ty < 0 || tx >= l.tilesX || ty >= l.tilesY) return nullptr;
+    const uint32_t key = static_cast<uint32_t>(ty) * static_cast<uint32_t>(l.tilesX) + static_cast<uint32_t>(tx);
+    auto it = l.tiles.find(key);
+    return it == l.tiles.end() ? nullptr : it->second.data();
+}
+
+int LayerRaster::levelForScale(double screenPixelsPerMm) const {
+    if (mLevels.empty() || !(screenPixelsPerMm > 0.0)) return 0;
+    int level = 0;
+    double levelPixelsPerMm = mOpt.pixelsPerMm;
+    while (level + 1 < levelCount() && levelPixelsPerMm / 2.0 >= screenPixelsPerMm) {
+        levelPixelsPerMm /= 2.0;
+        ++level;
+    }
+    return level;
+}
+
+// ============================================================================
+// PNG export
+// ============================================================================
+
+bool LayerRaster::writeGrayPng(const std::string& path, int width, int height, const uint8_t* pixels,
+                               int stride) {
+    if (width <= 0 || height <= 0) return false;
+
+    // Raw scanlines, each prefixed with filter type 0
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(height) * (static_cast<size_t>(width) + 1));
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        const uint8_t* row = pixels + static_cast<size_t>(y) * static_cast<size_t>(stride);
+        raw.insert(raw.end(), row, row + width);
+    }
+
+    // zlib stream of stored blocks + Adler-32
+    std::vector<uint8_t> z;
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    z.push_back(0x78);
+    z.push_back(0x01);
+    size_t pos = 0;
+    do {
+        const size_t len = std::min<size_t>(65535, raw.size() - pos);
+        const bool last = pos + len == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(static_cast<uint8_t>(len));
+        z.push_back(static_cast<uint8_t>(len >> 8));
+        z.push_back(static_cast<uint8_t>(~len));
+        z.push_back(static_cast<uint8_t>(~len >> 8));
+        z.insert(z.end(), raw.begin() + static_cast<std::ptrdiff_t>(pos),
+                 raw.begin() + static_cast<std::ptrdiff_t>(pos + len));
+        pos += len;
+    } while (pos < raw.size());
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) { a = (a + v) % 65521u; b = (b + a) % 65521u; }
+    putBE32(z, (b << 16) | a);
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, static_cast<uint32_t>(width));
+    putBE32(ihdr, static_cast<uint32_t>(height));
+    ihdr.insert(ihdr.end(), { 8, 0, 0, 0, 0 });   // 8-bit, grayscale, deflate, no filter, no interlace
+    putChunk(png, "IHDR", ihdr);
+    putChunk(png, "IDAT", z);
+    putChunk(png, "IEND", {});
+
+    std::ofstream os(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!os) return false;
+    os.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(os);
+}
+
+bool LayerRaster::exportPng(const std::string& outDir, std::string* error) const {
+    MARC_TRACE_SCOPE("raster", "LayerRaster::exportPng");
+    const int ts = mOpt.tileSize;
+    for (int level = 0; level < levelCount(); ++level) {
+        const Level& l = mLevels[level];
+        const std::string dir = outDir + "/" + std::to_string(level);
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec) {
+            if (error) *error = "Cannot create " + dir + ": " + ec.message();
+            return false;
+        }
+        for (const auto& entry : l.tiles) {
+            const int tx = static_cast<int>(entry.first % static_cast<uint32_t>(l.tilesX));
+            const int ty = static_cast<int>(entry.first / static_cast<uint32_t>(l.tilesX));
+            // Edge tiles are cropped to the level size
+            const int w = std::min(ts, l.width - tx * ts);
+            const int h = std::min(ts, l.height - ty * ts);
+            const std::string path = dir + "/" + std::to_string(tx) + "_" + std::to_string(ty) + ".png";
+            if (!writeGrayPng(path, w, h, entry.second.data(), ts)) {
+                if (error) *error = "Cannot write " + path;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace marc
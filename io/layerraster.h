@@ -0,0 +1,124 @@
+#pragma once
+
+#include "readSlices.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// LayerRaster - Tiled 8-bit raster of a layer with a mipmap pyramid
+// ============================================================================
+/**
+ * @brief CPU rasterizer for marc::Layer, used for previews of layers far too
+ * dense for SVG viewers.
+ *
+ * DESIGN:
+ * - Level 0 is rendered at Options::pixelsPerMm over the plate rectangle and
+ *   split into square tiles of Options::tileSize pixels. Tiles are allocated
+ *   on first touch, so empty plate regions cost nothing.
+ * - Vectors are clipped to the plate once and stepped with a fixed-point DDA
+ *   (one add per pixel, no per-pixel branches besides the tile switch).
+ * - Pixels hold an intensity per geometry kind (hatch < circle < contour),
+ *   combined with max(), so overlapping vectors never saturate or wrap.
+ * - Level n+1 is a 2x2 max-reduction of level n, so thin vectors stay visible
+ *   when zoomed out. Levels stop at the first one that fits in one tile.
+ * - No Qt: tiles can be exported as PNG or wrapped by a viewer as-is.
+ *
+ * USAGE:
+ *   LayerRaster raster;                  // or LayerRaster(options)
+ *   raster.render(layer);
+ *   raster.exportPng("preview/layer_12"); // <dir>/<level>/<tx>_<ty>.png
+ *   const uint8_t* px = raster.tile(level, tx, ty);   // nullptr = empty tile
+ */
+class LayerRaster {
+public:
+    struct Options {
+        double pixelsPerMm = 20.0;     // level-0 resolution (50 um pixels)
+        int tileSize = 256;            // tile edge in pixels (power of two)
+        double plateMinX = 0.0;        // plate rectangle in mm; width/height 0 =
+        double plateMinY = 0.0;        //   fit the layer's bounding box
+        double plateWidth = 0.0;
+        double plateHeight = 0.0;
+        uint8_t hatchValue = 110;
+        uint8_t contourValue = 255;
+        uint8_t circleValue = 200;
+    };
+
+    struct Stats {
+        uint64_t vectors = 0;          // segments drawn (after clipping)
+        uint64_t pixels = 0;           // pixels stepped at level 0
+        uint64_t tiles = 0;            // allocated tiles over all levels
+    };
+
+    LayerRaster() : LayerRaster(Options()) {}
+    explicit LayerRaster(const Options& opt);
+
+    // Rasterize a layer (replaces previous content) and build the pyramid
+    void render(const Layer& layer);
+    void clear();
+
+    // Geometry of the pyramid
+    int levelCount() const { return static_cast<int>(mLevels.size()); }
+    int tileSize() const { return mOpt.tileSize; }
+    int width(int level) const { return mLevels[level].width; }
+    int height(int level) const { return mLevels[level].height; }
+    int tilesX(int level) const { return mLevels[level].tilesX; }
+    int tilesY(int level) const { return mLevels[level].tilesY; }
+
+    // tileSize x tileSize pixels, row-major, row 0 at the top; nullptr if empty
+    const uint8_t* tile(int level, int tx, int ty) const;
+
+    // Coarsest level that still has one raster pixel per screen pixel (for viewers)
+    int levelForScale(double screenPixelsPerMm) const;
+
+    // Plate mapping (mm, Y up) -> level-0 pixel (Y down)
+    double pixelsPerMm() const { return mOpt.pixelsPerMm; }
+    double plateMinX() const { return mPlateMinX; }
+    double plateMinY() const { return mPlateMinY; }
+    double plateWidth() const { return mPlateWidth; }
+    double plateHeight() const { return mPlateHeight; }
+
+    const Stats& stats() const { return mStats; }
+
+    // Write every non-empty tile as <outDir>/<level>/<tx>_<ty>.png (8-bit gray)
+    bool exportPng(const std::string& outDir, std::string* error = nullptr) const;
+
+    static bool writeGrayPng(const std::string& path, int width, int height, const uint8_t* pixels,
+                             int stride);
+
+private:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        int tilesX = 0;
+        int tilesY = 0;
+        std::unordered_map<uint32_t, std::vector<uint8_t>> tiles;   // key = ty * tilesX + tx
+    };
+
+    uint8_t* touchTile(Level& level, int tx, int ty);
+    void drawSegment(double x0, double y0, double x1, double y1, uint8_t value);
+    void drawPoints(const std::vector<Point>& points, bool closed, uint8_t value);
+    void drawCircle(const Circle& c, uint8_t value);
+    void buildPyramid();
+
+    double toPx(double mmX) const { return (mmX - mPlateMinX) * mOpt.pixelsPerMm; }
+    double toPy(double mmY) const { return (mPlateMinY + mPlateHeight - mmY) * mOpt.pixelsPerMm; }
+
+    Options mOpt;
+    double mPlateMinX = 0.0;
+    double mPlateMinY = 0.0;
+    double mPlateWidth = 0.0;
+    double mPlateHeight = 0.0;
+    std::vector<Level> mLevels;
+    Stats mStats;
+
+    // Last tile written by drawSegment (vectors rarely cross tiles)
+    int mCachedTile = -1;
+    uint8_t* mCachedPixels = nullptr;
+};
+
+} // namespace marc
@@ -0,0 +1,125 @@
+#include "marcanalysisjob.h"
+#include "streamingmarcreader.h"
+#include "diagnostics/trace.h"
+
+#include <iterator>
+
+namespace marc {
+
+MarcAnalysisJob::MarcAnalysisJob(const std::wstring& marcPath)
+    : mMarcPath(marcPath) {}
+
+MarcAnalysisJob::~MarcAnalysisJob() {
+    cancel();
+    wait();
+}
+
+std::string MarcAnalysisJob::errorMessage() const {
+    std::lock_guard<std::mutex> lk(mErrorMutex);
+    return mError;
+}
+
+void MarcAnalysisJob::fail(const std::string& message) {
+    {
+        std::lock_guard<std::mutex> lk(mErrorMutex);
+        if (mError.empty()) mError = message;
+    }
+    mFailed.store(true, std::memory_order_relaxed);
+}
+
+size_t MarcAnalysisJob::takeLayers(std::vector<LayerSummary>& out) {
+    std::lock_guard<std::mutex> lk(mLayersMutex);
+    const size_t n = mPending.size();
+    out.insert(out.end(), std::make_move_iterator(mPending.begin()), std::make_move_iterator(mPending.end()));
+    mPending.clear();
+    return n;
+}
+
+LayerSummary MarcAnalysisJob::summarize(const char* data, std::size_t size, uint32_t version) {
+    const Layer layer = StreamingMarcReader::decodeLayer(data, size, version);
+
+    LayerSummary s;
+    s.layerNumber = layer.layerNumber;
+    s.layerHeight = layer.layerHeight;
+    s.layerThickness = layer.layerThickness;
+    s.hatches = static_cast<uint32_t>(layer.hatches.size());
+    s.polylines = static_cast<uint32_t>(layer.polylines.size());
+    s.polygons = static_cast<uint32_t>(layer.polygons.size());
+    s.circles = static_cast<uint32_t>(layer.support_circles.size());
+
+    // Marks as LayerConverter emits them (polygons get a closing mark)
+    uint64_t vectors = s.circles;
+    for (const auto& h : layer.hatches) vectors += h.lines.size();
+    for (const auto& pl : layer.polylines) {
+        if (pl.points.size() > 1) vectors += pl.points.size() - 1;
+    }
+    for (const auto& pg : layer.polygons) {
+        if (pg.points.size() > 1) vectors += pg.points.size();
+    }
+    s.vectorCount = vectors;
+    return s;
+}
+
+// ============================================================================
+// Start / Wait
+// ============================================================================
+
+bool MarcAnalysisJob::start() {
+    if (mThread.joinable()) return false;   // already started
+
+    try {
+        mFile = std::make_unique<StreamingMarcReader>(mMarcPath);
+    } catch (const std::exception& e) {
+        fail(std::string("Cannot open MARC file: ") + e.what());
+        mFinished.store(true, std::memory_order_release);
+        return false;
+    }
+    mTotal.store(mFile->totalLayers(), std::memory_order_relaxed);
+    mThread = std::thread(&MarcAnalysisJob::threadFunc, this);
+    return true;
+}
+
+bool MarcAnalysisJob::wait() {
+    if (mThread.joinable()) mThread.join();
+    mFile.reset();
+
+    return !mFailed.load(std::memory_order_relaxed) &&
+           !mCancel.load(std::memory_order_relaxed) &&
+           mAnalysed.load(std::memory_order_relaxed) == mTotal.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Worker: read + decode one layer at a time, publish its summary
+// ============================================================================
+
+void MarcAnalysisJob::threadFunc() {
+    trace::setThreadName("MARC Analysis");
+    std::vector<char> bytes;   // reused, grows to the largest layer
+    try {
+        while (mFile->hasNextLayer() && !mCancel.load(std::memory_order_relaxed)) {
+            const uint32_t index = mFile->currentLayerIndex();
+            const uint64_t offset = mFile->layerOffset(index);
+            mFile->readNextLayerBytes(bytes);
+
+            LayerSummary s;
+            try {
+                s = summarize(bytes.data(), bytes.size(), mFile->header().version);
+            } catch (const std::exception&) {
+                s.readable = false;
+            }
+            s.index = index;
+            s.fileOffset = offset;
+
+            {
+                std::lock_guard<std::mutex> lk(mLayersMutex);
+                mPending.push_back(s);
+            }
+            mAnalysed.fetch_add(1, std::memory_order_relaxed);
+        }
+    } catch (const std::exception& e) {
+        fail(std::string("Read error: ") + e.what());
+    }
+    mFinished.store(true, std::memory_order_release);
+}
+
+} // namespace marc
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace marc {
+
+class StreamingMarcReader;
+
+// ============================================================================
+// LayerSummary - What the project view needs to know about one layer
+// ============================================================================
+struct LayerSummary {
+    uint32_t index = 0;             // position in the file
+    uint32_t layerNumber = 0;
+    uint64_t fileOffset = 0;        // from the index table, 0 when the file has none
+    float layerHeight = 0.0f;
+    float layerThickness = 0.0f;
+    uint32_t hatches = 0;
+    uint32_t polylines = 0;
+    uint32_t polygons = 0;
+    uint32_t circles = 0;
+    uint64_t vectorCount = 0;       // hatch lines + polyline segments + polygon edges + circles
+    bool readable = true;           // false: bytes did not decode, counts are 0
+};
+
+// ============================================================================
+// MarcAnalysisJob - Background, cancellable scan of a .marc file
+// ============================================================================
+/**
+ * @brief Reads every layer of a .marc file once on a worker thread and hands
+ * out per-layer summaries as they are produced, so a project opens at once
+ * and its layer list fills in while the user works.
+ *
+ * DESIGN:
+ * - start() only reads the header and index table (total layers known right
+ *   away); the thread streams layer bytes with StreamingMarcReader and decodes
+ *   them one at a time, nothing but the summaries is kept.
+ * - One thread: the scan is I/O bound and must not compete with a running
+ *   build or the pre-flight check for cores.
+ * - Summaries are appended under a mutex; takeLayers() moves out everything
+ *   produced since the previous call, in file order, so the owner (GUI poll
+ *   timer) updates its model incrementally.
+ * - A layer that fails to decode is reported as unreadable and skipped; only
+ *   a read error ends the scan early. cancel() stops at the next layer.
+ *
+ * USAGE:
+ *   MarcAnalysisJob job(marcPath);
+ *   job.start();
+ *   // periodically: job.takeLayers(batch); job.layersAnalysed() / job.totalLayers()
+ *   if (job.isFinished()) job.wait();
+ */
+class MarcAnalysisJob {
+public:
+    explicit MarcAnalysisJob(const std::wstring& marcPath);
+    ~MarcAnalysisJob();
+
+    MarcAnalysisJob(const MarcAnalysisJob&) = delete;
+    MarcAnalysisJob& operator=(const MarcAnalysisJob&) = delete;
+
+    // Open the file and spawn the thread (false if the file cannot be opened)
+    bool start();
+
+    // Request cancellation (returns immediately; wait() joins)
+    void cancel() { mCancel.store(true, std::memory_order_relaxed); }
+
+    // Join the thread; true when every layer was scanned
+    bool wait();
+
+    bool isFinished() const { return mFinished.load(std::memory_order_acquire); }
+    bool isCancelled() const { return mCancel.load(std::memory_order_relaxed); }
+    uint32_t totalLayers() const { return mTotal.load(std::memory_order_relaxed); }
+    uint32_t layersAnalysed() const { return mAnalysed.load(std::memory_order_relaxed); }
+    std::string errorMessage() const;
+
+    // Append the summaries produced since the last call to out; returns how many
+    size_t takeLayers(std::vector<LayerSummary>& out);
+
+    static LayerSummary summarize(const char* data, std::size_t size, uint32_t version);
+
+private:
+    void threadFunc();
+    void fail(const std::string& message);
+
+    const std::wstring mMarcPath;
+    std::unique_ptr<StreamingMarcReader> mFile;
+    std::thread mThread;
+
+    std::mutex mLayersMutex;
+    std::vector<LayerSummary> mPending;
+
+    std::atomic<bool> mCancel{false};
+    std::atomic<bool> mFailed{false};
+    std::atomic<bool> mFinished{false};
+    std::atomic<uint32_t> mTotal{0};
+    std::atomic<uint32_t> mAnalysed{0};
+
+    mutable std::mutex mErrorMutex;
+    std::string mError;
+};
+
+} // namespace marc
@@ -0,0 +1,370 @@
+#include "partexcluder.h"
+#include "diagnostics/trace.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace marc {
+
+namespace {
+
+using Interval = std::pair<double, double>;
+
+// Pieces shorter than this (mm) are not worth a jump + mark
+constexpr double kMinPieceMM = 1e-4;
+
+struct Bounds {
+    double minX, minY, maxX, maxY;
+    bool overlaps(double x0, double y0, double x1, double y1) const {
+        return x0 <= maxX && x1 >= minX && y0 <= maxY && y1 >= minY;
+    }
+};
+
+bool inside(const PartExcluder::Region& r, double x, double y) {
+    return x >= r.minX && x <= r.maxX && y >= r.minY && y <= r.maxY;
+}
+
+// Parameter interval of segment a + t * d (t in [0, 1]) inside a closed rectangle
+bool insideInterval(const PartExcluder::Region& r, double ax, double ay, double dx, double dy, Interval& out) {
+    double t0 = 0.0, t1 = 1.0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { ax - r.minX, r.maxX - ax, ay - r.minY, r.maxY - ay };
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) { if (q[i] < 0.0) return false; continue; }
+        const double t = q[i] / p[i];
+        if (p[i] < 0.0) { if (t > t1) return false; t0 = std::max(t0, t); }
+        else            { if (t < t0) return false; t1 = std::min(t1, t); }
+    }
+    if (t1 <= t0) return false;     // touches a corner or an edge only
+    out = { t0, t1 };
+    return true;
+}
+
+// Cuts segments against the union of the regions
+class SegmentCutter {
+public:
+    explicit SegmentCutter(const std::vector<PartExcluder::Region>& regions) : mRegions(regions) {
+        mAll = Bounds{ regions[0].minX, regions[0].minY, regions[0].maxX, regions[0].maxY };
+        for (const auto& r : regions) {
+            mAll.minX = std::min(mAll.minX, r.minX);
+            mAll.minY = std::min(mAll.minY, r.minY);
+            mAll.maxX = std::max(mAll.maxX, r.maxX);
+            mAll.maxY = std::max(mAll.maxY, r.maxY);
+        }
+    }
+
+    bool mayTouch(double x0, double y0, double x1, double y1) const { return mAll.overlaps(x0, y0, x1, y1); }
+
+    // Parameter intervals of a -> b outside every region, ascending. Returns
+    // false when the segment is untouched (keep == { {0, 1} }).
+    bool cut(const Point& a, const Point& b, std::vector<Interval>& keep) {
+        keep.clear();
+        const double ax = a.x, ay = a.y;
+        const double dx = static_cast<double>(b.x) - ax, dy = static_cast<double>(b.y) - ay;
+        if (!mayTouch(std::min(ax, ax + dx), std::min(ay, ay + dy), std::max(ax, ax + dx), std::max(ay, ay + dy))) {
+            keep.emplace_back(0.0, 1.0);
+            return false;
+        }
+        const double length = std::hypot(dx, dy);
+        if (length == 0.0) {
+            for (const auto& r : mRegions) {
+                if (inside(r, ax, ay)) return true;
+            }
+            keep.emplace_back(0.0, 1.0);
+            return false;
+        }
+
+        mCuts.clear();
+        Interval in;
+        for (const auto& r : mRegions) {
+            if (insideInterval(r, ax, ay, dx, dy, in)) mCuts.push_back(in);
+        }
+        if (mCuts.empty()) {
+            keep.emplace_back(0.0, 1.0);
+            return false;
+        }
+        std::sort(mCuts.begin(), mCuts.end());
+
+        // Complement of the merged cuts, dropping slivers
+        const double minT = kMinPieceMM / length;
+        double t = 0.0;
+        for (const Interval& c : mCuts) {
+            if (c.first > t && c.first - t > minT) keep.emplace_back(t, c.first);
+            t = std::max(t, c.second);
+        }
+        if (t < 1.0 && 1.0 - t > minT) keep.emplace_back(t, 1.0);
+        return true;
+    }
+
+private:
+    const std::vector<PartExcluder::Region>& mRegions;
+    Bounds mAll{};
+    std::vector<Interval> mCuts;
+};
+
+Point lerp(const Point& a, const Point& b, double t) {
+    if (t <= 0.0) return a;
+    if (t >= 1.0) return b;
+    return Point{ static_cast<float>(a.x + t * (static_cast<double>(b.x) - a.x)),
+                  static_cast<float>(a.y + t * (static_cast<double>(b.y) - a.y)) };
+}
+
+// Splits a path into the runs outside the regions. Returns false when no
+// segment was cut (runs untouched).
+bool cutPath(const std::vector<Point>& pts, bool closed, SegmentCutter& cutter,
+             std::vector<Interval>& keep, std::vector<std::vector<Point>>& runs) {
+    runs.clear();
+    const size_t n = pts.size();
+    const size_t segments = closed ? n : n - 1;
+    bool cutAny = false;
+    bool open = false;              // last run reaches the end of the previous segment
+    bool startsAtZero = false;      // first run starts at the first vertex
+    std::vector<Point> run;
+    auto flush = [&] {
+        if (run.size() >= 2) runs.push_back(std::move(run));
+        run.clear();
+    };
+
+    for (size_t i = 0; i < segments; ++i) {
+        const Point& a = pts[i];
+        const Point& b = pts[(i + 1) % n];
+        cutAny |= cutter.cut(a, b, keep);
+        const bool cont = open;
+        open = false;
+        for (const Interval& k : keep) {
+            if (k.first > 0.0 || !cont || run.empty()) {
+                flush();
+                run.push_back(lerp(a, b, k.first));
+                if (i == 0 && k.first == 0.0) startsAtZero = true;
+            }
+            run.push_back(lerp(a, b, k.second));
+            open = k.second >= 1.0;
+        }
+    }
+    flush();
+
+    // A ring whose first and last runs meet at the first vertex is one run
+    if (closed && cutAny && open && startsAtZero && runs.size() >= 2) {
+        std::vector<Point> joined = std::move(runs.back());
+        runs.pop_back();
+        joined.insert(joined.end(), runs.front().begin() + 1, runs.front().end());
+        runs.front() = std::move(joined);
+    }
+    return cutAny;
+}
+
+Bounds boundsOf(const std::vector<Point>& pts) {
+    Bounds b{ pts[0].x, pts[0].y, pts[0].x, pts[0].y };
+    for (const Point& p : pts) {
+        b.minX = std::min(b.minX, static_cast<double>(p.x));
+        b.minY = std::min(b.minY, static_cast<double>(p.y));
+        b.maxX = std::max(b.maxX, static_cast<double>(p.x));
+        b.maxY = std::max(b.maxY, static_cast<double>(p.y));
+    }
+    return b;
+}
+
+} // namespace
+
+// ============================================================================
+// Rules
+// ============================================================================
+
+void PartExcluder::setRules(Rules rules) {
+    auto next = std::make_shared<const Rules>(std::move(rules));
+    std::lock_guard<std::mutex> lk(mMutex);
+    mRules = std::move(next);
+    ++mRevision;
+}
+
+std::shared_ptr<const PartExcluder::Rules> PartExcluder::rules() const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mRules;
+}
+
+uint64_t PartExcluder::revision() const {
+    std::lock_guard<std::mutex> lk(mMutex);
+    return mRevision;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+bool PartExcluder::saveRules(const Rules& rules, const std::string& path, std::string* error) {
+    nlohmann::json doc;
+    doc["fromLayer"] = rules.fromLayer;
+    doc["geometryTypes"] = rules.geometryTypes;
+    doc["regions"] = nlohmann::json::array();
+    for (const Region& r : rules.regions) {
+        doc["regions"].push_back({ {"minX", r.minX}, {"minY", r.minY}, {"maxX", r.maxX}, {"maxY", r.maxY},
+                                   {"label", r.label} });
+    }
+
+    // A crash mid-write leaves the previous file intact
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::out | std::ios::trunc);
+        out << doc.dump(2) << '\n';
+        out.flush();
+        if (!out) {
+            if (error) *error = "cannot write " + tmp;
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        if (error) *error = "cannot replace " + path + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+bool PartExcluder::loadRules(const std::string& path, Rules& rules, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    try {
+        const nlohmann::json doc = nlohmann::json::parse(in);
+        Rules parsed;
+        parsed.fromLayer = doc.value("fromLayer", parsed.fromLayer);
+        parsed.geometryTypes = doc.value("geometryTypes", parsed.geometryTypes);
+        for (const auto& r : doc.value("regions", nlohmann::json::array())) {
+            Region region;
+            region.minX = r.at("minX").get<double>();
+            region.minY = r.at("minY").get<double>();
+            region.maxX = r.at("maxX").get<double>();
+            region.maxY = r.at("maxY").get<double>();
+            region.label = r.value("label", std::string());
+            parsed.regions.push_back(std::move(region));
+        }
+        rules = std::move(parsed);
+        return true;
+    } catch (const std::exception& e) {
+        if (error) *error = path + ": " + e.what();
+        return false;
+    }
+}
+
+// ============================================================================
+// Apply
+// ============================================================================
+
+PartExcluder::Stats PartExcluder::apply(Layer& layer) const {
+    const auto snapshot = rules();
+    if (!snapshot || snapshot->empty()) return Stats{};
+    return apply(*snapshot, layer);
+}
+
+PartExcluder::Stats PartExcluder::apply(const Rules& rules, Layer& layer) {
+    Stats st;
+    if (rules.empty() || layer.layerNumber < rules.fromLayer) return st;
+    MARC_TRACE_SCOPE("exclude", "PartExcluder::apply");
+
+    // Geometry types first: no point in cutting what is removed anyway
+    if (!rules.geometryTypes.empty()) {
+        auto excluded = [&](const GeometryTag& tag) {
+            return std::find(rules.geometryTypes.begin(), rules.geometryTypes.end(), tag.type) != rules.geometryTypes.end();
+        };
+        auto eraseExcluded = [&](auto& geometries) {
+            const size_t before = geometries.size();
+            geometries.erase(std::remove_if(geometries.begin(), geometries.end(),
+                                            [&](const auto& g) { return excluded(g.tag); }),
+                             geometries.end());
+            st.removed += before - geometries.size();
+        };
+        eraseExcluded(layer.hatches);
+        eraseExcluded(layer.polylines);
+        eraseExcluded(layer.polygons);
+        eraseExcluded(layer.support_circles);
+    }
+    if (rules.regions.empty()) return st;
+
+    SegmentCutter cutter(rules.regions);
+    std::vector<Interval> keep;
+
+    // Hatches: vector by vector
+    std::vector<Line> lines;
+    for (Hatch& h : layer.hatches) {
+        lines.clear();
+        bool cut = false;
+        for (const Line& ln : h.lines) {
+            if (!cutter.cut(ln.a, ln.b, keep)) {
+                lines.push_back(ln);
+                continue;
+            }
+            cut = true;
+            for (const Interval& k : keep) lines.push_back(Line{ lerp(ln.a, ln.b, k.first), lerp(ln.a, ln.b, k.second) });
+        }
+        if (!cut) continue;
+        h.lines.swap(lines);
+        h.tag.pointCount = static_cast<uint32_t>(h.lines.size() * 2);
+        if (!h.lines.empty()) ++st.clipped;
+    }
+    const size_t hatchesBefore = layer.hatches.size();
+    layer.hatches.erase(std::remove_if(layer.hatches.begin(), layer.hatches.end(),
+                                       [](const Hatch& h) { return h.lines.empty(); }),
+                        layer.hatches.end());
+    st.removed += hatchesBefore - layer.hatches.size();
+
+    // Contours: runs outside the regions
+    std::vector<std::vector<Point>> runs;
+    std::vector<Polyline> polylines;
+    polylines.reserve(layer.polylines.size());
+    auto emitRuns = [&](const GeometryTag& tag) {
+        if (runs.empty()) { ++st.removed; return; }
+        ++st.clipped;
+        for (auto& r : runs) {
+            Polyline pl{};
+            pl.tag = tag;
+            pl.tag.category = 2;
+            pl.tag.pointCount = static_cast<uint32_t>(r.size());
+            pl.points = std::move(r);
+            polylines.push_back(std::move(pl));
+        }
+    };
+    auto untouched = [&](const std::vector<Point>& pts) {
+        const Bounds b = boundsOf(pts);
+        return !cutter.mayTouch(b.minX, b.minY, b.maxX, b.maxY);
+    };
+
+    for (Polyline& p : layer.polylines) {
+        if (p.points.size() < 2 || untouched(p.points) || !cutPath(p.points, false, cutter, keep, runs)) {
+            polylines.push_back(std::move(p));
+            continue;
+        }
+        emitRuns(p.tag);
+    }
+    std::vector<Polygon> polygons;
+    polygons.reserve(layer.polygons.size());
+    for (Polygon& p : layer.polygons) {
+        if (p.points.size() < 2 || untouched(p.points) || !cutPath(p.points, true, cutter, keep, runs)) {
+            polygons.push_back(std::move(p));
+            continue;
+        }
+        emitRuns(p.tag);
+    }
+    layer.polylines.swap(polylines);
+    layer.polygons.swap(polygons);
+
+    // Point exposures: by centre
+    const size_t circlesBefore = layer.support_circles.size();
+    layer.support_circles.erase(
+        std::remove_if(layer.support_circles.begin(), layer.support_circles.end(), [&](const Circle& c) {
+            return std::any_of(rules.regions.begin(), rules.regions.end(),
+                               [&](const Region& r) { return inside(r, c.center.x, c.center.y); });
+        }),
+        layer.support_circles.end());
+    st.removed += circlesBefore - layer.support_circles.size();
+    return st;
+}
+
+} // namespace marc
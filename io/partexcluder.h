@@ -0,0 +1,90 @@
+#pragma once
+
+#include "readSlices.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// PartExcluder - Exclusion of plate regions / geometry types during a build
+// ============================================================================
+/**
+ * @brief Removes everything that would be exposed inside excluded regions, or
+ * belongs to excluded geometry types, from the layers the producer converts,
+ * so a failed part can be dropped mid-build without restarting the job.
+ *
+ * DESIGN:
+ * - Rules are an immutable snapshot behind a shared_ptr. setRules() swaps it
+ *   from any thread; apply() takes one reference per layer, so rules never
+ *   change half way through a layer and an empty rule set costs one lock.
+ * - Regions are axis-aligned rectangles in plate mm. Every vector is cut
+ *   against all regions at once (Liang-Barsky parameter intervals, merged),
+ *   and only the pieces outside every region are kept:
+ *     hatches   -> shorter vectors, empty hatches removed
+ *     polylines -> split into the runs outside the regions
+ *     polygons  -> unchanged when untouched, otherwise their outside runs
+ *                  become open polylines (same tag)
+ *     circles   -> removed when the centre lies in a region
+ * - Geometry types (GeometryTag::type) are removed whole, wherever they are.
+ * - Rules apply to layers numbered fromLayer and up. Changes take effect at
+ *   the next layer the producer converts; a layer already queued is scanned
+ *   as converted.
+ * - saveRules() / loadRules() keep the active rules as JSON in the build's
+ *   report folder (kFileName), so a resumed build excludes the same parts.
+ *
+ * USAGE:
+ *   PartExcluder::Rules rules;
+ *   rules.regions.push_back({ 10.0, 10.0, 30.0, 30.0, "part 3" });
+ *   excluder.setRules(rules);     // GUI / API thread
+ *   excluder.apply(layer);        // producer, last step before conversion
+ */
+class PartExcluder {
+public:
+    static constexpr const char* kFileName = "part_exclusions.json";
+
+    struct Region {
+        double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;  // mm
+        std::string label;
+    };
+
+    struct Rules {
+        std::vector<Region> regions;
+        std::vector<uint32_t> geometryTypes;    // excluded GeometryTag::type values
+        uint32_t fromLayer = 0;                 // first layer number the rules apply to
+
+        bool empty() const { return regions.empty() && geometryTypes.empty(); }
+    };
+
+    // Result of one apply() call
+    struct Stats {
+        size_t removed = 0;         // geometries removed whole (type, fully inside, circle centre)
+        size_t clipped = 0;         // geometries cut at a region border, partly kept
+    };
+
+    // Any thread
+    void setRules(Rules rules);
+    void clear() { setRules(Rules{}); }
+    std::shared_ptr<const Rules> rules() const;
+    uint64_t revision() const;      // increments with every setRules()
+
+    // Producer: apply the current rules to a layer in place
+    Stats apply(Layer& layer) const;
+    static Stats apply(const Rules& rules, Layer& layer);
+
+    // Rules as JSON; written to a temporary file that replaces path
+    static bool saveRules(const Rules& rules, const std::string& path, std::string* error = nullptr);
+    // False when the file cannot be read or is malformed (rules untouched)
+    static bool loadRules(const std::string& path, Rules& rules, std::string* error = nullptr);
+
+private:
+    mutable std::mutex mMutex;      // guards the pointer only
+    std::shared_ptr<const Rules> mRules;
+    uint64_t mRevision = 0;
+};
+
+} // namespace marc
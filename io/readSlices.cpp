@@ -1,4 +1,5 @@
 #include "readSlices.h"
+#include "diagnostics/trace.h"
 
 #include <cstring>
 #include <fstream>
@@ -23,6 +24,7 @@ bool readSlices::open(const std::string& path) {
 }
 
 bool readSlices::open(const std::wstring& path) {
+    MARC_TRACE_SCOPE("marc", "readSlices::open");
     m_path = std::filesystem::path(path);
     m_layers.clear();
 
@@ -116,17 +118,41 @@ Polygon readSlices::readPolygon(std::ifstream& is) {
     return p;
 }
 
-Circle readSlices::readCircle(std::ifstream& is) {
+Circle readSlices::readCircle(std::ifstream& is, const GeometryTag& tag) {
     Circle c{};
-    c.tag = readGeometryTag(is);
+    c.tag = tag;
     readPod(is, c.center);
     readPod(is, c.radius);
     return c;
 }
 
+void readSlices::readPointGeometry(std::ifstream& is, Layer& layer) {
+    uint32_t count = 0;
+    readPod(is, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const GeometryTag tag = readGeometryTag(is);
+        if (tag.category == 4) {
+            layer.support_circles.emplace_back(readCircle(is, tag));
+        } else if (tag.category == 5) {
+            // Point set: one zero-radius circle per point
+            for (uint32_t k = 0; k < tag.pointCount; ++k) {
+                Circle c{};
+                c.tag = tag;
+                c.tag.pointCount = 1;
+                readPod(is, c.center);
+                c.radius = 0.0f;
+                layer.support_circles.push_back(c);
+            }
+        } else {
+            throw std::runtime_error("Unknown point geometry category");
+        }
+    }
+}
+
 Layer readSlices::readLayer(std::ifstream& is) {
     Layer L{};
     // Writer serializes: layerNumber, layerHeight, hatchCount, [hatches], polylineCount, [polylines], polygonCount, [polygons]
+    // and, from kMarcPointGeometryVersion on, pointGeometryCount, [circles / point sets]
     readPod(is, L.layerNumber);
     readPod(is, L.layerHeight);
     L.layerThickness = 0.0f; // not serialized in this version
@@ -155,8 +181,11 @@ Layer readSlices::readLayer(std::ifstream& is) {
         L.polygons.emplace_back(readPolygon(is));
     }
 
-    // No circles serialized by writer
+    // Circles and point sets
     L.support_circles.clear();
+    if (m_header.version >= kMarcPointGeometryVersion) {
+        readPointGeometry(is, L);
+    }
 
     return L;
 }
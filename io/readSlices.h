@@ -39,16 +39,23 @@ struct Line {
 
 struct GeometryTag {
     uint32_t type;       // Subtype (015)
-    uint32_t category;   // 1=hatch, 2=polyline, 3=polygon, 4=point (circle)
+    uint32_t category;   // 1=hatch, 2=polyline, 3=polygon, 4=point (circle), 5=point set
     uint32_t pointCount; // Total number of points
 };
 
+// Radius 0 is a single point exposure (point sets are stored as one Circle per point)
 struct Circle {
     GeometryTag tag;  // Geometry metadata
     Point center;
     float radius;
 };
 
+// From this version on every layer ends with a point geometry group:
+// count, then per entry a GeometryTag and its payload
+//   category 4: Point center, float radius
+//   category 5: pointCount x Point
+constexpr uint32_t kMarcPointGeometryVersion = 2;
+
 struct Hatch {
     GeometryTag tag;             // Geometry metadata
     std::vector<Line> lines;     // Vector of line segments
@@ -112,7 +119,8 @@ private:
     Hatch readHatch(std::ifstream& is);
     Polyline readPolyline(std::ifstream& is);
     Polygon readPolygon(std::ifstream& is);
-    Circle readCircle(std::ifstream& is);
+    Circle readCircle(std::ifstream& is, const GeometryTag& tag);
+    void readPointGeometry(std::ifstream& is, Layer& layer);
     Layer readLayer(std::ifstream& is);
 
     std::filesystem::path m_path;
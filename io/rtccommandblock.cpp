@@ -1,5 +1,6 @@
 #include "rtccommandblock.h"
 #include <algorithm>
+#include <cmath>
 
 namespace marc {
 
@@ -32,4 +33,81 @@ void RTCCommandBlock::addParameterSegment(uint32_t buildStyleId,
     parameterSegments.push_back(seg);
 }
 
+double RTCCommandBlock::estimateSeconds(double bitsPerMM) const {
+    if (bitsPerMM <= 0.0) return 0.0;
+    double seconds = 0.0;
+    double x = 0.0, y = 0.0;
+    size_t segIdx = 0;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        // Segments are ordered by command index; walk them alongside
+        while (segIdx < parameterSegments.size() && parameterSegments[segIdx].endCmd < i) ++segIdx;
+        const ParameterSegment* seg = (segIdx < parameterSegments.size() && parameterSegments[segIdx].startCmd <= i)
+            ? &parameterSegments[segIdx] : nullptr;
+
+        const Command& c = commands[i];
+        switch (c.type) {
+        case Command::Jump:
+        case Command::Mark:
+        case Command::Expose: {
+            const double mm = std::hypot(static_cast<double>(c.x) - x, static_cast<double>(c.y) - y) / bitsPerMM;
+            const double speed = (c.type == Command::Mark)
+                ? (seg ? seg->laserSpeed : 250.0)
+                : (seg ? seg->jumpSpeed : 1500.0);
+            if (speed > 0.0) seconds += mm / speed;
+            if (c.type == Command::Expose && seg) {
+                seconds += (static_cast<double>(seg->pointDelayUs) + seg->pointExposureUs) * 1e-6;
+            }
+            x = static_cast<double>(c.x);
+            y = static_cast<double>(c.y);
+            break;
+        }
+        case Command::Delay:
+            seconds += c.delayMs * 1e-3;
+            break;
+        default:
+            break;
+        }
+    }
+    return seconds;
+}
+
+uint64_t RTCCommandBlock::contentHash() const {
+    // Field by field: struct padding is not part of the content
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const void* data, size_t len) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    auto mixValue = [&mix](const auto& v) { mix(&v, sizeof(v)); };
+
+    mixValue(layerNumber);
+    mixValue(layerThickness);
+    for (const Command& c : commands) {
+        const uint32_t type = static_cast<uint32_t>(c.type);
+        const int64_t x = c.x, y = c.y;
+        mixValue(type);
+        mixValue(x);
+        mixValue(y);
+        mixValue(c.paramValue);
+        mixValue(c.delayMs);
+    }
+    for (const ParameterSegment& s : parameterSegments) {
+        const uint64_t start = s.startCmd, end = s.endCmd;
+        mixValue(start);
+        mixValue(end);
+        mixValue(s.buildStyleId);
+        mixValue(s.laserPower);
+        mixValue(s.laserSpeed);
+        mixValue(s.jumpSpeed);
+        mixValue(s.laserMode);
+        mixValue(s.laserFocus);
+        mixValue(s.pointDelayUs);
+        mixValue(s.pointExposureUs);
+    }
+    return h;
+}
+
 } // namespace marc
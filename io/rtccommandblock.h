@@ -30,6 +30,7 @@ class BuildStyle;
 struct RTCCommandBlock {
     // Layer metadata
     uint32_t layerNumber = 0;
+    uint32_t layerIndex = 0;                    // Position of the layer in the .marc file
     float layerHeight = 0.0f;
     float layerThickness = 0.0f;
 
@@ -39,9 +40,11 @@ struct RTCCommandBlock {
     size_t polygonCount = 0;
 
     // RTC5 scan commands (already converted to bits)
+    // Expose = point exposure: jump to (x, y), then card-timed delay and laser-on
+    // from the segment's pointDelayUs / pointExposureUs
     struct Command {
-        enum Type { Jump, Mark, SetPower, SetSpeed, SetFocus, Delay } type;
-        long x = 0, y = 0;                      // For Jump/Mark (RTC5 bits)
+        enum Type { Jump, Mark, SetPower, SetSpeed, SetFocus, Delay, Expose } type;
+        long x = 0, y = 0;                      // For Jump/Mark/Expose (RTC5 bits)
         double paramValue = 0.0;                // For SetPower/Speed/Focus (physical units)
         uint32_t delayMs = 0;                   // For Delay (milliseconds)
     };
@@ -70,6 +73,8 @@ struct RTCCommandBlock {
         double jumpSpeed = 1500.0;              // mm/s (jump speed)
         uint32_t laserMode = 0;                 // 0=normal, 1=pulse, 2=point
         double laserFocus = 0.1;                // Focus offset (mm)
+        uint32_t pointDelayUs = 0;              // Settling before each point exposure (us)
+        uint32_t pointExposureUs = 0;           // Laser-on time per point exposure (us)
     };
 
     std::vector<ParameterSegment> parameterSegments;
@@ -81,6 +86,20 @@ struct RTCCommandBlock {
     void addParameterSegment(uint32_t buildStyleId,
                              double laserPower, double laserSpeed, double jumpSpeed,
                              uint32_t laserMode, double laserFocus);
+
+    // Scan time of the block at segment speeds (jumps, marks, point dwells, delays);
+    // excludes scanner delays and list handling
+    double estimateSeconds(double bitsPerMM) const;
+
+    // FNV-1a over commands and segment parameters; equal blocks scan identically
+    // (build journal check that a resume converts layers as before)
+    uint64_t contentHash() const;
+
+    // Heap bytes held by the command and segment vectors (queue memory accounting)
+    size_t byteSize() const {
+        return commands.capacity() * sizeof(Command) +
+               parameterSegments.capacity() * sizeof(ParameterSegment);
+    }
 };
 
 } // namespace marc
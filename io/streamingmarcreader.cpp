@@ -1,5 +1,7 @@
 #include "streamingmarcreader.h"
+#include "diagnostics/trace.h"
 #include <filesystem>
+#include <cstring>
 
 namespace marc {
 
@@ -16,6 +18,128 @@ static bool openIfstream(std::ifstream& is, const std::filesystem::path& p) {
     return static_cast<bool>(is);
 }
 
+// Bounds-checked cursor over an in-memory layer record
+namespace {
+class ByteCursor {
+public:
+    ByteCursor(const char* data, std::size_t size) : m_data(data), m_size(size) {}
+
+    template <typename T>
+    void readPod(T& out) {
+        readBytes(&out, sizeof(T));
+    }
+
+    void readBytes(void* dst, std::size_t len) {
+        if (len > m_size - m_pos) {
+            throw std::runtime_error("Unexpected end of layer data");
+        }
+        std::memcpy(dst, m_data + m_pos, len);
+        m_pos += len;
+    }
+
+    void skip(std::size_t len) {
+        if (len > m_size - m_pos) {
+            throw std::runtime_error("Unexpected end of layer data");
+        }
+        m_pos += len;
+    }
+
+    std::size_t remaining() const { return m_size - m_pos; }
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+    std::size_t m_pos{0};
+};
+
+// On-disk size of a GeometryTag (type, category, pointCount)
+constexpr std::size_t kGeometryTagBytes = 3 * sizeof(uint32_t);
+
+// Bound an untrusted count by the bytes left before allocating for it, so a
+// corrupt layer fails cleanly instead of attempting a huge allocation
+void checkCount(const ByteCursor& in, uint32_t count, std::size_t bytesEach, const char* what) {
+    if (count > in.remaining() / bytesEach) {
+        throw std::runtime_error(std::string(what) + " count " + std::to_string(count) +
+                                 " exceeds the layer data");
+    }
+}
+
+GeometryTag readGeometryTag(ByteCursor& in) {
+    GeometryTag tag{};
+    in.readPod(tag.type);
+    in.readPod(tag.category);
+    in.readPod(tag.pointCount);
+    return tag;
+}
+
+Hatch readHatch(ByteCursor& in) {
+    Hatch h{};
+    h.tag = readGeometryTag(in);
+    uint32_t vertices = h.tag.pointCount;
+    uint32_t lineCount = vertices / 2;
+    checkCount(in, vertices, sizeof(Point), "Hatch point");
+    h.lines.resize(lineCount);
+    // Line is two packed Points, identical to the on-disk vertex stream
+    in.readBytes(h.lines.data(), static_cast<std::size_t>(lineCount) * sizeof(Line));
+    if (vertices % 2 == 1) {
+        in.skip(sizeof(Point));
+    }
+    return h;
+}
+
+Polyline readPolyline(ByteCursor& in) {
+    Polyline p{};
+    p.tag = readGeometryTag(in);
+    checkCount(in, p.tag.pointCount, sizeof(Point), "Polyline point");
+    p.points.resize(p.tag.pointCount);
+    in.readBytes(p.points.data(), static_cast<std::size_t>(p.tag.pointCount) * sizeof(Point));
+    return p;
+}
+
+Polygon readPolygon(ByteCursor& in) {
+    Polygon p{};
+    p.tag = readGeometryTag(in);
+    checkCount(in, p.tag.pointCount, sizeof(Point), "Polygon point");
+    p.points.resize(p.tag.pointCount);
+    in.readBytes(p.points.data(), static_cast<std::size_t>(p.tag.pointCount) * sizeof(Point));
+    return p;
+}
+
+Circle readCircle(ByteCursor& in, const GeometryTag& tag) {
+    Circle c{};
+    c.tag = tag;
+    in.readPod(c.center);
+    in.readPod(c.radius);
+    return c;
+}
+
+// Point geometry group (kMarcPointGeometryVersion): circles and point sets,
+// the latter expanded to one zero-radius circle per point
+void readPointGeometry(ByteCursor& in, Layer& L) {
+    uint32_t count = 0;
+    in.readPod(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const GeometryTag tag = readGeometryTag(in);
+        if (tag.category == 4) {
+            L.support_circles.emplace_back(readCircle(in, tag));
+        } else if (tag.category == 5) {
+            checkCount(in, tag.pointCount, sizeof(Point), "Point set point");
+            L.support_circles.reserve(L.support_circles.size() + tag.pointCount);
+            for (uint32_t k = 0; k < tag.pointCount; ++k) {
+                Circle c{};
+                c.tag = tag;
+                c.tag.pointCount = 1;
+                in.readPod(c.center);
+                c.radius = 0.0f;
+                L.support_circles.push_back(c);
+            }
+        } else {
+            throw std::runtime_error("Unknown point geometry category " + std::to_string(tag.category));
+        }
+    }
+}
+} // namespace
+
 // ============================================================================
 // Constructor / Destructor
 // ============================================================================
@@ -23,11 +147,13 @@ static bool openIfstream(std::ifstream& is, const std::filesystem::path& p) {
 StreamingMarcReader::StreamingMarcReader(const std::wstring& path) {
     openFile(path);
     readHeader();
+    readIndexTable();
 }
 
 StreamingMarcReader::StreamingMarcReader(const std::string& path) {
     openFile(std::filesystem::path(path).wstring());
     readHeader();
+    readIndexTable();
 }
 
 StreamingMarcReader::~StreamingMarcReader() {
@@ -57,116 +183,189 @@ void StreamingMarcReader::readHeader() {
     }
 }
 
+void StreamingMarcReader::readIndexTable() {
+    // The writer appends one uint64 start offset per layer at indexTableOffset.
+    // Older or truncated files may not carry it; fall back to sequential skimming.
+    m_layerOffsets.clear();
+    const uint32_t count = m_header.totalLayers;
+    const uint64_t tableOffset = m_header.indexTableOffset;
+    if (count == 0 || tableOffset < sizeof(MarcHeader)) return;
+
+    const std::streampos dataStart = m_ifstream.tellg();
+    m_ifstream.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(m_ifstream.tellg());
+    const uint64_t tableBytes = static_cast<uint64_t>(count) * sizeof(uint64_t);
+
+    if (tableOffset <= fileSize && tableBytes <= fileSize - tableOffset) {
+        std::vector<uint64_t> offsets(count);
+        m_ifstream.seekg(static_cast<std::streamoff>(tableOffset), std::ios::beg);
+        m_ifstream.read(reinterpret_cast<char*>(offsets.data()),
+                        static_cast<std::streamsize>(tableBytes));
+
+        bool valid = static_cast<bool>(m_ifstream) && offsets.front() == sizeof(MarcHeader);
+        for (uint32_t i = 1; valid && i < count; ++i) {
+            valid = offsets[i] > offsets[i - 1];
+        }
+        valid = valid && offsets.back() < tableOffset;
+        if (valid) {
+            m_layerOffsets = std::move(offsets);
+        }
+    }
+
+    m_ifstream.clear();
+    m_ifstream.seekg(dataStart, std::ios::beg);
+}
+
+uint64_t StreamingMarcReader::skimLayerSize() {
+    // Walk the counts of the next layer, seeking over vertex payloads, to find
+    // its serialized size. Restores the stream position afterwards.
+    const std::streampos start = m_ifstream.tellg();
+    uint32_t layerNumber = 0;
+    float layerHeight = 0.0f;
+    readPod(layerNumber);
+    readPod(layerHeight);
+    const int groups = m_header.version >= kMarcPointGeometryVersion ? 4 : 3;
+    for (int group = 0; group < groups; ++group) {
+        uint32_t count = 0;
+        readPod(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            GeometryTag tag{};
+            readPod(tag);
+            // Circles carry center + radius regardless of pointCount
+            const std::streamoff payload = (group == 3 && tag.category == 4)
+                ? static_cast<std::streamoff>(sizeof(Point) + sizeof(float))
+                : static_cast<std::streamoff>(tag.pointCount) * sizeof(Point);
+            m_ifstream.seekg(payload, std::ios::cur);
+            if (!m_ifstream) {
+                throw std::runtime_error("Unexpected EOF while skimming layer");
+            }
+        }
+    }
+    const std::streampos end = m_ifstream.tellg();
+    m_ifstream.seekg(start, std::ios::beg);
+    return static_cast<uint64_t>(end - start);
+}
+
 // ============================================================================
 // Layer Reading (Streaming)
 // ============================================================================
 
 Layer StreamingMarcReader::readNextLayer() {
+    readNextLayerBytes(m_layerBuffer);
+    try {
+        return decodeLayer(m_layerBuffer.data(), m_layerBuffer.size(), m_header.version);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(
+            std::string("Failed to read layer ") + std::to_string(m_currentLayerIndex) +
+            std::string(": ") + e.what()
+        );
+    }
+}
+
+void StreamingMarcReader::readNextLayerBytes(std::vector<char>& buffer) {
+    MARC_TRACE_SCOPE("marc", "readLayerBytes");
     if (!hasNextLayer()) {
         throw std::runtime_error("No more layers to read");
     }
+    const uint32_t index = m_currentLayerIndex;
     ++m_currentLayerIndex;
-    return readLayer();
-}
 
-Layer StreamingMarcReader::readLayer() {
-    Layer L{};
     try {
-        readPod(L.layerNumber);
-        readPod(L.layerHeight);
-        L.layerThickness = 0.0f; // not serialized
-
-        // Hatches
-        uint32_t hatchCount = 0;
-        readPod(hatchCount);
-        L.hatches.reserve(hatchCount);
-        for (uint32_t i = 0; i < hatchCount; ++i) {
-            L.hatches.emplace_back(readHatch());
-        }
-
-        // Polylines
-        uint32_t polylineCount = 0;
-        readPod(polylineCount);
-        L.polylines.reserve(polylineCount);
-        for (uint32_t i = 0; i < polylineCount; ++i) {
-            L.polylines.emplace_back(readPolyline());
+        uint64_t size = 0;
+        if (hasLayerIndex()) {
+            const uint64_t end = (index + 1 < m_layerOffsets.size())
+                ? m_layerOffsets[index + 1]
+                : m_header.indexTableOffset;
+            size = end - m_layerOffsets[index];
+            m_ifstream.seekg(static_cast<std::streamoff>(m_layerOffsets[index]), std::ios::beg);
+        } else {
+            size = skimLayerSize();
         }
 
-        // Polygons
-        uint32_t polygonCount = 0;
-        readPod(polygonCount);
-        L.polygons.reserve(polygonCount);
-        for (uint32_t i = 0; i < polygonCount; ++i) {
-            L.polygons.emplace_back(readPolygon());
-        }
-
-        // No circles
-        L.support_circles.clear();
-
-        return L;
+        buffer.resize(static_cast<std::size_t>(size));
+        readBytes(buffer.data(), buffer.size());
     } catch (const std::exception& e) {
         throw std::runtime_error(
-            std::string("Failed to read layer ") + std::to_string(m_currentLayerIndex) + 
+            std::string("Failed to read layer ") + std::to_string(m_currentLayerIndex) +
             std::string(": ") + e.what()
         );
     }
 }
 
-// ============================================================================
-// Geometry Reading
-// ============================================================================
+void StreamingMarcReader::seekToLayer(uint32_t index) {
+    MARC_TRACE_SCOPE("marc", "seekToLayer");
+    if (index > m_header.totalLayers) {
+        throw std::runtime_error("Layer index " + std::to_string(index) + " beyond end of file (" +
+                                 std::to_string(m_header.totalLayers) + " layers)");
+    }
+    if (hasLayerIndex()) {
+        // readNextLayerBytes seeks to the table offset itself
+        m_currentLayerIndex = index;
+        return;
+    }
 
-GeometryTag StreamingMarcReader::readGeometryTag() {
-    GeometryTag tag{};
-    readPod(tag.type);
-    readPod(tag.category);
-    readPod(tag.pointCount);
-    return tag;
+    m_ifstream.clear();
+    if (index < m_currentLayerIndex) {
+        m_ifstream.seekg(static_cast<std::streamoff>(sizeof(MarcHeader)), std::ios::beg);
+        m_currentLayerIndex = 0;
+    }
+    try {
+        while (m_currentLayerIndex < index) {
+            const uint64_t size = skimLayerSize();
+            m_ifstream.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+            ++m_currentLayerIndex;
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error(
+            std::string("Failed to seek to layer ") + std::to_string(index) +
+            std::string(": ") + e.what()
+        );
+    }
 }
 
-Hatch StreamingMarcReader::readHatch() {
-    Hatch h{};
-    h.tag = readGeometryTag();
-    uint32_t vertices = h.tag.pointCount;
-    uint32_t lineCount = vertices / 2;
-    h.lines.resize(lineCount);
-    for (uint32_t i = 0; i < lineCount; ++i) {
-        readPod(h.lines[i].a);
-        readPod(h.lines[i].b);
+Layer StreamingMarcReader::decodeLayer(const char* data, std::size_t size, uint32_t version) {
+    MARC_TRACE_SCOPE("marc", "decodeLayer");
+    ByteCursor in(data, size);
+    Layer L{};
+    in.readPod(L.layerNumber);
+    in.readPod(L.layerHeight);
+    L.layerThickness = 0.0f; // not serialized
+
+    // Hatches
+    uint32_t hatchCount = 0;
+    in.readPod(hatchCount);
+    checkCount(in, hatchCount, kGeometryTagBytes, "Hatch");
+    L.hatches.reserve(hatchCount);
+    for (uint32_t i = 0; i < hatchCount; ++i) {
+        L.hatches.emplace_back(readHatch(in));
     }
-    if (vertices % 2 == 1) {
-        Point dummy{};
-        readPod(dummy);
+
+    // Polylines
+    uint32_t polylineCount = 0;
+    in.readPod(polylineCount);
+    checkCount(in, polylineCount, kGeometryTagBytes, "Polyline");
+    L.polylines.reserve(polylineCount);
+    for (uint32_t i = 0; i < polylineCount; ++i) {
+        L.polylines.emplace_back(readPolyline(in));
     }
-    return h;
-}
 
-Polyline StreamingMarcReader::readPolyline() {
-    Polyline p{};
-    p.tag = readGeometryTag();
-    p.points.resize(p.tag.pointCount);
-    for (uint32_t i = 0; i < p.tag.pointCount; ++i) {
-        readPod(p.points[i]);
+    // Polygons
+    uint32_t polygonCount = 0;
+    in.readPod(polygonCount);
+    checkCount(in, polygonCount, kGeometryTagBytes, "Polygon");
+    L.polygons.reserve(polygonCount);
+    for (uint32_t i = 0; i < polygonCount; ++i) {
+        L.polygons.emplace_back(readPolygon(in));
     }
-    return p;
-}
 
-Polygon StreamingMarcReader::readPolygon() {
-    Polygon p{};
-    p.tag = readGeometryTag();
-    p.points.resize(p.tag.pointCount);
-    for (uint32_t i = 0; i < p.tag.pointCount; ++i) {
-        readPod(p.points[i]);
+    // Circles and point sets follow the polygons from kMarcPointGeometryVersion
+    // on, as in readSlices and skimLayerSize; older files end the layer here
+    L.support_circles.clear();
+    if (version >= kMarcPointGeometryVersion) {
+        readPointGeometry(in, L);
     }
-    return p;
-}
 
-Circle StreamingMarcReader::readCircle() {
-    Circle c{};
-    c.tag = readGeometryTag();
-    readPod(c.center);
-    readPod(c.radius);
-    return c;
+    return L;
 }
 
 } // namespace marc
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace marc {
 
@@ -22,6 +23,11 @@ namespace marc {
  *       Layer layer = reader.readNextLayer();
  *       // process layer
  *   }
+ *
+ * TWO-PHASE ACCESS:
+ *   readNextLayerBytes() performs only file I/O (one read per layer when the
+ *   file carries a layer index table), decodeLayer() parses the bytes from
+ *   memory (given the header version, which decides the layer layout). Callers can time or distribute the two stages independently.
  */
 class StreamingMarcReader {
 public:
@@ -39,16 +45,38 @@ public:
     uint32_t totalLayers() const { return m_header.totalLayers; }
     uint32_t currentLayerIndex() const { return m_currentLayerIndex; }
 
+    // True when the file's layer index table was found and validated
+    bool hasLayerIndex() const { return !m_layerOffsets.empty(); }
+
+    // File offset of layer `index` from the index table (0 when there is none)
+    uint64_t layerOffset(uint32_t index) const {
+        return index < m_layerOffsets.size() ? m_layerOffsets[index] : 0;
+    }
+
     // Read next layer from file (sequential only)
     Layer readNextLayer();
 
+    // Read the raw bytes of the next layer into buffer (no decoding)
+    void readNextLayerBytes(std::vector<char>& buffer);
+
+    // Position the reader so that the next layer read is layer `index`
+    // (index table when present, otherwise skims from the nearest known point)
+    void seekToLayer(uint32_t index);
+
+    // Decode one serialized layer from memory; version = header().version of its file
+    static Layer decodeLayer(const char* data, std::size_t size, uint32_t version);
+
 private:
     void openFile(const std::wstring& path);
     void readHeader();
+    void readIndexTable();
+    uint64_t skimLayerSize();
 
     std::ifstream m_ifstream;
     MarcHeader m_header{};
     uint32_t m_currentLayerIndex{0};
+    std::vector<uint64_t> m_layerOffsets;   // start offset of each layer (from index table)
+    std::vector<char> m_layerBuffer;        // reused by readNextLayer()
 
     // Low-level read helpers
     template <typename T>
@@ -65,14 +93,6 @@ private:
             throw std::runtime_error("Unexpected EOF while reading bytes");
         }
     }
-
-    // Layer reading helpers
-    GeometryTag readGeometryTag();
-    Hatch readHatch();
-    Polyline readPolyline();
-    Polygon readPolygon();
-    Circle readCircle();
-    Layer readLayer();
 };
 
 } // namespace marc
@@ -0,0 +1,74 @@
+#include "svgexportjob.h"
+#include "streamingmarcreader.h"
+#include "diagnostics/trace.h"
+
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+namespace marc {
+
+SvgExportJob::SvgExportJob(const std::wstring& marcPath, const std::string& outDir, const writeSVG::Options& svg)
+    : SvgExportJob(marcPath, outDir, svg, Settings()) {}
+
+SvgExportJob::SvgExportJob(const std::wstring& marcPath, const std::string& outDir, const writeSVG::Options& svg,
+                           const Settings& settings)
+    : mMarcPath(marcPath), mOutDir(outDir), mWriter(svg), mPipeline("SVG", settings) {}
+
+SvgExportJob::~SvgExportJob() {
+    cancel();
+    wait();
+}
+
+std::string SvgExportJob::layerFileName(const std::string& outDir, uint32_t layerNumber) {
+    std::ostringstream name;
+    name << outDir << "/layer_" << std::setw(6) << std::setfill('0') << layerNumber << ".svg";
+    return name.str();
+}
+
+// ============================================================================
+// Start / Wait
+// ============================================================================
+
+bool SvgExportJob::start() {
+    if (mPipeline.isStarted()) return false;   // already started
+
+    std::error_code ec;
+    std::filesystem::create_directories(mOutDir, ec);
+    if (ec) {
+        mPipeline.abort("Cannot create output folder " + mOutDir + ": " + ec.message());
+        return false;
+    }
+
+    if (!mPipeline.open(mMarcPath)) return false;
+    mPipeline.run([this] { return makeWorker(); });
+    return true;
+}
+
+bool SvgExportJob::wait() {
+    return mPipeline.wait();
+}
+
+// ============================================================================
+// Workers: decode + write, fully independent per layer
+// ============================================================================
+
+LayerPipeline::Worker SvgExportJob::makeWorker() {
+    // Reused serialization buffer, grows to the largest layer
+    return [this, svgBuffer = std::string()](LayerPipeline::RawLayer& raw) mutable {
+        try {
+            MARC_TRACE_SCOPE("svg", "SvgExportJob::writeLayer");
+            const Layer layer = StreamingMarcReader::decodeLayer(raw.bytes.data(), raw.bytes.size(), mPipeline.fileVersion());
+            if (!mWriter.writeLayer(layer, layerFileName(mOutDir, layer.layerNumber), svgBuffer)) {
+                mPipeline.fail("Cannot write SVG for layer " + std::to_string(layer.layerNumber));
+                return false;
+            }
+            return true;
+        } catch (const std::exception& e) {
+            mPipeline.fail("Layer " + std::to_string(raw.index) + ": " + e.what());
+            return false;
+        }
+    };
+}
+
+} // namespace marc
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "layerpipeline.h"
+#include "writeSVG.h"
+
+#include <cstdint>
+#include <string>
+
+namespace marc {
+
+/**
+ * @brief SvgExportJob - Background, parallel MARC -> SVG export
+ *
+ * DESIGN:
+ * - Runs on a LayerPipeline: one reader thread streams raw layer bytes (the
+ *   build is never loaded as a whole), bounded queue, N worker threads.
+ * - Workers decode the bytes and write layer_NNNNNN.svg files concurrently
+ *   through one shared (const, stateless) writeSVG; each worker reuses its
+ *   own serialization buffer.
+ * - Progress is a pair of atomics for the caller to poll; cancel() stops the
+ *   reader and lets workers drop queued layers.
+ *
+ * USAGE:
+ *   SvgExportJob job(marcPath, outDir, svgOptions);
+ *   job.start();
+ *   // poll job.layersWritten() / job.totalLayers(), job.cancel() on request
+ *   if (!job.wait()) std::cerr << job.errorMessage();
+ */
+class SvgExportJob {
+public:
+    using Settings = LayerPipeline::Settings;
+
+    SvgExportJob(const std::wstring& marcPath, const std::string& outDir, const writeSVG::Options& svg);
+    SvgExportJob(const std::wstring& marcPath, const std::string& outDir, const writeSVG::Options& svg,
+                 const Settings& settings);
+    ~SvgExportJob();
+
+    SvgExportJob(const SvgExportJob&) = delete;
+    SvgExportJob& operator=(const SvgExportJob&) = delete;
+
+    // Open the file and spawn the threads (false if the file cannot be opened)
+    bool start();
+
+    // Request cancellation (returns immediately; wait() joins)
+    void cancel() { mPipeline.cancel(); }
+
+    // Join all threads; true when every layer was written and nothing failed
+    bool wait();
+
+    bool isFinished() const { return mPipeline.isFinished(); }
+    bool isCancelled() const { return mPipeline.isCancelled(); }
+    uint32_t totalLayers() const { return mPipeline.totalLayers(); }
+    uint32_t layersWritten() const { return mPipeline.layersDone(); }
+    std::string errorMessage() const { return mPipeline.errorMessage(); }
+
+    static std::string layerFileName(const std::string& outDir, uint32_t layerNumber);
+
+private:
+    LayerPipeline::Worker makeWorker();
+
+    const std::wstring mMarcPath;
+    const std::string mOutDir;
+    const writeSVG mWriter;
+    LayerPipeline mPipeline;            // last: its threads use the members above
+};
+
+} // namespace marc
@@ -0,0 +1,98 @@
+#include "workerpool.h"
+#include "diagnostics/trace.h"
+
+#include <algorithm>
+
+namespace marc {
+
+WorkerPool::WorkerPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    mThreads.reserve(threads - 1);
+    for (unsigned i = 0; i + 1 < threads; ++i) {
+        mThreads.emplace_back(&WorkerPool::threadFunc, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        mStop = true;
+    }
+    mWakeCv.notify_all();
+    for (auto& t : mThreads) t.join();
+}
+
+// ============================================================================
+// parallelFor
+// ============================================================================
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& fn, unsigned maxThreads) {
+    if (count == 0) return;
+    const unsigned limit = maxThreads ? std::min(maxThreads, threadCount()) : threadCount();
+    const auto helpers = static_cast<unsigned>(std::min<size_t>(limit - 1, count - 1));
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(mCallMutex);
+    {
+        std::lock_guard<std::mutex> lk(mMutex);
+        mFn = &fn;
+        mCount = count;
+        mNext.store(0, std::memory_order_relaxed);
+        mHelpers = helpers;
+        mBusy = helpers;
+        mError = nullptr;
+        ++mGeneration;
+    }
+    mWakeCv.notify_all();
+
+    runItems();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lk(mMutex);
+        mDoneCv.wait(lk, [this] { return mBusy == 0; });
+        mFn = nullptr;
+        error = mError;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void WorkerPool::runItems() {
+    try {
+        for (size_t i = mNext.fetch_add(1, std::memory_order_relaxed); i < mCount;
+             i = mNext.fetch_add(1, std::memory_order_relaxed)) {
+            (*mFn)(i);
+        }
+    } catch (...) {
+        // Stop handing out indices; the caller rethrows the first error
+        mNext.store(mCount, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lk(mMutex);
+        if (!mError) mError = std::current_exception();
+    }
+}
+
+// ============================================================================
+// Helpers: sleep between calls, join a call when their id is within mHelpers
+// ============================================================================
+
+void WorkerPool::threadFunc(unsigned id) {
+    trace::setThreadName("Geometry Worker");
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lk(mMutex);
+    for (;;) {
+        mWakeCv.wait(lk, [&] { return mStop || mGeneration != seen; });
+        if (mStop) return;
+        seen = mGeneration;
+        if (id >= mHelpers) continue;
+
+        lk.unlock();
+        runItems();
+        lk.lock();
+        if (--mBusy == 0) mDoneCv.notify_one();
+    }
+}
+
+} // namespace marc
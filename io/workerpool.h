@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace marc {
+
+// ============================================================================
+// WorkerPool - Persistent threads for per-layer parallel loops
+// ============================================================================
+/**
+ * @brief A fixed set of threads, created once, that run the index loops of
+ * the producer's geometry stages (ContourOffsetter, HatchGenerator,
+ * IslandPartitioner), so a layer costs no thread creation.
+ *
+ * DESIGN:
+ * - parallelFor(count, fn) hands out indices through one atomic counter; the
+ *   calling thread takes part and returns when every index is done.
+ * - Helpers sleep on a condition variable between calls (one wake-up per
+ *   call, no spinning). maxThreads caps the threads of one call, so small
+ *   layers run on the caller alone.
+ * - One call at a time: concurrent callers are serialised. The stages run
+ *   one after another on the producer thread, so they never contend.
+ * - The first exception thrown by fn is rethrown to the caller once all
+ *   threads have left the loop.
+ *
+ * USAGE:
+ *   WorkerPool pool;                           // hardware concurrency
+ *   offsetter.setWorkerPool(&pool);            // stages share the pool
+ *   pool.parallelFor(n, [&](size_t i) { ... });
+ */
+class WorkerPool {
+public:
+    // threads: total including the calling thread, 0 = hardware concurrency
+    explicit WorkerPool(unsigned threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Threads available to one call, the caller included
+    unsigned threadCount() const { return static_cast<unsigned>(mThreads.size()) + 1; }
+
+    // fn(i) for every i in [0, count); maxThreads 0 = all, 1 = calling thread only
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn, unsigned maxThreads = 0);
+
+private:
+    void threadFunc(unsigned id);
+    void runItems();
+
+    std::vector<std::thread> mThreads;
+    std::mutex mCallMutex;                  // one parallelFor at a time
+
+    std::mutex mMutex;
+    std::condition_variable mWakeCv;        // new call / stop
+    std::condition_variable mDoneCv;        // last helper left the call
+    uint64_t mGeneration = 0;
+    bool mStop = false;
+    const std::function<void(size_t)>* mFn = nullptr;
+    size_t mCount = 0;
+    unsigned mHelpers = 0;                  // helpers taking part in the current call
+    unsigned mBusy = 0;                     // of those, still running
+    std::exception_ptr mError;
+
+    std::atomic<size_t> mNext{0};
+};
+
+// On the pool when there is one, otherwise on the calling thread
+inline void parallelFor(WorkerPool* pool, size_t count, unsigned maxThreads, const std::function<void(size_t)>& fn) {
+    if (pool) {
+        pool->parallelFor(count, fn, maxThreads);
+    } else {
+        for (size_t i = 0; i < count; ++i) fn(i);
+    }
+}
+
+} // namespace marc
@@ -1,39 +1,99 @@
 #include "writeSVG.h"
+#include <algorithm>
+#include <charconv>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
 
 namespace marc {
 
-std::string writeSVG::svgHeader(int w, int h) {
-    std::ostringstream ss;
-    ss << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
-    ss << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"" << w << "\" height=\"" << h << "\">\n";
-    ss << "  <g fill=\"none\" stroke-linecap=\"round\" stroke-linejoin=\"round\">\n";
-    return ss.str();
+namespace {
+
+// Fixed 3-decimal number, same text as ostream << std::fixed << std::setprecision(3)
+inline void appendFixed3(std::string& out, double v) {
+    char buf[48];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, 3);
+    out.append(buf, res.ptr);
+}
+
+inline void appendInt(std::string& out, long long v) {
+    char buf[24];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+// Value in thousandths of a pixel, shortest form ("12.5", "-3", "0.125")
+inline void appendMilli(std::string& out, long long milli) {
+    if (milli < 0) { out.push_back('-'); milli = -milli; }
+    appendInt(out, milli / 1000);
+    int frac = static_cast<int>(milli % 1000);
+    if (frac == 0) return;
+    char digits[4] = { '.', static_cast<char>('0' + frac / 100), static_cast<char>('0' + frac / 10 % 10),
+                       static_cast<char>('0' + frac % 10) };
+    int len = 4;
+    while (digits[len - 1] == '0') --len;
+    out.append(digits, static_cast<std::size_t>(len));
+}
+
+// Path coordinates are quantized once, so relative moves add up exactly
+inline long long toMilli(double v) { return std::llround(v * 1000.0); }
+
+} // namespace
+
+void writeSVG::appendHeader(std::string& out, int w, int h) {
+    out += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out += "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"";
+    appendInt(out, w);
+    out += "\" height=\"";
+    appendInt(out, h);
+    out += "\">\n";
+    out += "  <g fill=\"none\" stroke-linecap=\"round\" stroke-linejoin=\"round\">\n";
 }
 
-std::string writeSVG::svgFooter() {
-    return std::string("  </g>\n</svg>\n");
+void writeSVG::appendFooter(std::string& out) {
+    out += "  </g>\n</svg>\n";
 }
 
 bool writeSVG::writeLayer(const Layer& layer, const std::string& filePath) const {
-    std::ofstream os(filePath, std::ios::out | std::ios::trunc);
+    std::string buffer;
+    return writeLayer(layer, filePath, buffer);
+}
+
+bool writeSVG::writeLayer(const Layer& layer, const std::string& filePath, std::string& buffer) const {
+    serializeLayer(layer, buffer);
+
+    std::ofstream os(filePath, std::ios::out | std::ios::trunc | std::ios::binary);
     if (!os) return false;
+    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(os);
+}
+
+void writeSVG::serializeLayer(const Layer& layer, std::string& out) const {
+    out.clear();
+
+    // Pre-size: ~28 bytes per hatch vector, ~18 per point, plus fixed markup
+    std::size_t vectors = 0, points = 0;
+    for (const auto& h : layer.hatches) vectors += h.lines.size();
+    for (const auto& p : layer.polylines) points += p.points.size();
+    for (const auto& p : layer.polygons) points += p.points.size();
+    out.reserve(1024 + vectors * (m_opt.compactHatches ? 28 : 80) + points * 18 +
+                layer.support_circles.size() * 64);
 
     // Derived values from options
-    double scale = this->scalePxPerMm();
     double canvasW_px = this->canvasWidthPx();
     double canvasH_px = this->canvasHeightPx();
     int canvasW = static_cast<int>(std::lround(canvasW_px));
     int canvasH = static_cast<int>(std::lround(canvasH_px));
 
-    os << svgHeader(canvasW, canvasH);
+    appendHeader(out, canvasW, canvasH);
 
     // Metadata text
-    os << "  <text x=\"10\" y=\"20\" font-size=\"24\" fill=\"#555\">";
-    os << "Layer " << layer.layerNumber << " Z=" << std::fixed << std::setprecision(3) << layer.layerHeight << " mm";
-    os << "</text>\n";
+    out += "  <text x=\"10\" y=\"20\" font-size=\"24\" fill=\"#555\">";
+    out += "Layer ";
+    appendInt(out, layer.layerNumber);
+    out += " Z=";
+    appendFixed3(out, layer.layerHeight);
+    out += " mm</text>\n";
 
     // Compute bounding box in world units
     bool hasGeom = false;
@@ -73,59 +133,57 @@ bool writeSVG::writeLayer(const Layer& layer, const std::string& filePath) const
 
     // Emit transformed group
     {
-        std::ostringstream tr; tr << std::fixed << std::setprecision(3) << dx << "," << dy;
-        os << "  <g transform=\"translate(" << tr.str() << ")\">\n";
+        out += "  <g transform=\"translate(";
+        appendFixed3(out, dx);
+        out += ',';
+        appendFixed3(out, dy);
+        out += ")\">\n";
 
         // Hatches
-        os << "    <g stroke=\"#2E7D32\" stroke-width=\"0.4\">\n";
-        for (const auto& h : layer.hatches) {
-            for (const auto& ln : h.lines) {
-                os << "      <line x1=\"" << std::fixed << std::setprecision(3) << this->tx(ln.a.x)
-                   << "\" y1=\"" << this->ty(ln.a.y)
-                   << "\" x2=\"" << this->tx(ln.b.x)
-                   << "\" y2=\"" << this->ty(ln.b.y) << "\"/>\n";
-            }
-        }
-        os << "    </g>\n";
-
-        // Polylines 
-        os << "    <g stroke=\"#1976D2\" stroke-width=\"0.4\">\n";
-        for (const auto& p : layer.polylines) {
-            if (p.points.empty()) continue;
-            os << "      <polyline points=\"";
-            for (std::size_t i = 0; i < p.points.size(); ++i) {
-                const auto& pt = p.points[i];
-                os << std::fixed << std::setprecision(3) << this->tx(pt.x) << "," << this->ty(pt.y);
-                if (i + 1 < p.points.size()) os << " ";
+        if (m_opt.compactHatches) {
+            if (vectors > 0) {
+                out += "    <path stroke=\"#2E7D32\" stroke-width=\"0.4\" d=\"";
+                long long penX = 0, penY = 0;
+                bool first = true;
+                for (const auto& h : layer.hatches) {
+                    if (h.lines.empty()) continue;
+                    if (first) {
+                        // Absolute start, everything after is relative to the pen
+                        const auto& a = h.lines.front().a;
+                        penX = toMilli(this->tx(a.x));
+                        penY = toMilli(this->ty(a.y));
+                        out += 'M';
+                        appendMilli(out, penX);
+                        out += ' ';
+                        appendMilli(out, penY);
+                        first = false;
+                    }
+                    emitHatchPath(out, h, penX, penY);
+                }
+                out += "\"/>\n";
             }
-            os << "\" fill=\"none\"/>\n";
+        } else {
+            out += "    <g stroke=\"#2E7D32\" stroke-width=\"0.4\">\n";
+            for (const auto& h : layer.hatches) emitHatchLines(out, h);
+            out += "    </g>\n";
         }
-        os << "    </g>\n";
+
+        // Polylines
+        out += "    <g stroke=\"#1976D2\" stroke-width=\"0.4\">\n";
+        for (const auto& p : layer.polylines) emitPoints(out, "polyline", p.points, " fill=\"none\"");
+        out += "    </g>\n";
 
         // Polygons
-        os << "    <g stroke=\"#C62828\" stroke-width=\"0.4\" fill=\"none\">\n";
-        for (const auto& p : layer.polygons) {
-            if (p.points.empty()) continue;
-            os << "      <polygon points=\"";
-            for (std::size_t i = 0; i < p.points.size(); ++i) {
-                const auto& pt = p.points[i];
-                os << std::fixed << std::setprecision(3) << this->tx(pt.x) << "," << this->ty(pt.y);
-                if (i + 1 < p.points.size()) os << " ";
-            }
-            os << "\"/>\n";
-        }
-        os << "    </g>\n";
+        out += "    <g stroke=\"#C62828\" stroke-width=\"0.4\" fill=\"none\">\n";
+        for (const auto& p : layer.polygons) emitPoints(out, "polygon", p.points, "");
+        out += "    </g>\n";
 
         // Circles
-        os << "    <g stroke=\"#EF6C00\" stroke-width=\"0.4\" fill=\"none\">\n";
-        for (const auto& c : layer.support_circles) {
-            os << "      <circle cx=\"" << std::fixed << std::setprecision(3) << this->tx(c.center.x)
-               << "\" cy=\"" << this->ty(c.center.y)
-               << "\" r=\"" << (static_cast<double>(c.radius) * this->scalePxPerMm()) << "\"/>\n";
-        }
-        os << "    </g>\n";
+        out += "    <g stroke=\"#EF6C00\" stroke-width=\"0.4\" fill=\"none\">\n";
+        for (const auto& c : layer.support_circles) emitCircle(out, c);
+        out += "    </g>\n";
 
-        os << "  </g>\n"; // close transform group
+        out += "  </g>\n"; // close transform group
     }
 
     // Draw center guide lines (100 mm each)
@@ -134,28 +192,31 @@ bool writeSVG::writeLayer(const Layer& layer, const std::string& filePath) const
     double cx = this->canvasWidthPx() / 2.0;
     double cy = this->canvasHeightPx() / 2.0;
 
-    os << "  <g stroke=\"#000000\" stroke-width=\"0.4\">\n";
-    os << "    <line x1=\"" << std::fixed << std::setprecision(3) << (cx - halfLen)
-       << "\" y1=\"" << cy
-       << "\" x2=\"" << (cx + halfLen)
-       << "\" y2=\"" << cy << "\"/>\n";
-    os << "  </g>\n";
-
-    os << "  <g stroke=\"#000000\" stroke-width=\"0.4\">\n";
-    os << "    <line x1=\"" << cx
-       << "\" y1=\"" << (cy - halfLen)
-       << "\" x2=\"" << cx
-       << "\" y2=\"" << (cy + halfLen) << "\"/>\n";
-    os << "  </g>\n";
+    auto guideLine = [&out](double x1, double y1, double x2, double y2) {
+        out += "  <g stroke=\"#000000\" stroke-width=\"0.4\">\n";
+        out += "    <line x1=\"";
+        appendFixed3(out, x1);
+        out += "\" y1=\"";
+        appendFixed3(out, y1);
+        out += "\" x2=\"";
+        appendFixed3(out, x2);
+        out += "\" y2=\"";
+        appendFixed3(out, y2);
+        out += "\"/>\n  </g>\n";
+    };
+    guideLine(cx - halfLen, cy, cx + halfLen, cy);
+    guideLine(cx, cy - halfLen, cx, cy + halfLen);
 
     // Add red reference circle of 200mm diameter (100mm radius) at canvas center
-    os << "  <circle cx=\"" << std::fixed << std::setprecision(3) << cx
-       << "\" cy=\"" << cy
-       << "\" r=\"" << (100.0 * this->scalePxPerMm())
-       << "\" stroke=\"red\" stroke-width=\"1\" fill=\"none\"/>\n";
+    out += "  <circle cx=\"";
+    appendFixed3(out, cx);
+    out += "\" cy=\"";
+    appendFixed3(out, cy);
+    out += "\" r=\"";
+    appendFixed3(out, 100.0 * this->scalePxPerMm());
+    out += "\" stroke=\"red\" stroke-width=\"1\" fill=\"none\"/>\n";
 
-    os << svgFooter();
-    return true;
+    appendFooter(out);
 }
 
 bool writeSVG::writeAll(const std::vector<Layer>& layers, const std::string& outDir) const {
@@ -163,68 +224,82 @@ bool writeSVG::writeAll(const std::vector<Layer>& layers, const std::string& out
     std::filesystem::create_directories(outDir, ec);
     if (ec) return false;
 
+    std::string buffer;
     for (const auto& layer : layers) {
         std::ostringstream name;
         name << outDir << "/layer_" << std::setw(6) << std::setfill('0') << layer.layerNumber << ".svg";
-        if (!writeLayer(layer, name.str())) return false;
+        if (!writeLayer(layer, name.str(), buffer)) return false;
     }
     return true;
 }
 
-// Legacy emit helpers
-void writeSVG::emitHatch(std::ofstream& os, const Hatch& h) const {
-    double scale = this->scalePxPerMm();
-    double canvasH = this->canvasHeightPx();
+// ============================================================================
+// Emit helpers
+// ============================================================================
+
+// One "m dx dy l dx dy" pair per vector, relative to the previous pen position
+void writeSVG::emitHatchPath(std::string& out, const Hatch& h, long long& penX, long long& penY) const {
     for (const auto& ln : h.lines) {
-        double x1 = (static_cast<double>(ln.a.x) + static_cast<double>(m_opt.offsetX)) * scale;
-        double y1 = (static_cast<double>(ln.a.y) + static_cast<double>(m_opt.offsetY)) * scale;
-        double x2 = (static_cast<double>(ln.b.x) + static_cast<double>(m_opt.offsetX)) * scale;
-        double y2 = (static_cast<double>(ln.b.y) + static_cast<double>(m_opt.offsetY)) * scale;
-        if (m_opt.invertY) { y1 = canvasH - y1; y2 = canvasH - y2; }
-        os << "      <line x1=\"" << x1 << "\" y1=\"" << y1 << "\" x2=\"" << x2 << "\" y2=\"" << y2 << "\"/>\n";
+        const long long ax = toMilli(this->tx(ln.a.x));
+        const long long ay = toMilli(this->ty(ln.a.y));
+        const long long bx = toMilli(this->tx(ln.b.x));
+        const long long by = toMilli(this->ty(ln.b.y));
+
+        if (ax != penX || ay != penY) {
+            out += 'm';
+            appendMilli(out, ax - penX);
+            out += ' ';
+            appendMilli(out, ay - penY);
+        }
+        out += 'l';
+        appendMilli(out, bx - ax);
+        out += ' ';
+        appendMilli(out, by - ay);
+        penX = bx;
+        penY = by;
     }
 }
 
-void writeSVG::emitPolyline(std::ofstream& os, const Polyline& p) const {
-    if (p.points.empty()) return;
-    double scale = this->scalePxPerMm();
-    double canvasH = this->canvasHeightPx();
-    os << "      <polyline points=\"";
-    for (std::size_t i = 0; i < p.points.size(); ++i) {
-        const auto& pt = p.points[i];
-        double x = (static_cast<double>(pt.x) + static_cast<double>(m_opt.offsetX)) * scale;
-        double y = (static_cast<double>(pt.y) + static_cast<double>(m_opt.offsetY)) * scale;
-        if (m_opt.invertY) y = canvasH - y;
-        os << x << "," << y;
-        if (i + 1 < p.points.size()) os << " ";
+void writeSVG::emitHatchLines(std::string& out, const Hatch& h) const {
+    for (const auto& ln : h.lines) {
+        out += "      <line x1=\"";
+        appendFixed3(out, this->tx(ln.a.x));
+        out += "\" y1=\"";
+        appendFixed3(out, this->ty(ln.a.y));
+        out += "\" x2=\"";
+        appendFixed3(out, this->tx(ln.b.x));
+        out += "\" y2=\"";
+        appendFixed3(out, this->ty(ln.b.y));
+        out += "\"/>\n";
     }
-    os << "\" fill=\"none\"/>\n";
 }
 
-void writeSVG::emitPolygon(std::ofstream& os, const Polygon& p) const {
-    if (p.points.empty()) return;
-    double scale = this->scalePxPerMm();
-    double canvasH = this->canvasHeightPx();
-    os << "      <polygon points=\"";
-    for (std::size_t i = 0; i < p.points.size(); ++i) {
-        const auto& pt = p.points[i];
-        double x = (static_cast<double>(pt.x) + static_cast<double>(m_opt.offsetX)) * scale;
-        double y = (static_cast<double>(pt.y) + static_cast<double>(m_opt.offsetY)) * scale;
-        if (m_opt.invertY) y = canvasH - y;
-        os << x << "," << y;
-        if (i + 1 < p.points.size()) os << " ";
+void writeSVG::emitPoints(std::string& out, const char* element, const std::vector<Point>& points,
+                          const char* attributes) const {
+    if (points.empty()) return;
+    out += "      <";
+    out += element;
+    out += " points=\"";
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (i > 0) out += ' ';
+        appendFixed3(out, this->tx(points[i].x));
+        out += ',';
+        appendFixed3(out, this->ty(points[i].y));
     }
-    os << "\"/>\n";
+    out += '"';
+    out += attributes;
+    out += "/>\n";
 }
 
-void writeSVG::emitCircle(std::ofstream& os, const Circle& c) const {
-    double scale = this->scalePxPerMm();
-    double canvasH = this->canvasHeightPx();
-    double cx = (static_cast<double>(c.center.x) + static_cast<double>(m_opt.offsetX)) * scale;
-    double cy = (static_cast<double>(c.center.y) + static_cast<double>(m_opt.offsetY)) * scale;
-    if (m_opt.invertY) cy = canvasH - cy;
-    double r = static_cast<double>(c.radius) * scale;
-    os << "      <circle cx=\"" << cx << "\" cy=\"" << cy << "\" r=\"" << r << "\"/>\n";
+void writeSVG::emitCircle(std::string& out, const Circle& c) const {
+    out += "      <circle cx=\"";
+    appendFixed3(out, this->tx(c.center.x));
+    out += "\" cy=\"";
+    appendFixed3(out, this->ty(c.center.y));
+    out += "\" r=\"";
+    // Single points (radius 0) keep a visible dot
+    appendFixed3(out, std::max(static_cast<double>(c.radius) * this->scalePxPerMm(), 0.5));
+    out += "\"/>\n";
 }
 
 } // namespace marc
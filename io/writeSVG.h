@@ -20,25 +20,35 @@ public:
         float offsetX = 0.0f;      // world offset in mm
         float offsetY = 0.0f;      // world offset in mm
         bool invertY = true;       // SVG Y grows down; invert for Cartesian
+        bool compactHatches = true; // hatches as one <path> of relative moves (false: one <line> each)
     };
 
-    explicit writeSVG(Options opt = Options{}) : m_opt(opt) {}
+    // (no default argument: GCC/Clang reject Options{} before the class is complete)
+    writeSVG() : m_opt() {}
+    explicit writeSVG(Options opt) : m_opt(opt) {}
 
     // Writes a single layer to an SVG file path
     bool writeLayer(const Layer& layer, const std::string& filePath) const;
 
+    // Same, serializing into a caller-owned buffer that is reused across layers
+    bool writeLayer(const Layer& layer, const std::string& filePath, std::string& buffer) const;
+
+    // Serializes a layer into out (cleared first); one write() per file
+    void serializeLayer(const Layer& layer, std::string& out) const;
+
     // Writes all layers into a directory `svgOutput`, creating it if needed
     bool writeAll(const std::vector<Layer>& layers, const std::string& outDir = "svgOutput") const;
 
 private:
-    static std::string svgHeader(int w, int h);
-    static std::string svgFooter();
-
-    // Helpers to emit geometry
-    void emitHatch(std::ofstream& os, const Hatch& h) const;
-    void emitPolyline(std::ofstream& os, const Polyline& p) const;
-    void emitPolygon(std::ofstream& os, const Polygon& p) const;
-    void emitCircle(std::ofstream& os, const Circle& c) const;
+    static void appendHeader(std::string& out, int w, int h);
+    static void appendFooter(std::string& out);
+
+    // Helpers to emit geometry (coordinates formatted with std::to_chars)
+    void emitHatchPath(std::string& out, const Hatch& h, long long& penX, long long& penY) const;
+    void emitHatchLines(std::string& out, const Hatch& h) const;
+    void emitPoints(std::string& out, const char* element, const std::vector<Point>& points,
+                    const char* attributes) const;
+    void emitCircle(std::string& out, const Circle& c) const;
 
     // Coordinate transform helpers (use direct computations to avoid dependency issues)
     inline double baseScale() const { return static_cast<double>(m_opt.scale); }
@@ -5,9 +5,11 @@
 
 #include "mainwindow.h"
 #include "ProjectManager.h"
+#include "diagnostics/metrics.h"
 #include <QApplication>
 #include <QString>
 #include <QDebug>
+#include <cstdlib>
 
 // Export macro
 #ifdef MARCCONTROL_EXPORTS
@@ -42,6 +44,14 @@ MARCCONTROL_API int runApplication(int argc, char* argv[]) {
             .arg(4).arg(1).arg(0)); // Version from cmake/Version.cmake
         
         qDebug() << "MarcControl.dll: Application initialized";
+
+        // Pipeline metrics exposition file for line dashboards (MARCSLM_METRICS_FILE overrides)
+        const char* metricsEnv = std::getenv("MARCSLM_METRICS_FILE");
+        const QString metricsFile = (metricsEnv && *metricsEnv)
+            ? QString::fromLocal8Bit(metricsEnv)
+            : QCoreApplication::applicationDirPath() + "/metrics.prom";
+        marc::metrics::Registry::instance().startExporter(metricsFile.toStdWString());
+        qDebug() << "MarcControl.dll: Metrics exported to" << metricsFile;
         
         // Create and show main window
         g_mainWindow = new MainWindow();
@@ -53,6 +63,7 @@ MARCCONTROL_API int runApplication(int argc, char* argv[]) {
         int result = g_app->exec();
         
         qDebug() << "MarcControl.dll: Application exiting with code:" << result;
+        marc::metrics::Registry::instance().stopExporter();
         
         // Cleanup
         delete g_mainWindow;
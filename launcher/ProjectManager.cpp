@@ -1,4 +1,5 @@
 #include "ProjectManager.h"
+#include "io/marcanalysisjob.h"
 
 #include <QFileDialog>
 #include <QDir>
@@ -12,10 +13,15 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSettings>
+#include <QTimer>
 
 ProjectManager::ProjectManager(QWidget* parentWidget)
     : QObject(parentWidget), m_parentWidget(parentWidget) {}
 
+ProjectManager::~ProjectManager() {
+    stopAnalysis();
+}
+
 QString ProjectManager::defaultProjectsRoot() const {
     QString docs = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
     return QDir(docs).filePath("MarcSLM/Projects");
@@ -100,18 +106,123 @@ bool ProjectManager::loadBuildFile(const QString& buildPath) {
     QJsonObject proj = root.value("project").toObject();
     QJsonObject files = root.value("files").toObject();
 
+    stopAnalysis();
     m_currentProject = std::make_unique<MarcProject>();
     m_currentProject->setName(proj.value("name").toString());
     m_currentProject->setBuildFilePath(buildPath);
     if (files.contains("marcFile")) m_currentProject->attachMarcFile(files.value("marcFile").toString());
     if (files.contains("jsonFile")) m_currentProject->attachJsonFile(files.value("jsonFile").toString());
 
+    startAnalysis();
     addRecentProject(buildPath);
     emit projectOpened(buildPath);
     emit statusMessage(QString("Project opened: %1").arg(buildPath));
     return true;
 }
 
+// ============================================================================
+// Background MARC analysis
+// ============================================================================
+
+void ProjectManager::startAnalysis() {
+    stopAnalysis();
+    if (!m_currentProject) return;
+
+    m_currentProject->layers().clear();
+    BuildStatistics& stats = m_currentProject->statistics();
+    stats.totalLayers = 0;
+    stats.totalVectors = 0;
+    stats.layersAnalysed = 0;
+    stats.unreadableLayers = 0;
+    stats.buildHeight = 0.0;
+
+    const QString marcPath = marcAbsolutePath();
+    if (marcPath.isEmpty()) return;
+
+    auto job = std::make_unique<marc::MarcAnalysisJob>(marcPath.toStdWString());
+    if (!job->start()) {
+        emit errorMessage(QString("Cannot analyse MARC file: %1").arg(QString::fromStdString(job->errorMessage())));
+        return;
+    }
+    stats.totalLayers = static_cast<int>(job->totalLayers());
+    m_currentProject->layers().reserve(stats.totalLayers);
+    m_analysis = std::move(job);
+
+    if (!m_analysisTimer) {
+        m_analysisTimer = new QTimer(this);
+        connect(m_analysisTimer, &QTimer::timeout, this, &ProjectManager::pollAnalysis);
+    }
+    m_analysisTimer->start(100);
+    emit analysisProgress(0, stats.totalLayers);
+}
+
+void ProjectManager::stopAnalysis() {
+    if (m_analysisTimer) m_analysisTimer->stop();
+    if (!m_analysis) return;
+    m_analysis->cancel();
+    m_analysis.reset();   // joins the thread
+}
+
+void ProjectManager::cancelAnalysis() {
+    // The next poll reports the partial result
+    if (m_analysis) m_analysis->cancel();
+}
+
+void ProjectManager::pollAnalysis() {
+    if (!m_analysis || !m_currentProject) {
+        m_analysisTimer->stop();
+        return;
+    }
+
+    // Read finished before taking the batch so the last layers are not missed
+    const bool finished = m_analysis->isFinished();
+    std::vector<marc::LayerSummary> batch;
+    m_analysis->takeLayers(batch);
+
+    QList<LayerInfo>& layers = m_currentProject->layers();
+    BuildStatistics& stats = m_currentProject->statistics();
+    for (const marc::LayerSummary& s : batch) {
+        LayerInfo info;
+        info.layerNumber = static_cast<int>(s.layerNumber);
+        info.vectorCount = static_cast<int>(s.vectorCount);
+        info.fileOffset = static_cast<qint64>(s.fileOffset);
+        if (s.layerThickness > 0.0f) info.layerThickness = s.layerThickness;
+        if (!s.readable) {
+            info.layerType = "Unreadable";
+            ++stats.unreadableLayers;
+        }
+        layers.append(info);
+        stats.totalVectors += info.vectorCount;
+        if (s.readable) stats.buildHeight = s.layerHeight;
+    }
+    stats.layersAnalysed = layers.size();
+
+    if (!finished) {
+        if (!batch.empty()) emit analysisProgress(stats.layersAnalysed, stats.totalLayers);
+        return;
+    }
+
+    m_analysisTimer->stop();
+    const bool complete = m_analysis->wait();
+    const bool cancelled = m_analysis->isCancelled();
+    const QString reason = QString::fromStdString(m_analysis->errorMessage());
+    m_analysis.reset();
+
+    QString message;
+    if (complete) {
+        message = QString("MARC analysed: %1 layers, %2 vectors").arg(stats.totalLayers).arg(stats.totalVectors);
+        if (stats.unreadableLayers > 0) message += QString(", %1 unreadable layers").arg(stats.unreadableLayers);
+    } else if (cancelled) {
+        message = QString("MARC analysis cancelled after %1 / %2 layers").arg(stats.layersAnalysed).arg(stats.totalLayers);
+    } else {
+        message = QString("MARC analysis stopped after %1 / %2 layers: %3")
+                      .arg(stats.layersAnalysed).arg(stats.totalLayers).arg(reason);
+    }
+    emit analysisProgress(stats.layersAnalysed, stats.totalLayers);
+    emit analysisFinished(complete, message);
+    emit statusMessage(message);
+}
+
 QString ProjectManager::projectRootDir() const {
     if (!m_currentProject) return {};
     QFileInfo fi(m_currentProject->buildFilePath());
@@ -160,6 +271,7 @@ bool ProjectManager::createNewProjectInteractive() {
 
     QString buildPath = projectRoot.filePath(name + ".build");
 
+    stopAnalysis();
     m_currentProject = std::make_unique<MarcProject>();
     m_currentProject->setName(name);
     m_currentProject->setBuildFilePath(buildPath);
@@ -291,6 +403,7 @@ bool ProjectManager::attachMarcInteractive() {
     }
 
     m_currentProject->attachMarcFile(rel);
+    startAnalysis();
 
     if (!writeBuildFile(*m_currentProject)) {
         emit errorMessage("Failed to update .build file.");
@@ -11,6 +11,8 @@
 #include <memory>
 
 class QWidget;
+class QTimer;
+namespace marc { class MarcAnalysisJob; }
 
 struct LaserConfig {
     // Identification
@@ -71,6 +73,11 @@ struct BuildStatistics {
     QDateTime startTime;
     QDateTime endTime;
     QString status = "Not Started";
+
+    // Filled in the background by the MARC analysis after open / attach
+    int layersAnalysed = 0;
+    int unreadableLayers = 0;
+    double buildHeight = 0.0;       // mm, height of the last analysed layer
 };
 
 class MarcProject : public QObject {
@@ -119,6 +126,7 @@ class ProjectManager : public QObject {
     Q_OBJECT
 public:
     explicit ProjectManager(QWidget* parentWidget = nullptr);
+    ~ProjectManager() override;
 
     // Interactive flows
     bool createNewProjectInteractive();
@@ -147,12 +155,22 @@ public:
     QString marcAbsolutePath() const;
     QString jsonAbsolutePath() const;
 
+    // Background MARC analysis (layer list + statistics of the current project).
+    // Started on open / attach; the project is usable while it runs.
+    bool isAnalysing() const { return m_analysis != nullptr; }
+    void cancelAnalysis();
+
 signals:
     void statusMessage(const QString& message);
     void errorMessage(const QString& message);
     void projectOpened(const QString& buildPath);
     void projectSaved(const QString& buildPath);
     void projectModified();
+    void analysisProgress(int layersAnalysed, int totalLayers);
+    void analysisFinished(bool complete, const QString& message);
+
+private slots:
+    void pollAnalysis();
 
 private:
     QWidget* m_parentWidget;
@@ -165,6 +183,8 @@ private:
 
     // Helpers
     bool loadBuildFile(const QString& buildPath);
+    void startAnalysis();
+    void stopAnalysis();        // cancel + join, no signals (project is being replaced)
     QString projectRootDir() const;
 
     // Copy helpers
@@ -182,6 +202,9 @@ private:
     // Settings for recent projects
     QStringList loadRecentProjects() const;
     void saveRecentProjects(const QStringList& list) const;
+
+    std::unique_ptr<marc::MarcAnalysisJob> m_analysis;
+    QTimer* m_analysisTimer = nullptr;
 };
 
 #endif // PROJECTMANAGER_H
@@ -0,0 +1,177 @@
+#include "exclusiondialog.h"
+#include "controllers/scanstreamingmanager.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QStringList>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+enum Column { Label = 0, MinX, MinY, MaxX, MaxY, ColumnCount };
+}
+
+PartExclusionDialog::PartExclusionDialog(ScanStreamingManager* manager, QWidget* parent)
+    : QDialog(parent)
+    , mManager(manager)
+    , mRegions(new QTableWidget(0, ColumnCount, this))
+    , mTypes(new QLineEdit(this))
+    , mFromLayer(new QSpinBox(this))
+    , mActiveLabel(new QLabel(this))
+{
+    setWindowTitle("Exclude Parts");
+    resize(560, 420);
+
+    mRegions->setHorizontalHeaderLabels({ "Label", "Min X (mm)", "Min Y (mm)", "Max X (mm)", "Max Y (mm)" });
+    mRegions->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    mRegions->verticalHeader()->setVisible(false);
+    mTypes->setPlaceholderText("e.g. 3, 9");
+    mFromLayer->setRange(0, 1000000);
+    mFromLayer->setSpecialValueText("next layer");
+    mActiveLabel->setStyleSheet("QLabel { color: #888888; }");
+    mActiveLabel->setWordWrap(true);
+
+    QPushButton* addBtn = new QPushButton("Add Region", this);
+    QPushButton* removeBtn = new QPushButton("Remove Region", this);
+    QHBoxLayout* regionButtons = new QHBoxLayout();
+    regionButtons->addWidget(addBtn);
+    regionButtons->addWidget(removeBtn);
+    regionButtons->addStretch(1);
+
+    QFormLayout* form = new QFormLayout();
+    form->addRow("Excluded geometry types:", mTypes);
+    form->addRow("From layer number:", mFromLayer);
+
+    QPushButton* applyBtn = new QPushButton("Apply", this);
+    QPushButton* clearBtn = new QPushButton("Clear All", this);
+    QPushButton* closeBtn = new QPushButton("Close", this);
+    QHBoxLayout* buttons = new QHBoxLayout();
+    buttons->addWidget(mActiveLabel, 1);
+    buttons->addWidget(applyBtn);
+    buttons->addWidget(clearBtn);
+    buttons->addWidget(closeBtn);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel("Nothing inside these plate regions is exposed in later layers:", this));
+    layout->addWidget(mRegions, 1);
+    layout->addLayout(regionButtons);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+
+    connect(addBtn, &QPushButton::clicked, this, &PartExclusionDialog::addRegion);
+    connect(removeBtn, &QPushButton::clicked, this, &PartExclusionDialog::removeRegion);
+    connect(applyBtn, &QPushButton::clicked, this, &PartExclusionDialog::applyRules);
+    connect(clearBtn, &QPushButton::clicked, this, &PartExclusionDialog::clearRules);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::close);
+
+    const auto active = mManager->exclusions();
+    loadRules(active ? *active : marc::PartExcluder::Rules{});
+}
+
+void PartExclusionDialog::addRegion() {
+    const int row = mRegions->rowCount();
+    mRegions->insertRow(row);
+    mRegions->setItem(row, Label, new QTableWidgetItem(QString("part %1").arg(row + 1)));
+    for (int c = MinX; c < ColumnCount; ++c) mRegions->setItem(row, c, new QTableWidgetItem("0.0"));
+    mRegions->setCurrentCell(row, MinX);
+}
+
+void PartExclusionDialog::removeRegion() {
+    const int row = mRegions->currentRow();
+    if (row >= 0) mRegions->removeRow(row);
+}
+
+void PartExclusionDialog::loadRules(const marc::PartExcluder::Rules& rules) {
+    mRegions->setRowCount(0);
+    for (const auto& r : rules.regions) {
+        const int row = mRegions->rowCount();
+        mRegions->insertRow(row);
+        mRegions->setItem(row, Label, new QTableWidgetItem(QString::fromStdString(r.label)));
+        mRegions->setItem(row, MinX, new QTableWidgetItem(QString::number(r.minX)));
+        mRegions->setItem(row, MinY, new QTableWidgetItem(QString::number(r.minY)));
+        mRegions->setItem(row, MaxX, new QTableWidgetItem(QString::number(r.maxX)));
+        mRegions->setItem(row, MaxY, new QTableWidgetItem(QString::number(r.maxY)));
+    }
+    QStringList types;
+    for (uint32_t t : rules.geometryTypes) types << QString::number(t);
+    mTypes->setText(types.join(", "));
+    mFromLayer->setValue(static_cast<int>(rules.fromLayer));
+    mActiveLabel->setText(QString("Active: %1").arg(summary(rules)));
+}
+
+bool PartExclusionDialog::readRules(marc::PartExcluder::Rules& rules, QString& error) const {
+    for (int row = 0; row < mRegions->rowCount(); ++row) {
+        double v[ColumnCount] = {};
+        for (int c = MinX; c < ColumnCount; ++c) {
+            const QTableWidgetItem* item = mRegions->item(row, c);
+            bool ok = false;
+            v[c] = item ? item->text().trimmed().toDouble(&ok) : 0.0;
+            if (!ok) {
+                error = QString("Region %1: '%2' is not a number").arg(row + 1).arg(item ? item->text() : QString());
+                return false;
+            }
+        }
+        if (!(v[MinX] < v[MaxX]) || !(v[MinY] < v[MaxY])) {
+            error = QString("Region %1: min must be smaller than max").arg(row + 1);
+            return false;
+        }
+        const QTableWidgetItem* label = mRegions->item(row, Label);
+        rules.regions.push_back({ v[MinX], v[MinY], v[MaxX], v[MaxY],
+                                  label ? label->text().toStdString() : std::string() });
+    }
+    for (const QString& part : mTypes->text().split(',')) {
+        const QString text = part.trimmed();
+        if (text.isEmpty()) continue;
+        bool ok = false;
+        const uint type = text.toUInt(&ok);
+        if (!ok) {
+            error = QString("'%1' is not a geometry type").arg(text);
+            return false;
+        }
+        rules.geometryTypes.push_back(type);
+    }
+    rules.fromLayer = static_cast<uint32_t>(mFromLayer->value());
+    return true;
+}
+
+void PartExclusionDialog::applyRules() {
+    marc::PartExcluder::Rules rules;
+    QString error;
+    if (!readRules(rules, error)) {
+        QMessageBox::warning(this, "Invalid Exclusion", error);
+        return;
+    }
+    mManager->setExclusions(rules);
+    mActiveLabel->setText(QString("Active: %1").arg(summary(rules)));
+    emit exclusionsChanged(summary(rules));
+}
+
+void PartExclusionDialog::clearRules() {
+    mManager->clearExclusions();
+    loadRules(marc::PartExcluder::Rules{});
+    emit exclusionsChanged(summary(marc::PartExcluder::Rules{}));
+}
+
+QString PartExclusionDialog::summary(const marc::PartExcluder::Rules& rules) {
+    if (rules.empty()) return "no exclusions";
+    QStringList parts;
+    for (const auto& r : rules.regions) {
+        parts << QString("%1 [%2, %3]-[%4, %5] mm")
+                     .arg(QString::fromStdString(r.label))
+                     .arg(r.minX).arg(r.minY).arg(r.maxX).arg(r.maxY);
+    }
+    if (!rules.geometryTypes.empty()) {
+        QStringList types;
+        for (uint32_t t : rules.geometryTypes) types << QString::number(t);
+        parts << QString("types %1").arg(types.join(", "));
+    }
+    QString text = parts.join("; ");
+    if (rules.fromLayer > 0) text += QString(" from layer %1").arg(rules.fromLayer);
+    return text;
+}
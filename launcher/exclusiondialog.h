@@ -0,0 +1,54 @@
+#ifndef EXCLUSIONDIALOG_H
+#define EXCLUSIONDIALOG_H
+
+#include <QDialog>
+#include <QString>
+
+#include "io/partexcluder.h"
+
+class QLabel;
+class QLineEdit;
+class QSpinBox;
+class QTableWidget;
+class ScanStreamingManager;
+
+/**
+ * @brief PartExclusionDialog - Edits the part exclusion of a running build
+ *
+ * DESIGN:
+ * - Modeless; shows the rules currently active in the ScanStreamingManager
+ *   and replaces them as a whole on Apply (marc::PartExcluder snapshot).
+ * - Regions are plate rectangles in mm, geometry types a comma separated
+ *   list of GeometryTag types. Invalid input is reported and nothing is
+ *   applied.
+ * - The producer picks the new rules up at the next layer it converts.
+ */
+class PartExclusionDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit PartExclusionDialog(ScanStreamingManager* manager, QWidget* parent = nullptr);
+
+signals:
+    // One-line description of the rules just applied (for the system log)
+    void exclusionsChanged(const QString& summary);
+
+private slots:
+    void addRegion();
+    void removeRegion();
+    void applyRules();
+    void clearRules();
+
+private:
+    void loadRules(const marc::PartExcluder::Rules& rules);
+    bool readRules(marc::PartExcluder::Rules& rules, QString& error) const;
+    static QString summary(const marc::PartExcluder::Rules& rules);
+
+    ScanStreamingManager* mManager;
+    QTableWidget* mRegions;
+    QLineEdit* mTypes;
+    QSpinBox* mFromLayer;
+    QLabel* mActiveLabel;
+};
+
+#endif // EXCLUSIONDIALOG_H
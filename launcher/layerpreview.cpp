@@ -0,0 +1,307 @@
+#include "layerpreview.h"
+#include "io/streamingmarcreader.h"
+
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QImage>
+#include <QLabel>
+#include <QMessageBox>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// ============================================================================
+// LayerPreviewWidget
+// ============================================================================
+
+LayerPreviewWidget::LayerPreviewWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setMinimumSize(400, 300);
+    setMouseTracking(false);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    // Dark background, hatches in green, contours towards white
+    mPalette.resize(256);
+    for (int v = 0; v < 256; ++v) {
+        mPalette[v] = v == 0 ? qRgb(0x1E, 0x1E, 0x1E)
+                             : qRgb(v * 3 / 4, std::min(255, 60 + v), v * 3 / 4);
+    }
+}
+
+void LayerPreviewWidget::setRaster(std::shared_ptr<const marc::LayerRaster> raster, bool keepView) {
+    mRaster = std::move(raster);
+    mTileCache.clear();
+    if (!keepView) fitToPlate();
+    update();
+}
+
+void LayerPreviewWidget::fitToPlate() {
+    if (!mRaster || mRaster->plateWidth() <= 0.0 || mRaster->plateHeight() <= 0.0) return;
+    mCenterX = mRaster->plateMinX() + mRaster->plateWidth() / 2.0;
+    mCenterY = mRaster->plateMinY() + mRaster->plateHeight() / 2.0;
+    // Before the first show the widget has no size yet; fall back to the minimum
+    const double w = std::max(width(), minimumWidth());
+    const double h = std::max(height(), minimumHeight());
+    mScale = std::min(w / mRaster->plateWidth(), h / mRaster->plateHeight()) * 0.95;
+    update();
+}
+
+const QPixmap* LayerPreviewWidget::tilePixmap(int level, int tx, int ty) {
+    const quint64 key = (static_cast<quint64>(level) << 48) | (static_cast<quint64>(ty) << 24) |
+                        static_cast<quint64>(tx);
+    auto it = mTileCache.find(key);
+    if (it != mTileCache.end()) return &it.value();
+
+    const uint8_t* pixels = mRaster->tile(level, tx, ty);
+    if (!pixels) return nullptr;
+
+    const int ts = mRaster->tileSize();
+    QImage image(pixels, ts, ts, ts, QImage::Format_Indexed8);   // wraps, no copy
+    image.setColorTable(mPalette);
+    it = mTileCache.insert(key, QPixmap::fromImage(image));
+    return &it.value();
+}
+
+void LayerPreviewWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0x1E, 0x1E, 0x1E));
+    if (!mRaster || mRaster->levelCount() == 0) {
+        painter.setPen(QColor("#888888"));
+        painter.drawText(rect(), Qt::AlignCenter, "No layer");
+        return;
+    }
+
+    const int level = mRaster->levelForScale(mScale);
+    const double levelPixelsPerMm = mRaster->pixelsPerMm() / std::ldexp(1.0, level);
+    const int ts = mRaster->tileSize();
+    const double tileMm = ts / levelPixelsPerMm;
+    const double plateTop = mRaster->plateMinY() + mRaster->plateHeight();
+
+    // Visible plate rectangle (mm) -> tile range at this level
+    const double halfW = width() / (2.0 * mScale);
+    const double halfH = height() / (2.0 * mScale);
+    const int tx0 = std::max(0, static_cast<int>(std::floor((mCenterX - halfW - mRaster->plateMinX()) / tileMm)));
+    const int tx1 = std::min(mRaster->tilesX(level) - 1,
+                             static_cast<int>(std::floor((mCenterX + halfW - mRaster->plateMinX()) / tileMm)));
+    const int ty0 = std::max(0, static_cast<int>(std::floor((plateTop - (mCenterY + halfH)) / tileMm)));
+    const int ty1 = std::min(mRaster->tilesY(level) - 1,
+                             static_cast<int>(std::floor((plateTop - (mCenterY - halfH)) / tileMm)));
+
+    // Nearest-neighbour when magnified keeps single vectors crisp
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, mScale < levelPixelsPerMm);
+
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const QPixmap* pm = tilePixmap(level, tx, ty);
+            if (!pm) continue;
+            const double mmX = mRaster->plateMinX() + tx * tileMm;
+            const double mmTop = plateTop - ty * tileMm;
+            const QRectF target(width() / 2.0 + (mmX - mCenterX) * mScale,
+                                height() / 2.0 - (mmTop - mCenterY) * mScale,
+                                tileMm * mScale, tileMm * mScale);
+            painter.drawPixmap(target, *pm, QRectF(0, 0, ts, ts));
+        }
+    }
+
+    // Plate outline
+    painter.setPen(QColor("#3E3E42"));
+    painter.drawRect(QRectF(width() / 2.0 + (mRaster->plateMinX() - mCenterX) * mScale,
+                            height() / 2.0 - (plateTop - mCenterY) * mScale,
+                            mRaster->plateWidth() * mScale, mRaster->plateHeight() * mScale));
+
+    painter.setPen(QColor("#888888"));
+    painter.drawText(8, height() - 8, QString("%1 px/mm  |  level %2/%3")
+                                          .arg(mScale, 0, 'f', 1).arg(level).arg(mRaster->levelCount() - 1));
+}
+
+void LayerPreviewWidget::wheelEvent(QWheelEvent* event) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QPointF pos = event->position();
+#else
+    const QPointF pos = event->pos();
+#endif
+    // Keep the plate point under the cursor fixed while zooming
+    const double mmX = mCenterX + (pos.x() - width() / 2.0) / mScale;
+    const double mmY = mCenterY - (pos.y() - height() / 2.0) / mScale;
+    const double factor = std::pow(1.0015, event->angleDelta().y());
+    mScale = std::clamp(mScale * factor, 0.05, 400.0);
+    mCenterX = mmX - (pos.x() - width() / 2.0) / mScale;
+    mCenterY = mmY + (pos.y() - height() / 2.0) / mScale;
+    update();
+    event->accept();
+}
+
+void LayerPreviewWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        mDragging = true;
+        mLastMouse = event->pos();
+        mPressPos = event->pos();
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void LayerPreviewWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (!mDragging) return;
+    const QPoint delta = event->pos() - mLastMouse;
+    mLastMouse = event->pos();
+    mCenterX -= delta.x() / mScale;
+    mCenterY += delta.y() / mScale;
+    update();
+}
+
+void LayerPreviewWidget::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        mDragging = false;
+        unsetCursor();
+        if (mRaster && (event->pos() - mPressPos).manhattanLength() < 4) {
+            emit plateClicked(mCenterX + (event->pos().x() - width() / 2.0) / mScale,
+                              mCenterY - (event->pos().y() - height() / 2.0) / mScale,
+                              8.0 / mScale);
+        }
+    }
+}
+
+void LayerPreviewWidget::mouseDoubleClickEvent(QMouseEvent*) {
+    fitToPlate();
+}
+
+// ============================================================================
+// LayerPreviewDialog
+// ============================================================================
+
+LayerPreviewDialog::LayerPreviewDialog(const QString& marcPath, QWidget* parent)
+    : QDialog(parent)
+    , mMarcPath(marcPath)
+    , mView(new LayerPreviewWidget(this))
+    , mLayerSpin(new QSpinBox(this))
+    , mInfoLabel(new QLabel(this))
+{
+    setWindowTitle(QString("Layer Preview - %1").arg(marcPath));
+    resize(1000, 800);
+
+    mReader = std::make_unique<marc::StreamingMarcReader>(marcPath.toStdWString());
+    const int total = static_cast<int>(mReader->totalLayers());
+
+    mLayerSpin->setRange(0, std::max(0, total - 1));
+    mLayerSpin->setPrefix("Layer index ");
+    mLayerSpin->setKeyboardTracking(false);
+    mInfoLabel->setStyleSheet("QLabel { color: #888888; }");
+
+    QPushButton* fitBtn = new QPushButton("Fit", this);
+    QPushButton* exportBtn = new QPushButton("Export PNG Tiles...", this);
+
+    QHBoxLayout* toolbar = new QHBoxLayout();
+    toolbar->addWidget(mLayerSpin);
+    toolbar->addWidget(fitBtn);
+    toolbar->addWidget(exportBtn);
+    toolbar->addWidget(mInfoLabel, 1);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addLayout(toolbar);
+    layout->addWidget(mView, 1);
+
+    connect(mLayerSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &LayerPreviewDialog::showLayer);
+    connect(fitBtn, &QPushButton::clicked, mView, &LayerPreviewWidget::fitToPlate);
+    connect(exportBtn, &QPushButton::clicked, this, &LayerPreviewDialog::exportTiles);
+    connect(mView, &LayerPreviewWidget::plateClicked, this, &LayerPreviewDialog::pickAt);
+
+    if (total > 0) showLayer(0);
+}
+
+LayerPreviewDialog::~LayerPreviewDialog() = default;
+
+void LayerPreviewDialog::showLayer(int index) {
+    try {
+        // Forward seeks skip raw bytes; going back reopens the stream
+        if (static_cast<uint32_t>(index) < mReader->currentLayerIndex()) {
+            mReader = std::make_unique<marc::StreamingMarcReader>(mMarcPath.toStdWString());
+        }
+        std::vector<char> skip;
+        while (mReader->currentLayerIndex() < static_cast<uint32_t>(index) && mReader->hasNextLayer()) {
+            mReader->readNextLayerBytes(skip);
+        }
+        if (!mReader->hasNextLayer()) return;
+        mLayer = mReader->readNextLayer();
+        const marc::Layer& layer = mLayer;
+
+        QElapsedTimer timer;
+        timer.start();
+        const bool firstLayer = !mRaster;
+        auto raster = std::make_shared<marc::LayerRaster>(mRasterOptions);
+        raster->render(layer);
+        if (firstLayer) {
+            // Lock the plate so all layers share one coordinate frame
+            mRasterOptions.plateMinX = raster->plateMinX();
+            mRasterOptions.plateMinY = raster->plateMinY();
+            mRasterOptions.plateWidth = raster->plateWidth();
+            mRasterOptions.plateHeight = raster->plateHeight();
+        }
+        mRaster = raster;
+        mCurrentLayerNumber = static_cast<int>(layer.layerNumber);
+        mView->setRaster(mRaster, !firstLayer);
+        mIndex.build(mLayer);
+
+        const auto& st = mRaster->stats();
+        mLayerInfo = QString("Layer %1  Z=%2 mm  |  %3 vectors, %4 tiles, %5 levels  |  %6 ms")
+                         .arg(layer.layerNumber).arg(layer.layerHeight, 0, 'f', 3)
+                         .arg(static_cast<qulonglong>(st.vectors)).arg(static_cast<qulonglong>(st.tiles)).arg(mRaster->levelCount())
+                         .arg(timer.elapsed());
+        mInfoLabel->setText(mLayerInfo);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Preview Failed", QString("Cannot read layer %1: %2").arg(index).arg(e.what()));
+    }
+}
+
+void LayerPreviewDialog::pickAt(double xMm, double yMm, double toleranceMm) {
+    const std::vector<uint32_t> hit = mIndex.nearest(xMm, yMm, 1, toleranceMm);
+    if (hit.empty()) {
+        mInfoLabel->setText(QString("%1  |  (%2, %3) mm: nothing").arg(mLayerInfo).arg(xMm, 0, 'f', 3).arg(yMm, 0, 'f', 3));
+        return;
+    }
+
+    const marc::LayerIndex::Item& it = mIndex.item(hit[0]);
+    QString what = QString("%1 #%2").arg(marc::LayerIndex::kindName(it.kind)).arg(it.geometry);
+    uint32_t type = 0;
+    switch (it.kind) {
+    case marc::LayerIndex::Kind::Hatch:
+        what += QString(" line %1").arg(it.element);
+        type = mLayer.hatches[it.geometry].tag.type;
+        break;
+    case marc::LayerIndex::Kind::Polyline:
+        what += QString(", %1 points").arg(static_cast<qulonglong>(mLayer.polylines[it.geometry].points.size()));
+        type = mLayer.polylines[it.geometry].tag.type;
+        break;
+    case marc::LayerIndex::Kind::Polygon:
+        what += QString(", %1 points").arg(static_cast<qulonglong>(mLayer.polygons[it.geometry].points.size()));
+        type = mLayer.polygons[it.geometry].tag.type;
+        break;
+    case marc::LayerIndex::Kind::Circle:
+        type = mLayer.support_circles[it.geometry].tag.type;
+        break;
+    }
+    mInfoLabel->setText(QString("%1  |  %2 (type %3), %4 mm away")
+                            .arg(mLayerInfo).arg(what).arg(type).arg(mIndex.distance(hit[0], xMm, yMm), 0, 'f', 3));
+}
+
+void LayerPreviewDialog::exportTiles() {
+    if (!mRaster) return;
+    const QString dir = QFileDialog::getExistingDirectory(this, "Export PNG Tiles");
+    if (dir.isEmpty()) return;
+
+    const QString outDir = QString("%1/layer_%2").arg(dir).arg(mCurrentLayerNumber, 6, 10, QChar('0'));
+    std::string err;
+    if (mRaster->exportPng(outDir.toStdString(), &err)) {
+        QMessageBox::information(this, "Tiles Exported", QString("PNG tiles written to:\n%1").arg(outDir));
+    } else {
+        QMessageBox::critical(this, "Export Failed", QString::fromStdString(err));
+    }
+}
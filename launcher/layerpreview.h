@@ -0,0 +1,105 @@
+#ifndef LAYERPREVIEW_H
+#define LAYERPREVIEW_H
+
+#include <QColor>
+#include <QDialog>
+#include <QHash>
+#include <QPixmap>
+#include <QPoint>
+#include <QVector>
+#include <QWidget>
+
+#include <memory>
+#include <string>
+
+#include "io/layerindex.h"
+#include "io/layerraster.h"
+
+class QLabel;
+class QSpinBox;
+
+namespace marc { class StreamingMarcReader; }
+
+/**
+ * @brief LayerPreviewWidget - Zoomable view over a marc::LayerRaster pyramid
+ *
+ * DESIGN:
+ * - Each frame picks the pyramid level matching the zoom
+ *   (LayerRaster::levelForScale) and draws only the visible tiles.
+ * - Tiles are converted to QPixmap once (8-bit -> palette) and cached per
+ *   (level, tile); pan/zoom afterwards is pure pixmap blits.
+ * - Wheel zooms around the cursor, left drag pans, double click fits the plate,
+ *   a click without drag reports the plate position (plateClicked).
+ */
+class LayerPreviewWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit LayerPreviewWidget(QWidget* parent = nullptr);
+
+    void setRaster(std::shared_ptr<const marc::LayerRaster> raster, bool keepView);
+    void fitToPlate();
+
+signals:
+    // Click without drag: plate position and a pick radius of a few screen pixels (mm)
+    void plateClicked(double xMm, double yMm, double toleranceMm);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+private:
+    const QPixmap* tilePixmap(int level, int tx, int ty);
+
+    std::shared_ptr<const marc::LayerRaster> mRaster;
+    QHash<quint64, QPixmap> mTileCache;     // key = level << 48 | ty << 24 | tx
+    QVector<QRgb> mPalette;
+
+    double mScale = 1.0;                    // screen pixels per mm
+    double mCenterX = 0.0;                  // view center in mm
+    double mCenterY = 0.0;
+    bool mDragging = false;
+    QPoint mLastMouse;
+    QPoint mPressPos;
+};
+
+/**
+ * @brief LayerPreviewDialog - Browse layers of a .marc file as raster tiles
+ *
+ * Layers are streamed (StreamingMarcReader, forward seeks read raw bytes
+ * only); the plate rectangle is fixed by the first rendered layer so layers
+ * stay aligned while stepping through the build. The shown layer is kept
+ * with a marc::LayerIndex so a click names the geometry under the cursor.
+ */
+class LayerPreviewDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    LayerPreviewDialog(const QString& marcPath, QWidget* parent = nullptr);
+    ~LayerPreviewDialog() override;
+
+private slots:
+    void showLayer(int index);
+    void exportTiles();
+    void pickAt(double xMm, double yMm, double toleranceMm);
+
+private:
+    QString mMarcPath;
+    std::unique_ptr<marc::StreamingMarcReader> mReader;
+    marc::LayerRaster::Options mRasterOptions;
+    std::shared_ptr<marc::LayerRaster> mRaster;
+    int mCurrentLayerNumber = -1;
+    marc::Layer mLayer;
+    marc::LayerIndex mIndex;                // over mLayer, rebuilt per layer
+    QString mLayerInfo;
+
+    LayerPreviewWidget* mView = nullptr;
+    QSpinBox* mLayerSpin = nullptr;
+    QLabel* mInfoLabel = nullptr;
+};
+
+#endif // LAYERPREVIEW_H
@@ -0,0 +1,268 @@
+#include "logview.h"
+
+#include <QBrush>
+#include <QCheckBox>
+#include <QColor>
+#include <QComboBox>
+#include <QFont>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QMutexLocker>
+#include <QScrollBar>
+#include <QTimer>
+#include <QVBoxLayout>
+
+// ============================================================================
+// LogModel
+// ============================================================================
+
+LogModel::LogModel(int capacity, QObject* parent)
+    : QAbstractListModel(parent)
+    , mCapacity(capacity < 16 ? 16 : capacity)
+{
+    mRing.resize(mCapacity);
+}
+
+void LogModel::append(const QString& text) {
+    QMutexLocker lock(&mPendingMutex);
+    if (text.contains('\n')) {
+        mPending << text.split('\n');
+    } else {
+        mPending << text;
+    }
+}
+
+void LogModel::append(const QStringList& lines) {
+    QMutexLocker lock(&mPendingMutex);
+    for (const QString& line : lines) {
+        if (line.contains('\n')) mPending << line.split('\n');
+        else mPending << line;
+    }
+}
+
+int LogModel::flush() {
+    QStringList batch;
+    {
+        QMutexLocker lock(&mPendingMutex);
+        batch.swap(mPending);
+    }
+    if (batch.isEmpty()) return 0;
+
+    // Only the newest mCapacity lines of the batch can survive
+    int first = 0;
+    if (batch.size() > mCapacity) {
+        first = batch.size() - mCapacity;
+        mDropped += static_cast<quint64>(first);
+    }
+    const int incoming = batch.size() - first;
+
+    // Evict the oldest rows in one step
+    const int overflow = mCount + incoming - mCapacity;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        for (int i = 0; i < overflow; ++i) mRing[(mHead + i) % mCapacity].text.clear();
+        mHead = (mHead + overflow) % mCapacity;
+        mCount -= overflow;
+        mDropped += static_cast<quint64>(overflow);
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), mCount, mCount + incoming - 1);
+    for (int i = first; i < batch.size(); ++i) {
+        Entry& e = mRing[(mHead + mCount) % mCapacity];
+        e.text = batch[i];
+        e.severity = classify(e.text);
+        ++mCount;
+    }
+    endInsertRows();
+    return incoming;
+}
+
+void LogModel::clear() {
+    {
+        QMutexLocker lock(&mPendingMutex);
+        mPending.clear();
+    }
+    beginResetModel();
+    for (auto& e : mRing) e.text.clear();
+    mHead = 0;
+    mCount = 0;
+    endResetModel();
+}
+
+QString LogModel::toPlainText() const {
+    QStringList lines;
+    lines.reserve(mCount);
+    for (int row = 0; row < mCount; ++row) lines << at(row).text;
+    return lines.join('\n');
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : mCount;
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= mCount) return QVariant();
+    const Entry& e = at(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return e.text;
+    case SeverityRole:
+        return static_cast<int>(e.severity);
+    case Qt::ForegroundRole:
+        if (e.severity == Error) return QBrush(QColor("#F44336"));
+        if (e.severity == Warning) return QBrush(QColor("#FFB300"));
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+LogModel::Severity LogModel::classify(const QString& line) {
+    // Matches the prefixes used across controllers and ScanStreamingManager
+    if (line.contains(QLatin1String("ERROR"), Qt::CaseInsensitive) ||
+        line.contains(QLatin1String("CRITICAL")) ||
+        line.contains(QLatin1String("FAILED"), Qt::CaseInsensitive) ||
+        line.contains(QChar(0x2717))) {           // ✗
+        return Error;
+    }
+    if (line.contains(QLatin1String("WARNING"), Qt::CaseInsensitive) ||
+        line.contains(QChar(0x26A0))) {           // ⚠
+        return Warning;
+    }
+    return Info;
+}
+
+// ============================================================================
+// LogFilterProxy
+// ============================================================================
+
+LogFilterProxy::LogFilterProxy(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+    setDynamicSortFilter(true);
+}
+
+void LogFilterProxy::setMinimumSeverity(int severity) {
+    if (severity == mMinSeverity) return;
+    mMinSeverity = severity;
+    invalidateFilter();
+}
+
+void LogFilterProxy::setSearchText(const QString& text) {
+    if (text == mSearch) return;
+    mSearch = text;
+    invalidateFilter();
+}
+
+bool LogFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    if (mMinSeverity == LogModel::Info && mSearch.isEmpty()) return true;
+
+    const QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+    if (idx.data(LogModel::SeverityRole).toInt() < mMinSeverity) return false;
+    return mSearch.isEmpty() || idx.data(Qt::DisplayRole).toString().contains(mSearch, Qt::CaseInsensitive);
+}
+
+// ============================================================================
+// LogView
+// ============================================================================
+
+LogView::LogView(QWidget* parent, int capacity)
+    : QWidget(parent)
+    , mModel(new LogModel(capacity, this))
+    , mProxy(new LogFilterProxy(this))
+    , mList(new QListView(this))
+    , mSeverityFilter(new QComboBox(this))
+    , mSearch(new QLineEdit(this))
+    , mFollow(new QCheckBox("Follow", this))
+    , mCountLabel(new QLabel(this))
+    , mFrameTimer(new QTimer(this))
+{
+    mProxy->setSourceModel(mModel);
+
+    // Virtualized list: uniform rows, so only the visible rows are laid out
+    mList->setModel(mProxy);
+    mList->setUniformItemSizes(true);
+    mList->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    mList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    mList->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    mList->setStyleSheet(
+        "QListView { "
+        "   font-family: 'Consolas', 'Courier New', monospace; "
+        "   font-size: 9pt; "
+        "   background-color: #1E1E1E; "
+        "   color: #D4D4D4; "
+        "   border: 1px solid #3E3E42; "
+        "   border-radius: 4px; "
+        "}"
+    );
+
+    mSeverityFilter->addItem("All", LogModel::Info);
+    mSeverityFilter->addItem("Warnings + Errors", LogModel::Warning);
+    mSeverityFilter->addItem("Errors", LogModel::Error);
+    mSearch->setPlaceholderText("Search log...");
+    mSearch->setClearButtonEnabled(true);
+    mFollow->setChecked(true);
+    mCountLabel->setStyleSheet("QLabel { color: #888888; font-size: 8pt; }");
+
+    QHBoxLayout* toolbar = new QHBoxLayout();
+    toolbar->setContentsMargins(0, 0, 0, 0);
+    toolbar->addWidget(mSeverityFilter);
+    toolbar->addWidget(mSearch, 1);
+    toolbar->addWidget(mFollow);
+    toolbar->addWidget(mCountLabel);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(4);
+    layout->addLayout(toolbar);
+    layout->addWidget(mList, 1);
+
+    connect(mSeverityFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) {
+        mProxy->setMinimumSeverity(mSeverityFilter->currentData().toInt());
+    });
+    connect(mSearch, &QLineEdit::textChanged, mProxy, &LogFilterProxy::setSearchText);
+
+    // Scrolling up stops following; returning to the bottom resumes it
+    connect(mList->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        QScrollBar* bar = mList->verticalScrollBar();
+        if (value < bar->maximum() && bar->isSliderDown()) mFollow->setChecked(false);
+        else if (value == bar->maximum() && bar->isSliderDown()) mFollow->setChecked(true);
+    });
+
+    // Frame timer: coalesce appends (~30 Hz)
+    connect(mFrameTimer, &QTimer::timeout, this, &LogView::onFrame);
+    mFrameTimer->start(33);
+}
+
+void LogView::append(const QString& text) {
+    mModel->append(text);
+}
+
+void LogView::append(const QStringList& lines) {
+    mModel->append(lines);
+}
+
+void LogView::clear() {
+    mModel->clear();
+    mCountLabel->clear();
+}
+
+QString LogView::toPlainText() const {
+    mModel->flush();
+    return mModel->toPlainText();
+}
+
+void LogView::onFrame() {
+    if (mModel->flush() == 0) return;
+
+    if (mFollow->isChecked()) mList->scrollToBottom();
+
+    const int shown = mProxy->rowCount();
+    const int total = mModel->rowCount();
+    mCountLabel->setText(shown == total ? QString("%1 lines").arg(total)
+                                        : QString("%1 / %2 lines").arg(shown).arg(total));
+}
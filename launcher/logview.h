@@ -0,0 +1,134 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QWidget>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QListView;
+class QTimer;
+
+/**
+ * @brief LogModel - Ring buffer of log lines exposed as a list model
+ *
+ * DESIGN:
+ * - append() may be called from any thread; lines go to a pending batch
+ *   under a mutex and never touch the view directly.
+ * - flush() (GUI thread, driven by LogView's frame timer) moves the whole
+ *   batch into the ring with ONE beginInsertRows/endInsertRows, and drops the
+ *   oldest lines with ONE beginRemoveRows when the capacity is exceeded.
+ * - Row access is O(1) (head offset into a fixed-size vector).
+ */
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Severity { Info = 0, Warning = 1, Error = 2 };
+    enum Roles { SeverityRole = Qt::UserRole + 1 };
+
+    explicit LogModel(int capacity = 100000, QObject* parent = nullptr);
+
+    // Thread-safe: queue lines for the next flush (multi-line text is split)
+    void append(const QString& text);
+    void append(const QStringList& lines);
+
+    // GUI thread: publish pending lines, returns the number of lines added
+    int flush();
+    void clear();
+
+    int capacity() const { return mCapacity; }
+    quint64 droppedLines() const { return mDropped; }
+    QString toPlainText() const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    static Severity classify(const QString& line);
+
+private:
+    struct Entry {
+        QString text;
+        Severity severity = Info;
+    };
+
+    const Entry& at(int row) const { return mRing[(mHead + row) % mCapacity]; }
+
+    const int mCapacity;
+    QVector<Entry> mRing;       // fixed size, mCount valid entries starting at mHead
+    int mHead = 0;
+    int mCount = 0;
+    quint64 mDropped = 0;       // lines evicted by the ring
+
+    mutable QMutex mPendingMutex;
+    QStringList mPending;
+};
+
+/**
+ * @brief LogFilterProxy - Minimum severity + case-insensitive text search
+ */
+class LogFilterProxy : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    explicit LogFilterProxy(QObject* parent = nullptr);
+
+    void setMinimumSeverity(int severity);
+    void setSearchText(const QString& text);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    int mMinSeverity = LogModel::Info;
+    QString mSearch;
+};
+
+/**
+ * @brief LogView - System log widget for high message rates
+ *
+ * Replaces the rich-text QTextEdit log: a QListView with uniform row
+ * heights only lays out the visible rows, and appends are coalesced on a
+ * frame timer (~30 Hz), so 10k+ messages/s cost a handful of model resets
+ * per second instead of one document relayout per line.
+ *
+ * Filter by severity, search text, and "Follow" (auto-scroll while the view
+ * is at the bottom) are available from the toolbar row.
+ */
+class LogView : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit LogView(QWidget* parent = nullptr, int capacity = 100000);
+
+    // Thread-safe (same call shape as QTextEdit::append)
+    void append(const QString& text);
+    void append(const QStringList& lines);
+
+    void clear();
+    QString toPlainText() const;
+
+    LogModel* model() const { return mModel; }
+
+private slots:
+    void onFrame();
+
+private:
+    LogModel* mModel;
+    LogFilterProxy* mProxy;
+    QListView* mList;
+    QComboBox* mSeverityFilter;
+    QLineEdit* mSearch;
+    QCheckBox* mFollow;
+    QLabel* mCountLabel;
+    QTimer* mFrameTimer;
+};
+
+#endif // LOGVIEW_H
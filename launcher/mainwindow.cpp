@@ -4,13 +4,19 @@
 #include "controllers/processcontroller.h"
 #include "controllers/slm_worker_manager.h"
 #include "ProjectManager.h"
+#include "diagnostics/trace.h"
+#include "diagnostics/logring.h"
+#include "logview.h"
+#include "layerpreview.h"
+#include "exclusiondialog.h"
+#include "scanoverlay.h"
 
 #include <windows.h>
 #include <QMessageBox>
 #include <QTimerEvent>
 #include <QString>
+#include <QStringList>
 #include <QTimer>
-#include <QTextEdit>
 #include <QLCDNumber>
 #include <QDoubleSpinBox>
 #include <QPushButton>
@@ -27,6 +33,8 @@
 #include <QMenu>
 #include <QAction>
 #include <QStatusBar>
+#include <QProgressBar>
+#include <QProgressDialog>
 #include <QFileDialog>
 #include <QTextStream>
 #include <QFile>
@@ -37,11 +45,16 @@
 #include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <QDesktopServices>
 #include <QUrl>
+#include <QDateTime>
+#include <QFileInfo>
 
 #include "io/readSlices.h"
 #include "io/writeSVG.h"
+#include "io/svgexportjob.h"
+#include "io/buildvalidator.h"
 
 // ============================================================================
 // MainWindow Implementation
@@ -52,12 +65,12 @@ MainWindow::MainWindow(QWidget* parent)
     // Setup UI first
     setupUI();
     
-    // Create controllers AFTER UI (they need textEdit for logging)
-    mOPCController = new OPCController(textEdit, this);
-    mScannerController = new ScannerController(textEdit, this);
+    // Create controllers AFTER UI (they need logView for logging)
+    mOPCController = new OPCController(logView, this);
+    mScannerController = new ScannerController(logView, this);
     mScanManager = new ScanStreamingManager(this);  // Create BEFORE ProcessController
     mProcessController = new ProcessController(
-        mOPCController, mScannerController, textEdit, mScanManager, this);  // Pass streaming manager
+        mOPCController, mScannerController, logView, mScanManager, this);  // Pass streaming manager
     mProjectManager = new ProjectManager(this);
     
     // ========== INDUSTRIAL THREADING: SLM Worker Manager ==========
@@ -71,7 +84,7 @@ MainWindow::MainWindow(QWidget* parent)
     
     // Connect scanner controller logging to text edit (thread-safe)
     connect(mScannerController, &ScannerController::logMessage, this, [this](const QString& msg) {
-        textEdit->append(msg);
+        logView->append(msg);
     });
     
     // Setup menu bar (uses mProjectManager)
@@ -80,12 +93,39 @@ MainWindow::MainWindow(QWidget* parent)
     // Connect controller signals to UI
     connectControllerSignals();
 
+    // Drain hot-path log messages in batches (10 Hz) instead of one Qt event per message;
+    // LogView publishes them on its own frame timer
+    mLogDrainTimer = new QTimer(this);
+    connect(mLogDrainTimer, &QTimer::timeout, this, &MainWindow::drainLogRing);
+    mLogDrainTimer->start(100);
+
+    // Build progress: poll the lock-free status snapshot at display rate
+    mPipelineStatusLabel = new QLabel(this);
+    mPipelineProgress = new QProgressBar(this);
+    mPipelineProgress->setMaximumWidth(220);
+    mPipelineProgress->setTextVisible(true);
+    mPipelineProgress->hide();
+    statusBar()->addPermanentWidget(mPipelineStatusLabel);
+    statusBar()->addPermanentWidget(mPipelineProgress);
+    mStatusPollTimer = new QTimer(this);
+    connect(mStatusPollTimer, &QTimer::timeout, this, &MainWindow::pollPipelineStatus);
+    mStatusPollTimer->start(16);
+
+    // Live scan overlay: draws the executing layer's command block off the GUI thread
+    mScanOverlayDock = new QDockWidget("Live Scan", this);
+    mScanOverlay = new ScanOverlayWidget(mScanManager->progressFeed(), mScanOverlayDock);
+    mScanOverlayDock->setWidget(mScanOverlay);
+    addDockWidget(Qt::RightDockWidgetArea, mScanOverlayDock);
+
     // Show welcome message
-    textEdit->append("Initializing MarcSLM Controller!");
-    textEdit->append("→ Use 'Initialize OPC' and 'Initialize Scanner' buttons to begin");
+    logView->append("Initializing MarcSLM Controller!");
+    logView->append("→ Use 'Initialize OPC' and 'Initialize Scanner' buttons to begin");
 }
 
 MainWindow::~MainWindow() {
+    // The overlay's renderer thread reads mScanManager's feed: stop it first
+    delete mScanOverlay;
+    mScanOverlay = nullptr;
     // Controllers deleted automatically by Qt parent-child relationship
 }
 
@@ -111,14 +151,12 @@ void MainWindow::connectControllerSignals() {
             this, &MainWindow::onProcessStateChanged);
     connect(mProcessController, &ProcessController::layerPreparedByPLC,
             this, [this]() {
-                textEdit->append("✓ Layer prepared by PLC - scanning initiated");
+                logView->append("✓ Layer prepared by PLC - scanning initiated");
             });
     
     // Connect ScanStreamingManager signals
     connect(mScanManager, &ScanStreamingManager::statusMessage,
             this, &MainWindow::onScanProcessStatusMessage);
-    connect(mScanManager, &ScanStreamingManager::progress,
-            this, &MainWindow::onScanProcessProgress);
     connect(mScanManager, &ScanStreamingManager::finished,
             this, &MainWindow::onScanProcessFinished);
     connect(mScanManager, &ScanStreamingManager::error,
@@ -256,20 +294,10 @@ void MainWindow::setupUI() {
     QVBoxLayout* logLayout = new QVBoxLayout(logGroup);
     logLayout->setContentsMargins(8, 12, 8, 8);
     
-    textEdit = new QTextEdit(this);
-    textEdit->setReadOnly(true);
-    textEdit->setMinimumHeight(200);
-    textEdit->setStyleSheet(
-        "QTextEdit { "
-        "   font-family: 'Consolas', 'Courier New', monospace; "
-        "   font-size: 9pt; "
-        "   background-color: #1E1E1E; "
-        "   color: #D4D4D4; "
-        "   border: 1px solid #3E3E42; "
-        "   border-radius: 4px; "
-        "}"
-    );
-    logLayout->addWidget(textEdit);
+    // Virtualized log: ring-buffer model, appends coalesced per frame
+    logView = new LogView(this);
+    logView->setMinimumHeight(200);
+    logLayout->addWidget(logView);
     
     leftColumn->addWidget(logGroup, 1);
     mainLayout->addLayout(leftColumn, 3);
@@ -645,6 +673,11 @@ void MainWindow::setupMenuBar() {
     connect(actionGenerateSVGs, &QAction::triggered, this, &MainWindow::onViewGenerateSVGs);
     viewMenu->addAction(actionGenerateSVGs);
 
+    QAction* actionLayerPreview = new QAction("Layer &Preview...", this);
+    actionLayerPreview->setStatusTip("Browse layers of the attached .marc file as a zoomable raster");
+    connect(actionLayerPreview, &QAction::triggered, this, &MainWindow::onViewLayerPreview);
+    viewMenu->addAction(actionLayerPreview);
+
     // ========== RUN MENU ==========
     QMenu* runMenu = menuBar->addMenu("&Run");
     
@@ -661,6 +694,16 @@ void MainWindow::setupMenuBar() {
     actionStart->setStatusTip("Start the manufacturing process");
     connect(actionStart, &QAction::triggered, this, &MainWindow::onRunStart);
     runMenu->addAction(actionStart);
+
+    QAction* actionResume = new QAction("&Resume Build...", this);
+    actionResume->setStatusTip("Continue the project's interrupted build after its last completed layer");
+    connect(actionResume, &QAction::triggered, this, &MainWindow::onRunResume);
+    runMenu->addAction(actionResume);
+
+    QAction* actionPreflight = new QAction("Pre-&flight Check", this);
+    actionPreflight->setStatusTip("Check every layer of the attached MARC file against the JSON configuration");
+    connect(actionPreflight, &QAction::triggered, this, &MainWindow::onRunPreflight);
+    runMenu->addAction(actionPreflight);
     
     actionPause = new QAction("&Pause", this);
     actionPause->setShortcut(QKeySequence("F7"));
@@ -673,6 +716,19 @@ void MainWindow::setupMenuBar() {
     actionStop->setStatusTip("Stop current operation");
     connect(actionStop, &QAction::triggered, this, &MainWindow::onRunStop);
     runMenu->addAction(actionStop);
+
+    QAction* actionExcludeParts = new QAction("E&xclude Parts...", this);
+    actionExcludeParts->setStatusTip("Stop exposing plate regions or geometry types from the next layer on, without restarting");
+    connect(actionExcludeParts, &QAction::triggered, this, &MainWindow::onRunExcludeParts);
+    runMenu->addAction(actionExcludeParts);
+
+    QAction* actionReloadStyles = new QAction("Reload &Build Styles", this);
+    actionReloadStyles->setStatusTip("Re-read the JSON configuration; valid changes apply from the next layer converted");
+    connect(actionReloadStyles, &QAction::triggered, this, [this]() {
+        logView->append("Run -> Reload Build Styles");
+        if (mScanManager) mScanManager->reloadBuildStyles();
+    });
+    runMenu->addAction(actionReloadStyles);
     
     runMenu->addSeparator();
     
@@ -706,6 +762,15 @@ void MainWindow::setupMenuBar() {
     QAction* actionAttachJson = new QAction("Attach &Configuration (.json)...", this);
     connect(actionAttachJson, &QAction::triggered, this, &MainWindow::onProjectAttachJson);
     projectMenu->addAction(actionAttachJson);
+
+    projectMenu->addSeparator();
+
+    QAction* actionCancelAnalysis = new QAction("Cancel MARC &Analysis", this);
+    actionCancelAnalysis->setStatusTip("Stop reading layer statistics of the attached MARC file in the background");
+    connect(actionCancelAnalysis, &QAction::triggered, this, [this]() {
+        if (mProjectManager) mProjectManager->cancelAnalysis();
+    });
+    projectMenu->addAction(actionCancelAnalysis);
     
     // Project Explorer dock
     projectDock = new QDockWidget("Project Explorer", this);
@@ -717,6 +782,7 @@ void MainWindow::setupMenuBar() {
     // Connect project manager signals to update explorer
     connect(mProjectManager, &ProjectManager::projectOpened, this, [this](const QString&) {
         updateProjectExplorer();
+        startProjectPreflight();
     });
     
     connect(mProjectManager, &ProjectManager::projectSaved, this, [this](const QString&) {
@@ -725,6 +791,18 @@ void MainWindow::setupMenuBar() {
     
     connect(mProjectManager, &ProjectManager::projectModified, this, [this]() {
         updateProjectExplorer();
+        startProjectPreflight();
+    });
+
+    connect(mProjectManager, &ProjectManager::analysisProgress, this, [this](int analysed, int total) {
+        if (statusBar() && analysed < total) {
+            statusBar()->showMessage(QString("Analysing MARC: %1 / %2 layers").arg(analysed).arg(total), 500);
+        }
+    });
+
+    connect(mProjectManager, &ProjectManager::analysisFinished, this, [this](bool complete, const QString& message) {
+        if (logView) logView->append(QString(complete ? "✓ %1" : "⚠️ %1").arg(message));
+        updateProjectExplorer();
     });
     
     // Status bar
@@ -761,10 +839,10 @@ void MainWindow::setupMenuBar() {
 void MainWindow::onFileNew() {
     if (!mProjectManager) mProjectManager = new ProjectManager(this);
     if (mProjectManager->createNewProjectInteractive()) {
-        if (textEdit) textEdit->append("✓ New project created successfully");
+        if (logView) logView->append("✓ New project created successfully");
         if (statusBar()) statusBar()->showMessage("New project created", 3000);
     } else {
-        if (textEdit) textEdit->append("✗ New project creation canceled or failed");
+        if (logView) logView->append("✗ New project creation canceled or failed");
         if (statusBar()) statusBar()->showMessage("Project creation canceled/failed", 3000);
     }
 }
@@ -772,16 +850,16 @@ void MainWindow::onFileNew() {
 void MainWindow::onFileOpen() {
     if (!mProjectManager) mProjectManager = new ProjectManager(this);
     if (mProjectManager->openProjectInteractive()) {
-        if (textEdit) textEdit->append("✓ Project opened successfully");
+        if (logView) logView->append("✓ Project opened successfully");
         if (statusBar()) statusBar()->showMessage("Project opened", 3000);
     } else {
-        if (textEdit) textEdit->append("✗ Project open canceled or failed");
+        if (logView) logView->append("✗ Project open canceled or failed");
         if (statusBar()) statusBar()->showMessage("Project open canceled/failed", 3000);
     }
 }
 
 void MainWindow::onFileSave() {
-    textEdit->append("File -> Save");
+    logView->append("File -> Save");
     if (statusBar()) statusBar()->showMessage("Project saved", 3000);
 }
 
@@ -790,7 +868,7 @@ void MainWindow::onFileSaveAs() {
         "Save Project As", "", "MarcSLM Projects (*.mslm);;All Files (*)");
     
     if (!fileName.isEmpty()) {
-        textEdit->append(QString("File -> Save As: %1").arg(fileName));
+        logView->append(QString("File -> Save As: %1").arg(fileName));
         if (statusBar()) statusBar()->showMessage(QString("Saved as: %1").arg(fileName), 3000);
     }
 }
@@ -803,9 +881,9 @@ void MainWindow::onFileExport() {
         QFile file(fileName);
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&file);
-            out << textEdit->toPlainText();
+            out << logView->toPlainText();
             file.close();
-            textEdit->append(QString("✓ Log exported to: %1").arg(fileName));
+            logView->append(QString("✓ Log exported to: %1").arg(fileName));
             if (statusBar()) statusBar()->showMessage("Log exported successfully", 3000);
         } else {
             QMessageBox::warning(this, "Export Failed", 
@@ -823,47 +901,47 @@ void MainWindow::onFileExit() {
     
     if (reply == QMessageBox::Yes) {
         // Safely shut down hardware components before exiting
-        textEdit->append("=== Application Shutdown Initiated ===");
+        logView->append("=== Application Shutdown Initiated ===");
         
         // Stop any running processes
         if (mProcessController) {
-            textEdit->append("Stopping process controller...");
+            logView->append("Stopping process controller...");
             mProcessController->stopProcess();
         }
         
         // Stop streaming manager if active
         if (mScanManager) {
-            textEdit->append("Stopping scan streaming manager...");
+            logView->append("Stopping scan streaming manager...");
             mScanManager->stopProcess();
         }
         
         // Stop SLM worker manager (OPC thread)
         if (mSLMWorkerManager) {
-            textEdit->append("Stopping SLM worker manager...");
+            logView->append("Stopping SLM worker manager...");
             mSLMWorkerManager->stopWorkers();
         }
         
         // Shut down scanner if initialized
         if (mScannerController && mScannerController->isInitialized()) {
-            textEdit->append("Shutting down scanner...");
+            logView->append("Shutting down scanner...");
             mScannerController->shutdown();
         }
         
         // Shut down OPC if initialized
         if (mOPCController && mOPCController->isInitialized()) {
-            textEdit->append("Shutting down OPC server...");
+            logView->append("Shutting down OPC server...");
             // OPC shutdown is handled through SLMWorkerManager's stopWorkers
             // No direct shutdown needed as the worker thread handles cleanupOPCController::writeEmergencyStop()
         }
         
-        textEdit->append("=== Hardware shutdown complete. Exiting application. ===");
+        logView->append("=== Hardware shutdown complete. Exiting application. ===");
         close();
     }
 }
 
 // EDIT MENU
 void MainWindow::onEditPreferences() {
-    textEdit->append("Edit -> Preferences");
+    logView->append("Edit -> Preferences");
     QMessageBox::information(this, "Preferences",
         "Preferences dialog will be implemented in future version.\n\n"
         "Current default settings are in use.");
@@ -877,8 +955,8 @@ void MainWindow::onEditClearLog() {
         QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        textEdit->clear();
-        textEdit->append("=== Log Cleared ===");
+        logView->clear();
+        logView->append("=== Log Cleared ===");
         if (statusBar()) statusBar()->showMessage("Log cleared", 3000);
     }
 }
@@ -906,7 +984,7 @@ void MainWindow::onEditResetParameters() {
         wobbleAmplitudeSpinBox->setValue(50);
         wobbleFrequencySpinBox->setValue(100);
         
-        textEdit->append("✓ All parameters reset to defaults");
+        logView->append("✓ All parameters reset to defaults");
         if (statusBar()) statusBar()->showMessage("Parameters reset", 3000);
     }
 }
@@ -916,12 +994,12 @@ void MainWindow::onViewFullScreen() {
     if (isFullScreen) {
         showNormal();
         isFullScreen = false;
-        textEdit->append("View -> Full Screen Mode Disabled");
+        logView->append("View -> Full Screen Mode Disabled");
         if (statusBar()) statusBar()->showMessage("Normal view", 3000);
     } else {
         showFullScreen();
         isFullScreen = true;
-        textEdit->append("View -> Full Screen Mode Enabled");
+        logView->append("View -> Full Screen Mode Enabled");
         if (statusBar()) statusBar()->showMessage("Full screen mode (Press F11 to exit)", 5000);
     }
 }
@@ -930,22 +1008,22 @@ void MainWindow::onViewStatusBar() {
     if (isStatusBarVisible) {
         statusBar()->hide();
         isStatusBarVisible = false;
-        textEdit->append("View -> Status Bar Hidden");
+        logView->append("View -> Status Bar Hidden");
     } else {
         statusBar()->show();
         isStatusBarVisible = true;
-        textEdit->append("View -> Status Bar Shown");
+        logView->append("View -> Status Bar Shown");
     }
 }
 
 void MainWindow::onViewExpandLog() {
-    if (textEdit->maximumHeight() == 16777215) {
-        textEdit->setMaximumHeight(400);
-        textEdit->append("View -> Log Normal Size");
+    if (logView->maximumHeight() == 16777215) {
+        logView->setMaximumHeight(400);
+        logView->append("View -> Log Normal Size");
         if (statusBar()) statusBar()->showMessage("Log size: Normal", 3000);
     } else {
-        textEdit->setMaximumHeight(16777215);
-        textEdit->append("View -> Log Expanded");
+        logView->setMaximumHeight(16777215);
+        logView->append("View -> Log Expanded");
         if (statusBar()) statusBar()->showMessage("Log size: Expanded", 3000);
     }
 }
@@ -953,6 +1031,11 @@ void MainWindow::onViewExpandLog() {
 void MainWindow::onViewGenerateSVGs() {
     using namespace marc;
 
+    if (mSvgExportJob) {
+        QMessageBox::information(this, "Export Running", "An SVG export is already in progress.");
+        return;
+    }
+
     if (!mProjectManager || !mProjectManager->hasProject()) {
         QMessageBox::warning(this, "No Project", "Open a project and attach a .marc file first.");
         return;
@@ -964,34 +1047,15 @@ void MainWindow::onViewGenerateSVGs() {
         return;
     }
 
-#ifdef _WIN32
-    std::wstring marcPath = marcAbs.toStdWString();
+    const std::wstring marcPath = marcAbs.toStdWString();
     std::string err;
     if (!readSlices::isMarcFile(marcPath, &err)) {
         QMessageBox::warning(this, "Invalid File", QString("Not a valid MARC file: %1").arg(QString::fromStdString(err)));
         return;
     }
-    readSlices reader;
-    if (!reader.open(marcPath)) {
-        QMessageBox::critical(this, "Read Failed", "Failed to read MARC file from project.");
-        return;
-    }
-#else
-    std::string marcPath = marcAbs.toStdString();
-    std::string err;
-    if (!readSlices::isMarcFile(marcPath, &err)) {
-        QMessageBox::warning(this, "Invalid File", QString("Not a valid MARC file: %1").arg(QString::fromStdString(err)));
-        return;
-    }
-    readSlices reader;
-    if (!reader.open(marcPath)) {
-        QMessageBox::critical(this, "Read Failed", "Failed to read MARC file from project.");
-        return;
-    }
-#endif
 
     QDir projectDir = QFileInfo(mProjectManager->currentProject()->buildFilePath()).dir();
-    QString outDir = projectDir.filePath("svgOutput");
+    mSvgExportDir = projectDir.filePath("svgOutput");
 
     writeSVG::Options opt;
     opt.mmWidth = 200.0f;
@@ -1002,25 +1066,170 @@ void MainWindow::onViewGenerateSVGs() {
     opt.offsetY = 0.0f;
     opt.invertY = true;
 
-    writeSVG writer(opt);
-    if (writer.writeAll(reader.layers(), outDir.toStdString())) {
-        textEdit->append(QString("✓ SVGs generated in: %1").arg(outDir));
+    // Streamed and written in parallel off the GUI thread; never loads the whole build
+    mSvgExportJob = std::make_unique<SvgExportJob>(marcPath, mSvgExportDir.toStdString(), opt);
+    if (!mSvgExportJob->start()) {
+        const QString reason = QString::fromStdString(mSvgExportJob->errorMessage());
+        mSvgExportJob.reset();
+        QMessageBox::critical(this, "Read Failed", QString("Failed to start SVG export: %1").arg(reason));
+        return;
+    }
+
+    logView->append(QString("Generating SVGs for %1 layers in: %2")
+                        .arg(mSvgExportJob->totalLayers()).arg(mSvgExportDir));
+
+    mSvgExportDialog = new QProgressDialog("Generating SVGs...", "Cancel", 0,
+                                           static_cast<int>(mSvgExportJob->totalLayers()), this);
+    mSvgExportDialog->setWindowTitle("SVG Export");
+    mSvgExportDialog->setWindowModality(Qt::WindowModal);
+    mSvgExportDialog->setMinimumDuration(0);
+    mSvgExportDialog->setAutoClose(false);
+    mSvgExportDialog->setAutoReset(false);
+    connect(mSvgExportDialog, &QProgressDialog::canceled, this, [this]() {
+        if (mSvgExportJob) mSvgExportJob->cancel();
+    });
+
+    if (!mSvgExportTimer) {
+        mSvgExportTimer = new QTimer(this);
+        connect(mSvgExportTimer, &QTimer::timeout, this, &MainWindow::pollSvgExport);
+    }
+    mSvgExportTimer->start(50);
+}
+
+void MainWindow::pollSvgExport() {
+    if (!mSvgExportJob) {
+        mSvgExportTimer->stop();
+        return;
+    }
+
+    const uint32_t written = mSvgExportJob->layersWritten();
+    const uint32_t total = mSvgExportJob->totalLayers();
+    if (mSvgExportDialog) {
+        mSvgExportDialog->setValue(static_cast<int>(written));
+        mSvgExportDialog->setLabelText(QString("Generating SVGs... %1 / %2 layers").arg(written).arg(total));
+    }
+    if (!mSvgExportJob->isFinished()) return;
+
+    mSvgExportTimer->stop();
+    const bool ok = mSvgExportJob->wait();
+    const bool cancelled = mSvgExportJob->isCancelled() && mSvgExportJob->errorMessage().empty();
+    const QString reason = QString::fromStdString(mSvgExportJob->errorMessage());
+    mSvgExportJob.reset();
+    if (mSvgExportDialog) {
+        mSvgExportDialog->deleteLater();
+        mSvgExportDialog = nullptr;
+    }
+
+    if (ok) {
+        logView->append(QString("✓ SVGs generated in: %1").arg(mSvgExportDir));
         if (statusBar()) statusBar()->showMessage("SVG generation complete", 3000);
 
         QMessageBox msg(this);
         msg.setWindowTitle("SVGs Generated");
-        msg.setText(QString("SVG images have been generated in:\n%1").arg(outDir));
+        msg.setText(QString("SVG images have been generated in:\n%1").arg(mSvgExportDir));
         QPushButton* openBtn = msg.addButton("Open Folder", QMessageBox::AcceptRole);
         msg.addButton(QMessageBox::Ok);
         msg.exec();
         if (msg.clickedButton() == openBtn) {
-            QDesktopServices::openUrl(QUrl::fromLocalFile(outDir));
+            QDesktopServices::openUrl(QUrl::fromLocalFile(mSvgExportDir));
         }
+    } else if (cancelled) {
+        logView->append(QString("⚠ SVG export cancelled after %1 / %2 layers").arg(written).arg(total));
+        if (statusBar()) statusBar()->showMessage("SVG generation cancelled", 3000);
     } else {
-        QMessageBox::critical(this, "Export Failed", "Failed to generate SVGs");
+        logView->append(QString("✗ SVG export failed: %1").arg(reason));
+        QMessageBox::critical(this, "Export Failed", QString("Failed to generate SVGs: %1").arg(reason));
     }
 }
  
+void MainWindow::onViewLayerPreview() {
+    if (!mProjectManager || !mProjectManager->hasProject()) {
+        QMessageBox::warning(this, "No Project", "Open a project and attach a .marc file first.");
+        return;
+    }
+
+    const QString marcAbs = mProjectManager->marcAbsolutePath();
+    if (marcAbs.isEmpty()) {
+        QMessageBox::warning(this, "No MARC Attached", "No .marc file is attached to the current project.");
+        return;
+    }
+
+    try {
+        LayerPreviewDialog* dialog = new LayerPreviewDialog(marcAbs, this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->show();
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Read Failed", QString("Failed to open MARC file: %1").arg(e.what()));
+    }
+}
+
+void MainWindow::onRunExcludeParts() {
+    // One dialog at a time; it edits the live rules of the streaming manager
+    if (mExclusionDialog) {
+        mExclusionDialog->raise();
+        mExclusionDialog->activateWindow();
+        return;
+    }
+    mExclusionDialog = new PartExclusionDialog(mScanManager, this);
+    mExclusionDialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(mExclusionDialog, &PartExclusionDialog::exclusionsChanged, this, [this](const QString& summary) {
+        logView->append(QString("Part exclusion: %1 (from the next layer converted)").arg(summary));
+    });
+    mExclusionDialog->show();
+}
+
+void MainWindow::onRunResume() {
+    logView->append("Run -> Resume Build");
+    if (!mProjectManager || !mProjectManager->hasProject()) {
+        QMessageBox::warning(this, "No Project", "Open the project of the interrupted build first.");
+        return;
+    }
+    const QString marcPath = mProjectManager->marcAbsolutePath();
+    const QString jsonPath = mProjectManager->jsonAbsolutePath();
+    if (marcPath.isEmpty() || jsonPath.isEmpty()) {
+        QMessageBox::warning(this, "Incomplete Project", "The project needs its MARC file and JSON configuration.");
+        return;
+    }
+    // The remaining layers are checked like a new build: the files may have changed since
+    if (!requirePreflight(marcPath, jsonPath)) return;
+
+    // Show where the build continues before anything moves
+    const std::filesystem::path journalFile =
+        std::filesystem::path(ScanStreamingManager::defaultReportDirectory(marcPath.toStdWString())) /
+        BuildJournal::kFileName;
+    BuildJournal::Identity id;
+    std::vector<BuildJournal::Entry> entries;
+    std::string error;
+    if (!BuildJournal::load(journalFile, id, entries, &error)) {
+        QMessageBox::warning(this, "Nothing to Resume", QString::fromStdString(error));
+        return;
+    }
+    const BuildJournal::ResumePoint rp = BuildJournal::resumePoint(entries);
+    if (!rp.valid || rp.nextLayerIndex >= id.totalLayers) {
+        QMessageBox::information(this, "Nothing to Resume",
+            rp.valid ? "All layers of this build are completed." : "No layer of this build was completed.");
+        return;
+    }
+
+    const QDateTime lastTime = QDateTime::fromMSecsSinceEpoch(rp.lastCompleted.unixTimeUs / 1000);
+    QMessageBox::StandardButton reply = QMessageBox::question(this, "Resume Build",
+        QString("Resume %1 after layer %2 (completed %3)?\n\n"
+                "%4 of %5 layers are completed.%6\n"
+                "The cylinder positions of that layer are restored on the PLC.")
+            .arg(QFileInfo(marcPath).fileName())
+            .arg(rp.lastCompleted.layerNumber)
+            .arg(lastTime.toString("yyyy-MM-dd hh:mm:ss"))
+            .arg(rp.nextLayerIndex)
+            .arg(id.totalLayers)
+            .arg(rp.interrupted ? "\nThe next layer was interrupted during scanning and is scanned again." : ""),
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) return;
+
+    if (mProcessController) {
+        mProcessController->startProductionSLMProcess(marcPath, jsonPath, true);
+    }
+}
+
 // HELP MENU
 void MainWindow::onHelpDocumentation() {
     QMessageBox::information(this, "Documentation",
@@ -1035,7 +1244,7 @@ void MainWindow::onHelpDocumentation() {
         "• Troubleshooting\n\n"
         "For detailed documentation, please refer to the user manual.");
     
-    textEdit->append("Help -> Documentation opened");
+    logView->append("Help -> Documentation opened");
     if (statusBar()) statusBar()->showMessage("Documentation displayed", 3000);
 }
 
@@ -1063,7 +1272,7 @@ void MainWindow::onHelpAbout() {
 }
 
 void MainWindow::onHelpCheckUpdates() {
-    textEdit->append("Help -> Checking for updates...");
+    logView->append("Help -> Checking for updates...");
     if (statusBar()) statusBar()->showMessage("Checking for updates...", 3000);
     
     QMessageBox::information(this, "Check for Updates",
@@ -1071,7 +1280,7 @@ void MainWindow::onHelpCheckUpdates() {
         "Version: 4.1.0\n"
         "No updates available.");
     
-    textEdit->append("✓ Software is up to date");
+    logView->append("✓ Software is up to date");
 }
 
 // =============================
@@ -1080,7 +1289,7 @@ void MainWindow::onHelpCheckUpdates() {
 // Test SLM Process button
 void MainWindow::on_InitOPC_clicked() {
     if (mOPCController->isInitialized()) {
-        textEdit->append("OPC Server is already initialized");
+        logView->append("OPC Server is already initialized");
         QMessageBox::information(this, "Info", "OPC Server is already running");
         return;
     }
@@ -1091,22 +1300,22 @@ void MainWindow::on_InitOPC_clicked() {
         
         // AUTO-INITIALIZE SCANNER if not already initialized
         if (!mScannerController->isInitialized()) {
-            textEdit->append("\n=== Auto-initializing Scanner for layer printing ===");
+            logView->append("\n=== Auto-initializing Scanner for layer printing ===");
             on_InitScanner_clicked();
             
             if (mScannerController->isInitialized()) {
-                textEdit->append("✓ Scanner auto-initialized successfully");
-                textEdit->append("✓ System ready for layer-by-layer printing");
+                logView->append("✓ Scanner auto-initialized successfully");
+                logView->append("✓ System ready for layer-by-layer printing");
             } else {
-                textEdit->append("⚠️ Scanner auto-initialization failed");
-                textEdit->append("⚠️ Please manually click 'Initialize Scanner'");
+                logView->append("⚠️ Scanner auto-initialization failed");
+                logView->append("⚠️ Please manually click 'Initialize Scanner'");
                 QMessageBox::warning(this, "Scanner Init Warning",
                     "Scanner auto-initialization failed.\n"
                     "Please click 'Initialize Scanner' button manually\n"
                     "before starting the printing process.");
             }
         } else {
-            textEdit->append("✓ Scanner already initialized - ready for printing");
+            logView->append("✓ Scanner already initialized - ready for printing");
         }
     } else {
         QMessageBox::critical(this, "Initialization Failed",
@@ -1119,7 +1328,7 @@ void MainWindow::on_InitOPC_clicked() {
 // Initialize Scanner button
 void MainWindow::on_InitScanner_clicked() {
     if (mScannerController->isInitialized()) {
-        textEdit->append("Scanner is already initialized");
+        logView->append("Scanner is already initialized");
         QMessageBox::information(this, "Info", "Scanner is already running");
         return;
     }
@@ -1128,14 +1337,14 @@ void MainWindow::on_InitScanner_clicked() {
     // This is ONLY for standalone testing/diagnostics
     // Production process MUST NOT use this - Scanner initializes in its own thread
     
-    textEdit->append("WARNING: Initializing Scanner on UI thread (manual test mode only)");
-    textEdit->append("For production, Scanner will initialize in dedicated consumer thread");
+    logView->append("WARNING: Initializing Scanner on UI thread (manual test mode only)");
+    logView->append("For production, Scanner will initialize in dedicated consumer thread");
     
     //if (mScannerController->initialize()) {
         if (0) {
         // Scanner is initialized with default config in controller
-        textEdit->append("✓ Scanner initialized (test mode)");
-        textEdit->append("✓ Ready for manual diagnostics");
+        logView->append("✓ Scanner initialized (test mode)");
+        logView->append("✓ Ready for manual diagnostics");
         
         // Note: Do NOT shut down here - let user run diagnostics
         // Shutdown will happen when user explicitly requests it or starts production mode
@@ -1156,14 +1365,14 @@ void MainWindow::on_StartUP_clicked() {
     // Production process handles OPC initialization in dedicated thread
     
     if (!mOPCController->isInitialized()) {
-        textEdit->append("WARNING: Initializing OPC on UI thread (manual test mode only)");
-        textEdit->append("For production, OPC initializes in dedicated OPC worker thread");
+        logView->append("WARNING: Initializing OPC on UI thread (manual test mode only)");
+        logView->append("For production, OPC initializes in dedicated OPC worker thread");
         
         // Attempt a single initialization attempt and report result.
         if (mOPCController->initialize()) {
-            if (textEdit) textEdit->append("✓ OPC Server initialized (test mode)");
+            if (logView) logView->append("✓ OPC Server initialized (test mode)");
         } else {
-            if (textEdit) textEdit->append("⚠️ OPC Server initialization failed");
+            if (logView) logView->append("⚠️ OPC Server initialization failed");
             QMessageBox::warning(this, "OPC Init Warning",
                 "OPC Server initialization failed.\n"
                 "Please check the logs for more details.");
@@ -1190,7 +1399,7 @@ void MainWindow::on_StartUP_clicked() {
 
     if (reply == QMessageBox::Yes) {
         mOPCController->writeStartUp(true);
-        textEdit->append("- Machine startup command sent to PLC");
+        logView->append("- Machine startup command sent to PLC");
     }
 }
 //Start Powder Fill
@@ -1199,9 +1408,9 @@ void MainWindow::on_Prep_Powder_Fill_clicked() {
     if (!mOPCController->isInitialized()) {
         // Attempt a single initialization attempt and report result.
         if (mOPCController->initialize()) {
-            if (textEdit) textEdit->append("✓ OPC Server initialized successfully");
+            if (logView) logView->append("✓ OPC Server initialized successfully");
         } else {
-            if (textEdit) textEdit->append("⚠️ OPC Server initialization failed");
+            if (logView) logView->append("⚠️ OPC Server initialization failed");
             QMessageBox::warning(this, "OPC Init Warning",
                 "OPC Server initialization failed.\n"
                 "Please check the logs for more details.");
@@ -1257,7 +1466,7 @@ void MainWindow::on_Prep_Powder_Fill_clicked() {
 }
 
 void MainWindow::on_Lay_Surface_clicked() {
-    textEdit->append("Lay Surface (test mode) Not Implemented");
+    logView->append("Lay Surface (test mode) Not Implemented");
 }
 
 void MainWindow::on_MakeBottomLayers_clicked() {
@@ -1280,12 +1489,12 @@ void MainWindow::on_MakeBottomLayers_clicked() {
 
 void MainWindow::on_Restart_process_clicked() {
     if (mProcessController->isRunning()) {
-        textEdit->append("ℹ Process already running");
+        logView->append("ℹ Process already running");
     } else if (mOPCController->isInitialized()) {
         mProcessController->startProcess();
-        textEdit->append("✓ Process monitoring restarted");
+        logView->append("✓ Process monitoring restarted");
     } else {
-        textEdit->append("✗ Cannot restart - OPC not initialized");
+        logView->append("✗ Cannot restart - OPC not initialized");
         QMessageBox::warning(this, "Warning", "Please initialize OPC first");
     }
 }
@@ -1293,7 +1502,7 @@ void MainWindow::on_Restart_process_clicked() {
 void MainWindow::on_EmergencyStop_clicked() {
     mProcessController->emergencyStop();
     
-    textEdit->append("🚨 EMERGENCY STOP ACTIVATED!");
+    logView->append("🚨 EMERGENCY STOP ACTIVATED!");
     QMessageBox::warning(this, "Emergency Stop",
         "All operations stopped!\n"
         "Check machine state before restarting.");
@@ -1307,7 +1516,7 @@ void MainWindow::on_RunScannerDiagnostics_clicked() {
     if (!mScannerController->isInitialized()) {
         QMessageBox::warning(this, "Scanner Not Ready", 
             "Scanner is not initialized.\nPlease click 'Initialize Scanner' first.");
-        textEdit->append("⚠️ Cannot run diagnostics - scanner not initialized");
+        logView->append("⚠️ Cannot run diagnostics - scanner not initialized");
         return;
     }
 
@@ -1329,14 +1538,14 @@ void MainWindow::onOPCDataUpdated(const OPCServerManagerUA::OPCData& data) {
 }
 
 void MainWindow::onOPCConnectionLost() {
-    textEdit->append("⚠️ WARNING: OPC UA Connection Lost!");
+    logView->append("⚠️ WARNING: OPC UA Connection Lost!");
     QMessageBox::warning(this, "Connection Lost",
         "OPC UA Server connection has been lost.\n"
         "Please check the connection and restart if necessary.");
 }
 
 void MainWindow::onScannerLayerCompleted(int layerNumber) {
-    textEdit->append(QString("✓ Scanner completed layer %1").arg(layerNumber));
+    logView->append(QString("✓ Scanner completed layer %1").arg(layerNumber));
     
     // Update scanner status display
     mScannerController->updateStatusDisplay(scannerStatusDisplay, scannerErrorLabel);
@@ -1361,7 +1570,7 @@ void MainWindow::updateDisplaysFromOPCData(const OPCServerManagerUA::OPCData& da
 
 // RUN MENU
 void MainWindow::onRunInitialize() {
-    textEdit->append("Run -> Initialize System");
+    logView->append("Run -> Initialize System");
     
     // Initialize OPC if not already initialized
     if (!mOPCController->isInitialized()) {
@@ -1379,7 +1588,7 @@ void MainWindow::onRunInitialize() {
 }
 
 void MainWindow::onRunStart() {
-    textEdit->append("Run -> Start Process");
+    logView->append("Run -> Start Process");
     
     //if (mOPCController->isInitialized()) {
       //  mProcessController->startProcess();
@@ -1391,14 +1600,14 @@ void MainWindow::onRunStart() {
 }
 
 void MainWindow::onRunPause() {
-    textEdit->append("Run -> Pause");
+    logView->append("Run -> Pause");
     
     if (mProcessController->isRunning()) {
         mProcessController->pauseProcess();
         if (statusBar()) statusBar()->showMessage("Process paused", 3000);
         QMessageBox::information(this, "Paused", "Process has been paused.");
     } else {
-        textEdit->append("ℹ No active process to pause");
+        logView->append("ℹ No active process to pause");
         if (statusBar()) statusBar()->showMessage("No active process", 3000);
     }
 }
@@ -1412,7 +1621,7 @@ void MainWindow::onRunStop() {
     
     if (reply == QMessageBox::Yes) {
         mProcessController->stopProcess();
-        textEdit->append("Run -> Stop - Process stopped");
+        logView->append("Run -> Stop - Process stopped");
         if (statusBar()) statusBar()->showMessage("Process stopped", 3000);
     }
 }
@@ -1421,6 +1630,143 @@ void MainWindow::onRunEmergencyStop() {
     on_EmergencyStop_clicked();
 }
 
+// ============================================================================
+// Pre-flight Check (background, gates Start)
+// ============================================================================
+
+void MainWindow::onRunPreflight() {
+    if (!mProjectManager || !mProjectManager->hasProject() ||
+        mProjectManager->marcAbsolutePath().isEmpty() || mProjectManager->jsonAbsolutePath().isEmpty()) {
+        QMessageBox::warning(this, "No Project", "Open a project with an attached .marc and JSON file first.");
+        return;
+    }
+    startPreflight(mProjectManager->marcAbsolutePath(), mProjectManager->jsonAbsolutePath());
+}
+
+void MainWindow::startProjectPreflight() {
+    if (!mProjectManager || !mProjectManager->hasProject()) return;
+    const QString marcPath = mProjectManager->marcAbsolutePath();
+    const QString jsonPath = mProjectManager->jsonAbsolutePath();
+    if (marcPath.isEmpty() || jsonPath.isEmpty()) return;
+    if (marcPath == mPreflightMarc && jsonPath == mPreflightJson && mPreflight) return;
+    if (preflightCurrent(marcPath, jsonPath)) return;
+    startPreflight(marcPath, jsonPath);
+}
+
+QString MainWindow::preflightStamp(const QString& marcPath, const QString& jsonPath) {
+    // Re-slicing the .marc or saving the JSON in place changes time or size
+    const QFileInfo marc(marcPath);
+    const QFileInfo json(jsonPath);
+    return QString("%1:%2|%3:%4")
+        .arg(marc.lastModified().toMSecsSinceEpoch()).arg(marc.size())
+        .arg(json.lastModified().toMSecsSinceEpoch()).arg(json.size());
+}
+
+bool MainWindow::preflightCurrent(const QString& marcPath, const QString& jsonPath) const {
+    return mPreflightPassed && mPreflightMarc == marcPath && mPreflightJson == jsonPath &&
+           mPreflightStamp == preflightStamp(marcPath, jsonPath);
+}
+
+bool MainWindow::requirePreflight(const QString& marcPath, const QString& jsonPath) {
+    if (preflightCurrent(marcPath, jsonPath)) return true;
+    if (!(mPreflight && mPreflightMarc == marcPath && mPreflightJson == jsonPath)) {
+        if (mPreflightPassed && mPreflightMarc == marcPath && mPreflightJson == jsonPath) {
+            logView->append("MARC or JSON file changed since the pre-flight check, checking again");
+        }
+        startPreflight(marcPath, jsonPath);
+    }
+    if (mPreflight) {
+        QMessageBox::information(this, "Pre-flight Check Running",
+            "The build is being checked in the background.\n"
+            "Start or resume the build again as soon as the check passes.");
+    }
+    return false;
+}
+
+void MainWindow::startPreflight(const QString& marcPath, const QString& jsonPath) {
+    if (mPreflight) {
+        mPreflight->cancel();
+        mPreflight.reset();   // joins the threads
+    }
+    mPreflightMarc = marcPath;
+    mPreflightJson = jsonPath;
+    mPreflightStamp = preflightStamp(marcPath, jsonPath);
+    mPreflightPassed = false;
+    actionStart->setEnabled(false);
+
+    mPreflight = std::make_unique<BuildValidator>(marcPath.toStdWString(), jsonPath.toStdString());
+    if (!mPreflight->start()) {
+        const QString reason = QString::fromStdString(mPreflight->errorMessage());
+        mPreflight.reset();
+        logView->append(QString("✗ Pre-flight check could not start: %1").arg(reason));
+        QMessageBox::critical(this, "Pre-flight Check Failed", reason);
+        return;
+    }
+
+    logView->append(QString("Pre-flight check of %1 (%2 layers)...")
+                        .arg(QFileInfo(marcPath).fileName()).arg(mPreflight->totalLayers()));
+    if (!mPreflightTimer) {
+        mPreflightTimer = new QTimer(this);
+        connect(mPreflightTimer, &QTimer::timeout, this, &MainWindow::pollPreflight);
+    }
+    mPreflightTimer->start(100);
+}
+
+void MainWindow::pollPreflight() {
+    if (!mPreflight) {
+        mPreflightTimer->stop();
+        return;
+    }
+    if (!mPreflight->isFinished()) {
+        if (statusBar()) {
+            statusBar()->showMessage(QString("Pre-flight check: %1 / %2 layers")
+                                         .arg(mPreflight->layersChecked()).arg(mPreflight->totalLayers()), 500);
+        }
+        return;
+    }
+
+    mPreflightTimer->stop();
+    mPreflight->wait();
+    const QString reason = QString::fromStdString(mPreflight->errorMessage());
+    mPreflightPassed = mPreflight->passed();
+    const size_t errors = mPreflight->errorCount();
+    const size_t warnings = mPreflight->warningCount();
+
+    // Every stored issue goes to the details; the log gets the first few
+    constexpr size_t kLogIssues = 20;
+    QStringList details;
+    for (const auto& issue : mPreflight->issues()) {
+        const QString line = QString::fromStdString(issue.toString());
+        if (static_cast<size_t>(details.size()) < kLogIssues) logView->append("  " + line);
+        details << line;
+    }
+    if (errors + warnings > static_cast<size_t>(details.size())) {
+        details << QString("... %1 more not listed").arg(errors + warnings - details.size());
+    }
+    mPreflight.reset();
+    actionStart->setEnabled(mPreflightPassed);
+
+    if (!reason.isEmpty()) {
+        logView->append(QString("✗ Pre-flight check failed: %1").arg(reason));
+        QMessageBox::critical(this, "Pre-flight Check Failed", reason);
+        return;
+    }
+    if (mPreflightPassed) {
+        logView->append(QString("✓ Pre-flight check passed (%1 warnings)").arg(warnings));
+        if (statusBar()) statusBar()->showMessage("Pre-flight check passed - ready to start", 5000);
+        return;
+    }
+
+    logView->append(QString("✗ Pre-flight check: %1 errors, %2 warnings - Start disabled").arg(errors).arg(warnings));
+    QMessageBox msg(QMessageBox::Warning, "Pre-flight Check",
+                    QString("The build has %1 errors and %2 warnings.\n"
+                            "Start stays disabled until the MARC or JSON file is fixed.")
+                        .arg(errors).arg(warnings),
+                    QMessageBox::Ok, this);
+    msg.setDetailedText(details.join("\n"));
+    msg.exec();
+}
+
 // ============================================================================
 // Project Management Slot Implementations
 // ============================================================================
@@ -1431,10 +1777,10 @@ void MainWindow::onProjectOpen() {
     }
     
     if (mProjectManager->openProjectInteractive()) {
-        if (textEdit) textEdit->append("✓ Project opened successfully");
+        if (logView) logView->append("✓ Project opened successfully");
         if (statusBar()) statusBar()->showMessage("Project opened", 3000);
     } else {
-        if (textEdit) textEdit->append("✗ Project open canceled or failed");
+        if (logView) logView->append("✗ Project open canceled or failed");
         if (statusBar()) statusBar()->showMessage("Project open canceled/failed", 3000);
     }
 }
@@ -1447,10 +1793,10 @@ void MainWindow::onProjectAttachMarc() {
     }
     
     if (mProjectManager->attachMarcInteractive()) {
-        if (textEdit) textEdit->append("✓ MARC file attached successfully");
+        if (logView) logView->append("✓ MARC file attached successfully");
         if (statusBar()) statusBar()->showMessage("MARC file attached", 3000);
     } else {
-        if (textEdit) textEdit->append("✗ MARC file attachment canceled or failed");
+        if (logView) logView->append("✗ MARC file attachment canceled or failed");
     }
 }
 
@@ -1462,10 +1808,10 @@ void MainWindow::onProjectAttachJson() {
     }
     
     if (mProjectManager->attachJsonInteractive()) {
-        if (textEdit) textEdit->append("✓ JSON config attached successfully");
+        if (logView) logView->append("✓ JSON config attached successfully");
         if (statusBar()) statusBar()->showMessage("JSON config attached", 3000);
     } else {
-        if (textEdit) textEdit->append("✗ JSON config attachment canceled or failed");
+        if (logView) logView->append("✗ JSON config attachment canceled or failed");
     }
 }
 
@@ -1523,6 +1869,26 @@ void MainWindow::updateProjectExplorer() {
         layersItem->setText(0, "Total Layers");
         layersItem->setText(1, QString::number(stats.totalLayers));
         
+        auto* vectorsItem = new QTreeWidgetItem(statsItem);
+        vectorsItem->setText(0, "Total Vectors");
+        vectorsItem->setText(1, stats.layersAnalysed < stats.totalLayers
+                                    ? QString("%1 (%2/%3 layers analysed)")
+                                          .arg(stats.totalVectors).arg(stats.layersAnalysed).arg(stats.totalLayers)
+                                    : QString::number(stats.totalVectors));
+
+        if (stats.buildHeight > 0.0) {
+            auto* heightItem = new QTreeWidgetItem(statsItem);
+            heightItem->setText(0, "Build Height");
+            heightItem->setText(1, QString("%1 mm").arg(stats.buildHeight, 0, 'f', 2));
+        }
+
+        if (stats.unreadableLayers > 0) {
+            auto* unreadableItem = new QTreeWidgetItem(statsItem);
+            unreadableItem->setText(0, "Unreadable Layers");
+            unreadableItem->setText(1, QString::number(stats.unreadableLayers));
+            unreadableItem->setForeground(1, QBrush(QColor("#F44336")));
+        }
+
         auto* statusItem = new QTreeWidgetItem(statsItem);
         statusItem->setText(0, "Status");
         statusItem->setText(1, stats.status);
@@ -1543,20 +1909,55 @@ void MainWindow::updateProjectExplorer() {
 // ScanStreamingManager Signal Handlers (Streaming MARC Integration)
 // ============================================================================
 void MainWindow::onScanProcessStatusMessage(const QString& msg) {
-    if (textEdit) textEdit->append(msg);
+    MARC_TRACE_SCOPE("gui", "MainWindow::appendStatus");
+    if (logView) logView->append(msg);
+}
+
+void MainWindow::drainLogRing() {
+    MARC_TRACE_SCOPE("gui", "MainWindow::drainLogRing");
+    QStringList batch;
+    marc::logging::LogRing::instance().drain([&batch](const marc::logging::LogMessage& m) {
+        batch << QString::fromStdString(m.text);
+    }, 2000);
+    if (!batch.isEmpty() && logView) {
+        logView->append(batch);
+    }
 }
 
-void MainWindow::onScanProcessProgress(size_t processed, size_t total) {
-    QString progress = QString("Progress: %1/%2 layers").arg(processed).arg(total);
+void MainWindow::pollPipelineStatus() {
+    const PipelineStatus& status = mScanManager->status();
+    if (status.version() == mLastStatusVersion) return;
+
+    const PipelineStatus::Snapshot s = status.snapshot();
+    mLastStatusVersion = s.version;
+
+    QString text = QString("Layer %1 | %2").arg(s.currentLayer).arg(PipelineStatus::phaseName(s.phase));
+    if (s.layersExecuted > 0) {
+        text += QString(" | %1 layers/h | %2 cmd/s")
+                    .arg(s.layersPerHour, 0, 'f', 1)
+                    .arg(s.commandsPerSecond, 0, 'f', 0);
+    }
+    if (!s.lastError.empty()) {
+        mPipelineStatusLabel->setToolTip(QString::fromStdString(s.lastError));
+    }
+    mPipelineStatusLabel->setText(text);
+
+    if (s.layersTotal > 0) {
+        mPipelineProgress->setRange(0, static_cast<int>(s.layersTotal));
+        mPipelineProgress->setValue(static_cast<int>(s.layersExecuted));
+        mPipelineProgress->setFormat(QString("%v / %m layers (queued %1)")
+                                         .arg(s.layersProduced - s.layersExecuted));
+        mPipelineProgress->show();
+    }
 }
 
 void MainWindow::onScanProcessFinished() {
-    textEdit->append("✓✓✓ Streaming process finished successfully!");
+    logView->append("✓✓✓ Streaming process finished successfully!");
     if (statusBar()) statusBar()->showMessage("Streaming complete", 3000);
 }
 
 void MainWindow::onScanProcessError(const QString& err) {
-    textEdit->append(QString("✗✗✗ Streaming error: %1").arg(err));
+    logView->append(QString("✗✗✗ Streaming error: %1").arg(err));
     if (statusBar()) statusBar()->showMessage("Streaming error", 3000);
     QMessageBox::critical(this, "Process Error", err);
 }
@@ -1571,7 +1972,7 @@ void MainWindow::onTestSLMProcess_clicked() {
         QMessageBox::warning(this, "Scanner Not Ready", 
             "Scanner must be initialized before running test mode.\n"
             "Please click 'Initialize Scanner' first.");
-        textEdit->append("⚠️ Cannot start test SLM - scanner not initialized");
+        logView->append("⚠️ Cannot start test SLM - scanner not initialized");
         return;
     }*/
 
@@ -1660,7 +2061,7 @@ void MainWindow::onTestSLMProcess_clicked() {
 
 /// Start Scan Process - Production mode, slice-file driven with OPC
 void MainWindow::onStartScanProcess_clicked() {
-    textEdit->append("Run -> Start Process");
+    logView->append("Run -> Start Process");
 
     // ========== VALIDATION ONLY - NO INITIALIZATION ON UI THREAD ==========
     // Do NOT initialize OPC or Scanner here - they must initialize in their own threads
@@ -1670,7 +2071,7 @@ void MainWindow::onStartScanProcess_clicked() {
     if (mProjectManager && mProjectManager->hasProject()) {
         marcPath = mProjectManager->marcAbsolutePath();
         if (!marcPath.isEmpty()) {
-            textEdit->append(QString("- Using MARC from project: %1").arg(marcPath));
+            logView->append(QString("- Using MARC from project: %1").arg(marcPath));
         }
     }
 
@@ -1681,7 +2082,7 @@ void MainWindow::onStartScanProcess_clicked() {
             "MARC Files (*.marc);;All Files (*)");
 
         if (marcPath.isEmpty()) {
-            textEdit->append("- MARC file selection cancelled");
+            logView->append("- MARC file selection cancelled");
             return;
         }
     }
@@ -1691,7 +2092,7 @@ void MainWindow::onStartScanProcess_clicked() {
     if (mProjectManager && mProjectManager->hasProject()) {
         jsonPath = mProjectManager->jsonAbsolutePath();
         if (!jsonPath.isEmpty()) {
-            textEdit->append(QString("- Using JSON config from project: %1").arg(jsonPath));
+            logView->append(QString("- Using JSON config from project: %1").arg(jsonPath));
         }
     }
 
@@ -1702,7 +2103,7 @@ void MainWindow::onStartScanProcess_clicked() {
             "JSON Configuration Files (*.json);;All Files (*)");
 
         if (jsonPath.isEmpty()) {
-            textEdit->append("- JSON configuration file selection cancelled");
+            logView->append("- JSON configuration file selection cancelled");
             return;
         }
     }
@@ -1712,11 +2113,14 @@ void MainWindow::onStartScanProcess_clicked() {
     if (!jsonFileInfo.exists() || !jsonFileInfo.isFile()) {
         QMessageBox::critical(this, "Invalid Configuration File",
             QString("JSON configuration file does not exist:\n%1").arg(jsonPath));
-        textEdit->append(QString("✗ Invalid JSON configuration file: %1").arg(jsonPath));
+        logView->append(QString("✗ Invalid JSON configuration file: %1").arg(jsonPath));
         return;
     }
 
-    // ========== STEP 4: Confirmation dialog with both files ==========
+    // ========== STEP 4: Pre-flight check of this exact pair (unchanged since) must have passed ==========
+    if (!requirePreflight(marcPath, jsonPath)) return;
+
+    // ========== STEP 5: Confirmation dialog with both files ==========
     QMessageBox::StandardButton reply = QMessageBox::question(this,
         "Start Production SLM Process",
         QString("Start production SLM process with:\n\n"
@@ -1741,14 +2145,14 @@ void MainWindow::onStartScanProcess_clicked() {
         // 2. Start ScanStreamingManager -> Scanner initializes in consumer thread
         // 3. All initialization happens in proper threads (NOT UI thread)
         
-        textEdit->append("- Starting production SLM process...");
-        textEdit->append("- OPC will initialize in OPC worker thread");
-        textEdit->append("- Scanner will initialize in scanner consumer thread");
+        logView->append("- Starting production SLM process...");
+        logView->append("- OPC will initialize in OPC worker thread");
+        logView->append("- Scanner will initialize in scanner consumer thread");
         
         if (mProcessController) {
             mProcessController->startProductionSLMProcess(marcPath, jsonPath);
         } else {
-            textEdit->append("ERROR: ProcessController not available");
+            logView->append("ERROR: ProcessController not available");
             QMessageBox::critical(this, "Internal Error", 
                 "ProcessController is not initialized. Cannot start process.");
         }
@@ -8,8 +8,10 @@
 #include "ProjectManager.h"
 #include "opcserver/opcserverua.h"  // Include for OPCServerManagerUA and OPCData type
 #include <QDockWidget>
+#include <QPointer>
 #include <QTreeWidget>
 #include "controllers/scanstreamingmanager.h"
+#include <memory>
 
 // Forward declarations - Controllers
 class OPCController;
@@ -19,10 +21,17 @@ class SLMWorkerManager;
 
 // Forward declarations - UI
 class QPushButton;
-class QTextEdit;
+class LogView;
 class QLCDNumber;
 class QDoubleSpinBox;
 class QLabel;
+class QTimer;
+class QProgressBar;
+class QProgressDialog;
+class ScanOverlayWidget;
+class PartExclusionDialog;
+
+namespace marc { class SvgExportJob; class BuildValidator; }
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -56,9 +65,10 @@ private slots:
     void onScannerLayerCompleted(int layerNumber);
     void onProcessStateChanged(int state);
     void onScanProcessStatusMessage(const QString& msg);
-    void onScanProcessProgress(size_t processed, size_t total);
     void onScanProcessFinished();
     void onScanProcessError(const QString& err);
+    void drainLogRing();  // Batch-render messages from the lock-free log ring
+    void pollPipelineStatus();  // Refresh progress from ScanStreamingManager::status()
 
     // Menu bar slots
     void onFileNew();
@@ -76,12 +86,18 @@ private slots:
     void onViewStatusBar();
     void onViewExpandLog();
     void onViewGenerateSVGs(); // New: generate SVGs from MARC
+    void pollSvgExport();      // Progress / completion of the background SVG export
+    void onViewLayerPreview(); // Raster preview of the attached MARC (tiled, zoomable)
     
     void onRunInitialize();
     void onRunStart();  // Start process (streaming MARC)
     void onRunPause();
     void onRunStop();
     void onRunEmergencyStop();
+    void onRunPreflight();     // Re-run the pre-flight check of the project's MARC + JSON
+    void pollPreflight();      // Progress / result of the background pre-flight check
+    void onRunExcludeParts();  // Edit the part exclusion of the running build
+    void onRunResume();        // Continue an interrupted build from its build journal
     
     void onHelpDocumentation();
     void onHelpAbout();
@@ -111,7 +127,7 @@ private:
     QPushButton* MakeBottomLayers;
     QPushButton* EmergencyStop;
     
-    QTextEdit* textEdit;
+    LogView* logView;            // System log (virtualized, thread-safe append)
     
     // Scanner UI Controls
     QDoubleSpinBox* laserPowerSpinBox;
@@ -190,6 +206,42 @@ private:
     QMenu* recentMenu = nullptr;
     QList<QAction*> recentActions;
     
+    // Log ring drain (worker threads log without Qt events)
+    QTimer* mLogDrainTimer = nullptr;
+
+    // Pipeline status poll (display rate, redraw only when the snapshot changed)
+    QTimer* mStatusPollTimer = nullptr;
+    QLabel* mPipelineStatusLabel = nullptr;
+    QProgressBar* mPipelineProgress = nullptr;
+    quint64 mLastStatusVersion = 0;
+
+    // Live scan overlay (renders ScanStreamingManager::progressFeed() on its own thread)
+    QDockWidget* mScanOverlayDock = nullptr;
+    ScanOverlayWidget* mScanOverlay = nullptr;
+
+    // Part exclusion editor (modeless, deletes itself on close)
+    QPointer<PartExclusionDialog> mExclusionDialog;
+
+    // Background SVG export (reader + worker pool, polled like the pipeline status)
+    std::unique_ptr<marc::SvgExportJob> mSvgExportJob;
+    QProgressDialog* mSvgExportDialog = nullptr;
+    QTimer* mSvgExportTimer = nullptr;
+    QString mSvgExportDir;
+
+    // Pre-flight check of the MARC + JSON pair; Start runs only once it passed
+    void startPreflight(const QString& marcPath, const QString& jsonPath);
+    void startProjectPreflight();
+    // True when the check passed for these files as they are now; otherwise starts it
+    bool requirePreflight(const QString& marcPath, const QString& jsonPath);
+    bool preflightCurrent(const QString& marcPath, const QString& jsonPath) const;
+    static QString preflightStamp(const QString& marcPath, const QString& jsonPath);
+    std::unique_ptr<marc::BuildValidator> mPreflight;
+    QTimer* mPreflightTimer = nullptr;
+    QString mPreflightMarc;        // pair checked (or being checked)
+    QString mPreflightJson;
+    QString mPreflightStamp;       // modification times and sizes of the pair when the check started
+    bool mPreflightPassed = false;
+
     // UI State variables only
     bool isFullScreen = false;
     bool isStatusBarVisible = true;
@@ -0,0 +1,212 @@
+#include "scanoverlay.h"
+
+#include <QColor>
+#include <QLineF>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QVector>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace {
+
+// Segment colors, indexed by buildStyleId
+const QColor kSegmentColors[] = {
+    QColor("#2E7D32"), QColor("#1976D2"), QColor("#C62828"), QColor("#EF6C00"),
+    QColor("#6A1B9A"), QColor("#00838F"), QColor("#F9A825"), QColor("#AD1457"),
+};
+constexpr int kSegmentColorCount = sizeof(kSegmentColors) / sizeof(kSegmentColors[0]);
+
+const QColor kBackground(0x1E, 0x1E, 0x1E);
+
+bool isMove(const marc::RTCCommandBlock::Command& c) {
+    return c.type == marc::RTCCommandBlock::Command::Jump || c.type == marc::RTCCommandBlock::Command::Mark ||
+           c.type == marc::RTCCommandBlock::Command::Expose;
+}
+
+} // namespace
+
+ScanOverlayWidget::ScanOverlayWidget(const ScanProgressFeed& feed, QWidget* parent)
+    : QWidget(parent)
+    , mFeed(feed)
+{
+    setMinimumSize(200, 200);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    connect(this, &ScanOverlayWidget::frameReady, this, QOverload<>::of(&QWidget::update), Qt::QueuedConnection);
+
+    mRenderer = std::thread(&ScanOverlayWidget::renderLoop, this);
+}
+
+ScanOverlayWidget::~ScanOverlayWidget() {
+    {
+        std::lock_guard<std::mutex> lk(mWakeMutex);
+        mStop = true;
+    }
+    mWakeCv.notify_all();
+    if (mRenderer.joinable()) mRenderer.join();
+}
+
+void ScanOverlayWidget::resizeEvent(QResizeEvent* event) {
+    QWidget::resizeEvent(event);
+    mTargetWidth = event->size().width();
+    mTargetHeight = event->size().height();
+    mWakeCv.notify_all();
+}
+
+// ============================================================================
+// Renderer thread
+// ============================================================================
+
+void ScanOverlayWidget::renderLoop() {
+    uint64_t lastSerial = std::numeric_limits<uint64_t>::max();
+    int lastWidth = 0, lastHeight = 0;
+
+    while (!mStop) {
+        {
+            std::unique_lock<std::mutex> lk(mWakeMutex);
+            mWakeCv.wait_for(lk, std::chrono::milliseconds(kFrameIntervalMs), [this] { return mStop.load(); });
+        }
+        if (mStop) break;
+
+        const int width = mTargetWidth;
+        const int height = mTargetHeight;
+        if (width <= 0 || height <= 0) continue;
+        if (mFeed.serial() == lastSerial && width == lastWidth && height == lastHeight) continue;
+
+        const ScanProgressFeed::Snapshot s = mFeed.snapshot();
+        lastSerial = s.serial;
+        if (!s.block) continue;
+
+        // New layer or new size: redraw the dimmed layer from scratch
+        if (s.layerSerial != mDrawnLayerSerial || width != lastWidth || height != lastHeight) {
+            beginLayer(*s.block, width, height);
+            mDrawnLayerSerial = s.layerSerial;
+            lastWidth = width;
+            lastHeight = height;
+        }
+
+        // Incremental progress
+        if (s.submitted > mDrawnSubmitted) {
+            drawRange(*s.block, mDrawnSubmitted, s.submitted, Stroke::Submitted);
+            mDrawnSubmitted = s.submitted;
+        }
+        if (s.executed > mDrawnExecuted) {
+            drawRange(*s.block, mDrawnExecuted, s.executed, Stroke::Executed);
+            mDrawnExecuted = s.executed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lk(mFrameMutex);
+            mFrame = mCanvas.copy();
+            mFrameLayer = s.block->layerNumber;
+            mFrameSubmitted = s.submitted;
+            mFrameExecuted = s.executed;
+            mFrameTotal = s.block->commands.size();
+        }
+        emit frameReady();
+    }
+}
+
+void ScanOverlayWidget::beginLayer(const marc::RTCCommandBlock& block, int width, int height) {
+    mCanvas = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+    mCanvas.fill(kBackground);
+    mDrawnSubmitted = 0;
+    mDrawnExecuted = 0;
+
+    // Fit the layer's bounding box (RTC5 bits, Y up) into the canvas
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+    for (const auto& c : block.commands) {
+        if (!isMove(c)) continue;
+        minX = std::min(minX, static_cast<double>(c.x)); maxX = std::max(maxX, static_cast<double>(c.x));
+        minY = std::min(minY, static_cast<double>(c.y)); maxY = std::max(maxY, static_cast<double>(c.y));
+    }
+    if (minX > maxX) return;
+    const double spanX = std::max(1.0, maxX - minX);
+    const double spanY = std::max(1.0, maxY - minY);
+    mPxPerBit = std::min((width - 16) / spanX, (height - 16) / spanY);
+    mMinX = minX - ((width / mPxPerBit) - spanX) / 2.0;
+    mMinY = minY - ((height / mPxPerBit) - spanY) / 2.0;
+
+    // Whole layer, dimmed
+    drawRange(block, 0, block.commands.size(), Stroke::Layer);
+}
+
+void ScanOverlayWidget::drawRange(const marc::RTCCommandBlock& block, size_t from, size_t to, Stroke stroke) {
+    if (mCanvas.isNull() || from >= to) return;
+    const auto& cmds = block.commands;
+    to = std::min(to, cmds.size());
+
+    // Pen position before 'from': last jump/mark preceding it
+    QPointF pen;
+    bool havePen = false;
+    for (size_t k = from; k > 0; --k) {
+        if (isMove(cmds[k - 1])) {
+            pen = QPointF((cmds[k - 1].x - mMinX) * mPxPerBit, mCanvas.height() - (cmds[k - 1].y - mMinY) * mPxPerBit);
+            havePen = true;
+            break;
+        }
+    }
+
+    // Walk parameter segments alongside the commands, one drawLines() per run
+    const auto& segs = block.parameterSegments;
+    size_t segIndex = 0;
+    while (segIndex < segs.size() && segs[segIndex].endCmd < from) ++segIndex;
+
+    const bool segmentColors = stroke != Stroke::Submitted;
+    QPainter p(&mCanvas);
+    p.setOpacity(stroke == Stroke::Layer ? 0.3 : stroke == Stroke::Submitted ? 0.6 : 1.0);
+    QVector<QLineF> lines;
+    lines.reserve(1024);
+    QColor color = segmentColors ? kSegmentColors[0] : QColor("#BDBDBD");
+
+    auto flush = [&] {
+        if (lines.isEmpty()) return;
+        p.setPen(QPen(color, 1.0));
+        p.drawLines(lines);
+        lines.clear();
+    };
+
+    for (size_t i = from; i < to; ++i) {
+        if (segIndex < segs.size() && i >= segs[segIndex].startCmd && i <= segs[segIndex].endCmd) {
+            const QColor segColor = kSegmentColors[segs[segIndex].buildStyleId % kSegmentColorCount];
+            if (segmentColors && segColor != color) { flush(); color = segColor; }
+        }
+        while (segIndex < segs.size() && i >= segs[segIndex].endCmd) ++segIndex;
+
+        const auto& c = cmds[i];
+        if (!isMove(c)) continue;
+        const QPointF pt((c.x - mMinX) * mPxPerBit, mCanvas.height() - (c.y - mMinY) * mPxPerBit);
+        if (c.type == marc::RTCCommandBlock::Command::Mark && havePen) lines.append(QLineF(pen, pt));
+        if (c.type == marc::RTCCommandBlock::Command::Expose) lines.append(QLineF(pt, pt + QPointF(1.0, 0.0)));
+        pen = pt;
+        havePen = true;
+    }
+    flush();
+}
+
+// ============================================================================
+// GUI thread
+// ============================================================================
+
+void ScanOverlayWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), kBackground);
+
+    std::lock_guard<std::mutex> lk(mFrameMutex);
+    if (mFrame.isNull()) {
+        painter.setPen(QColor("#888888"));
+        painter.drawText(rect(), Qt::AlignCenter, "Waiting for layer");
+        return;
+    }
+    painter.drawImage(rect(), mFrame);
+
+    const double pct = mFrameTotal > 0 ? 100.0 * mFrameExecuted / mFrameTotal : 0.0;
+    painter.setPen(QColor("#D4D4D4"));
+    painter.drawText(8, 16, QString("Layer %1  |  scanned %2%  |  %3 / %4 commands in list")
+                                .arg(mFrameLayer).arg(pct, 0, 'f', 1)
+                                .arg(static_cast<qulonglong>(mFrameSubmitted))
+                                .arg(static_cast<qulonglong>(mFrameTotal)));
+}
@@ -0,0 +1,77 @@
+#ifndef SCANOVERLAY_H
+#define SCANOVERLAY_H
+
+#include <QImage>
+#include <QWidget>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "controllers/scanprogressfeed.h"
+
+/**
+ * @brief ScanOverlayWidget - Live drawing of the layer being scanned
+ *
+ * DESIGN:
+ * - A renderer thread (not the GUI thread) wakes at most kFrameIntervalMs,
+ *   takes a ScanProgressFeed snapshot and returns immediately if nothing
+ *   changed. The consumer thread is never touched: it only bumps atomics.
+ * - Per layer, the mark vectors are drawn once, dimmed, colored by parameter
+ *   segment. Progress is painted incrementally on top: commands submitted to
+ *   the RTC5 list in light grey, executed commands in full segment color.
+ *   Each frame only draws the commands that advanced since the last frame.
+ * - The finished frame is handed to the GUI under a mutex and shown by
+ *   paintEvent as one scaled blit; text overlays are drawn there.
+ */
+class ScanOverlayWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    static constexpr int kFrameIntervalMs = 100;   // ~10 fps is plenty for a layer preview
+
+    explicit ScanOverlayWidget(const ScanProgressFeed& feed, QWidget* parent = nullptr);
+    ~ScanOverlayWidget() override;
+
+signals:
+    void frameReady();   // emitted from the renderer thread (queued to update())
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    void renderLoop();
+    void beginLayer(const marc::RTCCommandBlock& block, int width, int height);
+    enum class Stroke { Layer, Submitted, Executed };   // dimmed segment color / grey / full segment color
+    void drawRange(const marc::RTCCommandBlock& block, size_t from, size_t to, Stroke stroke);
+
+    const ScanProgressFeed& mFeed;
+
+    // Renderer thread state
+    std::thread mRenderer;
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCv;
+    std::atomic<bool> mStop{false};
+    std::atomic<int> mTargetWidth{0};
+    std::atomic<int> mTargetHeight{0};
+
+    QImage mCanvas;                 // renderer-owned
+    uint64_t mDrawnLayerSerial = 0;
+    size_t mDrawnSubmitted = 0;
+    size_t mDrawnExecuted = 0;
+    double mMinX = 0.0;             // layer bounding box in RTC5 bits
+    double mMinY = 0.0;
+    double mPxPerBit = 1.0;
+
+    // Published frame (renderer -> GUI)
+    std::mutex mFrameMutex;
+    QImage mFrame;
+    uint32_t mFrameLayer = 0;
+    size_t mFrameExecuted = 0;
+    size_t mFrameSubmitted = 0;
+    size_t mFrameTotal = 0;
+};
+
+#endif // SCANOVERLAY_H
@@ -1,4 +1,6 @@
 #include "opcserverua.h"
+#include "diagnostics/trace.h"
+#include "diagnostics/metrics.h"
 
 #include <QThread>
 #include <cstring>
@@ -274,7 +276,11 @@ bool OPCServerManagerUA::readInt32Node(const UA_NodeId& nodeId, int& value) {
         std::scoped_lock uaLock(mUaCallMutex);
         
         // ========== Read value attribute from server ==========
-        UA_StatusCode status = UA_Client_readValueAttribute(client, nodeId, &variant);
+        UA_StatusCode status;
+        {
+            marc::metrics::ScopedTimer roundTrip(marc::metrics::pipeline().opcReadUs);
+            status = UA_Client_readValueAttribute(client, nodeId, &variant);
+        }
         
         if (status != UA_STATUSCODE_GOOD) {
             // ========== Detect connection loss ==========
@@ -333,7 +339,11 @@ bool OPCServerManagerUA::readBoolNode(const UA_NodeId& nodeId, bool& value) {
         std::scoped_lock uaLock(mUaCallMutex);
         
         // ========== Read value attribute from server ==========
-        UA_StatusCode status = UA_Client_readValueAttribute(client, nodeId, &variant);
+        UA_StatusCode status;
+        {
+            marc::metrics::ScopedTimer roundTrip(marc::metrics::pipeline().opcReadUs);
+            status = UA_Client_readValueAttribute(client, nodeId, &variant);
+        }
         
         if (status != UA_STATUSCODE_GOOD) {
             // ========== Detect connection loss ==========
@@ -390,7 +400,11 @@ bool OPCServerManagerUA::writeInt32Node(const UA_NodeId& nodeId, int value) {
         std::scoped_lock uaLock(mUaCallMutex);
         
         // ========== Write to server ==========
-        UA_StatusCode status = UA_Client_writeValueAttribute(client, nodeId, &variant);
+        UA_StatusCode status;
+        {
+            marc::metrics::ScopedTimer roundTrip(marc::metrics::pipeline().opcWriteUs);
+            status = UA_Client_writeValueAttribute(client, nodeId, &variant);
+        }
         
         // ========== ALWAYS clear variant, even on error ==========
         UA_Variant_clear(&variant);
@@ -437,7 +451,11 @@ bool OPCServerManagerUA::writeBoolNode(const UA_NodeId& nodeId, bool value) {
         std::scoped_lock uaLock(mUaCallMutex);
         
         // ========== Write to server ==========
-        UA_StatusCode status = UA_Client_writeValueAttribute(client, nodeId, &variant);
+        UA_StatusCode status;
+        {
+            marc::metrics::ScopedTimer roundTrip(marc::metrics::pipeline().opcWriteUs);
+            status = UA_Client_writeValueAttribute(client, nodeId, &variant);
+        }
         
         // ========== ALWAYS clear variant, even on error ==========
         UA_Variant_clear(&variant);
@@ -465,6 +483,7 @@ bool OPCServerManagerUA::writeBoolNode(const UA_NodeId& nodeId, bool value) {
 // ============================================================================
 
 bool OPCServerManagerUA::readData(OPCData& data) {
+    MARC_TRACE_SCOPE("opc", "readData");
     // ========== Stage 1: Quick state check to detect obvious connection loss ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -545,6 +564,7 @@ bool OPCServerManagerUA::readData(OPCData& data) {
 }
 
 bool OPCServerManagerUA::writeStartUp(bool value) {
+    MARC_TRACE_SCOPE("opc", "writeStartUp");
     // ========== Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -564,6 +584,7 @@ bool OPCServerManagerUA::writeStartUp(bool value) {
 }
 
 bool OPCServerManagerUA::writePowderFillParameters(int layers, int deltaSource, int deltaSink) {
+    MARC_TRACE_SCOPE("opc", "writePowderFillParameters");
     // ========== Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -601,6 +622,7 @@ bool OPCServerManagerUA::writePowderFillParameters(int layers, int deltaSource,
 }
 
 bool OPCServerManagerUA::writeLayerParameters(int layers, int deltaSource, int deltaSink) {
+    MARC_TRACE_SCOPE("opc", "writeLayerParameters");
     // ========== Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -651,6 +673,7 @@ bool OPCServerManagerUA::writeLayerParameters(int layers, int deltaSource, int d
 }
 
 bool OPCServerManagerUA::writeBottomLayerParameters(int layers, int deltaSource, int deltaSink) {
+    MARC_TRACE_SCOPE("opc", "writeBottomLayerParameters");
     // ========== Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -685,6 +708,7 @@ bool OPCServerManagerUA::writeBottomLayerParameters(int layers, int deltaSource,
 }
 
 bool OPCServerManagerUA::writeEmergencyStop() {
+    MARC_TRACE_SCOPE("opc", "writeEmergencyStop");
     // ========== Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -707,6 +731,7 @@ bool OPCServerManagerUA::writeEmergencyStop() {
 }
 
 bool OPCServerManagerUA::writeCylinderPosition(bool isSource, int position) {
+    MARC_TRACE_SCOPE("opc", "writeCylinderPosition");
     // ========== Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
@@ -737,6 +762,7 @@ bool OPCServerManagerUA::writeCylinderPosition(bool isSource, int position) {
 }
 
 bool OPCServerManagerUA::writeLayerExecutionComplete(int layerNumber) {
+    MARC_TRACE_SCOPE("opc", "writeLayerExecutionComplete");
     // ========== Stage 1: Quick state check ==========
     {
         std::scoped_lock lock(mStateMutex);
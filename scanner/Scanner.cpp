@@ -11,6 +11,8 @@
 // 7. Prevent dual Scanner instances via delete copy/move constructors
 
 #include "Scanner.h"
+#include "diagnostics/trace.h"
+#include "diagnostics/logring.h"
 #include <windows.h>
 #include <stdio.h>
 #include <math.h>
@@ -155,6 +157,10 @@ void Scanner::assertOwnerThread() const {
     }
 }
 
+bool Scanner::initialize() {
+    return initialize(Config());
+}
+
 bool Scanner::initialize(const Config& config) {
     try {
         // ? NEW: Use mutex to prevent concurrent initialization
@@ -484,7 +490,8 @@ bool Scanner::pauseScanning() {
         std::lock_guard<std::mutex> lock(mMutex);
         assertOwnerThread();
 
-        if (!mIsScanning) return false;
+        // Also for lists run without startScanning() (file2RTC): pause_list holds any executing list
+        if (!mIsInitialized) return false;
         pause_list();
         logMessage("Scanning paused");
         return true;
@@ -535,6 +542,19 @@ bool Scanner::markTo(const Point& destination)
     return checkRTC5Error("mark_abs");
 }
 
+bool Scanner::exposePoint(const Point& location, UINT delayMicroseconds, UINT exposureMicroseconds)
+{
+    if (!mIsInitialized) return false;
+    jump_abs(location.x, location.y);
+    if (delayMicroseconds > 0) {
+        long_delay((delayMicroseconds + 9) / 10);
+    }
+    // laser_on_list period is in 10 us units; a requested exposure never rounds to zero
+    const UINT period = (exposureMicroseconds + 5) / 10;
+    laser_on_list(period > 0 ? period : 1);
+    return checkRTC5Error("exposePoint");
+}
+
 bool Scanner::plotLine(const Point& destination)
 {
     // This function is deprecated by the new model.
@@ -607,6 +627,7 @@ bool Scanner::setLaserPower(UINT channel, UINT value) {
 
 bool Scanner::executeList()
 {
+    MARC_TRACE_SCOPE("scanner", "executeList");
    // std::lock_guard<std::mutex> lock(mMutex);
     if (!mIsInitialized) {
         return false;
@@ -873,6 +894,7 @@ bool Scanner::setJumpSpeedList(double speed) {
 }
 
 bool Scanner::applySegmentParameters(double laserPower, double laserSpeed, double jumpSpeed) {
+    MARC_TRACE_SCOPE("scanner", "applySegmentParameters");
     try {
         std::lock_guard<std::mutex> lock(mMutex);
         assertOwnerThread();
@@ -900,10 +922,9 @@ bool Scanner::applySegmentParameters(double laserPower, double laserSpeed, doubl
             return false;
         }
 
-        char msg[256];
-        sprintf_s(msg, "Applied segment parameters: power=%u (%.1fW), markSpeed=%.1f mm/s, jumpSpeed=%.1f mm/s",
+        // Called on every segment switch: log through the lock-free ring, not logMessage()
+        MARC_LOG_DEBUG(0, "Applied segment parameters: power=%u (%.1fW), markSpeed=%.1f mm/s, jumpSpeed=%.1f mm/s",
             powerValue, laserPower, laserSpeed, jumpSpeed);
-        logMessage(msg);
 
         return true;
     }
@@ -1158,6 +1179,7 @@ void Scanner::terminateDLL() {
     }
 }
 bool Scanner::prepareListForLayer() {
+    MARC_TRACE_SCOPE("scanner", "prepareListForLayer");
     // This function is now simplified as the list management is more direct.
     // The primary role is to open the list for writing.
     if (!mIsInitialized) {
@@ -1169,6 +1191,7 @@ bool Scanner::prepareListForLayer() {
     return checkRTC5Error("set_start_list");
 }
 bool Scanner::waitForListCompletion(UINT timeoutMs) {
+    MARC_TRACE_SCOPE("scanner", "waitForListCompletion");
     //std::lock_guard<std::mutex> lock(mMutex);
     if (!mIsInitialized) return false;
 
@@ -1,7 +1,6 @@
 ﻿#ifndef SCANNER_H
 #define SCANNER_H
 
-#include <windows.h>
 #include <functional>
 #include <string>
 #include <vector>
@@ -9,9 +8,18 @@
 #include <atomic>
 #include <thread>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if defined(MARCSLM_SIMULATED_SCANNER) && MARCSLM_SIMULATED_SCANNER
+// Simulated backend (scanner/ScannerSim.cpp): no Windows / RTC5 headers required
+typedef unsigned int UINT;
+#else
+#include <windows.h>
 
 // RTC5 header file for explicitly linking to the RTC5DLL.DLL
 #include "RTC5expl.h"
+#endif
 
 // ============================================================================
 // Global RTC5 DLL Lifecycle Management (Process-Wide)
@@ -37,6 +45,39 @@ private:
     static RTC5DLLManager* sInstance;
 };
 
+#if defined(MARCSLM_SIMULATED_SCANNER) && MARCSLM_SIMULATED_SCANNER
+// ============================================================================
+// ScannerSimulation - Settings and counters of the simulated backend
+// ============================================================================
+// The simulated Scanner keeps the RTC5 list semantics (open list, queue
+// jump/mark, execute, wait) and replaces the card with a timing model:
+//   jump: distance / jumpSpeed + jumpDelay
+//   mark: distance / markSpeed + polygonDelay (markDelay at the end of a mark run)
+// Speeds are the BuildStyle values (mm/s), distances are converted from bits
+// with bitsPerMM. Execution time is divided by timeScale, so a build can be
+// replayed faster than real time while busySeconds stays in machine time.
+struct ScannerSimulation {
+    struct Settings {
+        double timeScale = 1.0;         // >1 = faster than real time
+        double bitsPerMM = 2.0 * 524287.0 / 163.4;
+    };
+
+    struct Stats {
+        double busySeconds = 0.0;       // simulated galvo time (machine time)
+        double markMM = 0.0;
+        double jumpMM = 0.0;
+        uint64_t jumps = 0;
+        uint64_t marks = 0;
+        uint64_t listsExecuted = 0;
+    };
+
+    static void configure(const Settings& settings);
+    static Settings settings();
+    static Stats stats();
+    static void resetStats();
+};
+#endif
+
 // ============================================================================
 // Scanner Class - Handles RTC5 Scanner operations for SCANLAB
 // ============================================================================
@@ -118,7 +159,8 @@ public:
 
     // Initialization
     // ✅ CRITICAL: Must be called from the thread that will own the Scanner
-    bool initialize(const Config& config = Config());
+    bool initialize();                      // default Config
+    bool initialize(const Config& config);
     bool isInitialized() const { return mIsInitialized; }
     void shutdown();
 
@@ -133,6 +175,8 @@ public:
     bool jumpTo(const Point& destination);
     bool markTo(const Point& destination);
     bool plotLine(const Point& destination);
+    // Point exposure in the list: jump, settle for delay, laser on for exposure (card-timed, 10 us resolution)
+    bool exposePoint(const Point& location, UINT delayMicroseconds, UINT exposureMicroseconds);
     void setBeamDump(const Point& location);
 
     // ========== NEW: RTC5 List Buffer Management (Demo3 Pattern) =========
@@ -251,6 +295,26 @@ private:
 
     // Mutex for thread safety
     mutable std::mutex mMutex;
+
+#if defined(MARCSLM_SIMULATED_SCANNER) && MARCSLM_SIMULATED_SCANNER
+    // Simulated card state (ScannerSim.cpp)
+    void simQueueMove(const Point& destination, bool mark);
+
+    double mSimMarkSpeed = 0.0;         // mm/s
+    double mSimJumpSpeed = 0.0;         // mm/s
+    Point mSimPosition;
+    bool mSimLastWasMark = false;
+    ScannerSimulation::Stats mSimList;  // open list, folded into the global stats on execute
+    std::chrono::steady_clock::time_point mSimBusyUntil{};
+
+    // List position model: machine seconds at the end of each list command
+    double simElapsedSeconds() const;   // machine time into the executing list
+    std::vector<double> mSimListEnds;   // open list
+    std::vector<double> mSimRunEnds;    // executing list
+    std::chrono::steady_clock::time_point mSimRunStart{};
+    bool mSimPaused = false;            // pause_list until restart_list
+    std::chrono::steady_clock::time_point mSimPausedAt{};
+#endif
 };
 
 #endif // SCANNER_H
\ No newline at end of file
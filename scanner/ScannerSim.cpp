@@ -0,0 +1,546 @@
+// scanner_lib/ScannerSim.cpp
+// Simulated RTC5 backend - same Scanner interface, no card and no RTC5 DLL.
+//
+// Built instead of Scanner.cpp when MARCSLM_SIMULATED_SCANNER=1 (replay
+// harness, development machines). List handling mirrors Scanner.cpp:
+//   prepareListForLayer() -> jumpTo()/markTo() ... -> executeList() -> waitForListCompletion()
+// Each queued vector is costed with the timing model described in Scanner.h;
+// executeList() makes the "card" busy for that time divided by the time scale.
+
+#include "Scanner.h"
+#include "diagnostics/trace.h"
+#include "diagnostics/logring.h"
+#include <stdio.h>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <cassert>
+
+namespace {
+std::mutex sSimMutex;
+ScannerSimulation::Settings sSimSettings;
+ScannerSimulation::Stats sSimStats;
+}
+
+// ============================================================================
+// ScannerSimulation
+// ============================================================================
+
+void ScannerSimulation::configure(const Settings& settings) {
+    std::lock_guard<std::mutex> lock(sSimMutex);
+    sSimSettings = settings;
+    if (sSimSettings.timeScale <= 0.0) sSimSettings.timeScale = 1.0;
+    if (sSimSettings.bitsPerMM <= 0.0) sSimSettings.bitsPerMM = Settings().bitsPerMM;
+}
+
+ScannerSimulation::Settings ScannerSimulation::settings() {
+    std::lock_guard<std::mutex> lock(sSimMutex);
+    return sSimSettings;
+}
+
+ScannerSimulation::Stats ScannerSimulation::stats() {
+    std::lock_guard<std::mutex> lock(sSimMutex);
+    return sSimStats;
+}
+
+void ScannerSimulation::resetStats() {
+    std::lock_guard<std::mutex> lock(sSimMutex);
+    sSimStats = Stats();
+}
+
+// ============================================================================
+// Global RTC5 DLL Manager (simulated: reference counting only)
+// ============================================================================
+
+std::mutex RTC5DLLManager::sMutex;
+std::atomic<int> RTC5DLLManager::sRefCount(0);
+std::atomic<bool> RTC5DLLManager::sRTC5Opened(false);
+RTC5DLLManager* RTC5DLLManager::sInstance = nullptr;
+
+RTC5DLLManager& RTC5DLLManager::instance() {
+    static RTC5DLLManager sManager;
+    return sManager;
+}
+
+RTC5DLLManager::RTC5DLLManager() {
+}
+
+RTC5DLLManager::~RTC5DLLManager() {
+}
+
+bool RTC5DLLManager::acquireDLL() {
+    std::lock_guard<std::mutex> lock(sMutex);
+    if (sRefCount.load() == 0) {
+        sRTC5Opened.store(true);
+    }
+    sRefCount++;
+    return true;
+}
+
+void RTC5DLLManager::releaseDLL() {
+    std::lock_guard<std::mutex> lock(sMutex);
+    const int newCount = sRefCount.load() - 1;
+    if (newCount < 0) {
+        fprintf(stderr, "ERROR: RTC5DLLManager::releaseDLL() called too many times\n");
+        return;
+    }
+    if (newCount == 0) {
+        sRTC5Opened.store(false);
+    }
+    sRefCount.store(newCount);
+}
+
+// ============================================================================
+// Scanner Implementation (simulated)
+// ============================================================================
+
+Scanner::Scanner()
+    : mIsInitialized(false)
+    , mIsScanning(false)
+    , mLastError(0)
+    , mConfig()
+    , mBeamDump(0, 0)
+    , mStartFlags(0)
+    , mOwnerThread()
+    , mOwnerThreadSet(false)
+    , mListLevel(0)
+    , mCurrentList(1)
+    , mFirstExecution(true)
+{
+}
+
+Scanner::~Scanner() {
+    try {
+        shutdown();
+    }
+    catch (const std::exception& e) {
+        fprintf(stderr, "Exception in Scanner::~Scanner: %s\n", e.what());
+    }
+}
+
+void Scanner::assertOwnerThread() const {
+    if (mOwnerThreadSet && std::this_thread::get_id() != mOwnerThread) {
+#ifdef _DEBUG
+        assert(false && "RTC5 API called from wrong thread");
+#else
+        throw std::runtime_error("RTC5 API called from wrong thread");
+#endif
+    }
+}
+
+bool Scanner::initialize() {
+    return initialize(Config());
+}
+
+bool Scanner::initialize(const Config& config) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mIsInitialized) {
+        return true;
+    }
+
+    mOwnerThread = std::this_thread::get_id();
+    mOwnerThreadSet = true;
+    mConfig = config;
+    mSimMarkSpeed = config.markSpeed;
+    mSimJumpSpeed = config.jumpSpeed;
+    mSimPosition = Point();
+    mSimLastWasMark = false;
+    mSimList = ScannerSimulation::Stats();
+    mSimBusyUntil = std::chrono::steady_clock::now();
+    mIsInitialized = true;
+    return true;
+}
+
+void Scanner::shutdown() {
+    if (!mIsInitialized) return;
+    waitForListCompletion(0xFFFFFFFFu);
+    mIsInitialized = false;
+    mIsScanning = false;
+    mOwnerThreadSet = false;
+}
+
+bool Scanner::startScanning() {
+    if (!mIsInitialized) return false;
+    mIsScanning = true;
+    return true;
+}
+
+bool Scanner::stopScanning() {
+    if (!mIsInitialized) return false;
+    mSimBusyUntil = std::chrono::steady_clock::now();
+    mSimRunEnds.clear();
+    mSimPaused = false;
+    mIsScanning = false;
+    return true;
+}
+
+// pause_list: the executing list halts at its current command until restart_list
+bool Scanner::pauseScanning() {
+    if (!mIsInitialized) return false;
+    const auto now = std::chrono::steady_clock::now();
+    if (!mSimPaused && now < mSimBusyUntil) {
+        mSimPaused = true;
+        mSimPausedAt = now;
+    }
+    return true;
+}
+
+bool Scanner::resumeScanning() {
+    if (!mIsInitialized) return false;
+    if (mSimPaused) {
+        const auto paused = std::chrono::steady_clock::now() - mSimPausedAt;
+        mSimRunStart += paused;
+        mSimBusyUntil += paused;
+        mSimPaused = false;
+    }
+    mIsScanning = true;
+    return true;
+}
+
+// ============================================================================
+// Drawing Operations
+// ============================================================================
+
+void Scanner::simQueueMove(const Point& destination, bool mark) {
+    const double bitsPerMM = ScannerSimulation::settings().bitsPerMM;
+    const double dx = static_cast<double>(destination.x - mSimPosition.x);
+    const double dy = static_cast<double>(destination.y - mSimPosition.y);
+    const double mm = std::sqrt(dx * dx + dy * dy) / bitsPerMM;
+
+    // Config delays are in 10 us units
+    double seconds = 0.0;
+    if (mark) {
+        seconds = (mSimMarkSpeed > 0.0 ? mm / mSimMarkSpeed : 0.0) + mConfig.polygonDelay * 10e-6;
+        mSimList.markMM += mm;
+        ++mSimList.marks;
+    } else {
+        if (mSimLastWasMark) seconds += mConfig.markDelay * 10e-6;
+        seconds += (mSimJumpSpeed > 0.0 ? mm / mSimJumpSpeed : 0.0) + mConfig.jumpDelay * 10e-6;
+        mSimList.jumpMM += mm;
+        ++mSimList.jumps;
+    }
+    mSimList.busySeconds += seconds;
+    mSimListEnds.push_back(mSimList.busySeconds);
+    mSimPosition = destination;
+    mSimLastWasMark = mark;
+}
+
+bool Scanner::jumpTo(const Point& destination)
+{
+    if (!mIsInitialized) return false;
+    simQueueMove(destination, false);
+    return true;
+}
+
+bool Scanner::markTo(const Point& destination)
+{
+    if (!mIsInitialized) return false;
+    simQueueMove(destination, true);
+    return true;
+}
+
+bool Scanner::exposePoint(const Point& location, UINT delayMicroseconds, UINT exposureMicroseconds)
+{
+    if (!mIsInitialized) return false;
+    simQueueMove(location, false);
+    mSimList.busySeconds += (static_cast<double>(delayMicroseconds) + exposureMicroseconds) * 1e-6;
+    return true;
+}
+
+bool Scanner::plotLine(const Point& destination)
+{
+    return markTo(destination);
+}
+
+// ============================================================================
+// Laser Control
+// ============================================================================
+
+bool Scanner::enableLaser() {
+    assertOwnerThread();
+    return mIsInitialized;
+}
+
+bool Scanner::disableLaser() {
+    assertOwnerThread();
+    return mIsInitialized;
+}
+
+bool Scanner::setLaserPower(UINT channel, UINT value) {
+    (void)channel;
+    (void)value;
+    return mIsInitialized;
+}
+
+// ============================================================================
+// List Management
+// ============================================================================
+
+bool Scanner::executeList()
+{
+    MARC_TRACE_SCOPE("scanner", "executeList");
+    if (!mIsInitialized) {
+        return false;
+    }
+
+    // The card starts the list once the previous one has finished
+    const double timeScale = ScannerSimulation::settings().timeScale;
+    const auto now = std::chrono::steady_clock::now();
+    const auto start = (mSimBusyUntil > now) ? mSimBusyUntil : now;
+    mSimBusyUntil = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(mSimList.busySeconds / timeScale));
+    mSimRunStart = start;
+    mSimRunEnds.swap(mSimListEnds);
+    mSimListEnds.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(sSimMutex);
+        sSimStats.busySeconds += mSimList.busySeconds;
+        sSimStats.markMM += mSimList.markMM;
+        sSimStats.jumpMM += mSimList.jumpMM;
+        sSimStats.jumps += mSimList.jumps;
+        sSimStats.marks += mSimList.marks;
+        ++sSimStats.listsExecuted;
+    }
+    mSimList = ScannerSimulation::Stats();
+    return true;
+}
+
+bool Scanner::flushQueue() {
+    if (!mIsInitialized) return false;
+    mSimList = ScannerSimulation::Stats();
+    mSimListEnds.clear();
+    mSimBusyUntil = std::chrono::steady_clock::now();
+    return true;
+}
+
+double Scanner::simElapsedSeconds() const {
+    const auto at = mSimPaused ? mSimPausedAt : std::chrono::steady_clock::now();
+    if (at <= mSimRunStart) return 0.0;
+    return std::chrono::duration<double>(at - mSimRunStart).count() * ScannerSimulation::settings().timeScale;
+}
+
+void Scanner::getStatus(UINT& busy, UINT& position) {
+    // A paused list stays busy; position = list commands completed, like the card's output pointer
+    busy = (mIsInitialized && (mSimPaused || std::chrono::steady_clock::now() < mSimBusyUntil)) ? 1u : 0u;
+    const double elapsed = simElapsedSeconds();
+    position = static_cast<UINT>(std::upper_bound(mSimRunEnds.begin(), mSimRunEnds.end(), elapsed) -
+                                 mSimRunEnds.begin());
+}
+
+UINT Scanner::getInputPointer() {
+    return static_cast<UINT>(mSimList.jumps + mSimList.marks);
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+void Scanner::setConfig(const Config& config) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mConfig = config;
+}
+
+// ============================================================================
+// Error Handling
+// ============================================================================
+
+UINT Scanner::getLastError() const {
+    return mLastError;
+}
+
+std::string Scanner::getErrorMessage() const {
+    return "Error code: " + std::to_string(getLastError());
+}
+
+bool Scanner::resetError() {
+    if (!mIsInitialized) return false;
+    mLastError = 0;
+    return true;
+}
+
+Scanner::ScannerStatus Scanner::getDetailedStatus() {
+    ScannerStatus status = {};
+    getStatus(status.isBusy, status.listPosition);
+    status.inputPointer = getInputPointer();
+    status.encoderX = mSimPosition.x;
+    status.encoderY = mSimPosition.y;
+    return status;
+}
+
+// ============================================================================
+// Laser Control (in list)
+// ============================================================================
+
+bool Scanner::setLaserPowerList(UINT value) {
+    (void)value;
+    return mIsInitialized;
+}
+
+bool Scanner::laserSignalOnList() {
+    return mIsInitialized;
+}
+
+bool Scanner::laserSignalOffList() {
+    return mIsInitialized;
+}
+
+// ============================================================================
+// Dynamic Speed Control
+// ============================================================================
+
+bool Scanner::setMarkSpeedList(double speed) {
+    if (!mIsInitialized) return false;
+    mSimMarkSpeed = speed;
+    return true;
+}
+
+bool Scanner::setJumpSpeedList(double speed) {
+    if (!mIsInitialized) return false;
+    mSimJumpSpeed = speed;
+    return true;
+}
+
+bool Scanner::applySegmentParameters(double laserPower, double laserSpeed, double jumpSpeed) {
+    MARC_TRACE_SCOPE("scanner", "applySegmentParameters");
+    if (!mIsInitialized) {
+        logMessage("ERROR: Scanner not initialized");
+        return false;
+    }
+
+    mSimMarkSpeed = laserSpeed;
+    mSimJumpSpeed = jumpSpeed;
+
+    MARC_LOG_DEBUG(0, "Applied segment parameters (simulated): power=%.1fW, markSpeed=%.1f mm/s, jumpSpeed=%.1f mm/s",
+        laserPower, laserSpeed, jumpSpeed);
+    return true;
+}
+
+// ============================================================================
+// Delay and Timing Control
+// ============================================================================
+
+bool Scanner::addDelay(UINT delayMicroseconds) {
+    if (!mIsInitialized) return false;
+    mSimList.busySeconds += delayMicroseconds * 1e-6;
+    return true;
+}
+
+bool Scanner::setScannerDelays(UINT jump, UINT mark, UINT polygon) {
+    if (!mIsInitialized) return false;
+    mConfig.jumpDelay = jump;
+    mConfig.markDelay = mark;
+    mConfig.polygonDelay = polygon;
+    return true;
+}
+
+// ============================================================================
+// Logging
+// ============================================================================
+
+void Scanner::setLogCallback(std::function<void(const std::string&)> callback) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLogCallback = callback;
+}
+
+void Scanner::logMessage(const std::string& message) {
+    std::function<void(const std::string&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        callback = mLogCallback;
+    }
+    if (callback) {
+        callback(message);
+    }
+}
+
+// ============================================================================
+// Batch Drawing Operations
+// ============================================================================
+
+bool Scanner::drawVectors(const std::vector<Point>& points, bool closeLoop) {
+    if (!mIsInitialized || points.empty()) return false;
+
+    simQueueMove(points[0], false);
+    for (size_t i = 1; i < points.size(); i++) {
+        simQueueMove(points[i], true);
+    }
+    if (closeLoop && points.size() > 2) {
+        simQueueMove(points[0], true);
+    }
+    return true;
+}
+
+bool Scanner::drawPolyline(const std::vector<Point>& points) {
+    return drawVectors(points, false);
+}
+
+bool Scanner::drawPolygon(const std::vector<Point>& points) {
+    return drawVectors(points, true);
+}
+
+// ============================================================================
+// Wobble / Position / Pixel (accepted, no effect on timing)
+// ============================================================================
+
+bool Scanner::setWobble(UINT transversal, UINT longitudinal, double freq) {
+    (void)transversal;
+    (void)longitudinal;
+    (void)freq;
+    return mIsInitialized;
+}
+
+bool Scanner::disableWobble() {
+    return mIsInitialized;
+}
+
+bool Scanner::getCurrentPosition(long& x, long& y) {
+    if (!mIsInitialized) return false;
+    x = mSimPosition.x;
+    y = mSimPosition.y;
+    return true;
+}
+
+bool Scanner::setPixelMode(UINT pulseLength, UINT analogOut) {
+    (void)pulseLength;
+    (void)analogOut;
+    return mIsInitialized;
+}
+
+bool Scanner::setPixelLine(UINT channel, UINT halfPeriod, double dX, double dY) {
+    (void)channel;
+    (void)halfPeriod;
+    (void)dX;
+    (void)dY;
+    return mIsInitialized;
+}
+
+// ============================================================================
+// ============================================================================
+
+bool Scanner::prepareListForLayer() {
+    MARC_TRACE_SCOPE("scanner", "prepareListForLayer");
+    if (!mIsInitialized) {
+        logMessage("ERROR: Cannot prepare list - scanner not initialized");
+        return false;
+    }
+    mSimList = ScannerSimulation::Stats();
+    mSimListEnds.clear();
+    return true;
+}
+
+bool Scanner::waitForListCompletion(UINT timeoutMs) {
+    MARC_TRACE_SCOPE("scanner", "waitForListCompletion");
+    if (!mIsInitialized) return false;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    if (mSimPaused || mSimBusyUntil > deadline) {   // a paused list only ends with restart_list
+        std::this_thread::sleep_until(deadline);
+        logMessage("ERROR: List execution timeout");
+        return false;
+    }
+    std::this_thread::sleep_until(mSimBusyUntil);
+    return true;
+}